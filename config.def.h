@@ -475,6 +475,11 @@ static const bool video_shader_watch_files = false;
 /* Screenshots named automatically. */
 static const bool auto_screenshot_filename = true;
 
+/* zlib level for PNG screenshots and savestate thumbnails,
+ * 0 (stored) to 9 (smallest). 3 and below also skip the slower
+ * line filters, for screenshots taken mid-game without a hitch. */
+static const unsigned screenshot_compression = 6;
+
 /* Record post-shaded GPU output instead of raw game footage if available. */
 static const bool gpu_record = false;
 
@@ -649,6 +654,17 @@ static const unsigned netplay_delay_frames = 16;
 
 static const int netplay_check_frames = 600;
 
+/* Serialize the core for rollback only every N frames;
+ * frames in between are rebuilt by replaying input. This
+ * saves a serialization on most frames, but a rollback has
+ * to replay from further back, so the slowest frames get
+ * slower. 1 serializes every frame, as before. */
+static const unsigned netplay_snapshot_interval = 1;
+
+/* Also send input over UDP, repeating the last few frames
+ * in each datagram, so a lost packet doesn't stall it. */
+static const bool netplay_udp_input = false;
+
 static const bool netplay_use_mitm_server = false;
 
 static const char *netplay_mitm_server = "nyc";
@@ -721,6 +737,11 @@ static const bool default_menu_show_start_screen = true;
 
 static const bool menu_dpi_override_enable = false;
 
+/* Stop redrawing the menu while nothing on it changes
+ * (no input, animation, message or core running behind it)
+ * and keep showing the last frame. */
+static const bool menu_skip_idle_frames = true;
+
 #ifdef RARCH_MOBILE
 static const unsigned menu_dpi_override_value = 72;
 #elif defined(__CELLOS_LV2__)
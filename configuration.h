@@ -152,6 +152,7 @@ typedef struct settings
       bool menu_dpi_override_enable;
       bool menu_show_advanced_settings;
       bool menu_throttle_framerate;
+      bool menu_skip_idle_frames;
       bool menu_linear_filter;
       bool menu_horizontal_animation;
       bool menu_show_online_updater;
@@ -214,6 +215,7 @@ typedef struct settings
       bool netplay_require_slaves;
       bool netplay_stateless_mode;
       bool netplay_nat_traversal;
+      bool netplay_udp_input;
       bool netplay_use_mitm_server;
       bool netplay_request_devices[MAX_USERS];
 
@@ -380,6 +382,7 @@ typedef struct settings
       unsigned netplay_port;
       unsigned netplay_input_latency_frames_min;
       unsigned netplay_input_latency_frames_range;
+      unsigned netplay_snapshot_interval;
       unsigned netplay_share_digital;
       unsigned netplay_share_analog;
       unsigned bundle_assets_extract_version_current;
@@ -466,6 +469,7 @@ typedef struct settings
       unsigned window_position_height;
 
       unsigned video_record_threads;
+      unsigned screenshot_compression;
 
       unsigned libnx_overclock;
    } uints;
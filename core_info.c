@@ -15,6 +15,9 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <ctype.h>
+#include <stdint.h>
+
 #include <compat/strl.h>
 #include <string/stdstring.h>
 #include <file/config_file.h>
@@ -27,6 +30,8 @@
 #include "config.h"
 #endif
 
+#include <encodings/crc32.h>
+
 #include "verbosity.h"
 
 #include "core_info.h"
@@ -34,13 +39,314 @@
 
 #if defined(__WINRT__) || defined(WINAPI_FAMILY) && WINAPI_FAMILY == WINAPI_FAMILY_PHONE_APP
 #include "uwp/uwp_func.h"
+#elif !defined(RARCH_CONSOLE)
+/* Startup loads the parsed .info files from a single binary
+ * cache while none of them changed. */
+#define CORE_INFO_CACHE_ENABLE
+#include <sys/types.h>
+#include <sys/stat.h>
 #endif
 
-static const char *core_info_tmp_path               = NULL;
-static const struct string_list *core_info_tmp_list = NULL;
+static const core_info_t *core_info_tmp_cores       = NULL;
+static const unsigned char *core_info_tmp_supported = NULL;
 static core_info_t *core_info_current               = NULL;
 static core_info_list_t *core_info_curr_list        = NULL;
 
+typedef struct core_info_map_entry
+{
+   char *key;
+   size_t *cores;
+   size_t count;
+   size_t capacity;
+   uint32_t hash;
+} core_info_map_entry_t;
+
+/* Open-addressing hash table keyed by a case-insensitive
+ * string (or an 'a|b' pair of strings), each key mapping
+ * to the indices of the cores in core_info_list_t->list
+ * it was registered by. */
+struct core_info_map
+{
+   core_info_map_entry_t *entries;
+   size_t capacity;
+   size_t size;
+};
+
+typedef struct core_info_map core_info_map_t;
+
+static uint32_t core_info_map_hash_str(uint32_t hash, const char *s)
+{
+   while (*s)
+      hash = (hash << 5) + hash + (uint32_t)tolower((unsigned char)*s++);
+   return hash;
+}
+
+static uint32_t core_info_map_hash(const char *a, const char *b)
+{
+   uint32_t hash = core_info_map_hash_str(5381, a);
+   if (b)
+   {
+      hash = (hash << 5) + hash + '|';
+      hash = core_info_map_hash_str(hash, b);
+   }
+   return hash;
+}
+
+static bool core_info_map_key_equal(const char *key,
+      const char *a, const char *b)
+{
+   while (*a)
+   {
+      if (tolower((unsigned char)*key) != tolower((unsigned char)*a))
+         return false;
+      key++;
+      a++;
+   }
+
+   if (!b)
+      return *key == '\0';
+   if (*key++ != '|')
+      return false;
+
+   return string_is_equal_noncase(key, b);
+}
+
+static core_info_map_t *core_info_map_new(void)
+{
+   core_info_map_t *map = (core_info_map_t*)calloc(1, sizeof(*map));
+
+   if (!map)
+      return NULL;
+
+   map->capacity = 64;
+   map->entries  = (core_info_map_entry_t*)
+      calloc(map->capacity, sizeof(*map->entries));
+
+   if (!map->entries)
+   {
+      free(map);
+      return NULL;
+   }
+
+   return map;
+}
+
+static void core_info_map_free(core_info_map_t *map)
+{
+   size_t i;
+
+   if (!map)
+      return;
+
+   for (i = 0; i < map->capacity; i++)
+   {
+      free(map->entries[i].key);
+      free(map->entries[i].cores);
+   }
+
+   free(map->entries);
+   free(map);
+}
+
+/**
+ * core_info_map_find:
+ * @map              : lookup table
+ * @a                : key (or first half of a pair key)
+ * @b                : second half of a pair key, or NULL
+ *
+ * Returns: the entry registered under @a (or @a|@b),
+ * NULL if there is none.
+ **/
+static const core_info_map_entry_t *core_info_map_find(
+      const core_info_map_t *map, const char *a, const char *b)
+{
+   size_t mask;
+   size_t slot;
+   uint32_t hash;
+
+   if (!map || !a)
+      return NULL;
+
+   mask = map->capacity - 1;
+   hash = core_info_map_hash(a, b);
+
+   for (slot = hash & mask; map->entries[slot].key; slot = (slot + 1) & mask)
+   {
+      const core_info_map_entry_t *entry = &map->entries[slot];
+
+      if (entry->hash == hash && core_info_map_key_equal(entry->key, a, b))
+         return entry;
+   }
+
+   return NULL;
+}
+
+static bool core_info_map_grow(core_info_map_t *map)
+{
+   size_t i;
+   size_t capacity                = map->capacity * 2;
+   core_info_map_entry_t *entries = (core_info_map_entry_t*)
+      calloc(capacity, sizeof(*entries));
+
+   if (!entries)
+      return false;
+
+   for (i = 0; i < map->capacity; i++)
+   {
+      size_t slot;
+
+      if (!map->entries[i].key)
+         continue;
+
+      slot = map->entries[i].hash & (capacity - 1);
+      while (entries[slot].key)
+         slot = (slot + 1) & (capacity - 1);
+      entries[slot] = map->entries[i];
+   }
+
+   free(map->entries);
+   map->entries  = entries;
+   map->capacity = capacity;
+   return true;
+}
+
+/**
+ * core_info_map_add:
+ * @map              : lookup table
+ * @a                : key (or first half of a pair key)
+ * @b                : second half of a pair key, or NULL
+ * @core             : index of the core in core_info_list_t->list
+ *
+ * Registers @core under @a (or @a|@b).
+ *
+ * Returns: true on success, false on allocation failure.
+ **/
+static bool core_info_map_add(core_info_map_t *map,
+      const char *a, const char *b, size_t core)
+{
+   size_t slot;
+   core_info_map_entry_t *entry = NULL;
+   uint32_t hash                = core_info_map_hash(a, b);
+
+   if ((map->size + 1) * 4 > map->capacity * 3)
+      if (!core_info_map_grow(map))
+         return false;
+
+   for (slot = hash & (map->capacity - 1); map->entries[slot].key;
+         slot = (slot + 1) & (map->capacity - 1))
+   {
+      if (map->entries[slot].hash == hash
+            && core_info_map_key_equal(map->entries[slot].key, a, b))
+      {
+         entry = &map->entries[slot];
+         break;
+      }
+   }
+
+   if (!entry)
+   {
+      size_t len = strlen(a) + (b ? strlen(b) + 1 : 0) + 1;
+      char *key  = (char*)malloc(len);
+
+      if (!key)
+         return false;
+
+      strlcpy(key, a, len);
+      if (b)
+      {
+         strlcat(key, "|", len);
+         strlcat(key, b, len);
+      }
+
+      entry       = &map->entries[slot];
+      entry->key  = key;
+      entry->hash = hash;
+      map->size++;
+   }
+
+   /* Cores are registered in order, so a repeated
+    * extension within one core shows up last. */
+   if (entry->count && entry->cores[entry->count - 1] == core)
+      return true;
+
+   if (entry->count == entry->capacity)
+   {
+      size_t capacity = entry->capacity ? entry->capacity * 2 : 4;
+      size_t *cores   = (size_t*)realloc(entry->cores,
+            capacity * sizeof(*cores));
+
+      if (!cores)
+         return false;
+
+      entry->cores    = cores;
+      entry->capacity = capacity;
+   }
+
+   entry->cores[entry->count++] = core;
+   return true;
+}
+
+/* Rewrites the core indices after core_info_list_t->list
+ * has been reordered; @new_pos maps old index to new. */
+static void core_info_map_remap(core_info_map_t *map, const size_t *new_pos)
+{
+   size_t i, j;
+
+   if (!map)
+      return;
+
+   for (i = 0; i < map->capacity; i++)
+   {
+      core_info_map_entry_t *entry = &map->entries[i];
+
+      for (j = 0; j < entry->count; j++)
+         entry->cores[j] = new_pos[entry->cores[j]];
+   }
+}
+
+static bool core_info_list_resolve_maps(core_info_list_t *core_info_list)
+{
+   size_t i, j, k;
+
+   if (!(core_info_list->extensions    = core_info_map_new()))
+      return false;
+   if (!(core_info_list->databases     = core_info_map_new()))
+      return false;
+   if (!(core_info_list->ext_databases = core_info_map_new()))
+      return false;
+
+   for (i = 0; i < core_info_list->count; i++)
+   {
+      const core_info_t *info          = &core_info_list->list[i];
+      const struct string_list *exts   = info->supported_extensions_list;
+      const struct string_list *dbs    = info->databases_list;
+
+      if (exts)
+         for (j = 0; j < exts->size; j++)
+            if (!core_info_map_add(core_info_list->extensions,
+                     exts->elems[j].data, NULL, i))
+               return false;
+
+      if (!dbs)
+         continue;
+
+      for (j = 0; j < dbs->size; j++)
+      {
+         if (!core_info_map_add(core_info_list->databases,
+                  dbs->elems[j].data, NULL, i))
+            return false;
+
+         if (exts)
+            for (k = 0; k < exts->size; k++)
+               if (!core_info_map_add(core_info_list->ext_databases,
+                        exts->elems[k].data, dbs->elems[j].data, i))
+                  return false;
+      }
+   }
+
+   return true;
+}
+
 static void core_info_list_resolve_all_extensions(
       core_info_list_t *core_info_list)
 {
@@ -82,60 +388,53 @@ static void core_info_list_resolve_all_extensions(
 #endif
 }
 
-static void core_info_list_resolve_all_firmware(
-      core_info_list_t *core_info_list)
+static void core_info_resolve_firmware(
+      core_info_t *info, config_file_t *config)
 {
-   size_t i;
    unsigned c;
+   unsigned count                  = 0;
+   core_info_firmware_t *firmware  = NULL;
 
-   for (i = 0; i < core_info_list->count; i++)
-   {
-      unsigned count                  = 0;
-      core_info_firmware_t *firmware  = NULL;
-      core_info_t *info               = (core_info_t*)&core_info_list->list[i];
-      config_file_t *config           = (config_file_t*)info->config_data;
-
-      if (!config || !config_get_uint(config, "firmware_count", &count))
-         continue;
+   if (!config || !config_get_uint(config, "firmware_count", &count))
+      return;
 
-      firmware = (core_info_firmware_t*)calloc(count, sizeof(*firmware));
+   firmware = (core_info_firmware_t*)calloc(count, sizeof(*firmware));
 
-      if (!firmware)
-         continue;
+   if (!firmware)
+      return;
 
-      info->firmware = firmware;
+   info->firmware = firmware;
 
-      for (c = 0; c < count; c++)
+   for (c = 0; c < count; c++)
+   {
+      char path_key[64];
+      char desc_key[64];
+      char opt_key[64];
+      bool tmp_bool     = false;
+      char *tmp         = NULL;
+      path_key[0]       = desc_key[0] = opt_key[0] = '\0';
+
+      snprintf(path_key, sizeof(path_key), "firmware%u_path", c);
+      snprintf(desc_key, sizeof(desc_key), "firmware%u_desc", c);
+      snprintf(opt_key,  sizeof(opt_key),  "firmware%u_opt",  c);
+
+      if (config_get_string(config, path_key, &tmp) && !string_is_empty(tmp))
       {
-         char path_key[64];
-         char desc_key[64];
-         char opt_key[64];
-         bool tmp_bool     = false;
-         char *tmp         = NULL;
-         path_key[0]       = desc_key[0] = opt_key[0] = '\0';
-
-         snprintf(path_key, sizeof(path_key), "firmware%u_path", c);
-         snprintf(desc_key, sizeof(desc_key), "firmware%u_desc", c);
-         snprintf(opt_key,  sizeof(opt_key),  "firmware%u_opt",  c);
-
-         if (config_get_string(config, path_key, &tmp) && !string_is_empty(tmp))
-         {
-            info->firmware[c].path = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
-         if (config_get_string(config, desc_key, &tmp) && !string_is_empty(tmp))
-         {
-            info->firmware[c].desc = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
-         if (tmp)
-            free(tmp);
+         info->firmware[c].path = strdup(tmp);
+         free(tmp);
+         tmp = NULL;
+      }
+      if (config_get_string(config, desc_key, &tmp) && !string_is_empty(tmp))
+      {
+         info->firmware[c].desc = strdup(tmp);
+         free(tmp);
          tmp = NULL;
-         if (config_get_bool(config, opt_key , &tmp_bool))
-            info->firmware[c].optional = tmp_bool;
       }
+      if (tmp)
+         free(tmp);
+      tmp = NULL;
+      if (config_get_bool(config, opt_key , &tmp_bool))
+         info->firmware[c].optional = tmp_bool;
    }
 }
 
@@ -171,7 +470,6 @@ static void core_info_list_free(core_info_list_t *core_info_list)
       string_list_free(info->licenses_list);
       string_list_free(info->categories_list);
       string_list_free(info->databases_list);
-      config_file_free((config_file_t*)info->config_data);
 
       for (j = 0; j < info->firmware_count; j++)
       {
@@ -181,6 +479,9 @@ static void core_info_list_free(core_info_list_t *core_info_list)
       free(info->firmware);
    }
 
+   core_info_map_free(core_info_list->extensions);
+   core_info_map_free(core_info_list->databases);
+   core_info_map_free(core_info_list->ext_databases);
    free(core_info_list->all_ext);
    free(core_info_list->list);
    free(core_info_list);
@@ -189,7 +490,7 @@ static void core_info_list_free(core_info_list_t *core_info_list)
 static bool core_info_list_iterate(
       char *s, size_t len,
       const char *path_basedir,
-      struct string_list *contents, size_t i)
+      const struct string_list *contents, size_t i)
 {
    size_t info_path_base_size = PATH_MAX_LENGTH * sizeof(char);
    char *info_path_base       = NULL;
@@ -227,40 +528,460 @@ static bool core_info_list_iterate(
    return true;
 }
 
-static core_info_list_t *core_info_list_new(const char *path,
-      const char *libretro_info_dir,
-      const char *exts,
-      bool dir_show_hidden_files)
+#ifdef CORE_INFO_CACHE_ENABLE
+#define CORE_INFO_CACHE_MAGIC       "RCIC"
+#define CORE_INFO_CACHE_VERSION     1
+#define CORE_INFO_CACHE_HEADER_SIZE 20
+
+enum core_info_cache_flags
 {
-   size_t i;
-   core_info_t *core_info           = NULL;
+   CORE_INFO_CACHE_HAS_INFO         = (1 << 0),
+   CORE_INFO_CACHE_SUPPORTS_NO_GAME = (1 << 1),
+   CORE_INFO_CACHE_MATCH_ARCHIVE    = (1 << 2)
+};
+
+/* Size and modification time of the .info file belonging
+ * to a core; a cached entry is only reused while these
+ * still match. */
+typedef struct core_info_cache_stat
+{
+   uint64_t size;
+   int64_t mtime;
+   bool present;
+} core_info_cache_stat_t;
+
+typedef struct core_info_cache_buf
+{
+   uint8_t *data;
+   size_t len;
+   size_t cap;
+   size_t pos;
+   bool error;
+} core_info_cache_buf_t;
+
+/**
+ * core_info_cache_stat_file:
+ * @path             : path to .info file
+ * @st               : stat record to fill
+ *
+ * Returns: false if the file exists but could not be
+ * stat()ed, in which case the cache cannot be trusted.
+ **/
+static bool core_info_cache_stat_file(const char *path,
+      core_info_cache_stat_t *st)
+{
+   struct stat buf;
+
+   memset(st, 0, sizeof(*st));
+
+   if (stat(path, &buf) == 0)
+   {
+      st->present = true;
+      st->size    = (uint64_t)buf.st_size;
+      st->mtime   = (int64_t)buf.st_mtime;
+      return true;
+   }
+
+   return !path_is_valid(path);
+}
+
+static void core_info_cache_put(core_info_cache_buf_t *buf,
+      const void *data, size_t len)
+{
+   if (buf->error)
+      return;
+
+   if (buf->len + len > buf->cap)
+   {
+      size_t cap    = buf->cap ? buf->cap : 4096;
+      uint8_t *tmp  = NULL;
+
+      while (cap < buf->len + len)
+         cap *= 2;
+
+      if (!(tmp = (uint8_t*)realloc(buf->data, cap)))
+      {
+         buf->error = true;
+         return;
+      }
+
+      buf->data = tmp;
+      buf->cap  = cap;
+   }
+
+   memcpy(buf->data + buf->len, data, len);
+   buf->len += len;
+}
+
+static void core_info_cache_put_u32(core_info_cache_buf_t *buf,
+      uint32_t val)
+{
+   uint8_t bytes[4];
+   bytes[0] = (uint8_t)(val);
+   bytes[1] = (uint8_t)(val >> 8);
+   bytes[2] = (uint8_t)(val >> 16);
+   bytes[3] = (uint8_t)(val >> 24);
+   core_info_cache_put(buf, bytes, sizeof(bytes));
+}
+
+static void core_info_cache_put_u64(core_info_cache_buf_t *buf,
+      uint64_t val)
+{
+   core_info_cache_put_u32(buf, (uint32_t)val);
+   core_info_cache_put_u32(buf, (uint32_t)(val >> 32));
+}
+
+/* Strings are stored as length + 1 followed by the bytes,
+ * so that 0 can encode a NULL pointer. */
+static void core_info_cache_put_string(core_info_cache_buf_t *buf,
+      const char *s)
+{
+   size_t len = s ? strlen(s) : 0;
+
+   core_info_cache_put_u32(buf, s ? (uint32_t)(len + 1) : 0);
+   if (s)
+      core_info_cache_put(buf, s, len);
+}
+
+static uint32_t core_info_cache_get_u32(core_info_cache_buf_t *buf)
+{
+   const uint8_t *p = NULL;
+
+   if (buf->error || buf->len - buf->pos < 4)
+   {
+      buf->error = true;
+      return 0;
+   }
+
+   p         = buf->data + buf->pos;
+   buf->pos += 4;
+
+   return (uint32_t)p[0]         | ((uint32_t)p[1] << 8)
+      |   ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t core_info_cache_get_u64(core_info_cache_buf_t *buf)
+{
+   uint64_t lo = core_info_cache_get_u32(buf);
+   uint64_t hi = core_info_cache_get_u32(buf);
+   return lo | (hi << 32);
+}
+
+static char *core_info_cache_get_string(core_info_cache_buf_t *buf)
+{
+   char *s      = NULL;
+   uint32_t len = core_info_cache_get_u32(buf);
+
+   if (!len--)
+      return NULL;
+
+   if (buf->error || buf->len - buf->pos < len
+         || !(s = (char*)malloc(len + 1)))
+   {
+      buf->error = true;
+      return NULL;
+   }
+
+   memcpy(s, buf->data + buf->pos, len);
+   s[len]    = '\0';
+   buf->pos += len;
+   return s;
+}
+
+/* Compares the next cached string against @s without
+ * allocating. */
+static bool core_info_cache_match_string(core_info_cache_buf_t *buf,
+      const char *s)
+{
+   uint32_t len = core_info_cache_get_u32(buf);
+
+   if (buf->error)
+      return false;
+   if (!len--)
+      return !s;
+   if (!s || buf->len - buf->pos < len || strlen(s) != len)
+      return false;
+   if (memcmp(buf->data + buf->pos, s, len))
+      return false;
+
+   buf->pos += len;
+   return true;
+}
+
+/**
+ * core_info_cache_read:
+ * @cache_path       : path to the cache file
+ * @contents         : directory listing of the cores directory
+ * @stats            : stat records of the matching .info files
+ *
+ * Loads a fully resolved core info list from @cache_path,
+ * provided it was written for exactly the same listing and
+ * none of the .info files changed since.
+ *
+ * Returns: new core info list on success, NULL if the cache
+ * is missing, stale or corrupt.
+ **/
+static core_info_list_t *core_info_cache_read(const char *cache_path,
+      const struct string_list *contents,
+      const core_info_cache_stat_t *stats)
+{
+   size_t i, j;
+   void *data                       = NULL;
+   int64_t len                      = 0;
+   core_info_cache_buf_t buf        = {0};
    core_info_list_t *core_info_list = NULL;
-   const char       *path_basedir   = libretro_info_dir;
-   struct string_list *contents     = string_list_new();
-   bool                          ok = dir_list_append(contents, path, exts,
-         false, dir_show_hidden_files, false, false);
 
-#if defined(__WINRT__) || defined(WINAPI_FAMILY) && WINAPI_FAMILY == WINAPI_FAMILY_PHONE_APP
-   /* UWP: browse the optional packages for additional cores */
-   struct string_list *core_packages = string_list_new();
-   uwp_fill_installed_core_packages(core_packages);
-   for (i = 0; i < core_packages->size; i++)
+   if (!path_is_valid(cache_path)
+         || !filestream_read_file(cache_path, &data, &len)
+         || len < CORE_INFO_CACHE_HEADER_SIZE)
+      goto error;
+
+   buf.data = (uint8_t*)data;
+   buf.len  = (size_t)len;
+
+   if (memcmp(buf.data, CORE_INFO_CACHE_MAGIC, 4))
+      goto error;
+
+   buf.pos = 4;
+
    {
-      dir_list_append(contents, core_packages->elems[i].data, exts,
-            false, dir_show_hidden_files, false, false);
+      uint32_t version = core_info_cache_get_u32(&buf);
+      uint32_t crc     = core_info_cache_get_u32(&buf);
+      uint64_t size    = core_info_cache_get_u64(&buf);
+
+      if (     version != CORE_INFO_CACHE_VERSION
+            || size    != buf.len - CORE_INFO_CACHE_HEADER_SIZE
+            || crc     != encoding_crc32(0,
+               buf.data + CORE_INFO_CACHE_HEADER_SIZE, (size_t)size))
+         goto error;
    }
-   string_list_free(core_packages);
-#else
-   /* Keep the old 'directory not found' behavior */
-   if (!ok)
+
+   if (core_info_cache_get_u32(&buf) != contents->size)
+      goto error;
+
+   core_info_list = (core_info_list_t*)calloc(1, sizeof(*core_info_list));
+   if (!core_info_list)
+      goto error;
+
+   if (contents->size && !(core_info_list->list = (core_info_t*)
+            calloc(contents->size, sizeof(*core_info_list->list))))
+      goto error;
+
+   for (i = 0; i < contents->size; i++)
    {
-      string_list_free(contents);
-      contents = NULL;
+      uint32_t flags;
+      uint32_t firmware;
+      core_info_t *info = &core_info_list->list[i];
+      const char *path  = contents->elems[i].data;
+
+      if (!core_info_cache_match_string(&buf,
+               string_is_empty(path) ? NULL : path))
+         goto error;
+
+      if (     (core_info_cache_get_u32(&buf) != 0) != stats[i].present
+            || core_info_cache_get_u64(&buf)        != stats[i].size
+            || (int64_t)core_info_cache_get_u64(&buf) != stats[i].mtime)
+         goto error;
+
+      core_info_list->count       = i + 1;
+
+      if (!string_is_empty(path))
+         info->path               = strdup(path);
+      info->display_name          = core_info_cache_get_string(&buf);
+      info->display_version       = core_info_cache_get_string(&buf);
+      info->core_name             = core_info_cache_get_string(&buf);
+      info->systemname            = core_info_cache_get_string(&buf);
+      info->system_id             = core_info_cache_get_string(&buf);
+      info->system_manufacturer   = core_info_cache_get_string(&buf);
+      info->supported_extensions  = core_info_cache_get_string(&buf);
+      info->authors               = core_info_cache_get_string(&buf);
+      info->permissions           = core_info_cache_get_string(&buf);
+      info->licenses              = core_info_cache_get_string(&buf);
+      info->categories            = core_info_cache_get_string(&buf);
+      info->databases             = core_info_cache_get_string(&buf);
+      info->notes                 = core_info_cache_get_string(&buf);
+
+      flags                       = core_info_cache_get_u32(&buf);
+      info->has_info              = !!(flags & CORE_INFO_CACHE_HAS_INFO);
+      info->supports_no_game      =
+         !!(flags & CORE_INFO_CACHE_SUPPORTS_NO_GAME);
+      info->database_match_archive_member =
+         !!(flags & CORE_INFO_CACHE_MATCH_ARCHIVE);
+
+      info->firmware_count        = core_info_cache_get_u32(&buf);
+      firmware                    = core_info_cache_get_u32(&buf);
+
+      if (buf.error)
+         goto error;
+
+      if (firmware)
+      {
+         if (firmware != info->firmware_count
+               || firmware > buf.len - buf.pos)
+            goto error;
+
+         if (!(info->firmware = (core_info_firmware_t*)
+                  calloc(firmware, sizeof(*info->firmware))))
+            goto error;
+
+         for (j = 0; j < firmware; j++)
+         {
+            info->firmware[j].path     = core_info_cache_get_string(&buf);
+            info->firmware[j].desc     = core_info_cache_get_string(&buf);
+            info->firmware[j].optional = !!core_info_cache_get_u32(&buf);
+         }
+      }
+      else
+         info->firmware_count     = 0;
+
+      if (buf.error)
+         goto error;
+
+      if (info->supported_extensions)
+         info->supported_extensions_list =
+            string_split(info->supported_extensions, "|");
+      if (info->authors)
+         info->authors_list     = string_split(info->authors, "|");
+      if (info->permissions)
+         info->permissions_list = string_split(info->permissions, "|");
+      if (info->licenses)
+         info->licenses_list    = string_split(info->licenses, "|");
+      if (info->categories)
+         info->categories_list  = string_split(info->categories, "|");
+      if (info->databases)
+         info->databases_list   = string_split(info->databases, "|");
+      if (info->notes)
+         info->note_list        = string_split(info->notes, "|");
+   }
+
+   if (buf.pos != buf.len)
+      goto error;
+
+   core_info_list->count = contents->size;
+
+   free(data);
+   return core_info_list;
+
+error:
+   if (core_info_list)
+      core_info_list_free(core_info_list);
+   free(data);
+   return NULL;
+}
+
+/**
+ * core_info_cache_write:
+ * @cache_path       : path to the cache file
+ * @core_info_list   : freshly parsed core info list
+ * @stats            : stat records of the .info files, taken
+ *                     before they were parsed
+ *
+ * Serializes @core_info_list so the next startup can skip
+ * parsing the .info files. Failure is not an error, the
+ * list is simply parsed again next time.
+ **/
+static void core_info_cache_write(const char *cache_path,
+      const core_info_list_t *core_info_list,
+      const core_info_cache_stat_t *stats)
+{
+   size_t i, j;
+   char tmp_path[PATH_MAX_LENGTH];
+   core_info_cache_buf_t buf = {0};
+   uint64_t size             = 0;
+
+   core_info_cache_put(&buf, CORE_INFO_CACHE_MAGIC, 4);
+   core_info_cache_put_u32(&buf, CORE_INFO_CACHE_VERSION);
+   core_info_cache_put_u32(&buf, 0);
+   core_info_cache_put_u64(&buf, 0);
+   core_info_cache_put_u32(&buf, (uint32_t)core_info_list->count);
+
+   for (i = 0; i < core_info_list->count; i++)
+   {
+      const core_info_t *info = &core_info_list->list[i];
+      uint32_t flags          = 0;
+      uint32_t firmware       = info->firmware
+         ? (uint32_t)info->firmware_count : 0;
+
+      if (info->has_info)
+         flags |= CORE_INFO_CACHE_HAS_INFO;
+      if (info->supports_no_game)
+         flags |= CORE_INFO_CACHE_SUPPORTS_NO_GAME;
+      if (info->database_match_archive_member)
+         flags |= CORE_INFO_CACHE_MATCH_ARCHIVE;
+
+      core_info_cache_put_string(&buf, info->path);
+      core_info_cache_put_u32(&buf, stats[i].present);
+      core_info_cache_put_u64(&buf, stats[i].size);
+      core_info_cache_put_u64(&buf, (uint64_t)stats[i].mtime);
+
+      core_info_cache_put_string(&buf, info->display_name);
+      core_info_cache_put_string(&buf, info->display_version);
+      core_info_cache_put_string(&buf, info->core_name);
+      core_info_cache_put_string(&buf, info->systemname);
+      core_info_cache_put_string(&buf, info->system_id);
+      core_info_cache_put_string(&buf, info->system_manufacturer);
+      core_info_cache_put_string(&buf, info->supported_extensions);
+      core_info_cache_put_string(&buf, info->authors);
+      core_info_cache_put_string(&buf, info->permissions);
+      core_info_cache_put_string(&buf, info->licenses);
+      core_info_cache_put_string(&buf, info->categories);
+      core_info_cache_put_string(&buf, info->databases);
+      core_info_cache_put_string(&buf, info->notes);
+
+      core_info_cache_put_u32(&buf, flags);
+      core_info_cache_put_u32(&buf, (uint32_t)info->firmware_count);
+      core_info_cache_put_u32(&buf, firmware);
+
+      for (j = 0; j < firmware; j++)
+      {
+         core_info_cache_put_string(&buf, info->firmware[j].path);
+         core_info_cache_put_string(&buf, info->firmware[j].desc);
+         core_info_cache_put_u32(&buf, info->firmware[j].optional);
+      }
+   }
+
+   if (buf.error)
+      goto end;
+
+   size = buf.len - CORE_INFO_CACHE_HEADER_SIZE;
+   buf.len = 8;
+   core_info_cache_put_u32(&buf, encoding_crc32(0,
+            buf.data + CORE_INFO_CACHE_HEADER_SIZE, (size_t)size));
+   core_info_cache_put_u64(&buf, size);
+   buf.len = (size_t)size + CORE_INFO_CACHE_HEADER_SIZE;
+
+   /* Write to a temporary file first so an interrupted
+    * write never leaves a truncated cache behind. */
+   strlcpy(tmp_path, cache_path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   if (filestream_write_file(tmp_path, buf.data, (int64_t)buf.len))
+   {
+      filestream_delete(cache_path);
+      if (filestream_rename(tmp_path, cache_path) != 0)
+         filestream_delete(tmp_path);
    }
+
+end:
+   free(buf.data);
+}
 #endif
 
-   if (!contents)
-      return NULL;
+/**
+ * core_info_list_read_info_files:
+ * @contents         : directory listing of the cores directory
+ * @path_basedir     : directory holding the .info files
+ *
+ * Parses the .info file of every core in @contents.
+ *
+ * Returns: new core info list, NULL on allocation failure.
+ **/
+static core_info_list_t *core_info_list_read_info_files(
+      const struct string_list *contents, const char *path_basedir)
+{
+   size_t i;
+   core_info_t *core_info           = NULL;
+   core_info_list_t *core_info_list = NULL;
 
    core_info_list = (core_info_list_t*)calloc(1, sizeof(*core_info_list));
    if (!core_info_list)
@@ -433,7 +1154,10 @@ static core_info_list_t *core_info_list_new(const char *path,
                &tmp_bool))
             core_info[i].database_match_archive_member = tmp_bool;
 
-         core_info[i].config_data = conf;
+         core_info[i].has_info = true;
+
+         core_info_resolve_firmware(&core_info[i], conf);
+         config_file_free(conf);
       }
       else
          free(info_path);
@@ -446,16 +1170,111 @@ static core_info_list_t *core_info_list_new(const char *path,
             strdup(path_basename(core_info[i].path));
    }
 
-   if (core_info_list)
+   return core_info_list;
+
+error:
+   core_info_list_free(core_info_list);
+   return NULL;
+}
+
+static core_info_list_t *core_info_list_new(const char *path,
+      const char *libretro_info_dir,
+      const char *exts,
+      bool dir_show_hidden_files)
+{
+   size_t i;
+   core_info_list_t *core_info_list = NULL;
+   const char       *path_basedir   = libretro_info_dir;
+#ifdef CORE_INFO_CACHE_ENABLE
+   core_info_cache_stat_t *stats    = NULL;
+   char cache_path[PATH_MAX_LENGTH];
+#endif
+   struct string_list *contents     = string_list_new();
+   bool                          ok = dir_list_append(contents, path, exts,
+         false, dir_show_hidden_files, false, false);
+
+#if defined(__WINRT__) || defined(WINAPI_FAMILY) && WINAPI_FAMILY == WINAPI_FAMILY_PHONE_APP
+   /* UWP: browse the optional packages for additional cores */
+   struct string_list *core_packages = string_list_new();
+   uwp_fill_installed_core_packages(core_packages);
+   for (i = 0; i < core_packages->size; i++)
    {
-      core_info_list_resolve_all_extensions(core_info_list);
-      core_info_list_resolve_all_firmware(core_info_list);
+      dir_list_append(contents, core_packages->elems[i].data, exts,
+            false, dir_show_hidden_files, false, false);
+   }
+   string_list_free(core_packages);
+#else
+   /* Keep the old 'directory not found' behavior */
+   if (!ok)
+   {
+      string_list_free(contents);
+      contents = NULL;
+   }
+#endif
+
+   if (!contents)
+      return NULL;
+
+#ifdef CORE_INFO_CACHE_ENABLE
+   fill_pathname_join(cache_path, path_basedir,
+         file_path_str(FILE_PATH_CORE_INFO_CACHE), sizeof(cache_path));
+
+   if ((stats = (core_info_cache_stat_t*)
+            calloc(contents->size + 1, sizeof(*stats))))
+   {
+      char *info_path = (char*)malloc(PATH_MAX_LENGTH * sizeof(char));
+
+      for (i = 0; info_path && i < contents->size; i++)
+      {
+         info_path[0] = '\0';
+
+         if (!core_info_list_iterate(info_path, PATH_MAX_LENGTH,
+                  path_basedir, contents, i))
+            continue;
+
+         if (!core_info_cache_stat_file(info_path, &stats[i]))
+            break;
+      }
+
+      if (!info_path || i < contents->size)
+      {
+         free(stats);
+         stats = NULL;
+      }
+
+      free(info_path);
    }
 
+   if (stats)
+      core_info_list = core_info_cache_read(cache_path, contents, stats);
+#endif
+
+   if (!core_info_list)
+   {
+      if (!(core_info_list = core_info_list_read_info_files(
+                  contents, path_basedir)))
+         goto error;
+
+#ifdef CORE_INFO_CACHE_ENABLE
+      if (stats)
+         core_info_cache_write(cache_path, core_info_list, stats);
+#endif
+   }
+
+   core_info_list_resolve_all_extensions(core_info_list);
+   if (!core_info_list_resolve_maps(core_info_list))
+      goto error;
+
+#ifdef CORE_INFO_CACHE_ENABLE
+   free(stats);
+#endif
    string_list_free(contents);
    return core_info_list;
 
 error:
+#ifdef CORE_INFO_CACHE_ENABLE
+   free(stats);
+#endif
    if (contents)
       string_list_free(contents);
    core_info_list_free(core_info_list);
@@ -490,48 +1309,57 @@ static bool core_info_list_get_info(core_info_list_t *core_info_list,
    return false;
 }
 
-static bool core_info_does_support_any_file(const core_info_t *core,
-      const struct string_list *list)
+/**
+ * core_info_list_mark_supported:
+ * @core_info_list   : core info list
+ * @path             : content path
+ * @supported        : per-core flags, indexed like core_info_list->list
+ *
+ * Flags every core whose supported extensions contain the
+ * extension of @path (with or without a leading '.').
+ **/
+static void core_info_list_mark_supported(
+      const core_info_list_t *core_info_list,
+      const char *path, unsigned char *supported)
 {
    size_t i;
-   if (!list || !core || !core->supported_extensions_list)
-      return false;
-
-   for (i = 0; i < list->size; i++)
-      if (string_list_find_elem_prefix(core->supported_extensions_list,
-               ".", path_get_extension(list->elems[i].data)))
-         return true;
-   return false;
-}
+   char prefixed[255];
+   const char *ext                     = NULL;
+   const core_info_map_entry_t *entry  = NULL;
 
-static bool core_info_does_support_file(
-      const core_info_t *core, const char *path)
-{
-   if (!core || !core->supported_extensions_list)
-      return false;
    if (string_is_empty(path))
-      return false;
+      return;
+
+   ext   = path_get_extension(path);
+   entry = core_info_map_find(core_info_list->extensions, ext, NULL);
+
+   if (entry)
+      for (i = 0; i < entry->count; i++)
+         supported[entry->cores[i]] = 1;
+
+   prefixed[0] = '.';
+   strlcpy(prefixed + 1, ext, sizeof(prefixed) - 1);
+
+   entry = core_info_map_find(core_info_list->extensions, prefixed, NULL);
 
-   return string_list_find_elem_prefix(
-         core->supported_extensions_list, ".", path_get_extension(path));
+   if (entry)
+      for (i = 0; i < entry->count; i++)
+         supported[entry->cores[i]] = 1;
 }
 
 /* qsort_r() is not in standard C, sadly. */
 
 static int core_info_qsort_cmp(const void *a_, const void *b_)
 {
-   const core_info_t *a = (const core_info_t*)a_;
-   const core_info_t *b = (const core_info_t*)b_;
-   int support_a        =
-         core_info_does_support_any_file(a, core_info_tmp_list)
-      || core_info_does_support_file(a, core_info_tmp_path);
-   int support_b        =
-         core_info_does_support_any_file(b, core_info_tmp_list)
-      || core_info_does_support_file(b, core_info_tmp_path);
+   size_t a             = *(const size_t*)a_;
+   size_t b             = *(const size_t*)b_;
+   int support_a        = core_info_tmp_supported[a];
+   int support_b        = core_info_tmp_supported[b];
 
    if (support_a != support_b)
       return support_b - support_a;
-   return strcasecmp(a->display_name, b->display_name);
+   return strcasecmp(core_info_tmp_cores[a].display_name,
+         core_info_tmp_cores[b].display_name);
 }
 
 static core_info_t *core_info_find_internal(
@@ -758,43 +1586,78 @@ void core_info_list_get_supported_cores(core_info_list_t *core_info_list,
    size_t i;
    struct string_list *list = NULL;
    size_t supported         = 0;
+   size_t count             = 0;
+   size_t *order            = NULL;
+   size_t *new_pos          = NULL;
+   unsigned char *flags     = NULL;
+   core_info_t *sorted      = NULL;
 
    if (!core_info_list)
       return;
 
-   core_info_tmp_path = path;
+   count      = core_info_list->count;
+   *infos     = core_info_list->list;
+   *num_infos = 0;
+
+   if (!count)
+      return;
+
+   flags   = (unsigned char*)calloc(count, sizeof(*flags));
+   order   = (size_t*)malloc(count * sizeof(*order));
+   new_pos = (size_t*)malloc(count * sizeof(*new_pos));
+   sorted  = (core_info_t*)malloc(count * sizeof(*sorted));
+
+   if (!flags || !order || !new_pos || !sorted)
+      goto end;
+
+   core_info_list_mark_supported(core_info_list, path, flags);
 
 #ifdef HAVE_COMPRESSION
    if (path_is_compressed_file(path))
       list = file_archive_get_file_list(path, NULL);
-   core_info_tmp_list = list;
+
+   if (list)
+      for (i = 0; i < list->size; i++)
+         core_info_list_mark_supported(core_info_list,
+               list->elems[i].data, flags);
 #endif
 
    /* Let supported core come first in list so we can return
-    * a pointer to them. */
-   qsort(core_info_list->list, core_info_list->count,
-         sizeof(core_info_t), core_info_qsort_cmp);
+    * a pointer to them. The sort runs over indices so the
+    * lookup tables can follow the cores to their new slots. */
+   for (i = 0; i < count; i++)
+   {
+      order[i]   = i;
+      supported += flags[i];
+   }
 
-   for (i = 0; i < core_info_list->count; i++, supported++)
+   core_info_tmp_cores     = core_info_list->list;
+   core_info_tmp_supported = flags;
+   qsort(order, count, sizeof(*order), core_info_qsort_cmp);
+   core_info_tmp_cores     = NULL;
+   core_info_tmp_supported = NULL;
+
+   for (i = 0; i < count; i++)
    {
-      const core_info_t *core = &core_info_list->list[i];
+      sorted[i]           = core_info_list->list[order[i]];
+      new_pos[order[i]]   = i;
+   }
 
-      if (core_info_does_support_file(core, path))
-         continue;
+   memcpy(core_info_list->list, sorted, count * sizeof(*sorted));
 
-#ifdef HAVE_COMPRESSION
-      if (core_info_does_support_any_file(core, list))
-         continue;
-#endif
+   core_info_map_remap(core_info_list->extensions,    new_pos);
+   core_info_map_remap(core_info_list->databases,     new_pos);
+   core_info_map_remap(core_info_list->ext_databases, new_pos);
 
-      break;
-   }
+   *num_infos = supported;
 
+end:
    if (list)
       string_list_free(list);
-
-   *infos     = core_info_list->list;
-   *num_infos = supported;
+   free(flags);
+   free(order);
+   free(new_pos);
+   free(sorted);
 }
 
 void core_info_get_name(const char *path, char *s, size_t len,
@@ -864,11 +1727,7 @@ size_t core_info_list_num_info_files(core_info_list_t *core_info_list)
       return 0;
 
    for (i = 0; i < core_info_list->count; i++)
-   {
-      config_file_t *conf = (config_file_t*)
-         core_info_list->list[i].config_data;
-      num += !!conf;
-   }
+      num += core_info_list->list[i].has_info;
 
    return num;
 }
@@ -891,17 +1750,17 @@ bool core_info_database_match_archive_member(const char *database_path)
    if (core_info_curr_list)
    {
       size_t i;
+      const core_info_map_entry_t *entry = core_info_map_find(
+            core_info_curr_list->databases, database, NULL);
 
-      for (i = 0; i < core_info_curr_list->count; i++)
+      for (i = 0; entry && i < entry->count; i++)
       {
-         const core_info_t *info = &core_info_curr_list->list[i];
+         const core_info_t *info =
+            &core_info_curr_list->list[entry->cores[i]];
 
          if (!info->database_match_archive_member)
              continue;
 
-         if (!string_list_find_elem(info->databases_list, database))
-             continue;
-
          free(database);
          return true;
       }
@@ -930,19 +1789,14 @@ bool core_info_database_supports_content_path(const char *database_path, const c
 
    if (core_info_curr_list)
    {
-      size_t i;
+      const char *ext = path_get_extension(path);
 
-      for (i = 0; i < core_info_curr_list->count; i++)
+      /* Neither list can hold a '|' since both are split on it,
+       * and keeping it out of the pair key avoids ambiguity. */
+      if (!strchr(ext, '|') && !strchr(database, '|') &&
+            core_info_map_find(core_info_curr_list->ext_databases,
+               ext, database))
       {
-         const core_info_t *info = &core_info_curr_list->list[i];
-
-         if (!string_list_find_elem(info->supported_extensions_list,
-                  path_get_extension(path)))
-            continue;
-
-         if (!string_list_find_elem(info->databases_list, database))
-            continue;
-
          free(database);
          return true;
       }
@@ -37,11 +37,11 @@ typedef struct
 
 typedef struct
 {
+   bool has_info;
    bool supports_no_game;
    bool database_match_archive_member;
    size_t firmware_count;
    char *path;
-   void *config_data;
    char *display_name;
    char *display_version;
    char *core_name;
@@ -66,11 +66,18 @@ typedef struct
    void *userdata;
 } core_info_t;
 
+struct core_info_map;
+
 typedef struct
 {
    core_info_t *list;
    size_t count;
    char *all_ext;
+   /* Lookup tables built once from the per-core
+    * extension and database lists. */
+   struct core_info_map *extensions;
+   struct core_info_map *databases;
+   struct core_info_map *ext_databases;
 } core_info_list_t;
 
 typedef struct core_info_ctx_firmware
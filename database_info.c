@@ -303,7 +303,8 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
 }
 
 static int database_cursor_open(libretrodb_t *db,
-      libretrodb_cursor_t *cur, const char *path, const char *query)
+      libretrodb_cursor_t *cur, const char *path, const char *query,
+      const char **fields, unsigned num_fields)
 {
    const char *error     = NULL;
    libretrodb_query_t *q = NULL;
@@ -319,6 +320,8 @@ static int database_cursor_open(libretrodb_t *db,
       goto error;
    if ((libretrodb_cursor_open(db, cur, q)) != 0)
       goto error;
+   if (fields && libretrodb_cursor_set_fields(cur, fields, num_fields) != 0)
+      goto error;
 
    if (q)
       libretrodb_query_free(q);
@@ -441,6 +444,15 @@ void database_info_free(database_info_handle_t *db)
 
 database_info_list_t *database_info_list_new(
       const char *rdb_path, const char *query)
+{
+   return database_info_list_new_fields(rdb_path, query, NULL, 0);
+}
+
+/* Like database_info_list_new, but only the listed fields get
+ * decoded and filled in, the others are left empty. */
+database_info_list_t *database_info_list_new_fields(
+      const char *rdb_path, const char *query,
+      const char **fields, unsigned num_fields)
 {
    int ret                                  = 0;
    unsigned k                               = 0;
@@ -452,7 +464,8 @@ database_info_list_t *database_info_list_new(
    if (!db || !cur)
       goto end;
 
-   if ((database_cursor_open(db, cur, rdb_path, query) != 0))
+   if ((database_cursor_open(db, cur, rdb_path, query,
+               fields, num_fields) != 0))
       goto end;
 
    database_info_list = (database_info_list_t*)
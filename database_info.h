@@ -123,6 +123,9 @@ typedef struct
 database_info_list_t *database_info_list_new(const char *rdb_path,
       const char *query);
 
+database_info_list_t *database_info_list_new_fields(const char *rdb_path,
+      const char *query, const char **fields, unsigned num_fields);
+
 void database_info_list_free(database_info_list_t *list);
 
 database_info_handle_t *database_info_dir_init(const char *dir,
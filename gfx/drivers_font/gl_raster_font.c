@@ -23,6 +23,7 @@
 
 #include "../common/gl_common.h"
 #include "../font_driver.h"
+#include "../font_run_cache.h"
 #include "../video_driver.h"
 #include "../../verbosity.h"
 
@@ -52,6 +53,7 @@ typedef struct
    const font_renderer_driver_t *font_driver;
    void *font_data;
    struct font_atlas *atlas;
+   font_run_cache_t *runs;
 
    video_font_raster_block_t *block;
 } gl_raster_t;
@@ -63,6 +65,8 @@ static void gl_raster_font_free_font(void *data,
    if (!font)
       return;
 
+   font_run_cache_free(font->runs);
+
    if (font->font_driver && font->font_data)
       font->font_driver->free(font->font_data);
 
@@ -202,6 +206,10 @@ static void *gl_raster_font_init_font(void *data,
    if (!gl_raster_font_upload_atlas(font))
       goto error;
 
+   font->runs = font_run_cache_new(font->font_driver, font->font_data);
+   if (!font->runs)
+      goto error;
+
    font->atlas->dirty = false;
 
    glBindTexture(GL_TEXTURE_2D, font->gl->texture[font->gl->tex_index]);
@@ -219,30 +227,17 @@ static int gl_get_message_width(void *data, const char *msg,
       unsigned msg_len, float scale)
 {
    gl_raster_t *font   = (gl_raster_t*)data;
-   const char* msg_end = msg + msg_len;
-   int delta_x         = 0;
+   const font_run_t *run;
 
-   if (     !font
-         || !font->font_driver
-         || !font->font_driver->get_glyph
-         || !font->font_data )
+   if (!font)
       return 0;
 
-   while (msg < msg_end)
-   {
-      unsigned code                  = utf8_walk(&msg);
-      const struct font_glyph *glyph = font->font_driver->get_glyph(
-            font->font_data, code);
-
-      if (!glyph) /* Do something smarter here ... */
-         glyph = font->font_driver->get_glyph(font->font_data, '?');
-      if (!glyph)
-         continue;
+   run = font_run_cache_get(font->runs, msg, msg_len);
 
-      delta_x += glyph->advance_x;
-   }
+   if (!run)
+      return 0;
 
-   return delta_x * scale;
+   return run->width * scale;
 }
 
 static void gl_raster_font_draw_vertices(gl_raster_t *font,
@@ -274,48 +269,45 @@ static void gl_raster_font_render_line(
       GLfloat pos_y, unsigned text_align,
       video_frame_info_t *video_info)
 {
-   unsigned i;
+   unsigned i, j;
+   const font_run_t *run;
    struct video_coords coords;
    GLfloat font_tex_coords[2 * 6 * MAX_MSG_LEN_CHUNK];
    GLfloat font_vertex[2 * 6 * MAX_MSG_LEN_CHUNK];
    GLfloat font_color[4 * 6 * MAX_MSG_LEN_CHUNK];
    GLfloat font_lut_tex_coord[2 * 6 * MAX_MSG_LEN_CHUNK];
    gl_t      *gl        = font->gl;
-   const char* msg_end  = msg + msg_len;
    int x                = roundf(pos_x * gl->vp.width);
    int y                = roundf(pos_y * gl->vp.height);
-   int delta_x          = 0;
-   int delta_y          = 0;
    float inv_tex_size_x = 1.0f / font->tex_width;
    float inv_tex_size_y = 1.0f / font->tex_height;
    float inv_win_width  = 1.0f / font->gl->vp.width;
    float inv_win_height = 1.0f / font->gl->vp.height;
 
+   run                  = font_run_cache_get(font->runs, msg, msg_len);
+   if (!run)
+      return;
+
    switch (text_align)
    {
       case TEXT_ALIGN_RIGHT:
-         x -= gl_get_message_width(font, msg, msg_len, scale);
+         x -= (int)(run->width * scale);
          break;
       case TEXT_ALIGN_CENTER:
-         x -= gl_get_message_width(font, msg, msg_len, scale) / 2.0;
+         x -= (int)(run->width * scale) / 2.0;
          break;
    }
 
-   while (msg < msg_end)
+   for (j = 0; j < run->count; )
    {
       i = 0;
-      while ((i < MAX_MSG_LEN_CHUNK) && (msg < msg_end))
+      while ((i < MAX_MSG_LEN_CHUNK) && (j < run->count))
       {
          int off_x, off_y, tex_x, tex_y, width, height;
-         unsigned                  code = utf8_walk(&msg);
-         const struct font_glyph *glyph = font->font_driver->get_glyph(
-               font->font_data, code);
-
-         if (!glyph) /* Do something smarter here ... */
-            glyph = font->font_driver->get_glyph(font->font_data, '?');
-
-         if (!glyph)
-            continue;
+         const struct font_run_glyph *rg = &run->glyphs[j++];
+         const struct font_glyph *glyph  = &rg->glyph;
+         int delta_x                     = rg->x;
+         int delta_y                     = -rg->y;
 
          off_x  = glyph->draw_offset_x;
          off_y  = glyph->draw_offset_y;
@@ -333,9 +325,6 @@ static void gl_raster_font_render_line(
          gl_raster_font_emit(5, 1, 1); /* Bottom-right */
 
          i++;
-
-         delta_x += glyph->advance_x;
-         delta_y -= glyph->advance_y;
       }
 
       coords.tex_coord     = font_tex_coords;
@@ -100,6 +100,8 @@ static freetype_atlas_slot_t* font_renderer_get_slot(ft_font_renderer_t *handle)
       ptr->next = handle->atlas_slots[oldest].next;
    }
 
+   handle->atlas.generation++;
+
    return &handle->atlas_slots[oldest];
 }
 
@@ -103,6 +103,8 @@ static stb_unicode_atlas_slot_t* font_renderer_stb_unicode_get_slot(stb_unicode_
       ptr->next = handle->atlas_slots[oldest].next;
    }
 
+   handle->atlas.generation++;
+
    return &handle->atlas_slots[oldest];
 }
 
@@ -58,6 +58,9 @@ struct font_atlas
    uint8_t *buffer; /* Alpha channel. */
    unsigned width;
    unsigned height;
+   /* Bumped whenever a spot in the atlas is reused
+    * for another glyph. */
+   unsigned generation;
    bool dirty;
 };
 
@@ -0,0 +1,218 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <encodings/utf.h>
+
+#include "font_run_cache.h"
+
+static uint32_t font_run_cache_hash(const char *msg, unsigned msg_len)
+{
+   unsigned i;
+   uint32_t hash = 5381;
+
+   for (i = 0; i < msg_len; i++)
+      hash = (hash << 5) + hash + (uint8_t)msg[i];
+
+   return hash;
+}
+
+static void font_run_cache_unlink(font_run_cache_t *cache, font_run_t *run)
+{
+   if (run->prev)
+      run->prev->next = run->next;
+   else
+      cache->head     = run->next;
+
+   if (run->next)
+      run->next->prev = run->prev;
+   else
+      cache->tail     = run->prev;
+
+   run->prev = NULL;
+   run->next = NULL;
+}
+
+static void font_run_cache_push_front(font_run_cache_t *cache, font_run_t *run)
+{
+   run->prev   = NULL;
+   run->next   = cache->head;
+
+   if (cache->head)
+      cache->head->prev = run;
+   else
+      cache->tail       = run;
+
+   cache->head = run;
+}
+
+static void font_run_cache_remove(font_run_cache_t *cache, font_run_t *run)
+{
+   font_run_t **link = &cache->buckets[run->hash % FONT_RUN_CACHE_BUCKETS];
+
+   while (*link && *link != run)
+      link = &(*link)->hash_next;
+   if (*link)
+      *link = run->hash_next;
+
+   font_run_cache_unlink(cache, run);
+   cache->count--;
+
+   free(run);
+}
+
+static void font_run_cache_clear(font_run_cache_t *cache)
+{
+   while (cache->tail)
+      font_run_cache_remove(cache, cache->tail);
+}
+
+/* Lays out a line the same way the font drivers do
+ * glyph by glyph, with '?' standing in for glyphs
+ * the font doesn't have. The glyphs and a copy of
+ * the text share the run's allocation. */
+static font_run_t *font_run_cache_layout(font_run_cache_t *cache,
+      const char *msg, unsigned msg_len)
+{
+   int x               = 0;
+   int y               = 0;
+   const char *msg_end = msg + msg_len;
+   /* There can't be more glyphs than bytes. */
+   font_run_t *run     = (font_run_t*)malloc(sizeof(*run)
+         + msg_len * sizeof(struct font_run_glyph) + msg_len);
+
+   if (!run)
+      return NULL;
+
+   run->glyphs   = (struct font_run_glyph*)(run + 1);
+   run->count    = 0;
+   run->text     = (const char*)(run->glyphs + msg_len);
+   run->text_len = msg_len;
+
+   memcpy((char*)run->text, msg, msg_len);
+
+   while (msg < msg_end)
+   {
+      unsigned code                  = utf8_walk(&msg);
+      const struct font_glyph *glyph = cache->font_driver->get_glyph(
+            cache->font_data, code);
+      struct font_run_glyph *out     = NULL;
+
+      if (!glyph)
+         glyph = cache->font_driver->get_glyph(cache->font_data, '?');
+      if (!glyph)
+         continue;
+
+      out        = &run->glyphs[run->count++];
+      out->x     = x;
+      out->y     = y;
+      out->glyph = *glyph;
+
+      x         += glyph->advance_x;
+      y         += glyph->advance_y;
+   }
+
+   run->width = x;
+
+   return run;
+}
+
+font_run_cache_t *font_run_cache_new(
+      const font_renderer_driver_t *font_driver, void *font_data)
+{
+   font_run_cache_t *cache = NULL;
+
+   if (!font_driver || !font_driver->get_glyph || !font_data)
+      return NULL;
+
+   cache = (font_run_cache_t*)calloc(1, sizeof(*cache));
+
+   if (!cache)
+      return NULL;
+
+   cache->font_driver = font_driver;
+   cache->font_data   = font_data;
+   cache->atlas       = font_driver->get_atlas
+      ? font_driver->get_atlas(font_data) : NULL;
+   cache->generation  = cache->atlas ? cache->atlas->generation : 0;
+
+   return cache;
+}
+
+const font_run_t *font_run_cache_get(font_run_cache_t *cache,
+      const char *msg, unsigned msg_len)
+{
+   font_run_t *run = NULL;
+   uint32_t hash   = 0;
+   unsigned bucket = 0;
+
+   if (!cache || !msg)
+      return NULL;
+
+   if (cache->atlas && cache->atlas->generation != cache->generation)
+   {
+      font_run_cache_clear(cache);
+      cache->generation = cache->atlas->generation;
+   }
+
+   hash   = font_run_cache_hash(msg, msg_len);
+   bucket = hash % FONT_RUN_CACHE_BUCKETS;
+
+   for (run = cache->buckets[bucket]; run; run = run->hash_next)
+   {
+      if (     run->hash     == hash
+            && run->text_len == msg_len
+            && !memcmp(run->text, msg, msg_len))
+      {
+         font_run_cache_unlink(cache, run);
+         font_run_cache_push_front(cache, run);
+         return run;
+      }
+   }
+
+   run = font_run_cache_layout(cache, msg, msg_len);
+
+   if (!run)
+      return NULL;
+
+   /* Laying out may have loaded glyphs over older ones,
+    * invalidating everything cached before. */
+   if (cache->atlas && cache->atlas->generation != cache->generation)
+   {
+      font_run_cache_clear(cache);
+      cache->generation = cache->atlas->generation;
+   }
+
+   run->hash               = hash;
+   run->hash_next          = cache->buckets[bucket];
+   cache->buckets[bucket]  = run;
+   font_run_cache_push_front(cache, run);
+
+   if (++cache->count > FONT_RUN_CACHE_SIZE)
+      font_run_cache_remove(cache, cache->tail);
+
+   return run;
+}
+
+void font_run_cache_free(font_run_cache_t *cache)
+{
+   if (!cache)
+      return;
+
+   font_run_cache_clear(cache);
+   free(cache);
+}
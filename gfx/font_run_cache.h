@@ -0,0 +1,100 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __FONT_RUN_CACHE_H
+#define __FONT_RUN_CACHE_H
+
+#include <stdint.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+#include "font_driver.h"
+
+RETRO_BEGIN_DECLS
+
+/* Number of laid out lines kept per font. */
+#define FONT_RUN_CACHE_SIZE    1024
+
+#define FONT_RUN_CACHE_BUCKETS 512
+
+struct font_run_glyph
+{
+   /* Pen position of this glyph, i.e. the sum of the
+    * advances of the glyphs before it. */
+   int x;
+   int y;
+   struct font_glyph glyph;
+};
+
+/* A line of text laid out with a font renderer.
+ * Positions are unscaled and relative to the start
+ * of the line, so a run can be drawn anywhere at
+ * any scale. */
+typedef struct font_run
+{
+   struct font_run_glyph *glyphs;
+   unsigned count;
+   /* Sum of the advances of all glyphs. */
+   int width;
+
+   /* Internal */
+   const char *text;
+   unsigned text_len;
+   uint32_t hash;
+   struct font_run *hash_next;
+   struct font_run *prev;
+   struct font_run *next;
+} font_run_t;
+
+typedef struct font_run_cache
+{
+   const font_renderer_driver_t *font_driver;
+   void *font_data;
+   struct font_atlas *atlas;
+   /* Atlas generation the cached runs were laid out with. */
+   unsigned generation;
+   unsigned count;
+   /* Most and least recently used run */
+   font_run_t *head;
+   font_run_t *tail;
+   font_run_t *buckets[FONT_RUN_CACHE_BUCKETS];
+} font_run_cache_t;
+
+font_run_cache_t *font_run_cache_new(
+      const font_renderer_driver_t *font_driver, void *font_data);
+
+/**
+ * font_run_cache_get:
+ * @cache                : Run cache of the font.
+ * @msg                  : UTF-8 text, not necessarily terminated.
+ * @msg_len              : Length of @msg in bytes.
+ *
+ * Looks up the layout of @msg, laying it out with the
+ * font renderer if it isn't cached yet. Everything is
+ * laid out again once the renderer reuses a spot in
+ * its atlas, since cached glyphs may point to it.
+ *
+ * Returns: the run, valid until the next call, or
+ * NULL on allocation failure.
+ **/
+const font_run_t *font_run_cache_get(font_run_cache_t *cache,
+      const char *msg, unsigned msg_len);
+
+void font_run_cache_free(font_run_cache_t *cache);
+
+RETRO_END_DECLS
+
+#endif
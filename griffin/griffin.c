@@ -468,6 +468,7 @@ FONTS
 
 #include "../gfx/drivers_font_renderer/bitmapfont.c"
 #include "../gfx/font_driver.c"
+#include "../gfx/font_run_cache.c"
 
 #if defined(HAVE_D3D9) && defined(HAVE_D3DX)
 #include "../gfx/drivers_font/d3d_w32_font.c"
@@ -1142,6 +1143,7 @@ NETPLAY
 #include "../network/netplay/netplay_io.c"
 #include "../network/netplay/netplay_keyboard.c"
 #include "../network/netplay/netplay_sync.c"
+#include "../network/netplay/netplay_udp.c"
 #include "../network/netplay/netplay_discovery.c"
 #include "../network/netplay/netplay_buf.c"
 #include "../network/netplay/netplay_room_parse.c"
@@ -1167,6 +1169,7 @@ DATA RUNLOOP
 #include "../tasks/task_save.c"
 #include "../tasks/task_image.c"
 #include "../tasks/task_file_transfer.c"
+#include "../tasks/task_dir_list.c"
 #ifdef HAVE_ZLIB
 #include "../tasks/task_decompress.c"
 #endif
@@ -1227,6 +1230,7 @@ MENU
 #include "../menu/menu_shader.c"
 #include "../menu/menu_displaylist.c"
 #include "../menu/menu_animation.c"
+#include "../menu/menu_thumbnail_cache.c"
 
 #include "../menu/drivers/null.c"
 #include "../menu/drivers/menu_generic.c"
@@ -59,6 +59,7 @@ struct config_entry_list
 
    char *key;
    char *value;
+   uint32_t hash;
    struct config_entry_list *next;
 };
 
@@ -71,6 +72,110 @@ struct config_include_list
 static config_file_t *config_file_new_internal(
       const char *path, unsigned depth, config_file_cb_t *cb);
 
+static uint32_t config_hash_key(const char *key)
+{
+   uint32_t hash = 5381;
+
+   while (*key)
+      hash = (hash << 5) + hash + (uint8_t)*key++;
+
+   return hash;
+}
+
+/* Drops the index, it gets rebuilt on the next lookup */
+static void config_index_clear(config_file_t *conf)
+{
+   free(conf->index);
+   conf->index       = NULL;
+   conf->index_cap   = 0;
+   conf->index_count = 0;
+}
+
+/* Inserts @entry, unless the index already holds an
+ * (earlier) entry with the same key */
+static void config_index_insert(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   size_t mask = conf->index_cap - 1;
+   size_t i    = entry->hash & mask;
+
+   for (; conf->index[i]; i = (i + 1) & mask)
+   {
+      if (     conf->index[i]->hash == entry->hash
+            && string_is_equal(conf->index[i]->key, entry->key))
+         return;
+   }
+
+   conf->index[i] = entry;
+   conf->index_count++;
+}
+
+static bool config_index_build(config_file_t *conf)
+{
+   size_t count                    = 0;
+   size_t cap                      = 32;
+   struct config_entry_list *entry = NULL;
+
+   for (entry = conf->entries; entry; entry = entry->next)
+      count++;
+
+   while (cap < count * 2)
+      cap <<= 1;
+
+   config_index_clear(conf);
+
+   conf->index = (struct config_entry_list**)calloc(cap, sizeof(*conf->index));
+   if (!conf->index)
+      return false;
+   conf->index_cap = cap;
+
+   for (entry = conf->entries; entry; entry = entry->next)
+   {
+      if (!entry->key)
+         continue;
+      entry->hash = config_hash_key(entry->key);
+      config_index_insert(conf, entry);
+   }
+
+   return true;
+}
+
+/* Keeps the index up to date with an entry added to the end of the list */
+static void config_index_add(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   if (!conf->index || !entry->key)
+      return;
+
+   if ((conf->index_count + 1) * 2 > conf->index_cap)
+   {
+      size_t i;
+      size_t cap                        = conf->index_cap * 2;
+      struct config_entry_list **old    = conf->index;
+      size_t old_cap                    = conf->index_cap;
+
+      conf->index = (struct config_entry_list**)calloc(cap, sizeof(*conf->index));
+      if (!conf->index)
+      {
+         conf->index = old;
+         config_index_clear(conf);
+         return;
+      }
+
+      conf->index_cap   = cap;
+      conf->index_count = 0;
+
+      for (i = 0; i < old_cap; i++)
+         if (old[i])
+            config_index_insert(conf, old[i]);
+
+      free(old);
+   }
+
+   entry->hash = config_hash_key(entry->key);
+   config_index_insert(conf, entry);
+}
+
 static int config_sort_compare_func(struct config_entry_list *a,
       struct config_entry_list *b)
 {
@@ -268,6 +373,8 @@ static void add_child_list(config_file_t *parent, config_file_t *child)
    }
    else
       parent->tail = NULL;
+
+   config_index_clear(parent);
 }
 
 static void add_sub_conf(config_file_t *conf, char *path, config_file_cb_t *cb)
@@ -409,7 +516,9 @@ static config_file_t *config_file_new_internal(
    conf->path                     = NULL;
    conf->entries                  = NULL;
    conf->tail                     = NULL;
-   conf->last                     = NULL;
+   conf->index                    = NULL;
+   conf->index_cap                = 0;
+   conf->index_count              = 0;
    conf->includes                 = NULL;
    conf->include_depth            = 0;
    conf->guaranteed_no_duplicates = false ;
@@ -468,6 +577,7 @@ static config_file_t *config_file_new_internal(
             conf->entries = list;
 
          conf->tail = list;
+         config_index_add(conf, list);
 
          if (cb != NULL && list->key != NULL && list->value != NULL)
             cb->config_file_new_entry_cb(list->key, list->value) ;
@@ -527,6 +637,7 @@ void config_file_free(config_file_t *conf)
 
    if (conf->path)
       free(conf->path);
+   free(conf->index);
    free(conf);
 }
 
@@ -541,6 +652,11 @@ bool config_append_file(config_file_t *conf, const char *path)
       new_conf->tail->next = conf->entries;
       conf->entries        = new_conf->entries; /* Pilfer. */
       new_conf->entries    = NULL;
+
+      if (!conf->tail)
+         conf->tail        = new_conf->tail;
+
+      config_index_clear(conf);
    }
 
    config_file_free(new_conf);
@@ -555,17 +671,19 @@ config_file_t *config_file_new_from_string(const char *from_string)
    if (!conf)
       return NULL;
 
-   if (!from_string)
-      return conf;
-
    conf->path                     = NULL;
    conf->entries                  = NULL;
    conf->tail                     = NULL;
-   conf->last                     = NULL;
+   conf->index                    = NULL;
+   conf->index_cap                = 0;
+   conf->index_count              = 0;
    conf->includes                 = NULL;
    conf->include_depth            = 0;
    conf->guaranteed_no_duplicates = false ;
 
+   if (!from_string)
+      return conf;
+
    lines = string_split(from_string, "\n");
    if (!lines)
       return conf;
@@ -597,6 +715,7 @@ config_file_t *config_file_new_from_string(const char *from_string)
                conf->entries = list;
 
             conf->tail = list;
+            config_index_add(conf, list);
          }
       }
 
@@ -618,29 +737,44 @@ config_file_t *config_file_new(const char *path)
    return config_file_new_internal(path, 0, NULL);
 }
 
-static struct config_entry_list *config_get_entry(const config_file_t *conf,
-      const char *key, struct config_entry_list **prev)
+static struct config_entry_list *config_get_entry(config_file_t *conf,
+      const char *key)
 {
-   struct config_entry_list *entry    = NULL;
-   struct config_entry_list *previous = prev ? *prev : NULL;
+   size_t i, mask;
+   uint32_t hash;
+   struct config_entry_list *entry = NULL;
 
-   for (entry = conf->entries; entry; entry = entry->next)
+   if (!key)
+      return NULL;
+
+   if (!conf->index && !config_index_build(conf))
    {
-      if (string_is_equal(key, entry->key))
-         return entry;
+      for (entry = conf->entries; entry; entry = entry->next)
+      {
+         if (string_is_equal(key, entry->key))
+            return entry;
+      }
 
-      previous = entry;
+      return NULL;
    }
 
-   if (prev)
-      *prev = previous;
+   hash = config_hash_key(key);
+   mask = conf->index_cap - 1;
+
+   for (i = hash & mask; conf->index[i]; i = (i + 1) & mask)
+   {
+      entry = conf->index[i];
+
+      if (entry->hash == hash && string_is_equal(key, entry->key))
+         return entry;
+   }
 
    return NULL;
 }
 
 bool config_get_double(config_file_t *conf, const char *key, double *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -653,7 +787,7 @@ bool config_get_double(config_file_t *conf, const char *key, double *in)
 
 bool config_get_float(config_file_t *conf, const char *key, float *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -666,7 +800,7 @@ bool config_get_float(config_file_t *conf, const char *key, float *in)
 
 bool config_get_int(config_file_t *conf, const char *key, int *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -685,7 +819,7 @@ bool config_get_int(config_file_t *conf, const char *key, int *in)
 
 bool config_get_size_t(config_file_t *conf, const char *key, size_t *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -704,7 +838,7 @@ bool config_get_size_t(config_file_t *conf, const char *key, size_t *in)
 #if defined(__STDC_VERSION__) && __STDC_VERSION__>=199901L
 bool config_get_uint64(config_file_t *conf, const char *key, uint64_t *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -723,7 +857,7 @@ bool config_get_uint64(config_file_t *conf, const char *key, uint64_t *in)
 
 bool config_get_uint(config_file_t *conf, const char *key, unsigned *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -742,7 +876,7 @@ bool config_get_uint(config_file_t *conf, const char *key, unsigned *in)
 
 bool config_get_hex(config_file_t *conf, const char *key, unsigned *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -761,7 +895,7 @@ bool config_get_hex(config_file_t *conf, const char *key, unsigned *in)
 
 bool config_get_char(config_file_t *conf, const char *key, char *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -777,7 +911,7 @@ bool config_get_char(config_file_t *conf, const char *key, char *in)
 
 bool config_get_string(config_file_t *conf, const char *key, char **str)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -798,7 +932,7 @@ bool config_get_config_path(config_file_t *conf, char *s, size_t len)
 bool config_get_array(config_file_t *conf, const char *key,
       char *buf, size_t size)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
       return strlcpy(buf, entry->value, size) < size;
@@ -812,7 +946,7 @@ bool config_get_path(config_file_t *conf, const char *key,
    if (config_get_array(conf, key, buf, size))
       return true;
 #else
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -825,7 +959,7 @@ bool config_get_path(config_file_t *conf, const char *key,
 
 bool config_get_bool(config_file_t *conf, const char *key, bool *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -846,8 +980,8 @@ bool config_get_bool(config_file_t *conf, const char *key, bool *in)
 
 void config_set_string(config_file_t *conf, const char *key, const char *val)
 {
-   struct config_entry_list *last  = (conf->guaranteed_no_duplicates && conf->last) ? conf->last : conf->entries;
-   struct config_entry_list *entry = conf->guaranteed_no_duplicates?NULL:config_get_entry(conf, key, &last);
+   struct config_entry_list *entry = conf->guaranteed_no_duplicates
+      ? NULL : config_get_entry(conf, key);
 
    if (entry && !entry->readonly)
    {
@@ -868,27 +1002,30 @@ void config_set_string(config_file_t *conf, const char *key, const char *val)
    entry->value     = strdup(val);
    entry->next      = NULL;
 
-   if (last)
-      last->next    = entry;
+   if (conf->tail)
+      conf->tail->next = entry;
    else
-      conf->entries = entry;
+      conf->entries    = entry;
 
-   conf->last = entry ;
+   conf->tail = entry;
 
+   config_index_add(conf, entry);
 }
 
 void config_unset(config_file_t *conf, const char *key)
 {
-   struct config_entry_list *last  = conf->entries;
-   struct config_entry_list *entry = config_get_entry(conf, key, &last);
+   struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (!entry)
       return;
 
-   entry->key   = NULL;
-   entry->value = NULL;
    free(entry->key);
    free(entry->value);
+   entry->key   = NULL;
+   entry->value = NULL;
+
+   /* A later entry with the same key may show up now */
+   config_index_clear(conf);
 }
 
 void config_set_path(config_file_t *conf, const char *entry, const char *val)
@@ -1031,6 +1168,10 @@ void config_file_dump_orbis(config_file_t *conf, int fd)
    list = merge_sort_linked_list((struct config_entry_list*)conf->entries, config_sort_compare_func);
    conf->entries = list;
 
+   for (conf->tail = list; conf->tail && conf->tail->next; )
+      conf->tail = conf->tail->next;
+   config_index_clear(conf);
+
    while (list)
    {
       if (!list->readonly && list->key)
@@ -1056,7 +1197,14 @@ void config_file_dump(config_file_t *conf, FILE *file, bool sort)
    }
 
    if (sort)
+   {
       list = merge_sort_linked_list((struct config_entry_list*)conf->entries, config_sort_compare_func);
+
+      /* Rebase tail, the first entry of a key may have changed too */
+      for (conf->tail = list; conf->tail && conf->tail->next; )
+         conf->tail = conf->tail->next;
+      config_index_clear(conf);
+   }
    else
       list = (struct config_entry_list*)conf->entries;
 
@@ -1072,16 +1220,7 @@ void config_file_dump(config_file_t *conf, FILE *file, bool sort)
 
 bool config_entry_exists(config_file_t *conf, const char *entry)
 {
-   struct config_entry_list *list = conf->entries;
-
-   while (list)
-   {
-      if (string_is_equal(entry, list->key))
-         return true;
-      list = list->next;
-   }
-
-   return false;
+   return config_get_entry(conf, entry) != NULL;
 }
 
 bool config_get_entry_list_head(config_file_t *conf,
@@ -206,6 +206,26 @@ void image_transfer_set_buffer_ptr(
    }
 }
 
+void image_transfer_set_threaded(
+      void *data,
+      enum image_type_enum type,
+      bool threaded)
+{
+   switch (type)
+   {
+      case IMAGE_TYPE_PNG:
+#ifdef HAVE_RPNG
+         rpng_set_threaded((rpng_t*)data, threaded);
+#endif
+         break;
+      case IMAGE_TYPE_JPEG:
+      case IMAGE_TYPE_TGA:
+      case IMAGE_TYPE_BMP:
+      case IMAGE_TYPE_NONE:
+         break;
+   }
+}
+
 int image_transfer_process(
       void *data,
       enum image_type_enum type,
@@ -35,8 +35,27 @@
 #include <streams/trans_stream.h>
 #include <string/stdstring.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "rpng_internal.h"
 
+#if !defined(RPNG_NO_SIMD)
+#if defined(__SSE2__)
+#define RPNG_SSE2
+#include <emmintrin.h>
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(MSB_FIRST)
+#define RPNG_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+/* Images which inflate to less than this aren't worth a worker thread. */
+#define RPNG_THREADED_MIN_SIZE (256 * 1024)
+/* How much the worker inflates before handing it over. */
+#define RPNG_THREADED_CHUNK_SIZE (32 * 1024)
+
 enum png_ihdr_color_type
 {
    PNG_IHDR_COLOR_GRAY       = 0,
@@ -114,6 +133,19 @@ struct rpng_process
    uint32_t *palette;
    void *stream;
    const struct trans_stream_backend *stream_backend;
+#ifdef HAVE_THREADS
+   /* While thread runs, it owns stream, avail_in, avail_out and total_out,
+    * and publishes under lock how much of inflate_buf it has filled
+    * (inflated) and whether it's stopped (inflate_done). */
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   uint8_t *thread_buf;
+   size_t inflated;
+   size_t inflated_seen;
+   bool inflate_done;
+   bool inflate_cancel;
+#endif
 };
 
 struct rpng
@@ -124,6 +156,7 @@ struct rpng
    bool has_iend;
    bool has_plte;
    bool has_trns;
+   bool threaded;
    struct idat_buffer idat_buf;
    struct png_ihdr ihdr;
    uint8_t *buff_data;
@@ -228,14 +261,63 @@ end:
    return ret;
 }
 
+#if defined(RPNG_SSE2)
+/* Turns R | G << 8 | B << 16 into B | G << 8 | R << 16, keeping the bits
+ * of keep (green, and alpha if there's one). */
+static INLINE __m128i png_swap_rb_sse2(__m128i px, __m128i keep)
+{
+   const __m128i mask = _mm_set1_epi32(0xff);
+   __m128i r          = _mm_slli_epi32(_mm_and_si128(px, mask), 16);
+   __m128i b          = _mm_and_si128(_mm_srli_epi32(px, 16), mask);
+
+   return _mm_or_si128(_mm_and_si128(px, keep), _mm_or_si128(r, b));
+}
+#endif
+
 static void png_reverse_filter_copy_line_rgb(uint32_t *data,
       const uint8_t *decoded, unsigned width, unsigned bpp)
 {
-   unsigned i;
+   unsigned i = 0;
 
    bpp /= 8;
 
-   for (i = 0; i < width; i++)
+#if defined(RPNG_SSE2)
+   if (bpp == 1)
+   {
+      const __m128i keep  = _mm_set1_epi32(0xff00);
+      const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+
+      /* Four pixels at a time, as long as 16 bytes can be read. */
+      for (; i + 6 <= width; i += 4, decoded += 12)
+      {
+         __m128i in  = _mm_loadu_si128((const __m128i*)decoded);
+         __m128i p01 = _mm_unpacklo_epi32(in, _mm_srli_si128(in, 3));
+         __m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(in, 6),
+               _mm_srli_si128(in, 9));
+         __m128i px  = _mm_unpacklo_epi64(p01, p23);
+
+         _mm_storeu_si128((__m128i*)(data + i),
+               _mm_or_si128(png_swap_rb_sse2(px, keep), alpha));
+      }
+   }
+#elif defined(RPNG_NEON)
+   if (bpp == 1)
+   {
+      for (; i + 16 <= width; i += 16, decoded += 48)
+      {
+         uint8x16x3_t in = vld3q_u8(decoded);
+         uint8x16x4_t out;
+
+         out.val[0] = in.val[2];
+         out.val[1] = in.val[1];
+         out.val[2] = in.val[0];
+         out.val[3] = vdupq_n_u8(0xff);
+         vst4q_u8((uint8_t*)(data + i), out);
+      }
+   }
+#endif
+
+   for (; i < width; i++)
    {
       uint32_t r, g, b;
 
@@ -252,11 +334,35 @@ static void png_reverse_filter_copy_line_rgb(uint32_t *data,
 static void png_reverse_filter_copy_line_rgba(uint32_t *data,
       const uint8_t *decoded, unsigned width, unsigned bpp)
 {
-   unsigned i;
+   unsigned i = 0;
 
    bpp /= 8;
 
-   for (i = 0; i < width; i++)
+#if defined(RPNG_SSE2)
+   if (bpp == 1)
+   {
+      const __m128i keep = _mm_set1_epi32((int)0xff00ff00);
+
+      for (; i + 4 <= width; i += 4, decoded += 16)
+         _mm_storeu_si128((__m128i*)(data + i), png_swap_rb_sse2(
+                  _mm_loadu_si128((const __m128i*)decoded), keep));
+   }
+#elif defined(RPNG_NEON)
+   if (bpp == 1)
+   {
+      for (; i + 16 <= width; i += 16, decoded += 64)
+      {
+         uint8x16x4_t px = vld4q_u8(decoded);
+         uint8x16_t r    = px.val[0];
+
+         px.val[0]       = px.val[2];
+         px.val[2]       = r;
+         vst4q_u8((uint8_t*)(data + i), px);
+      }
+   }
+#endif
+
+   for (; i < width; i++)
    {
       uint32_t r, g, b, a;
       r        = *decoded;
@@ -487,10 +593,125 @@ static void png_reverse_filter_adam7_deinterlace_pass(uint32_t *data,
    }
 }
 
+#ifdef HAVE_THREADS
+static void rpng_inflate_thread(void *data)
+{
+   struct rpng_process *pngp = (struct rpng_process*)data;
+   bool done                 = false;
+
+   while (!done && pngp->avail_in && pngp->avail_out)
+   {
+      bool zstatus;
+      uint32_t rd                    = 0;
+      uint32_t wn                    = 0;
+      enum trans_stream_error terror = TRANS_STREAM_ERROR_NONE;
+      size_t chunk                   = pngp->avail_out;
+
+      if (chunk > RPNG_THREADED_CHUNK_SIZE)
+         chunk = RPNG_THREADED_CHUNK_SIZE;
+
+      pngp->stream_backend->set_out(pngp->stream,
+            pngp->thread_buf + pngp->total_out, (uint32_t)chunk);
+
+      zstatus = pngp->stream_backend->trans(pngp->stream, false,
+            &rd, &wn, &terror);
+
+      pngp->avail_in  -= rd;
+      pngp->avail_out -= wn;
+      pngp->total_out += wn;
+
+      /* Filling up the chunk is fine, the end of the stream
+       * or an error isn't. */
+      done = terror == TRANS_STREAM_ERROR_NONE ||
+         (!zstatus && terror != TRANS_STREAM_ERROR_BUFFER_FULL);
+
+      slock_lock(pngp->lock);
+      pngp->inflated = pngp->total_out;
+      if (pngp->inflate_cancel)
+         done = true;
+      scond_signal(pngp->cond);
+      slock_unlock(pngp->lock);
+   }
+
+   slock_lock(pngp->lock);
+   pngp->inflate_done = true;
+   scond_signal(pngp->cond);
+   slock_unlock(pngp->lock);
+}
+
+static bool rpng_inflate_thread_start(struct rpng_process *pngp)
+{
+   pngp->lock = slock_new();
+   pngp->cond = scond_new();
+
+   if (!pngp->lock || !pngp->cond)
+      goto error;
+
+   pngp->thread_buf = pngp->inflate_buf;
+   pngp->thread     = sthread_create(rpng_inflate_thread, pngp);
+
+   if (!pngp->thread)
+      goto error;
+
+   return true;
+
+error:
+   slock_free(pngp->lock);
+   scond_free(pngp->cond);
+   pngp->lock = NULL;
+   pngp->cond = NULL;
+   return false;
+}
+
+static void rpng_inflate_thread_stop(struct rpng_process *pngp)
+{
+   if (!pngp->thread)
+      return;
+
+   slock_lock(pngp->lock);
+   pngp->inflate_cancel = true;
+   slock_unlock(pngp->lock);
+
+   sthread_join(pngp->thread);
+   slock_free(pngp->lock);
+   scond_free(pngp->cond);
+
+   pngp->thread = NULL;
+   pngp->lock   = NULL;
+   pngp->cond   = NULL;
+}
+#endif
+
+/* Whether the first size bytes of inflated data are there, waiting on
+ * the worker for them if it's still inflating. */
+static bool png_inflated(struct rpng_process *pngp, size_t size)
+{
+#ifdef HAVE_THREADS
+   if (pngp->thread)
+   {
+      if (size <= pngp->inflated_seen)
+         return true;
+
+      slock_lock(pngp->lock);
+      while (pngp->inflated < size && !pngp->inflate_done)
+         scond_wait(pngp->cond, pngp->lock);
+      pngp->inflated_seen = pngp->inflated;
+      slock_unlock(pngp->lock);
+
+      return size <= pngp->inflated_seen;
+   }
+#endif
+
+   return size <= pngp->total_out;
+}
+
 static void png_reverse_filter_deinit(struct rpng_process *pngp)
 {
    if (!pngp)
       return;
+#ifdef HAVE_THREADS
+   rpng_inflate_thread_stop(pngp);
+#endif
    if (pngp->decoded_scanline)
       free(pngp->decoded_scanline);
    pngp->decoded_scanline = NULL;
@@ -558,8 +779,8 @@ static int png_reverse_filter_init(const struct png_ihdr *ihdr,
 
    png_pass_geom(ihdr, ihdr->width, ihdr->height, &pngp->bpp, &pngp->pitch, &pass_size);
 
-   if (pngp->total_out < pass_size)
-      return -1;
+   /* A worker may still be inflating, so lines are checked against
+    * what's been inflated as they're read instead. */
 
    pngp->restore_buf_size      = 0;
    pngp->data_restore_buf_size = 0;
@@ -579,10 +800,265 @@ error:
    return -1;
 }
 
+/* Unfiltering. in is the filtered line, prev the previous unfiltered one,
+ * and out receives this one unfiltered. Sub, Average and Paeth depend on
+ * the pixel to the left, so the SIMD versions work one pixel at a time for
+ * the common 3 and 4 bytes per pixel, and leave the rest to plain C. */
+
+#if defined(RPNG_SSE2)
+static INLINE __m128i png_load_pixel_simd(const uint8_t *p, unsigned bpp)
+{
+   uint32_t v = 0;
+   memcpy(&v, p, bpp);
+   return _mm_cvtsi32_si128((int)v);
+}
+
+static INLINE void png_store_pixel_simd(uint8_t *p, __m128i v, unsigned bpp)
+{
+   uint32_t o = (uint32_t)_mm_cvtsi128_si32(v);
+   memcpy(p, &o, bpp);
+}
+
+static INLINE void png_reverse_filter_sub_simd(uint8_t *out,
+      const uint8_t *in, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   __m128i a = _mm_setzero_si128();
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      a = _mm_add_epi8(a, png_load_pixel_simd(in + i, bpp));
+      png_store_pixel_simd(out + i, a, bpp);
+   }
+}
+
+static INLINE void png_reverse_filter_avg_simd(uint8_t *out,
+      const uint8_t *in, const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   const __m128i one = _mm_set1_epi8(1);
+   __m128i a         = _mm_setzero_si128();
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      __m128i b   = png_load_pixel_simd(prev + i, bpp);
+      /* _mm_avg_epu8 rounds up, PNG rounds down. */
+      __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+            _mm_and_si128(_mm_xor_si128(a, b), one));
+
+      a = _mm_add_epi8(avg, png_load_pixel_simd(in + i, bpp));
+      png_store_pixel_simd(out + i, a, bpp);
+   }
+}
+
+static INLINE __m128i png_abs_epi16_sse2(__m128i x)
+{
+   return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+static INLINE __m128i png_select_sse2(__m128i cond, __m128i a, __m128i b)
+{
+   return _mm_or_si128(_mm_and_si128(cond, a), _mm_andnot_si128(cond, b));
+}
+
+static INLINE void png_reverse_filter_paeth_simd(uint8_t *out,
+      const uint8_t *in, const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   const __m128i zero = _mm_setzero_si128();
+   __m128i a          = zero;
+   __m128i b          = zero;
+   __m128i c          = zero;
+   __m128i d          = zero;
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      __m128i pa, pb, pc, smallest, nearest;
+
+      /* Widen to 16 bits: c is up-left, b up, a left. */
+      c  = b;
+      b  = _mm_unpacklo_epi8(png_load_pixel_simd(prev + i, bpp), zero);
+      a  = d;
+      d  = _mm_unpacklo_epi8(png_load_pixel_simd(in + i, bpp), zero);
+
+      /* With p = a + b - c: p - a = b - c, p - b = a - c,
+       * p - c = (b - c) + (a - c). */
+      pa = _mm_sub_epi16(b, c);
+      pb = _mm_sub_epi16(a, c);
+      pc = _mm_add_epi16(pa, pb);
+
+      pa = png_abs_epi16_sse2(pa);
+      pb = png_abs_epi16_sse2(pb);
+      pc = png_abs_epi16_sse2(pc);
+
+      smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+      nearest  = png_select_sse2(_mm_cmpeq_epi16(smallest, pa), a,
+            png_select_sse2(_mm_cmpeq_epi16(smallest, pb), b, c));
+
+      /* Bytewise add wraps within each 16-bit lane's low byte. */
+      d = _mm_add_epi8(d, nearest);
+      png_store_pixel_simd(out + i, _mm_packus_epi16(d, d), bpp);
+   }
+}
+#elif defined(RPNG_NEON)
+static INLINE uint8x8_t png_load_pixel_simd(const uint8_t *p, unsigned bpp)
+{
+   uint32_t v = 0;
+   memcpy(&v, p, bpp);
+   return vreinterpret_u8_u32(vdup_n_u32(v));
+}
+
+static INLINE void png_store_pixel_simd(uint8_t *p, uint8x8_t v, unsigned bpp)
+{
+   uint32_t o = vget_lane_u32(vreinterpret_u32_u8(v), 0);
+   memcpy(p, &o, bpp);
+}
+
+static INLINE void png_reverse_filter_sub_simd(uint8_t *out,
+      const uint8_t *in, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   uint8x8_t a = vdup_n_u8(0);
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      a = vadd_u8(a, png_load_pixel_simd(in + i, bpp));
+      png_store_pixel_simd(out + i, a, bpp);
+   }
+}
+
+static INLINE void png_reverse_filter_avg_simd(uint8_t *out,
+      const uint8_t *in, const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   uint8x8_t a = vdup_n_u8(0);
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      a = vadd_u8(vhadd_u8(a, png_load_pixel_simd(prev + i, bpp)),
+            png_load_pixel_simd(in + i, bpp));
+      png_store_pixel_simd(out + i, a, bpp);
+   }
+}
+
+static INLINE void png_reverse_filter_paeth_simd(uint8_t *out,
+      const uint8_t *in, const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   uint8x8_t a = vdup_n_u8(0);
+   uint8x8_t c = vdup_n_u8(0);
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      uint8x8_t b    = png_load_pixel_simd(prev + i, bpp);
+      /* |p - a| = |b - c|, |p - b| = |a - c|, |p - c| = |a + b - 2c| */
+      uint16x8_t pa  = vabdl_u8(b, c);
+      uint16x8_t pb  = vabdl_u8(a, c);
+      uint16x8_t pc  = vabdq_u16(vaddl_u8(a, b), vaddl_u8(c, c));
+      uint8x8_t use_a = vmovn_u16(vandq_u16(vcleq_u16(pa, pb),
+               vcleq_u16(pa, pc)));
+      uint8x8_t use_b = vmovn_u16(vcleq_u16(pb, pc));
+      uint8x8_t pred  = vbsl_u8(use_a, a, vbsl_u8(use_b, b, c));
+
+      a = vadd_u8(pred, png_load_pixel_simd(in + i, bpp));
+      c = b;
+      png_store_pixel_simd(out + i, a, bpp);
+   }
+}
+#endif
+
+static void png_reverse_filter_sub(uint8_t *out,
+      const uint8_t *in, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+
+#if defined(RPNG_SSE2) || defined(RPNG_NEON)
+   if (bpp == 3 || bpp == 4)
+   {
+      /* Constant sizes let the pixel loads and stores inline. */
+      if (bpp == 4)
+         png_reverse_filter_sub_simd(out, in, pitch, 4);
+      else
+         png_reverse_filter_sub_simd(out, in, pitch, 3);
+      return;
+   }
+#endif
+
+   for (i = 0; i < bpp; i++)
+      out[i] = in[i];
+   for (i = bpp; i < pitch; i++)
+      out[i] = out[i - bpp] + in[i];
+}
+
+static void png_reverse_filter_up(uint8_t *out,
+      const uint8_t *in, const uint8_t *prev, unsigned pitch)
+{
+   unsigned i = 0;
+
+#if defined(RPNG_SSE2)
+   for (; i + 16 <= pitch; i += 16)
+      _mm_storeu_si128((__m128i*)(out + i), _mm_add_epi8(
+               _mm_loadu_si128((const __m128i*)(in + i)),
+               _mm_loadu_si128((const __m128i*)(prev + i))));
+#elif defined(RPNG_NEON)
+   for (; i + 16 <= pitch; i += 16)
+      vst1q_u8(out + i, vaddq_u8(vld1q_u8(in + i), vld1q_u8(prev + i)));
+#endif
+
+   for (; i < pitch; i++)
+      out[i] = prev[i] + in[i];
+}
+
+static void png_reverse_filter_avg(uint8_t *out,
+      const uint8_t *in, const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+
+#if defined(RPNG_SSE2) || defined(RPNG_NEON)
+   if (bpp == 3 || bpp == 4)
+   {
+      /* Constant sizes let the pixel loads and stores inline. */
+      if (bpp == 4)
+         png_reverse_filter_avg_simd(out, in, prev, pitch, 4);
+      else
+         png_reverse_filter_avg_simd(out, in, prev, pitch, 3);
+      return;
+   }
+#endif
+
+   for (i = 0; i < bpp; i++)
+      out[i] = (prev[i] >> 1) + in[i];
+   for (i = bpp; i < pitch; i++)
+      out[i] = ((out[i - bpp] + prev[i]) >> 1) + in[i];
+}
+
+static void png_reverse_filter_paeth(uint8_t *out,
+      const uint8_t *in, const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+
+#if defined(RPNG_SSE2) || defined(RPNG_NEON)
+   if (bpp == 3 || bpp == 4)
+   {
+      /* Constant sizes let the pixel loads and stores inline. */
+      if (bpp == 4)
+         png_reverse_filter_paeth_simd(out, in, prev, pitch, 4);
+      else
+         png_reverse_filter_paeth_simd(out, in, prev, pitch, 3);
+      return;
+   }
+#endif
+
+   for (i = 0; i < bpp; i++)
+      out[i] = paeth(0, prev[i], 0) + in[i];
+   for (i = bpp; i < pitch; i++)
+      out[i] = paeth(out[i - bpp], prev[i], prev[i - bpp]) + in[i];
+}
+
 static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *ihdr,
       struct rpng_process *pngp, unsigned filter)
 {
-   unsigned i;
+   uint8_t *swap;
 
    switch (filter)
    {
@@ -590,33 +1066,20 @@ static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *i
          memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
          break;
       case PNG_FILTER_SUB:
-         for (i = 0; i < pngp->bpp; i++)
-            pngp->decoded_scanline[i] = pngp->inflate_buf[i];
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = pngp->decoded_scanline[i - pngp->bpp] + pngp->inflate_buf[i];
+         png_reverse_filter_sub(pngp->decoded_scanline,
+               pngp->inflate_buf, pngp->pitch, pngp->bpp);
          break;
       case PNG_FILTER_UP:
-         for (i = 0; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = pngp->prev_scanline[i] + pngp->inflate_buf[i];
+         png_reverse_filter_up(pngp->decoded_scanline,
+               pngp->inflate_buf, pngp->prev_scanline, pngp->pitch);
          break;
       case PNG_FILTER_AVERAGE:
-         for (i = 0; i < pngp->bpp; i++)
-         {
-            uint8_t avg = pngp->prev_scanline[i] >> 1;
-            pngp->decoded_scanline[i] = avg + pngp->inflate_buf[i];
-         }
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-         {
-            uint8_t avg = (pngp->decoded_scanline[i - pngp->bpp] + pngp->prev_scanline[i]) >> 1;
-            pngp->decoded_scanline[i] = avg + pngp->inflate_buf[i];
-         }
+         png_reverse_filter_avg(pngp->decoded_scanline,
+               pngp->inflate_buf, pngp->prev_scanline, pngp->pitch, pngp->bpp);
          break;
       case PNG_FILTER_PAETH:
-         for (i = 0; i < pngp->bpp; i++)
-            pngp->decoded_scanline[i] = paeth(0, pngp->prev_scanline[i], 0) + pngp->inflate_buf[i];
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = paeth(pngp->decoded_scanline[i - pngp->bpp],
-                  pngp->prev_scanline[i], pngp->prev_scanline[i - pngp->bpp]) + pngp->inflate_buf[i];
+         png_reverse_filter_paeth(pngp->decoded_scanline,
+               pngp->inflate_buf, pngp->prev_scanline, pngp->pitch, pngp->bpp);
          break;
 
       default:
@@ -644,7 +1107,10 @@ static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *i
          break;
    }
 
-   memcpy(pngp->prev_scanline, pngp->decoded_scanline, pngp->pitch);
+   /* This line is the next one's previous line. */
+   swap                   = pngp->prev_scanline;
+   pngp->prev_scanline    = pngp->decoded_scanline;
+   pngp->decoded_scanline = swap;
 
    return IMAGE_PROCESS_NEXT;
 }
@@ -656,7 +1122,15 @@ static int png_reverse_filter_regular_iterate(uint32_t **data, const struct png_
 
    if (pngp->h < ihdr->height)
    {
-      unsigned filter = *pngp->inflate_buf++;
+      unsigned filter;
+
+      if (!png_inflated(pngp, pngp->restore_buf_size + 1 + pngp->pitch))
+      {
+         ret = IMAGE_PROCESS_ERROR_END;
+         goto end;
+      }
+
+      filter = *pngp->inflate_buf++;
       pngp->restore_buf_size += 1;
       ret = png_reverse_filter_copy_line(*data,
             ihdr, pngp, filter);
@@ -786,6 +1260,15 @@ static int rpng_load_image_argb_process_inflate_init(rpng_t *rpng,
    if (!to_continue)
       goto end;
 
+#ifdef HAVE_THREADS
+   /* Inflate on a worker from here on, and unfilter lines as they come. */
+   if (     rpng->threaded
+         && !rpng->ihdr.interlace
+         && process->inflate_buf_size >= RPNG_THREADED_MIN_SIZE
+         && rpng_inflate_thread_start(process))
+      goto output;
+#endif
+
    zstatus = process->stream_backend->trans(process->stream, false, &rd, &wn, &terror);
 
    if (!zstatus && terror != TRANS_STREAM_ERROR_BUFFER_FULL)
@@ -802,6 +1285,9 @@ end:
    process->stream_backend->stream_free(process->stream);
    process->stream = NULL;
 
+#ifdef HAVE_THREADS
+output:
+#endif
    *width  = rpng->ihdr.width;
    *height = rpng->ihdr.height;
 #ifdef GEKKO
@@ -1112,11 +1598,15 @@ int rpng_process_image(rpng_t *rpng,
 error:
    if (rpng->process)
    {
+#ifdef HAVE_THREADS
+      rpng_inflate_thread_stop(rpng->process);
+#endif
       if (rpng->process->inflate_buf)
          free(rpng->process->inflate_buf);
       if (rpng->process->stream)
          rpng->process->stream_backend->stream_free(rpng->process->stream);
       free(rpng->process);
+      rpng->process = NULL;
    }
    return IMAGE_PROCESS_ERROR;
 }
@@ -1126,10 +1616,11 @@ void rpng_free(rpng_t *rpng)
    if (!rpng)
       return;
 
-   if (rpng->idat_buf.data)
-      free(rpng->idat_buf.data);
    if (rpng->process)
    {
+#ifdef HAVE_THREADS
+      rpng_inflate_thread_stop(rpng->process);
+#endif
       if (rpng->process->inflate_buf)
          free(rpng->process->inflate_buf);
       if (rpng->process->stream)
@@ -1141,6 +1632,8 @@ void rpng_free(rpng_t *rpng)
       }
       free(rpng->process);
    }
+   if (rpng->idat_buf.data)
+      free(rpng->idat_buf.data);
 
    free(rpng);
 }
@@ -1190,6 +1683,12 @@ bool rpng_set_buf_ptr(rpng_t *rpng, void *data)
    return true;
 }
 
+void rpng_set_threaded(rpng_t *rpng, bool threaded)
+{
+   if (rpng)
+      rpng->threaded = threaded;
+}
+
 rpng_t *rpng_alloc(void)
 {
    rpng_t *rpng = (rpng_t*)calloc(1, sizeof(*rpng));
@@ -208,28 +208,80 @@ static unsigned filter_paeth(uint8_t *target,
    return count_sad(target, width);
 }
 
+/* Compressed data is written out in IDAT chunks of this size
+ * as it is produced, instead of deflating the whole image
+ * into one buffer first. */
+#define RPNG_SAVE_IDAT_SIZE (64 * 1024)
+
+static bool png_write_idat_chunk(RFILE *file, uint8_t *chunk, uint32_t size)
+{
+   dword_write_be(chunk + 0, size);
+   memcpy(chunk + 4, "IDAT", 4);
+   return png_write_idat(file, chunk, (size_t)size + 8);
+}
+
+/* Feeds one filtered line to the deflate stream, writing out
+ * every IDAT chunk that fills up. With flush, also finishes
+ * the stream and writes the last, partial chunk. */
+static bool png_deflate_line(RFILE *file,
+      const struct trans_stream_backend *stream_backend, void *stream,
+      uint8_t *chunk, uint32_t *chunk_used,
+      const uint8_t *data, uint32_t size, bool flush)
+{
+   stream_backend->set_in(stream, data, size);
+
+   for (;;)
+   {
+      uint32_t rd                 = 0;
+      uint32_t wn                 = 0;
+      enum trans_stream_error err = TRANS_STREAM_ERROR_NONE;
+
+      stream_backend->set_out(stream, chunk + 8 + *chunk_used,
+            RPNG_SAVE_IDAT_SIZE - *chunk_used);
+
+      if (!stream_backend->trans(stream, flush, &rd, &wn, &err)
+            && err != TRANS_STREAM_ERROR_BUFFER_FULL)
+         return false;
+
+      size        -= rd;
+      *chunk_used += wn;
+
+      if (*chunk_used == RPNG_SAVE_IDAT_SIZE)
+      {
+         if (!png_write_idat_chunk(file, chunk, *chunk_used))
+            return false;
+         *chunk_used = 0;
+      }
+
+      if (flush ? err == TRANS_STREAM_ERROR_NONE : !size)
+         break;
+   }
+
+   if (flush && *chunk_used)
+      return png_write_idat_chunk(file, chunk, *chunk_used);
+
+   return true;
+}
+
 static bool rpng_save_image(const char *path,
       const uint8_t *data,
-      unsigned width, unsigned height, unsigned pitch, unsigned bpp)
+      unsigned width, unsigned height, unsigned pitch, unsigned bpp,
+      unsigned level)
 {
    unsigned h;
    bool ret = true;
    struct png_ihdr ihdr = {0};
 
    const struct trans_stream_backend *stream_backend = NULL;
-   size_t encode_buf_size  = 0;
-   uint8_t *encode_buf     = NULL;
-   uint8_t *deflate_buf    = NULL;
+   uint32_t chunk_used     = 0;
+   uint8_t *chunk          = NULL;
    uint8_t *rgba_line      = NULL;
    uint8_t *up_filtered    = NULL;
    uint8_t *sub_filtered   = NULL;
    uint8_t *avg_filtered   = NULL;
    uint8_t *paeth_filtered = NULL;
    uint8_t *prev_encoded   = NULL;
-   uint8_t *encode_target  = NULL;
    void *stream            = NULL;
-   uint32_t total_in       = 0;
-   uint32_t total_out      = 0;
    RFILE *file             = filestream_open(path,
          RETRO_VFS_FILE_ACCESS_WRITE,
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
@@ -248,119 +300,113 @@ static bool rpng_save_image(const char *path,
    if (!png_write_ihdr(file, &ihdr))
       GOTO_END_ERROR();
 
-   encode_buf_size = (width * bpp + 1) * height;
-   encode_buf = (uint8_t*)malloc(encode_buf_size);
-   if (!encode_buf)
+   chunk = (uint8_t*)malloc(RPNG_SAVE_IDAT_SIZE + 8);
+   if (!chunk)
       GOTO_END_ERROR();
 
    prev_encoded = (uint8_t*)calloc(1, width * bpp);
    if (!prev_encoded)
       GOTO_END_ERROR();
 
-   rgba_line      = (uint8_t*)malloc(width * bpp);
-   up_filtered    = (uint8_t*)malloc(width * bpp);
-   sub_filtered   = (uint8_t*)malloc(width * bpp);
-   avg_filtered   = (uint8_t*)malloc(width * bpp);
-   paeth_filtered = (uint8_t*)malloc(width * bpp);
+   /* One spare byte in front of each line for the filter type */
+   rgba_line      = (uint8_t*)malloc(width * bpp + 1);
+   up_filtered    = (uint8_t*)malloc(width * bpp + 1);
+   sub_filtered   = (uint8_t*)malloc(width * bpp + 1);
+   avg_filtered   = (uint8_t*)malloc(width * bpp + 1);
+   paeth_filtered = (uint8_t*)malloc(width * bpp + 1);
    if (!rgba_line || !up_filtered || !sub_filtered || !avg_filtered || !paeth_filtered)
       GOTO_END_ERROR();
 
-   encode_target = encode_buf;
-   for (h = 0; h < height;
-         h++, encode_target += width * bpp, data += pitch)
+   stream = stream_backend->stream_new();
+
+   if (!stream)
+      GOTO_END_ERROR();
+
+   if (level > 9)
+      level = 9;
+   stream_backend->define(stream, "level", level);
+
+   for (h = 0; h < height; h++, data += pitch)
    {
+      uint8_t *line = rgba_line + 1;
+
       if (bpp == sizeof(uint32_t))
-         copy_argb_line(rgba_line, (const uint32_t*)data, width);
+         copy_argb_line(line, (const uint32_t*)data, width);
       else
-         copy_bgr24_line(rgba_line, data, width);
+         copy_bgr24_line(line, data, width);
 
       /* Try every filtering method, and choose the method
        * which has most entries as zero.
        *
        * This is probably not very optimal, but it's very
        * simple to implement.
+       *
+       * Stored (level 0) images aren't filtered at all, and
+       * fast levels skip avg and paeth, which are the slowest
+       * to compute and rarely win on flat emulator graphics.
        */
       {
-         unsigned none_score  = count_sad(rgba_line, width * bpp);
-         unsigned up_score    = filter_up(up_filtered, rgba_line, prev_encoded, width, bpp);
-         unsigned sub_score   = filter_sub(sub_filtered, rgba_line, width, bpp);
-         unsigned avg_score   = filter_avg(avg_filtered, rgba_line, prev_encoded, width, bpp);
-         unsigned paeth_score = filter_paeth(paeth_filtered, rgba_line, prev_encoded, width, bpp);
-
          uint8_t filter       = 0;
-         unsigned min_sad     = none_score;
-         const uint8_t *chosen_filtered = rgba_line;
+         uint8_t *chosen      = rgba_line;
 
-         if (sub_score < min_sad)
+         if (level > 0)
          {
-            filter = 1;
-            chosen_filtered = sub_filtered;
-            min_sad = sub_score;
+            unsigned min_sad     = count_sad(line, width * bpp);
+            unsigned sub_score   = filter_sub(sub_filtered + 1, line, width, bpp);
+            unsigned up_score    = filter_up(up_filtered + 1, line, prev_encoded, width, bpp);
+
+            if (sub_score < min_sad)
+            {
+               filter = 1;
+               chosen = sub_filtered;
+               min_sad = sub_score;
+            }
+
+            if (up_score < min_sad)
+            {
+               filter = 2;
+               chosen = up_filtered;
+               min_sad = up_score;
+            }
+
+            if (level > 3)
+            {
+               unsigned avg_score   = filter_avg(avg_filtered + 1, line, prev_encoded, width, bpp);
+               unsigned paeth_score = filter_paeth(paeth_filtered + 1, line, prev_encoded, width, bpp);
+
+               if (avg_score < min_sad)
+               {
+                  filter = 3;
+                  chosen = avg_filtered;
+                  min_sad = avg_score;
+               }
+
+               if (paeth_score < min_sad)
+               {
+                  filter = 4;
+                  chosen = paeth_filtered;
+               }
+            }
          }
 
-         if (up_score < min_sad)
-         {
-            filter = 2;
-            chosen_filtered = up_filtered;
-            min_sad = up_score;
-         }
-
-         if (avg_score < min_sad)
-         {
-            filter = 3;
-            chosen_filtered = avg_filtered;
-            min_sad = avg_score;
-         }
+         chosen[0] = filter;
 
-         if (paeth_score < min_sad)
-         {
-            filter = 4;
-            chosen_filtered = paeth_filtered;
-         }
+         if (!png_deflate_line(file, stream_backend, stream,
+                  chunk, &chunk_used, chosen, width * bpp + 1,
+                  h == height - 1))
+            GOTO_END_ERROR();
 
-         *encode_target++ = filter;
-         memcpy(encode_target, chosen_filtered, width * bpp);
-
-         memcpy(prev_encoded, rgba_line, width * bpp);
+         memcpy(prev_encoded, line, width * bpp);
       }
    }
 
-   deflate_buf = (uint8_t*)malloc(encode_buf_size * 2); /* Just to be sure. */
-   if (!deflate_buf)
-      GOTO_END_ERROR();
-
-   stream = stream_backend->stream_new();
-
-   if (!stream)
-      GOTO_END_ERROR();
-
-   stream_backend->set_in(
-         stream,
-         encode_buf,
-         (unsigned)encode_buf_size);
-   stream_backend->set_out(
-         stream,
-         deflate_buf + 8,
-         (unsigned)(encode_buf_size * 2));
-
-   if (!stream_backend->trans(stream, true, &total_in, &total_out, NULL))
-   {
-      GOTO_END_ERROR();
-   }
-
-   memcpy(deflate_buf + 4, "IDAT", 4);
-   dword_write_be(deflate_buf + 0,        ((uint32_t)total_out));
-   if (!png_write_idat(file, deflate_buf, ((size_t)total_out + 8)))
-      GOTO_END_ERROR();
-
    if (!png_write_iend(file))
       GOTO_END_ERROR();
 
 end:
    if (file)
       filestream_close(file);
-   free(encode_buf);
-   free(deflate_buf);
+   free(chunk);
    free(rgba_line);
    free(prev_encoded);
    free(up_filtered);
@@ -383,12 +429,26 @@ bool rpng_save_image_argb(const char *path, const uint32_t *data,
       unsigned width, unsigned height, unsigned pitch)
 {
    return rpng_save_image(path, (const uint8_t*)data,
-         width, height, pitch, sizeof(uint32_t));
+         width, height, pitch, sizeof(uint32_t), 9);
 }
 
 bool rpng_save_image_bgr24(const char *path, const uint8_t *data,
       unsigned width, unsigned height, unsigned pitch)
 {
    return rpng_save_image(path, (const uint8_t*)data,
-         width, height, pitch, 3);
+         width, height, pitch, 3, 9);
+}
+
+bool rpng_save_image_argb_level(const char *path, const uint32_t *data,
+      unsigned width, unsigned height, unsigned pitch, unsigned level)
+{
+   return rpng_save_image(path, (const uint8_t*)data,
+         width, height, pitch, sizeof(uint32_t), level);
+}
+
+bool rpng_save_image_bgr24_level(const char *path, const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch, unsigned level)
+{
+   return rpng_save_image(path, (const uint8_t*)data,
+         width, height, pitch, 3, level);
 }
@@ -56,7 +56,11 @@ struct config_file
    char *path;
    struct config_entry_list *entries;
    struct config_entry_list *tail;
-   struct config_entry_list *last;
+   /* Open-addressed hash of the entries by key, holding the
+    * first entry of each key. Built on the first lookup. */
+   struct config_entry_list **index;
+   size_t index_cap;
+   size_t index_count;
    unsigned include_depth;
    bool guaranteed_no_duplicates;
 
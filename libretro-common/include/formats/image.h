@@ -80,6 +80,11 @@ void image_transfer_set_buffer_ptr(
       enum image_type_enum type,
       void *ptr);
 
+void image_transfer_set_threaded(
+      void *data,
+      enum image_type_enum type,
+      bool threaded);
+
 int image_transfer_process(
       void *data,
       enum image_type_enum type,
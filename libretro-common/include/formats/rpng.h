@@ -51,11 +51,24 @@ int rpng_process_image(rpng_t *rpng,
 
 bool rpng_start(rpng_t *rpng);
 
+/* Inflate large images on a worker thread while rpng_process_image
+ * unfilters the lines already inflated. Only has an effect with
+ * HAVE_THREADS, and has to be set before processing starts. */
+void rpng_set_threaded(rpng_t *rpng, bool threaded);
+
 bool rpng_save_image_argb(const char *path, const uint32_t *data,
       unsigned width, unsigned height, unsigned pitch);
 bool rpng_save_image_bgr24(const char *path, const uint8_t *data,
       unsigned width, unsigned height, unsigned pitch);
 
+/* Same as above with a zlib compression level, from 0 (stored)
+ * to 9 (smallest, what the functions above use). Levels 3 and
+ * below also try fewer line filters, trading size for speed. */
+bool rpng_save_image_argb_level(const char *path, const uint32_t *data,
+      unsigned width, unsigned height, unsigned pitch, unsigned level);
+bool rpng_save_image_bgr24_level(const char *path, const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch, unsigned level);
+
 RETRO_END_DECLS
 
 #endif
@@ -63,6 +63,49 @@ bool dir_list_append(struct string_list *list, const char *dir, const char *ext,
 struct string_list *dir_list_new(const char *dir, const char *ext,
       bool include_dirs, bool include_hidden, bool include_compressed, bool recursive);
 
+struct dir_list_stream;
+
+/**
+ * dir_list_stream_new:
+ * @dir                : directory path.
+ * @ext                : allowed extensions of file directory entries to include.
+ * @include_dirs       : include directories as part of the finished directory listing?
+ * @include_hidden     : include hidden files and directories as part of the finished directory listing?
+ * @include_compressed : include compressed files, even when not part of ext.
+ *
+ * Opens a directory to be listed a few entries at a time
+ * with dir_list_stream_read().
+ *
+ * Returns: the stream, or NULL in case of error. Has to be
+ * freed with dir_list_stream_free().
+ **/
+struct dir_list_stream *dir_list_stream_new(const char *dir,
+      const char *ext, bool include_dirs,
+      bool include_hidden, bool include_compressed);
+
+/**
+ * dir_list_stream_read:
+ * @stream             : directory stream.
+ * @list               : the string list to add files to.
+ * @max                : maximum number of files to add.
+ *
+ * Adds up to @max more files of the directory to @list,
+ * in the order the file system returns them.
+ *
+ * Returns: -1 on error, 0 once the whole directory has
+ * been read, 1 if there are more files to read.
+ **/
+int dir_list_stream_read(struct dir_list_stream *stream,
+      struct string_list *list, size_t max);
+
+/**
+ * dir_list_stream_free:
+ * @stream : directory stream.
+ *
+ * Closes a directory stream.
+ **/
+void dir_list_stream_free(struct dir_list_stream *stream);
+
 /**
  * dir_list_sort:
  * @list      : pointer to the directory listing.
@@ -73,6 +116,22 @@ struct string_list *dir_list_new(const char *dir, const char *ext,
  **/
 void dir_list_sort(struct string_list *list, bool dir_first);
 
+/**
+ * dir_list_merge:
+ * @list      : pointer to the sorted directory listing.
+ * @sorted    : sorted listing of more files.
+ * @dir_first : are the directories in the listings at the top?
+ *
+ * Merges @sorted into @list, keeping it sorted the way
+ * dir_list_sort() would. The files are moved rather than
+ * copied, leaving @sorted empty.
+ *
+ * Returns: false if out of memory, leaving both
+ * listings as they were.
+ **/
+bool dir_list_merge(struct string_list *list,
+      struct string_list *sorted, bool dir_first);
+
 /**
  * dir_list_free:
  * @list : pointer to the directory listing
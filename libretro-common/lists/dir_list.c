@@ -74,6 +74,61 @@ void dir_list_sort(struct string_list *list, bool dir_first)
             dir_first ? qstrcmp_dir : qstrcmp_plain);
 }
 
+/**
+ * dir_list_merge:
+ * @list      : pointer to the sorted directory listing.
+ * @sorted    : sorted listing of more files.
+ * @dir_first : are the directories in the listings at the top?
+ *
+ * Merges @sorted into @list, keeping it sorted the way
+ * dir_list_sort() would. The files are moved rather than
+ * copied, leaving @sorted empty.
+ *
+ * Returns: false if out of memory, leaving both
+ * listings as they were.
+ **/
+bool dir_list_merge(struct string_list *list,
+      struct string_list *sorted, bool dir_first)
+{
+   size_t i = 0;
+   size_t j = 0;
+   size_t k = 0;
+   size_t size                     = list->size + sorted->size;
+   struct string_list_elem *elems  = NULL;
+   int (*cmp)(const void*, const void*) = dir_first
+      ? qstrcmp_dir : qstrcmp_plain;
+
+   if (sorted->size == 0)
+      return true;
+
+   elems = (struct string_list_elem*)malloc(size * sizeof(*elems));
+
+   if (!elems)
+      return false;
+
+   while (i < list->size && j < sorted->size)
+   {
+      if (cmp(&list->elems[i], &sorted->elems[j]) <= 0)
+         elems[k++] = list->elems[i++];
+      else
+         elems[k++] = sorted->elems[j++];
+   }
+
+   while (i < list->size)
+      elems[k++] = list->elems[i++];
+   while (j < sorted->size)
+      elems[k++] = sorted->elems[j++];
+
+   free(list->elems);
+
+   list->elems  = elems;
+   list->size   = size;
+   list->cap    = size;
+   sorted->size = 0;
+
+   return true;
+}
+
 /**
  * dir_list_free:
  * @list : pointer to the directory listing
@@ -263,6 +318,136 @@ bool dir_list_append(struct string_list *list,
    return true;
 }
 
+struct dir_list_stream
+{
+   struct RDIR *entry;
+   struct string_list *ext_list;
+   char *dir;
+   bool include_dirs;
+   bool include_hidden;
+   bool include_compressed;
+};
+
+/**
+ * dir_list_stream_new:
+ * @dir                : directory path.
+ * @ext                : allowed extensions of file directory entries to include.
+ * @include_dirs       : include directories as part of the finished directory listing?
+ * @include_hidden     : include hidden files and directories as part of the finished directory listing?
+ * @include_compressed : include compressed files, even when not part of ext.
+ *
+ * Opens a directory to be listed a few entries at a time
+ * with dir_list_stream_read().
+ *
+ * Returns: the stream, or NULL in case of error. Has to be
+ * freed with dir_list_stream_free().
+ **/
+struct dir_list_stream *dir_list_stream_new(const char *dir,
+      const char *ext, bool include_dirs,
+      bool include_hidden, bool include_compressed)
+{
+   struct dir_list_stream *stream = (struct dir_list_stream*)
+      calloc(1, sizeof(*stream));
+
+   if (!stream)
+      return NULL;
+
+   stream->dir                = strdup(dir);
+   stream->include_dirs       = include_dirs;
+   stream->include_hidden     = include_hidden;
+   stream->include_compressed = include_compressed;
+
+   if (ext)
+      stream->ext_list        = string_split(ext, "|");
+
+   if (!stream->dir)
+      goto error;
+
+   stream->entry = retro_opendir_include_hidden(dir, include_hidden);
+
+   if (!stream->entry || retro_dirent_error(stream->entry))
+      goto error;
+
+   return stream;
+
+error:
+   dir_list_stream_free(stream);
+   return NULL;
+}
+
+/**
+ * dir_list_stream_read:
+ * @stream             : directory stream.
+ * @list               : the string list to add files to.
+ * @max                : maximum number of files to add.
+ *
+ * Adds up to @max more files of the directory to @list,
+ * in the order the file system returns them.
+ *
+ * Returns: -1 on error, 0 once the whole directory has
+ * been read, 1 if there are more files to read.
+ **/
+int dir_list_stream_read(struct dir_list_stream *stream,
+      struct string_list *list, size_t max)
+{
+   size_t count = 0;
+
+   while (count < max)
+   {
+      char file_path[PATH_MAX_LENGTH];
+      bool is_dir                     = false;
+      int ret                         = 0;
+      const char *name                = NULL;
+      const char *file_ext            = "";
+
+      if (!retro_readdir(stream->entry))
+         return 0;
+
+      name = retro_dirent_get_name(stream->entry);
+
+      if (!stream->include_hidden && *name == '.')
+         continue;
+
+      file_path[0] = '\0';
+
+      fill_pathname_join(file_path, stream->dir, name, sizeof(file_path));
+      is_dir = retro_dirent_is_dir(stream->entry, NULL);
+
+      if (!is_dir)
+         file_ext = path_get_extension(name);
+
+      ret    = parse_dir_entry(name, file_path, is_dir,
+            stream->include_dirs, stream->include_compressed,
+            list, stream->ext_list, file_ext);
+
+      if (ret == -1)
+         return -1;
+
+      if (ret == 0)
+         count++;
+   }
+
+   return 1;
+}
+
+/**
+ * dir_list_stream_free:
+ * @stream : directory stream.
+ *
+ * Closes a directory stream.
+ **/
+void dir_list_stream_free(struct dir_list_stream *stream)
+{
+   if (!stream)
+      return;
+
+   if (stream->entry)
+      retro_closedir(stream->entry);
+   string_list_free(stream->ext_list);
+   free(stream->dir);
+   free(stream);
+}
+
 /**
  * dir_list_new:
  * @dir                : directory path.
@@ -147,6 +147,19 @@ void msg_queue_push(msg_queue_t *queue, const char *msg,
    }
 }
 
+/**
+ * msg_queue_size:
+ * @queue             : pointer to queue object
+ *
+ * Returns: number of messages in the queue.
+ **/
+size_t msg_queue_size(msg_queue_t *queue)
+{
+   if (!queue)
+      return 0;
+   return queue->ptr - 1;
+}
+
 /**
  * msg_queue_clear:
  * @queue             : pointer to queue object
@@ -0,0 +1,167 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rpng_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <features/features_cpu.h>
+#include <streams/file_stream.h>
+#include <formats/rpng.h>
+#include <formats/image.h>
+
+/*
+ * Decodes a set of PNGs (e.g. a folder of boxart thumbnails) a number
+ * of times and reports decoding speed.
+ *
+ * Usage: rpng_bench [-t] [-n runs] <png files>
+ *   -t  inflate on a worker thread (see rpng_set_threaded)
+ */
+
+struct bench_file
+{
+   const char *path;
+   void *buf;
+   int64_t len;
+};
+
+static bool decode_png(struct bench_file *file, bool threaded,
+      uint64_t *out_size)
+{
+   int retval;
+   uint32_t *data  = NULL;
+   unsigned width  = 0;
+   unsigned height = 0;
+   bool ret        = false;
+   rpng_t *rpng    = rpng_alloc();
+
+   if (!rpng)
+      return false;
+
+   rpng_set_buf_ptr(rpng, file->buf);
+   rpng_set_threaded(rpng, threaded);
+
+   if (!rpng_start(rpng))
+      goto end;
+
+   while (rpng_iterate_image(rpng));
+
+   if (!rpng_is_valid(rpng))
+      goto end;
+
+   do
+   {
+      retval = rpng_process_image(rpng,
+            (void**)&data, (size_t)file->len, &width, &height);
+   } while (retval == IMAGE_PROCESS_NEXT);
+
+   if (retval == IMAGE_PROCESS_ERROR || retval == IMAGE_PROCESS_ERROR_END)
+      goto end;
+
+   *out_size += (uint64_t)width * height * sizeof(uint32_t);
+   ret        = true;
+
+end:
+   rpng_free(rpng);
+   free(data);
+   return ret;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned run;
+   retro_time_t start, elapsed;
+   struct bench_file *files = NULL;
+   unsigned num_files       = 0;
+   unsigned runs            = 5;
+   bool threaded            = false;
+   uint64_t in_size         = 0;
+   uint64_t out_size        = 0;
+
+   for (i = 1; i < argc && argv[i][0] == '-'; i++)
+   {
+      if (!strcmp(argv[i], "-t"))
+         threaded = true;
+      else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         runs = (unsigned)strtoul(argv[++i], NULL, 10);
+   }
+
+   if (i >= argc || !runs)
+   {
+      fprintf(stderr, "Usage: %s [-t] [-n runs] <png files>\n", argv[0]);
+      return 1;
+   }
+
+   files = (struct bench_file*)calloc(argc - i, sizeof(*files));
+   if (!files)
+      return 1;
+
+   /* Read everything up front so only decoding is measured. */
+   for (; i < argc; i++)
+   {
+      struct bench_file *file = &files[num_files];
+
+      file->path = argv[i];
+      if (!filestream_read_file(file->path, &file->buf, &file->len))
+      {
+         fprintf(stderr, "Could not read %s.\n", file->path);
+         continue;
+      }
+      num_files++;
+   }
+
+   start = cpu_features_get_time_usec();
+
+   for (run = 0; run < runs; run++)
+   {
+      unsigned j;
+
+      for (j = 0; j < num_files; j++)
+      {
+         if (!decode_png(&files[j], threaded, &out_size))
+         {
+            if (!run)
+               fprintf(stderr, "Could not decode %s.\n", files[j].path);
+            continue;
+         }
+         in_size += (uint64_t)files[j].len;
+      }
+   }
+
+   elapsed = cpu_features_get_time_usec() - start;
+   if (elapsed <= 0)
+      elapsed = 1;
+
+   fprintf(stderr, "%u files, %u runs%s: %.1f ms per run\n",
+         num_files, runs, threaded ? ", threaded" : "",
+         elapsed / 1000.0 / runs);
+   fprintf(stderr, "  in : %.1f MB/s\n", (double)in_size / elapsed);
+   fprintf(stderr, "  out: %.1f MB/s\n", (double)out_size / elapsed);
+
+   for (run = 0; run < num_files; run++)
+      free(files[run].buf);
+   free(files);
+
+   return 0;
+}
@@ -48,7 +48,7 @@
 
 struct node_iter_ctx
 {
-	libretrodb_t *db;
+	RFILE *fd;
 	libretrodb_index_t *idx;
 };
 
@@ -79,6 +79,18 @@ typedef struct libretrodb_header
 	uint64_t metadata_offset;
 } libretrodb_header_t;
 
+#define LIBRETRODB_MAX_PREDICATES        16
+#define LIBRETRODB_MAX_PREDICATE_VALUES  8
+#define LIBRETRODB_CURSOR_BUFF_SIZE      (64 * 1024)
+
+/* An equality test on one field, evaluated on the encoded record */
+struct libretrodb_predicate
+{
+   const struct rmsgpack_dom_value *field;
+   const struct rmsgpack_dom_value *values[LIBRETRODB_MAX_PREDICATE_VALUES];
+   unsigned num_values;
+};
+
 struct libretrodb_cursor
 {
 	int is_valid;
@@ -86,6 +98,27 @@ struct libretrodb_cursor
 	int eof;
 	libretrodb_query_t *query;
 	libretrodb_t *db;
+
+   /* Window of the record stream that sequential scans decode from */
+   uint8_t *buff;
+   size_t buff_cap;
+   size_t buff_len;
+   size_t buff_pos;
+   uint64_t buff_offset;
+   uint64_t item_offset;
+
+   /* Record offsets resolved through an index, if the query allowed it */
+   uint64_t *index_offsets;
+   unsigned index_count;
+   unsigned index_ptr;
+   int use_index;
+
+   struct libretrodb_predicate predicates[LIBRETRODB_MAX_PREDICATES];
+   unsigned num_predicates;
+
+   /* Projection, all fields are returned if NULL */
+   struct rmsgpack_dom_value *fields;
+   unsigned num_fields;
 };
 
 static struct rmsgpack_dom_value sentinal;
@@ -173,8 +206,7 @@ int libretrodb_create(RFILE *fd, libretrodb_value_provider value_provider,
    if ((rv = rmsgpack_dom_write(fd, &sentinal)) < 0)
       goto clean;
 
-   header.metadata_offset = swap_if_little64(filestream_seek(
-            fd, 0, RETRO_VFS_SEEK_POSITION_CURRENT));
+   header.metadata_offset = swap_if_little64(filestream_tell(fd));
    md.count = item_count;
    libretrodb_write_metadata(fd, &md);
    filestream_seek(fd, root, RETRO_VFS_SEEK_POSITION_START);
@@ -238,7 +270,7 @@ int libretrodb_open(const char *path, libretrodb_t *db)
       goto error;
    }
 
-   if (strncmp(header.magic_number, MAGIC_NUMBER, sizeof(MAGIC_NUMBER)) != 0)
+   if (memcmp(header.magic_number, MAGIC_NUMBER, sizeof(MAGIC_NUMBER)-1) != 0)
    {
       rv = -EINVAL;
       goto error;
@@ -265,52 +297,83 @@ error:
    return rv;
 }
 
-static int libretrodb_find_index(libretrodb_t *db, const char *index_name,
-      libretrodb_index_t *idx)
+static int libretrodb_find_index(libretrodb_t *db, RFILE *fd,
+      const char *index_name, libretrodb_index_t *idx)
 {
-   ssize_t eof    = filestream_get_size(db->fd);
-   ssize_t offset = filestream_seek(db->fd,
+   ssize_t eof    = filestream_get_size(fd);
+   ssize_t offset = filestream_seek(fd,
          (ssize_t)db->first_index_offset,
          RETRO_VFS_SEEK_POSITION_START);
 
    /* TODO: this should use filestream_eof instead */
    while (offset < eof)
    {
-      libretrodb_read_index_header(db->fd, idx);
+      if (libretrodb_read_index_header(fd, idx) < 0)
+         break;
 
-      if (strncmp(index_name, idx->name, strlen(idx->name)) == 0)
+      if (string_is_equal(index_name, idx->name))
          return 0;
 
-      filestream_seek(db->fd, (ssize_t)idx->next,
+      filestream_seek(fd, (ssize_t)idx->next,
             RETRO_VFS_SEEK_POSITION_CURRENT);
-      offset = filestream_tell(db->fd);
+      offset = filestream_tell(fd);
    }
 
    return -1;
 }
 
-static int binsearch(const void *buff, const void *item,
-      uint64_t count, uint8_t field_size, uint64_t *offset)
+/* Reads the sorted (key, offset) table of the index found
+ * by libretrodb_find_index, which left @fd positioned at it. */
+static uint8_t *libretrodb_read_index(RFILE *fd, libretrodb_index_t *idx)
 {
-   int mid            = (int)(count / 2);
-   int item_size      = field_size + sizeof(uint64_t);
-   uint64_t *current  = (uint64_t *)buff + (mid * item_size);
-   int rv             = memcmp(current, item, field_size);
+   ssize_t nread   = 0;
+   ssize_t bufflen = (ssize_t)idx->next;
+   uint8_t *buff   = (uint8_t*)malloc(bufflen > 0 ? bufflen : 1);
 
-   if (rv == 0)
+   if (!buff)
+      return NULL;
+
+   while (nread < bufflen)
    {
-      *offset = *(uint64_t *)(current + field_size);
-      return 0;
+      int64_t rv = filestream_read(fd, buff + nread, bufflen - nread);
+
+      if (rv <= 0)
+      {
+         free(buff);
+         return NULL;
+      }
+      nread += (ssize_t)rv;
    }
 
-   if (count == 0)
-      return -1;
+   return buff;
+}
 
-   if (rv > 0)
-      return binsearch(buff, item, mid, field_size, offset);
+static int binsearch(const uint8_t *buff, const void *item,
+      uint64_t count, size_t field_size, uint64_t *offset)
+{
+   uint64_t lo        = 0;
+   uint64_t hi        = count;
+   size_t item_size   = field_size + sizeof(uint64_t);
+
+   while (lo < hi)
+   {
+      uint64_t mid           = lo + (hi - lo) / 2;
+      const uint8_t *current = buff + mid * item_size;
+      int rv                 = memcmp(current, item, field_size);
+
+      if (rv == 0)
+      {
+         memcpy(offset, current + field_size, sizeof(uint64_t));
+         return 0;
+      }
 
-   return binsearch(current + item_size, item,
-         count - mid, field_size, offset);
+      if (rv < 0)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   return -1;
 }
 
 int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
@@ -318,38 +381,25 @@ int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
 {
    libretrodb_index_t idx;
    int rv;
-   void *buff;
+   uint8_t *buff;
    uint64_t offset;
-   ssize_t bufflen, nread = 0;
 
-   if (libretrodb_find_index(db, index_name, &idx) < 0)
+   if (libretrodb_find_index(db, db->fd, index_name, &idx) < 0)
       return -1;
 
-   bufflen = idx.next;
-   buff = malloc(bufflen);
-
-   if (!buff)
+   if (!(buff = libretrodb_read_index(db->fd, &idx)))
       return -ENOMEM;
 
-   while (nread < bufflen)
-   {
-      void *buff_ = (uint64_t *)buff + nread;
-      rv = (int)filestream_read(db->fd, buff_, bufflen - nread);
-
-      if (rv <= 0)
-      {
-         free(buff);
-         return -errno;
-      }
-      nread += rv;
-   }
-
-   rv = binsearch(buff, key, db->count, (ssize_t)idx.key_size, &offset);
+   rv = binsearch(buff, key,
+         idx.next / (idx.key_size + sizeof(uint64_t)),
+         (size_t)idx.key_size, &offset);
    free(buff);
 
-   if (rv == 0)
-      filestream_seek(db->fd, (ssize_t)offset,
-            RETRO_VFS_SEEK_POSITION_START);
+   if (rv != 0)
+      return -1;
+
+   filestream_seek(db->fd, (ssize_t)offset,
+         RETRO_VFS_SEEK_POSITION_START);
 
    return rmsgpack_dom_read(db->fd, out);
 }
@@ -364,12 +414,274 @@ int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
  **/
 int libretrodb_cursor_reset(libretrodb_cursor_t *cursor)
 {
-   cursor->eof = 0;
+   cursor->eof         = 0;
+   cursor->buff_len    = 0;
+   cursor->buff_pos    = 0;
+   cursor->index_ptr   = 0;
+   cursor->buff_offset = cursor->db->root + sizeof(libretrodb_header_t);
    return (int)filestream_seek(cursor->fd,
          (ssize_t)(cursor->db->root + sizeof(libretrodb_header_t)),
          RETRO_VFS_SEEK_POSITION_START);
 }
 
+static int libretrodb_key_equals(const struct rmsgpack_dom_value *key,
+      const struct rmsgpack_dom_value *name)
+{
+   return key->type == RDT_STRING
+      && key->val.string.len == name->val.string.len
+      && memcmp(key->val.string.buff, name->val.string.buff,
+            key->val.string.len) == 0;
+}
+
+static int libretrodb_value_equals(const struct rmsgpack_dom_value *value,
+      const struct rmsgpack_dom_value *literal)
+{
+   /* Same coercion as the query 'equals' function */
+   if (value->type == RDT_UINT && literal->type == RDT_INT)
+      return value->val.uint_ == (uint64_t)literal->val.int_;
+   if (value->type == RDT_MAP || value->type == RDT_ARRAY)
+      return 0;
+   return rmsgpack_dom_value_cmp(value, literal) == 0;
+}
+
+/* Moves the unread part of the window to the front and reads
+ * more of the record stream behind it. */
+static int libretrodb_cursor_fill(libretrodb_cursor_t *cursor)
+{
+   int64_t nread;
+
+   if (cursor->buff_pos > 0)
+   {
+      memmove(cursor->buff, cursor->buff + cursor->buff_pos,
+            cursor->buff_len - cursor->buff_pos);
+      cursor->buff_len    -= cursor->buff_pos;
+      cursor->buff_offset += cursor->buff_pos;
+      cursor->buff_pos     = 0;
+   }
+
+   if (cursor->buff_len == cursor->buff_cap)
+   {
+      size_t new_cap    = cursor->buff_cap ?
+         cursor->buff_cap * 2 : LIBRETRODB_CURSOR_BUFF_SIZE;
+      uint8_t *new_buff = (uint8_t*)realloc(cursor->buff, new_cap);
+
+      if (!new_buff)
+         return -ENOMEM;
+
+      cursor->buff     = new_buff;
+      cursor->buff_cap = new_cap;
+   }
+
+   nread = filestream_read(cursor->fd, cursor->buff + cursor->buff_len,
+         cursor->buff_cap - cursor->buff_len);
+
+   if (nread <= 0)
+      return -EINVAL;
+
+   cursor->buff_len += (size_t)nread;
+   return 0;
+}
+
+/* Evaluates the equality predicates on the encoded record, so that
+ * records which cannot match are never decoded. */
+static int libretrodb_cursor_match_raw(libretrodb_cursor_t *cursor,
+      const uint8_t *rec, size_t size)
+{
+   struct rmsgpack_dom_value tok;
+   unsigned i, j;
+   uint32_t found = 0;
+   size_t pos     = 0;
+
+   if (cursor->num_predicates == 0)
+      return 1;
+
+   if (rmsgpack_dom_read_token(rec, size, &pos, &tok) < 0
+         || tok.type != RDT_MAP)
+      return 1;
+
+   for (i = tok.val.map.len; i > 0; i--)
+   {
+      struct rmsgpack_dom_value key;
+      struct libretrodb_predicate *pred = NULL;
+
+      if (rmsgpack_dom_read_token(rec, size, &pos, &key) < 0)
+         return 1;
+
+      for (j = 0; j < cursor->num_predicates; j++)
+      {
+         if (libretrodb_key_equals(&key, cursor->predicates[j].field))
+         {
+            pred = &cursor->predicates[j];
+            break;
+         }
+      }
+
+      if (pred)
+      {
+         struct rmsgpack_dom_value value;
+         size_t value_pos = pos;
+         unsigned k;
+
+         if (rmsgpack_dom_read_token(rec, size, &value_pos, &value) < 0)
+            return 1;
+
+         for (k = 0; k < pred->num_values; k++)
+            if (libretrodb_value_equals(&value, pred->values[k]))
+               break;
+
+         if (k == pred->num_values)
+            return 0;
+
+         found |= 1 << j;
+      }
+
+      if (rmsgpack_dom_skip_buf(rec, size, &pos) < 0)
+         return 1;
+   }
+
+   /* A missing field compares as nil, which no predicate accepts */
+   return found == ((UINT32_C(1) << cursor->num_predicates) - 1);
+}
+
+static int libretrodb_cursor_wants_field(libretrodb_cursor_t *cursor,
+      const struct rmsgpack_dom_value *key)
+{
+   unsigned i;
+   int n = libretrodb_query_num_predicates(cursor->query);
+
+   for (i = 0; i < cursor->num_fields; i++)
+      if (libretrodb_key_equals(key, &cursor->fields[i]))
+         return 1;
+
+   for (i = 0; (int)i < n; i++)
+      if (libretrodb_key_equals(key,
+               libretrodb_query_predicate_field(cursor->query, i)))
+         return 1;
+
+   return 0;
+}
+
+/* Decodes a record, skipping fields that neither the projection
+ * nor the query need. */
+static int libretrodb_cursor_decode(libretrodb_cursor_t *cursor,
+      const uint8_t *rec, size_t size, struct rmsgpack_dom_value *out)
+{
+   struct rmsgpack_dom_value tok;
+   uint32_t i;
+   int rv;
+   size_t pos = 0;
+
+   if (!cursor->fields
+         || (cursor->query
+            && libretrodb_query_num_predicates(cursor->query) < 0))
+      return rmsgpack_dom_read_buf(rec, size, &pos, out);
+
+   if ((rv = rmsgpack_dom_read_token(rec, size, &pos, &tok)) < 0)
+      return rv;
+
+   if (tok.type != RDT_MAP)
+   {
+      pos = 0;
+      return rmsgpack_dom_read_buf(rec, size, &pos, out);
+   }
+
+   out->type          = RDT_MAP;
+   out->val.map.len   = 0;
+   out->val.map.items = (struct rmsgpack_dom_pair*)calloc(
+         tok.val.map.len ? tok.val.map.len : 1,
+         sizeof(struct rmsgpack_dom_pair));
+
+   if (!out->val.map.items)
+   {
+      out->type = RDT_NULL;
+      return -ENOMEM;
+   }
+
+   for (i = 0; i < tok.val.map.len; i++)
+   {
+      struct rmsgpack_dom_value key;
+      size_t key_pos = pos;
+
+      if ((rv = rmsgpack_dom_read_token(rec, size, &pos, &key)) < 0)
+         return rv;
+
+      if (libretrodb_cursor_wants_field(cursor, &key))
+      {
+         struct rmsgpack_dom_pair *pair =
+            &out->val.map.items[out->val.map.len++];
+
+         pos = key_pos;
+         if ((rv = rmsgpack_dom_read_buf(rec, size, &pos, &pair->key)) < 0)
+            return rv;
+         if ((rv = rmsgpack_dom_read_buf(rec, size, &pos, &pair->value)) < 0)
+            return rv;
+      }
+      else if ((rv = rmsgpack_dom_skip_buf(rec, size, &pos)) < 0)
+         return rv;
+   }
+
+   return 0;
+}
+
+/* Drops the fields that were only decoded to evaluate the query */
+static void libretrodb_cursor_project(libretrodb_cursor_t *cursor,
+      struct rmsgpack_dom_value *item)
+{
+   uint32_t i, j;
+
+   if (!cursor->fields || item->type != RDT_MAP)
+      return;
+
+   for (i = 0, j = 0; i < item->val.map.len; i++)
+   {
+      struct rmsgpack_dom_pair *pair = &item->val.map.items[i];
+      unsigned k;
+
+      for (k = 0; k < cursor->num_fields; k++)
+         if (libretrodb_key_equals(&pair->key, &cursor->fields[k]))
+            break;
+
+      if (k == cursor->num_fields)
+      {
+         rmsgpack_dom_value_free(&pair->key);
+         rmsgpack_dom_value_free(&pair->value);
+         continue;
+      }
+
+      item->val.map.items[j++] = *pair;
+   }
+
+   item->val.map.len = j;
+}
+
+static int libretrodb_cursor_read_indexed(libretrodb_cursor_t *cursor,
+      struct rmsgpack_dom_value *out)
+{
+   int rv;
+
+   while (cursor->index_ptr < cursor->index_count)
+   {
+      cursor->item_offset = cursor->index_offsets[cursor->index_ptr++];
+      filestream_seek(cursor->fd, (ssize_t)cursor->item_offset,
+            RETRO_VFS_SEEK_POSITION_START);
+
+      if ((rv = rmsgpack_dom_read(cursor->fd, out)) < 0)
+         return rv;
+
+      if (cursor->query && !libretrodb_query_filter(cursor->query, out))
+      {
+         rmsgpack_dom_value_free(out);
+         continue;
+      }
+
+      libretrodb_cursor_project(cursor, out);
+      return 0;
+   }
+
+   cursor->eof = 1;
+   return EOF;
+}
+
 int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
       struct rmsgpack_dom_value *out)
 {
@@ -378,23 +690,108 @@ int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
    if (cursor->eof)
       return EOF;
 
-retry:
-   rv = rmsgpack_dom_read(cursor->fd, out);
-   if (rv < 0)
-      return rv;
+   if (cursor->use_index)
+      return libretrodb_cursor_read_indexed(cursor, out);
 
-   if (out->type == RDT_NULL)
+   for (;;)
    {
-      cursor->eof = 1;
-      return EOF;
+      struct rmsgpack_dom_value tok;
+      const uint8_t *rec;
+      size_t size;
+      size_t pos = cursor->buff_pos;
+
+      rv = rmsgpack_dom_skip_buf(cursor->buff, cursor->buff_len, &pos);
+
+      if (rv == -EAGAIN)
+      {
+         if ((rv = libretrodb_cursor_fill(cursor)) < 0)
+            return rv;
+         continue;
+      }
+
+      if (rv < 0)
+         return rv;
+
+      rec                 = cursor->buff + cursor->buff_pos;
+      size                = pos - cursor->buff_pos;
+      cursor->item_offset = cursor->buff_offset + cursor->buff_pos;
+      cursor->buff_pos    = pos;
+
+      pos = 0;
+      if (rmsgpack_dom_read_token(rec, size, &pos, &tok) == 0
+            && tok.type == RDT_NULL)
+      {
+         out->type   = RDT_NULL;
+         cursor->eof = 1;
+         return EOF;
+      }
+
+      if (!libretrodb_cursor_match_raw(cursor, rec, size))
+         continue;
+
+      if ((rv = libretrodb_cursor_decode(cursor, rec, size, out)) < 0)
+      {
+         rmsgpack_dom_value_free(out);
+         return rv;
+      }
+
+      if (cursor->query && !libretrodb_query_filter(cursor->query, out))
+      {
+         rmsgpack_dom_value_free(out);
+         continue;
+      }
+
+      libretrodb_cursor_project(cursor, out);
+      return 0;
    }
+}
 
-   if (cursor->query)
+/**
+ * libretrodb_cursor_set_fields:
+ * @cursor              : Handle to database cursor.
+ * @fields              : Names of the fields to return, NULL for all.
+ * @count               : Number of names in @fields.
+ *
+ * Restricts the records returned by libretrodb_cursor_read_item to
+ * the given fields. The others are skipped without being decoded.
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+int libretrodb_cursor_set_fields(libretrodb_cursor_t *cursor,
+      const char **fields, unsigned count)
+{
+   unsigned i;
+
+   if (cursor->fields)
+   {
+      for (i = 0; i < cursor->num_fields; i++)
+         rmsgpack_dom_value_free(&cursor->fields[i]);
+      free(cursor->fields);
+   }
+
+   cursor->fields     = NULL;
+   cursor->num_fields = 0;
+
+   if (!fields || count == 0)
+      return 0;
+
+   cursor->fields = (struct rmsgpack_dom_value*)
+      calloc(count, sizeof(*cursor->fields));
+
+   if (!cursor->fields)
+      return -ENOMEM;
+
+   for (i = 0; i < count; i++)
    {
-      if (!libretrodb_query_filter(cursor->query, out))
+      cursor->fields[i].type            = RDT_STRING;
+      cursor->fields[i].val.string.len  = (uint32_t)strlen(fields[i]);
+      cursor->fields[i].val.string.buff = strdup(fields[i]);
+      cursor->num_fields++;
+
+      if (!cursor->fields[i].val.string.buff)
       {
-         rmsgpack_dom_value_free(out);
-         goto retry;
+         cursor->fields[i].type = RDT_NULL;
+         return -ENOMEM;
       }
    }
 
@@ -418,11 +815,121 @@ void libretrodb_cursor_close(libretrodb_cursor_t *cursor)
    if (cursor->query)
       libretrodb_query_free(cursor->query);
 
-   cursor->is_valid = 0;
-   cursor->eof      = 1;
-   cursor->fd       = NULL;
-   cursor->db       = NULL;
-   cursor->query    = NULL;
+   if (cursor->buff)
+      free(cursor->buff);
+
+   if (cursor->index_offsets)
+      free(cursor->index_offsets);
+
+   libretrodb_cursor_set_fields(cursor, NULL, 0);
+
+   cursor->is_valid       = 0;
+   cursor->eof            = 1;
+   cursor->fd             = NULL;
+   cursor->db             = NULL;
+   cursor->query          = NULL;
+   cursor->buff           = NULL;
+   cursor->buff_cap       = 0;
+   cursor->buff_len       = 0;
+   cursor->buff_pos       = 0;
+   cursor->index_offsets  = NULL;
+   cursor->index_count    = 0;
+   cursor->use_index      = 0;
+   cursor->num_predicates = 0;
+}
+
+/* Resolves the records of an equality predicate on binary keys
+ * through an index named after the field, if the database has one. */
+static int libretrodb_cursor_plan_index(libretrodb_cursor_t *cursor,
+      const struct libretrodb_predicate *pred)
+{
+   libretrodb_index_t idx;
+   unsigned i;
+   uint8_t *buff = NULL;
+
+   for (i = 0; i < pred->num_values; i++)
+      if (     pred->values[i]->type != RDT_BINARY
+            || pred->values[i]->val.binary.len
+            != pred->values[0]->val.binary.len)
+         return -1;
+
+   if (libretrodb_find_index(cursor->db, cursor->fd,
+            pred->field->val.string.buff, &idx) < 0)
+      return -1;
+
+   if (idx.key_size != pred->values[0]->val.binary.len)
+      return -1;
+
+   if (!(buff = libretrodb_read_index(cursor->fd, &idx)))
+      return -1;
+
+   cursor->index_offsets = (uint64_t*)calloc(pred->num_values,
+         sizeof(uint64_t));
+
+   if (!cursor->index_offsets)
+   {
+      free(buff);
+      return -1;
+   }
+
+   for (i = 0; i < pred->num_values; i++)
+   {
+      uint64_t offset;
+      unsigned j;
+
+      if (binsearch(buff, pred->values[i]->val.binary.buff,
+               idx.next / (idx.key_size + sizeof(uint64_t)),
+               (size_t)idx.key_size, &offset) != 0)
+         continue;
+
+      for (j = 0; j < cursor->index_count; j++)
+         if (cursor->index_offsets[j] == offset)
+            break;
+
+      if (j == cursor->index_count)
+         cursor->index_offsets[cursor->index_count++] = offset;
+   }
+
+   free(buff);
+   cursor->use_index = 1;
+   return 0;
+}
+
+static void libretrodb_cursor_plan(libretrodb_cursor_t *cursor)
+{
+   unsigned i;
+   int n = libretrodb_query_num_predicates(cursor->query);
+
+   for (i = 0; (int)i < n; i++)
+   {
+      unsigned j;
+      struct libretrodb_predicate *pred =
+         &cursor->predicates[cursor->num_predicates];
+
+      if (cursor->num_predicates == LIBRETRODB_MAX_PREDICATES)
+         break;
+
+      pred->field      = libretrodb_query_predicate_field(cursor->query, i);
+      pred->num_values = libretrodb_query_predicate_values(cursor->query,
+            i, pred->values, LIBRETRODB_MAX_PREDICATE_VALUES);
+
+      if (pred->num_values == 0 || pred->field->type != RDT_STRING)
+         continue;
+
+      /* Missing fields compare equal to nil */
+      for (j = 0; j < pred->num_values; j++)
+         if (pred->values[j]->type == RDT_NULL)
+            break;
+
+      if (j < pred->num_values)
+         continue;
+
+      cursor->num_predicates++;
+   }
+
+   for (i = 0; i < cursor->num_predicates; i++)
+      if (libretrodb_cursor_plan_index(cursor, &cursor->predicates[i]) == 0)
+         break;
 }
 
 /**
@@ -433,6 +940,10 @@ void libretrodb_cursor_close(libretrodb_cursor_t *cursor)
  *
  * Opens cursor to database based on query @q.
  *
+ * Equality predicates on fields that have an index are answered
+ * through it, others are tested on the encoded records before
+ * anything gets decoded.
+ *
  * Returns: 0 if successful, otherwise negative.
  **/
 int libretrodb_cursor_open(libretrodb_t *db, libretrodb_cursor_t *cursor,
@@ -449,14 +960,22 @@ int libretrodb_cursor_open(libretrodb_t *db, libretrodb_cursor_t *cursor,
    if (!fd)
       return -errno;
 
-   cursor->fd       = fd;
-   cursor->db       = db;
-   cursor->is_valid = 1;
-   libretrodb_cursor_reset(cursor);
-   cursor->query    = q;
+   cursor->fd             = fd;
+   cursor->db             = db;
+   cursor->is_valid       = 1;
+   cursor->query          = q;
+   cursor->index_offsets  = NULL;
+   cursor->index_count    = 0;
+   cursor->use_index      = 0;
+   cursor->num_predicates = 0;
 
    if (q)
+   {
       libretrodb_query_inc_ref(q);
+      libretrodb_cursor_plan(cursor);
+   }
+
+   libretrodb_cursor_reset(cursor);
 
    return 0;
 }
@@ -465,18 +984,13 @@ static int node_iter(void *value, void *ctx)
 {
    struct node_iter_ctx *nictx = (struct node_iter_ctx*)ctx;
 
-   if (filestream_write(nictx->db->fd, value,
+   if (filestream_write(nictx->fd, value,
             (ssize_t)(nictx->idx->key_size + sizeof(uint64_t))) > 0)
       return 0;
 
    return -1;
 }
 
-static uint64_t libretrodb_tell(libretrodb_t *db)
-{
-   return filestream_tell(db->fd);
-}
-
 static int node_compare(const void *a, const void *b, void *ctx)
 {
    return memcmp(a, b, *(uint8_t *)ctx);
@@ -491,10 +1005,9 @@ int libretrodb_create_index(libretrodb_t *db,
    struct rmsgpack_dom_value item;
    libretrodb_cursor_t cur          = {0};
    struct rmsgpack_dom_value *field = NULL;
-   void *buff                       = NULL;
-   uint64_t *buff_u64               = NULL;
+   RFILE *fd                        = NULL;
+   uint8_t *buff                    = NULL;
    uint8_t field_size               = 0;
-   uint64_t item_loc                = libretrodb_tell(db);
    bintree_t *tree                  = bintree_new(node_compare, &field_size);
 
    item.type                        = RDT_NULL;
@@ -542,15 +1055,12 @@ int libretrodb_create_index(libretrodb_t *db,
          goto clean;
       }
 
-      buff = malloc(field_size + sizeof(uint64_t));
+      buff = (uint8_t*)malloc(field_size + sizeof(uint64_t));
       if (!buff)
          goto clean;
 
       memcpy(buff, field->val.binary.buff, field_size);
-
-      buff_u64 = (uint64_t *)buff + field_size;
-
-      memcpy(buff_u64, &item_loc, sizeof(uint64_t));
+      memcpy(buff + field_size, &cur.item_offset, sizeof(uint64_t));
 
       if (bintree_insert(tree, buff) != 0)
       {
@@ -561,23 +1071,33 @@ int libretrodb_create_index(libretrodb_t *db,
       }
       buff     = NULL;
       rmsgpack_dom_value_free(&item);
-      item_loc = libretrodb_tell(db);
    }
 
-   filestream_seek(db->fd, 0, RETRO_VFS_SEEK_POSITION_END);
+   /* The database handle is read-only, append through a second one */
+   fd = filestream_open(db->path,
+         RETRO_VFS_FILE_ACCESS_READ_WRITE
+         | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!fd)
+      goto clean;
+
+   filestream_seek(fd, 0, RETRO_VFS_SEEK_POSITION_END);
 
    strncpy(idx.name, name, 50);
 
    idx.name[49] = '\0';
    idx.key_size = field_size;
    idx.next     = db->count * (field_size + sizeof(uint64_t));
-   libretrodb_write_index_header(db->fd, &idx);
+   libretrodb_write_index_header(fd, &idx);
 
-   nictx.db  = db;
+   nictx.fd  = fd;
    nictx.idx = &idx;
    bintree_iterate(tree, node_iter, &nictx);
 
 clean:
+   if (fd)
+      filestream_close(fd);
    rmsgpack_dom_value_free(&item);
    if (buff)
       free(buff);
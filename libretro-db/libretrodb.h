@@ -97,6 +97,20 @@ int libretrodb_cursor_reset(libretrodb_cursor_t *cursor);
  **/
 void libretrodb_cursor_close(libretrodb_cursor_t *cursor);
 
+/**
+ * libretrodb_cursor_set_fields:
+ * @cursor              : Handle to database cursor.
+ * @fields              : Names of the fields to return, NULL for all.
+ * @count               : Number of names in @fields.
+ *
+ * Restricts the records returned by libretrodb_cursor_read_item to
+ * the given fields. The others are skipped without being decoded.
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+int libretrodb_cursor_set_fields(libretrodb_cursor_t *cursor,
+      const char **fields, unsigned count);
+
 void *libretrodb_query_compile(libretrodb_t *db, const char *query,
         size_t buff_len, const char **error);
 
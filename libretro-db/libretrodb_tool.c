@@ -22,20 +22,60 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 
 #include <string/stdstring.h>
 
 #include "libretrodb.h"
 #include "rmsgpack_dom.h"
 
+#define BENCH_RUNS 20
+
+/* Runs @q BENCH_RUNS times, returns the average in milliseconds */
+static double bench_query(libretrodb_t *db, libretrodb_query_t *q,
+      const char **fields, unsigned num_fields, unsigned *matches)
+{
+   unsigned i;
+   struct rmsgpack_dom_value item;
+   clock_t start = clock();
+
+   *matches = 0;
+
+   for (i = 0; i < BENCH_RUNS; i++)
+   {
+      libretrodb_cursor_t *cur = libretrodb_cursor_new();
+
+      if (!cur || libretrodb_cursor_open(db, cur, q) != 0)
+      {
+         libretrodb_cursor_free(cur);
+         return -1.0;
+      }
+
+      libretrodb_cursor_set_fields(cur, fields, num_fields);
+
+      while (libretrodb_cursor_read_item(cur, &item) == 0)
+      {
+         if (i == 0)
+            (*matches)++;
+         rmsgpack_dom_value_free(&item);
+      }
+
+      libretrodb_cursor_close(cur);
+      libretrodb_cursor_free(cur);
+   }
+
+   return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC / BENCH_RUNS;
+}
+
 int main(int argc, char ** argv)
 {
    int rv;
    libretrodb_t *db;
    libretrodb_cursor_t *cur;
-   libretrodb_query_t *q;
+   libretrodb_query_t *q = NULL;
    struct rmsgpack_dom_value item;
    const char *command, *path, *query_exp, *error;
+   const char *name_field = "name";
 
    if (argc < 3)
    {
@@ -45,6 +85,7 @@ int main(int argc, char ** argv)
       printf("\tcreate-index <index name> <field name>\n");
       printf("\tfind <query expression>\n");
       printf("\tget-names <query expression>\n");
+      printf("\tbench <query expression> [field...]\n");
       return 1;
    }
 
@@ -114,6 +155,38 @@ int main(int argc, char ** argv)
          rmsgpack_dom_value_free(&item);
       }
    }
+   else if (memcmp(command, "bench", 5) == 0)
+   {
+      unsigned matches = 0;
+      double ms        = 0.0;
+
+      if (argc < 4)
+      {
+         printf("Usage: %s <db file> bench <query expression> [field...]\n", argv[0]);
+         goto error;
+      }
+
+      query_exp = argv[3];
+      error = NULL;
+      q = libretrodb_query_compile(db, query_exp, strlen(query_exp), &error);
+
+      if (error)
+      {
+         printf("%s\n", error);
+         goto error;
+      }
+
+      ms = bench_query(db, NULL, NULL, 0, &matches);
+      printf("full scan        : %8.3f ms (%u records)\n", ms, matches);
+      ms = bench_query(db, q, NULL, 0, &matches);
+      printf("query            : %8.3f ms (%u matches)\n", ms, matches);
+
+      if (argc > 4)
+      {
+         ms = bench_query(db, q, (const char**)&argv[4], argc - 4, &matches);
+         printf("query, projected : %8.3f ms (%u matches)\n", ms, matches);
+      }
+   }
    else if (memcmp(command, "get-names", 9) == 0)
    {
       if (argc != 4)
@@ -138,6 +211,8 @@ int main(int argc, char ** argv)
          goto error;
       }
 
+      libretrodb_cursor_set_fields(cur, &name_field, 1);
+
       while (libretrodb_cursor_read_item(cur, &item) == 0)
       {
          if (item.type == RDT_MAP) //should always be true, but if false the program would segfault
@@ -974,3 +974,59 @@ int libretrodb_query_filter(libretrodb_query_t *q,
    struct rmsgpack_dom_value res = inv.func(*v, inv.argc, inv.argv);
    return (res.type == RDT_BOOL && res.val.bool_);
 }
+
+int libretrodb_query_num_predicates(libretrodb_query_t *q)
+{
+   struct query *rq = (struct query*)q;
+
+   if (!rq || rq->root.func != query_func_all_map)
+      return -1;
+
+   return (int)(rq->root.argc / 2);
+}
+
+const struct rmsgpack_dom_value *libretrodb_query_predicate_field(
+      libretrodb_query_t *q, unsigned i)
+{
+   struct query *rq = (struct query*)q;
+
+   if (libretrodb_query_num_predicates(q) <= (int)i)
+      return NULL;
+
+   return &rq->root.argv[i * 2].a.value;
+}
+
+unsigned libretrodb_query_predicate_values(libretrodb_query_t *q,
+      unsigned i, const struct rmsgpack_dom_value **values, unsigned max)
+{
+   unsigned j;
+   const struct argument *arg = NULL;
+   struct query *rq           = (struct query*)q;
+
+   if (libretrodb_query_num_predicates(q) <= (int)i)
+      return 0;
+
+   arg = &rq->root.argv[i * 2 + 1];
+
+   if (arg->type == AT_VALUE)
+   {
+      if (max < 1)
+         return 0;
+      values[0] = &arg->a.value;
+      return 1;
+   }
+
+   /* or(v1, v2, ...) over plain literals is a set membership test */
+   if (     arg->a.invocation.func != query_func_operator_or
+         || arg->a.invocation.argc > max)
+      return 0;
+
+   for (j = 0; j < arg->a.invocation.argc; j++)
+   {
+      if (arg->a.invocation.argv[j].type != AT_VALUE)
+         return 0;
+      values[j] = &arg->a.invocation.argv[j].a.value;
+   }
+
+   return arg->a.invocation.argc;
+}
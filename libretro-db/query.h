@@ -38,6 +38,34 @@ void libretrodb_query_dec_ref(libretrodb_query_t *q);
 
 int libretrodb_query_filter(libretrodb_query_t *q, struct rmsgpack_dom_value *v);
 
+/**
+ * libretrodb_query_num_predicates:
+ * @q                   : Compiled query.
+ *
+ * Returns: number of field predicates of a table query
+ * ({field: ..., ...}), or -1 if the query is not a table and may
+ * therefore look at any field of a record.
+ **/
+int libretrodb_query_num_predicates(libretrodb_query_t *q);
+
+const struct rmsgpack_dom_value *libretrodb_query_predicate_field(
+      libretrodb_query_t *q, unsigned i);
+
+/**
+ * libretrodb_query_predicate_values:
+ * @q                   : Compiled query.
+ * @i                   : Predicate index.
+ * @values              : Receives the literals the field is compared to.
+ * @max                 : Capacity of @values.
+ *
+ * Lets the planner see predicates that are plain equality tests, either
+ * {field: value} or {field: or(value, ...)}.
+ *
+ * Returns: number of literals, or 0 if predicate @i is anything else.
+ **/
+unsigned libretrodb_query_predicate_values(libretrodb_query_t *q,
+      unsigned i, const struct rmsgpack_dom_value **values, unsigned max);
+
 RETRO_END_DECLS
 
 #endif
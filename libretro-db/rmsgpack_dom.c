@@ -418,6 +418,310 @@ int rmsgpack_dom_read(RFILE *fd, struct rmsgpack_dom_value *out)
    return rv;
 }
 
+static uint64_t dom_buf_read_be(const uint8_t *p, size_t size)
+{
+   size_t i;
+   uint64_t v = 0;
+
+   for (i = 0; i < size; i++)
+      v = (v << 8) | p[i];
+
+   return v;
+}
+
+/**
+ * rmsgpack_dom_read_token:
+ * @buf                 : Encoded msgpack data.
+ * @size                : Number of valid bytes in @buf.
+ * @pos                 : Read position, advanced past the token.
+ * @out                 : Shallow value.
+ *
+ * Decodes a single value header straight from memory. Scalars are fully
+ * decoded, strings and binaries point into @buf (they are neither owned
+ * nor NUL-terminated), maps and arrays only report their length with
+ * the elements following at @pos. @out must not be passed to
+ * rmsgpack_dom_value_free.
+ *
+ * Returns: 0 on success, -EAGAIN if @buf ends before the token does,
+ * -EINVAL on an unsupported type.
+ **/
+int rmsgpack_dom_read_token(const uint8_t *buf, size_t size,
+      size_t *pos, struct rmsgpack_dom_value *out)
+{
+   size_t len_size = 0;
+   uint64_t len    = 0;
+   size_t p        = *pos;
+   uint8_t type;
+
+   if (p >= size)
+      return -EAGAIN;
+
+   type = buf[p++];
+
+   if (type < 0x80)
+   {
+      out->type     = RDT_INT;
+      out->val.int_ = type;
+      goto done;
+   }
+   else if (type < 0x90)
+   {
+      out->type        = RDT_MAP;
+      out->val.map.len = type - 0x80;
+      goto done;
+   }
+   else if (type < 0xa0)
+   {
+      out->type          = RDT_ARRAY;
+      out->val.array.len = type - 0x90;
+      goto done;
+   }
+   else if (type < 0xc0)
+   {
+      out->type = RDT_STRING;
+      len       = type - 0xa0;
+      goto buff;
+   }
+   else if (type > 0xdf)
+   {
+      out->type     = RDT_INT;
+      out->val.int_ = (int8_t)type;
+      goto done;
+   }
+
+   switch (type)
+   {
+      case 0xc0:
+         out->type = RDT_NULL;
+         goto done;
+      case 0xc2:
+      case 0xc3:
+         out->type      = RDT_BOOL;
+         out->val.bool_ = (type == 0xc3);
+         goto done;
+      case 0xc4:
+      case 0xc5:
+      case 0xc6:
+         out->type = RDT_BINARY;
+         len_size  = (size_t)1 << (type - 0xc4);
+         break;
+      case 0xd9:
+      case 0xda:
+      case 0xdb:
+         out->type = RDT_STRING;
+         len_size  = (size_t)1 << (type - 0xd9);
+         break;
+      case 0xcc:
+      case 0xcd:
+      case 0xce:
+      case 0xcf:
+         len_size = (size_t)1 << (type - 0xcc);
+         if (size - p < len_size)
+            return -EAGAIN;
+         out->type      = RDT_UINT;
+         out->val.uint_ = dom_buf_read_be(buf + p, len_size);
+         p             += len_size;
+         goto done;
+      case 0xd0:
+      case 0xd1:
+      case 0xd2:
+      case 0xd3:
+         len_size = (size_t)1 << (type - 0xd0);
+         if (size - p < len_size)
+            return -EAGAIN;
+         len = dom_buf_read_be(buf + p, len_size);
+         /* Sign-extend from the encoded width */
+         if (len_size < 8 && (len & (UINT64_C(1) << (len_size * 8 - 1))))
+            len |= ~UINT64_C(0) << (len_size * 8);
+         out->type     = RDT_INT;
+         out->val.int_ = (int64_t)len;
+         p            += len_size;
+         goto done;
+      case 0xdc:
+      case 0xdd:
+      case 0xde:
+      case 0xdf:
+         len_size = (type & 1) ? 4 : 2;
+         if (size - p < len_size)
+            return -EAGAIN;
+         len = dom_buf_read_be(buf + p, len_size);
+         p  += len_size;
+         if (type < 0xde)
+         {
+            out->type          = RDT_ARRAY;
+            out->val.array.len = (uint32_t)len;
+         }
+         else
+         {
+            out->type        = RDT_MAP;
+            out->val.map.len = (uint32_t)len;
+         }
+         goto done;
+      default:
+         return -EINVAL;
+   }
+
+   if (size - p < len_size)
+      return -EAGAIN;
+   len = dom_buf_read_be(buf + p, len_size);
+   p  += len_size;
+
+buff:
+   if (size - p < len)
+      return -EAGAIN;
+   /* string and binary share their layout */
+   out->val.string.len  = (uint32_t)len;
+   out->val.string.buff = (char*)(buf + p);
+   p                   += (size_t)len;
+
+done:
+   *pos = p;
+   return 0;
+}
+
+/**
+ * rmsgpack_dom_skip_buf:
+ * @buf                 : Encoded msgpack data.
+ * @size                : Number of valid bytes in @buf.
+ * @pos                 : Read position, advanced past the value.
+ *
+ * Skips one complete value, including all nested elements, without
+ * allocating anything.
+ *
+ * Returns: 0 on success, negative on error (see rmsgpack_dom_read_token).
+ **/
+int rmsgpack_dom_skip_buf(const uint8_t *buf, size_t size, size_t *pos)
+{
+   struct rmsgpack_dom_value tok;
+   uint64_t pending = 1;
+   size_t p         = *pos;
+
+   while (pending > 0)
+   {
+      int rv = rmsgpack_dom_read_token(buf, size, &p, &tok);
+
+      if (rv < 0)
+         return rv;
+
+      pending--;
+
+      if (tok.type == RDT_MAP)
+         pending += (uint64_t)tok.val.map.len * 2;
+      else if (tok.type == RDT_ARRAY)
+         pending += tok.val.array.len;
+   }
+
+   *pos = p;
+   return 0;
+}
+
+static int dom_read_buf(const uint8_t *buf, size_t size, size_t *pos,
+      struct rmsgpack_dom_value *out, unsigned depth)
+{
+   unsigned i;
+   int rv;
+
+   if (depth >= MAX_DEPTH)
+      return -ENOMEM;
+
+   if ((rv = rmsgpack_dom_read_token(buf, size, pos, out)) < 0)
+   {
+      out->type = RDT_NULL;
+      return rv;
+   }
+
+   switch (out->type)
+   {
+      case RDT_STRING:
+      case RDT_BINARY:
+         {
+            const char *src = out->val.string.buff;
+            char *copy      = (char*)malloc(out->val.string.len + 1);
+
+            if (!copy)
+            {
+               out->type = RDT_NULL;
+               return -ENOMEM;
+            }
+
+            memcpy(copy, src, out->val.string.len);
+            copy[out->val.string.len] = '\0';
+            out->val.string.buff      = copy;
+         }
+         break;
+      case RDT_MAP:
+         {
+            uint32_t len     = out->val.map.len;
+            out->val.map.len = 0;
+            out->val.map.items = (struct rmsgpack_dom_pair*)
+               calloc(len ? len : 1, sizeof(struct rmsgpack_dom_pair));
+
+            if (!out->val.map.items)
+            {
+               out->type = RDT_NULL;
+               return -ENOMEM;
+            }
+
+            for (i = 0; i < len; i++)
+            {
+               struct rmsgpack_dom_pair *pair = &out->val.map.items[i];
+               out->val.map.len++;
+               if ((rv = dom_read_buf(buf, size, pos,
+                           &pair->key, depth + 1)) < 0)
+                  return rv;
+               if ((rv = dom_read_buf(buf, size, pos,
+                           &pair->value, depth + 1)) < 0)
+                  return rv;
+            }
+         }
+         break;
+      case RDT_ARRAY:
+         {
+            uint32_t len       = out->val.array.len;
+            out->val.array.len = 0;
+            out->val.array.items = (struct rmsgpack_dom_value*)
+               calloc(len ? len : 1, sizeof(struct rmsgpack_dom_value));
+
+            if (!out->val.array.items)
+            {
+               out->type = RDT_NULL;
+               return -ENOMEM;
+            }
+
+            for (i = 0; i < len; i++)
+            {
+               out->val.array.len++;
+               if ((rv = dom_read_buf(buf, size, pos,
+                           &out->val.array.items[i], depth + 1)) < 0)
+                  return rv;
+            }
+         }
+         break;
+      default:
+         break;
+   }
+
+   return 0;
+}
+
+/**
+ * rmsgpack_dom_read_buf:
+ * @buf                 : Encoded msgpack data.
+ * @size                : Number of valid bytes in @buf.
+ * @pos                 : Read position, advanced past the value.
+ * @out                 : Decoded value.
+ *
+ * In-memory counterpart of rmsgpack_dom_read. @out owns its data and
+ * must be released with rmsgpack_dom_value_free, also on failure.
+ *
+ * Returns: 0 on success, negative on error.
+ **/
+int rmsgpack_dom_read_buf(const uint8_t *buf, size_t size, size_t *pos,
+      struct rmsgpack_dom_value *out)
+{
+   return dom_read_buf(buf, size, pos, out, 0);
+}
+
 int rmsgpack_dom_read_into(RFILE *fd, ...)
 {
    va_list ap;
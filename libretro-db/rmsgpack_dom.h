@@ -24,6 +24,7 @@
 #define __LIBRETRODB_MSGPACK_DOM_H__
 
 #include <stdint.h>
+#include <stddef.h>
 
 #include <retro_common_api.h>
 #include <streams/file_stream.h>
@@ -95,6 +96,14 @@ int rmsgpack_dom_write(RFILE *fd, const struct rmsgpack_dom_value *obj);
 
 int rmsgpack_dom_read_into(RFILE *fd, ...);
 
+int rmsgpack_dom_read_token(const uint8_t *buf, size_t size,
+      size_t *pos, struct rmsgpack_dom_value *out);
+
+int rmsgpack_dom_skip_buf(const uint8_t *buf, size_t size, size_t *pos);
+
+int rmsgpack_dom_read_buf(const uint8_t *buf, size_t size, size_t *pos,
+      struct rmsgpack_dom_value *out);
+
 RETRO_END_DECLS
 
 #endif
@@ -2795,5 +2795,6 @@ menu_ctx_driver_t menu_ctx_mui = {
    NULL, /* update_savestate_thumbnail_image */
    materialui_pointer_down,
    materialui_pointer_up,
-   NULL /* get_load_content_animation_data */
+   NULL, /* get_load_content_animation_data */
+   false /* virtual_lists */
 };
@@ -99,4 +99,5 @@ menu_ctx_driver_t menu_ctx_null = {
   NULL,  /* pointer_down */
   NULL,  /* pointer_up   */
   NULL,  /* get_load_content_animation_data */
+  false  /* virtual_lists */
 };
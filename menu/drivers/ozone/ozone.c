@@ -1845,8 +1845,9 @@ menu_ctx_driver_t menu_ctx_ozone = {
    NULL,                         /* pointer_down */
    NULL,                         /* pointer_up   */
 #ifdef HAVE_MENU_WIDGETS
-   ozone_get_load_content_animation_data
+   ozone_get_load_content_animation_data,
 #else
-   NULL
+   NULL,
 #endif
+   false                               /* virtual_lists */
 };
@@ -44,6 +44,7 @@
 
 #include "../menu_driver.h"
 #include "../menu_animation.h"
+#include "../menu_thumbnail_cache.h"
 
 #include "../widgets/menu_input_dialog.h"
 
@@ -676,7 +677,7 @@ static bool request_thumbnail(rgui_t *rgui, const char *path)
       {
          /* Would like to cancel any existing image load tasks
           * here, but can't see how to do it... */
-         if(task_push_image_load(thumbnail.path, menu_display_handle_thumbnail_upload, NULL))
+         if(menu_thumbnail_cache_load(thumbnail.path, menu_display_handle_thumbnail_upload, NULL))
          {
             rgui->thumbnail_queue_size++;
             return true;
@@ -1910,6 +1911,7 @@ static void *rgui_init(void **userdata, bool video_is_threaded)
    rgui->last_height = fb_height;
 
    rgui->thumbnail_queue_size = 0;
+   menu_thumbnail_cache_set_max_size(THUMB_MAX_WIDTH, THUMB_MAX_HEIGHT);
    /* Ensure that we start with thumbnails disabled */
    rgui->show_thumbnail = false;
 
@@ -2507,4 +2509,5 @@ menu_ctx_driver_t menu_ctx_rgui = {
    NULL,                               /* pointer_down */
    NULL,                               /* pointer_up */
    NULL,                               /* get_load_content_animation_data */
+   true                                /* virtual_lists */
 };
@@ -45,6 +45,7 @@
 #include "../menu_animation.h"
 #include "../menu_entries.h"
 #include "../menu_input.h"
+#include "../menu_thumbnail_cache.h"
 
 #include "../../core_info.h"
 #include "../../core.h"
@@ -1070,7 +1071,7 @@ static void stripes_update_thumbnail_image(void *data)
    if (!(string_is_empty(stripes->thumbnail_file_path)))
       {
          if (filestream_exists(stripes->thumbnail_file_path))
-            task_push_image_load(stripes->thumbnail_file_path,
+            menu_thumbnail_cache_load(stripes->thumbnail_file_path,
                   menu_display_handle_thumbnail_upload, NULL);
          else
             video_driver_texture_unload(&stripes->thumbnail);
@@ -1082,7 +1083,7 @@ static void stripes_update_thumbnail_image(void *data)
    if (!(string_is_empty(stripes->left_thumbnail_file_path)))
       {
          if (filestream_exists(stripes->left_thumbnail_file_path))
-            task_push_image_load(stripes->left_thumbnail_file_path,
+            menu_thumbnail_cache_load(stripes->left_thumbnail_file_path,
                   menu_display_handle_left_thumbnail_upload, NULL);
          else
             video_driver_texture_unload(&stripes->left_thumbnail);
@@ -3191,6 +3192,12 @@ static void stripes_layout(stripes_handle_t *stripes)
    else
       stripes_layout_psp(stripes, width);
 
+   /* Thumbnails are never drawn larger than the screen */
+   menu_thumbnail_cache_set_max_size(
+         MIN((unsigned)MAX(stripes->thumbnail_width,
+               stripes->left_thumbnail_width), width),
+         height);
+
    current = (unsigned)selection;
    end     = (unsigned)menu_entries_get_size();
 
@@ -4451,5 +4458,6 @@ menu_ctx_driver_t menu_ctx_stripes = {
    stripes_update_savestate_thumbnail_image,
    NULL,                                     /* pointer_down */
    NULL,                                     /* pointer_up   */
-   NULL                                      /* get_load_content_animation_data   */
+   NULL,                                     /* get_load_content_animation_data   */
+   false                                     /* virtual_lists */
 };
@@ -45,6 +45,7 @@
 #include "../menu_animation.h"
 #include "../menu_entries.h"
 #include "../menu_input.h"
+#include "../menu_thumbnail_cache.h"
 
 #include "../../core_info.h"
 #include "../../core.h"
@@ -950,6 +951,77 @@ end:
    string_list_free(list);
 }
 
+/* Builds <thumbnails>/<system>/<Named_*>/<content>.png
+ * for the right ('R') or left ('L') thumbnail. */
+static void xmb_build_thumbnail_path(xmb_handle_t *xmb,
+      const char *dir_thumbnails, const char *content, char pos,
+      char *s, size_t len)
+{
+   /* Append thumbnail system directory */
+   if (!string_is_empty(xmb->thumbnail_system))
+      fill_pathname_join(
+            s,
+            dir_thumbnails,
+            xmb->thumbnail_system,
+            len);
+
+   if (!string_is_empty(s))
+   {
+      char            *tmp_new2      = (char*)
+         malloc(PATH_MAX_LENGTH * sizeof(char));
+
+      tmp_new2[0]                    = '\0';
+
+      /* Append Named_Snaps/Named_Boxarts/Named_Titles */
+      if (pos ==  'R')
+         fill_pathname_join(tmp_new2, s,
+               xmb_thumbnails_ident('R'), PATH_MAX_LENGTH * sizeof(char));
+      if (pos ==  'L')
+         fill_pathname_join(tmp_new2, s,
+               xmb_thumbnails_ident('L'), PATH_MAX_LENGTH * sizeof(char));
+
+      strlcpy(s, tmp_new2, len);
+      free(tmp_new2);
+   }
+
+   /* Scrub characters that are not cross-platform and/or violate the
+    * No-Intro filename standard:
+    * http://datomatic.no-intro.org/stuff/The%20Official%20No-Intro%20Convention%20(20071030).zip
+    * Replace these characters in the entry name with underscores.
+    */
+   if (!string_is_empty(content))
+   {
+      char *scrub_char_pointer       = NULL;
+      char            *tmp_new       = (char*)
+         malloc(PATH_MAX_LENGTH * sizeof(char));
+      char            *tmp           = strdup(content);
+
+      tmp_new[0]                     = '\0';
+
+      while((scrub_char_pointer = strpbrk(tmp, "&*/:`\"<>?\\|")))
+         *scrub_char_pointer = '_';
+
+      /* Look for thumbnail file with this scrubbed filename */
+
+      fill_pathname_join(tmp_new,
+            s,
+            tmp, PATH_MAX_LENGTH * sizeof(char));
+
+      if (!string_is_empty(tmp_new))
+         strlcpy(s,
+               tmp_new, len);
+
+      free(tmp_new);
+      free(tmp);
+   }
+
+   /* Append png extension */
+   if (!string_is_empty(s))
+      strlcat(s,
+            file_path_str(FILE_PATH_PNG_EXTENSION),
+            len);
+}
+
 static void xmb_update_thumbnail_path(void *data, unsigned i, char pos)
 {
    menu_entry_t entry;
@@ -1024,70 +1096,8 @@ static void xmb_update_thumbnail_path(void *data, unsigned i, char pos)
       }
    }
 
-   /* Append thumbnail system directory */
-   if (!string_is_empty(xmb->thumbnail_system))
-      fill_pathname_join(
-            new_path,
-            dir_thumbnails,
-            xmb->thumbnail_system,
-            sizeof(new_path));
-
-   if (!string_is_empty(new_path))
-   {
-      char            *tmp_new2      = (char*)
-         malloc(PATH_MAX_LENGTH * sizeof(char));
-
-      tmp_new2[0]                    = '\0';
-
-      /* Append Named_Snaps/Named_Boxarts/Named_Titles */
-      if (pos ==  'R')
-         fill_pathname_join(tmp_new2, new_path,
-               xmb_thumbnails_ident('R'), PATH_MAX_LENGTH * sizeof(char));
-      if (pos ==  'L')
-         fill_pathname_join(tmp_new2, new_path,
-               xmb_thumbnails_ident('L'), PATH_MAX_LENGTH * sizeof(char));
-
-      strlcpy(new_path, tmp_new2,
-            PATH_MAX_LENGTH * sizeof(char));
-      free(tmp_new2);
-   }
-
-   /* Scrub characters that are not cross-platform and/or violate the
-    * No-Intro filename standard:
-    * http://datomatic.no-intro.org/stuff/The%20Official%20No-Intro%20Convention%20(20071030).zip
-    * Replace these characters in the entry name with underscores.
-    */
-   if (!string_is_empty(xmb->thumbnail_content))
-   {
-      char *scrub_char_pointer       = NULL;
-      char            *tmp_new       = (char*)
-         malloc(PATH_MAX_LENGTH * sizeof(char));
-      char            *tmp           = strdup(xmb->thumbnail_content);
-
-      tmp_new[0]                     = '\0';
-
-      while((scrub_char_pointer = strpbrk(tmp, "&*/:`\"<>?\\|")))
-         *scrub_char_pointer = '_';
-
-      /* Look for thumbnail file with this scrubbed filename */
-
-      fill_pathname_join(tmp_new,
-            new_path,
-            tmp, PATH_MAX_LENGTH * sizeof(char));
-
-      if (!string_is_empty(tmp_new))
-         strlcpy(new_path,
-               tmp_new, sizeof(new_path));
-
-      free(tmp_new);
-      free(tmp);
-   }
-
-   /* Append png extension */
-   if (!string_is_empty(new_path))
-      strlcat(new_path,
-            file_path_str(FILE_PATH_PNG_EXTENSION),
-            sizeof(new_path));
+   xmb_build_thumbnail_path(xmb, dir_thumbnails,
+         xmb->thumbnail_content, pos, new_path, sizeof(new_path));
 
 end:
    if (xmb && !string_is_empty(new_path))
@@ -1169,7 +1179,7 @@ static void xmb_update_thumbnail_image(void *data)
    if (!(string_is_empty(xmb->thumbnail_file_path)))
    {
       if (filestream_exists(xmb->thumbnail_file_path))
-         task_push_image_load(xmb->thumbnail_file_path,
+         menu_thumbnail_cache_load(xmb->thumbnail_file_path,
                menu_display_handle_thumbnail_upload, NULL);
       else
          video_driver_texture_unload(&xmb->thumbnail);
@@ -1181,7 +1191,7 @@ static void xmb_update_thumbnail_image(void *data)
    if (!(string_is_empty(xmb->left_thumbnail_file_path)))
    {
       if (filestream_exists(xmb->left_thumbnail_file_path))
-         task_push_image_load(xmb->left_thumbnail_file_path,
+         menu_thumbnail_cache_load(xmb->left_thumbnail_file_path,
                menu_display_handle_left_thumbnail_upload, NULL);
       else
          video_driver_texture_unload(&xmb->left_thumbnail);
@@ -1191,6 +1201,57 @@ static void xmb_update_thumbnail_image(void *data)
    }
 }
 
+/* Queue the thumbnails of the playlist entries around
+ * the selection, nearest first, so that scrolling onto
+ * them hits the thumbnail cache. */
+static void xmb_prefetch_thumbnails(xmb_handle_t *xmb,
+      size_t selection, char pos)
+{
+   unsigned d;
+   settings_t     *settings      = config_get_ptr();
+   playlist_t     *playlist      = playlist_get_cached();
+   size_t          end           = menu_entries_get_size();
+
+   if (string_is_empty(settings->paths.directory_thumbnails))
+      return;
+
+   for (d = 1; d <= 2 * MENU_THUMBNAIL_PREFETCH; d++)
+   {
+      menu_entry_t entry;
+      char new_path[PATH_MAX_LENGTH];
+      const char *core_name = NULL;
+      size_t i              = (d & 1)
+         ? selection + (d + 1) / 2
+         : selection - d / 2;
+
+      /* Below zero wraps around and fails this too */
+      if (i >= end)
+         continue;
+
+      if (playlist && i < playlist_size(playlist))
+      {
+         playlist_get_index(playlist, i,
+               NULL, NULL, NULL, &core_name, NULL, NULL);
+         if (string_is_equal(core_name, "imageviewer"))
+            continue;
+      }
+
+      new_path[0] = '\0';
+
+      menu_entry_init(&entry);
+      menu_entry_get(&entry, 0, i, NULL, true);
+
+      if (!string_is_empty(entry.path))
+      {
+         xmb_build_thumbnail_path(xmb, settings->paths.directory_thumbnails,
+               entry.path, pos, new_path, sizeof(new_path));
+         menu_thumbnail_cache_prefetch(new_path);
+      }
+
+      menu_entry_free(&entry);
+   }
+}
+
 static void xmb_set_thumbnail_system(void *data, char*s, size_t len)
 {
    xmb_handle_t *xmb = (xmb_handle_t*)data;
@@ -1251,7 +1312,8 @@ static unsigned xmb_get_system_tab(xmb_handle_t *xmb, unsigned i)
 static void xmb_selection_pointer_changed(
       xmb_handle_t *xmb, bool allow_animations)
 {
-   unsigned i, end, height;
+   unsigned i, height;
+   size_t begin, end;
    menu_animation_ctx_tag tag;
    menu_entry_t entry;
    size_t num                 = 0;
@@ -1270,7 +1332,6 @@ static void xmb_selection_pointer_changed(
 
    menu_entry_get(&entry, 0, selection, NULL, true);
 
-   end       = (unsigned)menu_entries_get_size();
    threshold = xmb->icon_size * 10;
 
    video_driver_get_size(NULL, &height);
@@ -1280,7 +1341,9 @@ static void xmb_selection_pointer_changed(
    menu_animation_kill_by_tag(&tag);
    menu_entries_ctl(MENU_ENTRIES_CTL_SET_START, &num);
 
-   for (i = 0; i < end; i++)
+   menu_entries_get_window(selection_buf, &begin, &end);
+
+   for (i = (unsigned)begin; i < end; i++)
    {
       float iy, real_iy;
       float ia         = xmb->items_passive_alpha;
@@ -1316,12 +1379,14 @@ static void xmb_selection_pointer_changed(
                {
                   xmb_update_thumbnail_path(xmb, i, 'R');
                   xmb_update_thumbnail_image(xmb);
+                  xmb_prefetch_thumbnails(xmb, i, 'R');
                }
                if (!string_is_equal(lft_thumb_ident,
                         msg_hash_to_str(MENU_ENUM_LABEL_VALUE_OFF)))
                {
                   xmb_update_thumbnail_path(xmb, i, 'L');
                   xmb_update_thumbnail_image(xmb);
+                  xmb_prefetch_thumbnails(xmb, i, 'L');
                }
             }
             else if (((entry_type == FILE_TYPE_IMAGE || entry_type == FILE_TYPE_IMAGEVIEWER ||
@@ -1410,13 +1475,14 @@ static void xmb_list_open_old(xmb_handle_t *xmb,
 {
    unsigned i, height = 0;
    int        threshold = xmb->icon_size * 10;
+   size_t         begin = 0;
    size_t           end = 0;
 
-   end = file_list_get_size(list);
+   menu_entries_get_window(list, &begin, &end);
 
    video_driver_get_size(NULL, &height);
 
-   for (i = 0; i < end; i++)
+   for (i = (unsigned)begin; i < end; i++)
    {
       float ia = 0;
       float real_y;
@@ -1472,11 +1538,14 @@ static void xmb_list_open_new(xmb_handle_t *xmb,
    unsigned xmb_system_tab = 0;
    size_t skip             = 0;
    int        threshold    = xmb->icon_size * 10;
-   size_t           end    = file_list_get_size(list);
+   size_t         begin    = 0;
+   size_t           end    = 0;
+
+   menu_entries_get_window(list, &begin, &end);
 
    video_driver_get_size(NULL, &height);
 
-   for (i = 0; i < end; i++)
+   for (i = (unsigned)begin; i < end; i++)
    {
       float ia;
       float real_y;
@@ -1616,6 +1685,7 @@ static void xmb_list_switch_old(xmb_handle_t *xmb,
       file_list_t *list, int dir, size_t current)
 {
    unsigned i, height;
+   size_t begin, window_end;
    size_t end          = file_list_get_size(list);
    float ix            = -xmb->icon_spacing_horizontal * dir;
    float ia            = 0;
@@ -1626,7 +1696,9 @@ static void xmb_list_switch_old(xmb_handle_t *xmb,
    xmb_calculate_visible_range(xmb, height, end,
          (unsigned)current, &first, &last);
 
-   for (i = 0; i < end; i++)
+   menu_entries_get_window(list, &begin, &window_end);
+
+   for (i = (unsigned)begin; i < window_end; i++)
    {
       xmb_node_t *node = (xmb_node_t*)
          file_list_get_userdata_at_offset(list, i);
@@ -1648,6 +1720,7 @@ static void xmb_list_switch_new(xmb_handle_t *xmb,
       file_list_t *list, int dir, size_t current)
 {
    unsigned i, first, last, height;
+   size_t begin, window_end;
    size_t end           = 0;
    settings_t *settings = config_get_ptr();
 
@@ -1700,7 +1773,9 @@ static void xmb_list_switch_new(xmb_handle_t *xmb,
    video_driver_get_size(NULL, &height);
    xmb_calculate_visible_range(xmb, height, end, (unsigned)current, &first, &last);
 
-   for (i = 0; i < end; i++)
+   menu_entries_get_window(list, &begin, &window_end);
+
+   for (i = (unsigned)begin; i < window_end; i++)
    {
       xmb_node_t *node = (xmb_node_t*)
          file_list_get_userdata_at_offset(list, i);
@@ -3114,6 +3189,7 @@ static void xmb_draw_items(
    xmb_calculate_visible_range(xmb, height, end, (unsigned)current, &first, &last);
 
    menu_display_blend_begin(video_info);
+   menu_display_batch_begin(video_info);
 
    for (i = first; i <= last; i++)
    {
@@ -3133,6 +3209,7 @@ static void xmb_draw_items(
          break;
    }
 
+   menu_display_batch_end(video_info);
    menu_display_blend_end(video_info);
 }
 
@@ -3287,6 +3364,10 @@ static void xmb_draw_bg(
       }
 
       menu_display_draw_pipeline(&draw, video_info);
+
+      /* The pipeline animates on its own,
+       * so the menu is never idle. */
+      menu_animation_ctl(MENU_ANIMATION_CTL_SET_ACTIVE, NULL);
    }
    else
 #endif
@@ -3875,6 +3956,7 @@ static void xmb_frame(void *data, video_frame_info_t *video_info)
             xmb->shadow_offset);
 
    menu_display_blend_begin(video_info);
+   menu_display_batch_begin(video_info);
 
    /* Horizontal tab icons */
    if (!xmb->assets_missing)
@@ -4064,6 +4146,7 @@ static void xmb_frame(void *data, video_frame_info_t *video_info)
       }
    }
 
+   menu_display_batch_end(video_info);
    menu_display_blend_end(video_info);
 
    /* Vertical icons */
@@ -4261,6 +4344,7 @@ static void xmb_layout_psp(xmb_handle_t *xmb, int width)
 static void xmb_layout(xmb_handle_t *xmb)
 {
    unsigned width, height, i, current, end;
+   size_t begin, window_end;
    settings_t *settings       = config_get_ptr();
    file_list_t *selection_buf = menu_entries_get_selection_buf_ptr(0);
    size_t selection           = menu_navigation_get_selection();
@@ -4298,6 +4382,12 @@ static void xmb_layout(xmb_handle_t *xmb)
          break;
    }
 
+   /* Thumbnails are never drawn larger than the screen */
+   menu_thumbnail_cache_set_max_size(
+         MIN((unsigned)MAX(xmb->thumbnail_width,
+               xmb->left_thumbnail_width), width),
+         height);
+
 #ifdef XMB_DEBUG
    RARCH_LOG("[XMB] margin screen left: %.2f\n",  xmb->margins_screen_left);
    RARCH_LOG("[XMB] margin screen top:  %.2f\n",  xmb->margins_screen_top);
@@ -4313,9 +4403,10 @@ static void xmb_layout(xmb_handle_t *xmb)
 #endif
 
    current = (unsigned)selection;
-   end     = (unsigned)menu_entries_get_size();
 
-   for (i = 0; i < end; i++)
+   menu_entries_get_window(selection_buf, &begin, &window_end);
+
+   for (i = (unsigned)begin; i < window_end; i++)
    {
       float ia         = xmb->items_passive_alpha;
       float iz         = xmb->items_passive_zoom;
@@ -5203,7 +5294,28 @@ static void xmb_list_clear(file_list_t *list)
 
 static void xmb_list_free(file_list_t *list, size_t a, size_t b)
 {
-   xmb_list_clear(list);
+   menu_animation_ctx_subject_t subject;
+   float *subjects[5];
+   xmb_node_t *node = (xmb_node_t*)file_list_get_userdata_at_offset(list, a);
+
+   if (!node)
+      return;
+
+   subjects[0]   = &node->alpha;
+   subjects[1]   = &node->label_alpha;
+   subjects[2]   = &node->zoom;
+   subjects[3]   = &node->x;
+   subjects[4]   = &node->y;
+
+   subject.count = 5;
+   subject.data  = subjects;
+
+   menu_animation_kill_by_subject(&subject);
+
+   xmb_free_node(node);
+
+   /* file_list_set_userdata() doesn't accept NULL */
+   list->list[a].userdata = NULL;
 }
 
 static void xmb_list_deep_copy(const file_list_t *src, file_list_t *dst,
@@ -5832,8 +5944,9 @@ menu_ctx_driver_t menu_ctx_xmb = {
    NULL, /* pointer_down */
    NULL, /* pointer_up   */
 #ifdef HAVE_MENU_WIDGETS
-   xmb_get_load_content_animation_data
+   xmb_get_load_content_animation_data,
 #else
-   NULL
+   NULL,
 #endif
+   true                                /* virtual_lists */
 };
@@ -749,5 +749,6 @@ menu_ctx_driver_t menu_ctx_xui = {
    NULL,          /* update_savestate_thumbnail_image */
    NULL,          /* pointer_down */
    NULL,          /* pointer_up */
-   NULL           /* get_load_content_animation_data */
+   NULL,          /* get_load_content_animation_data */
+   false          /* virtual_lists */
 };
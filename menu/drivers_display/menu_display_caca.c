@@ -103,5 +103,6 @@ menu_display_ctx_driver_t menu_display_ctx_caca = {
    "caca",
    false,
    NULL,
-   NULL
+   NULL,
+   false
 };
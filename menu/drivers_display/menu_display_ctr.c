@@ -211,5 +211,6 @@ menu_display_ctx_driver_t menu_display_ctx_ctr = {
    "ctr",
    true,
    NULL,
-   NULL
+   NULL,
+   false
 };
@@ -325,5 +325,6 @@ menu_display_ctx_driver_t menu_display_ctx_d3d10 = {
    "d3d10",
    true,
    menu_display_d3d10_scissor_begin,
-   menu_display_d3d10_scissor_end
+   menu_display_d3d10_scissor_end,
+   false
 };
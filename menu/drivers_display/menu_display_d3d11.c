@@ -324,5 +324,6 @@ menu_display_ctx_driver_t menu_display_ctx_d3d11 = {
    "d3d11",
    true,
    menu_display_d3d11_scissor_begin,
-   menu_display_d3d11_scissor_end
+   menu_display_d3d11_scissor_end,
+   false
 };
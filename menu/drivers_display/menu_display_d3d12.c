@@ -345,5 +345,6 @@ menu_display_ctx_driver_t menu_display_ctx_d3d12 = {
    "d3d12",
    true,
    menu_display_d3d12_scissor_begin,
-   menu_display_d3d12_scissor_end
+   menu_display_d3d12_scissor_end,
+   false
 };
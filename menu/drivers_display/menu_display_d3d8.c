@@ -288,5 +288,6 @@ menu_display_ctx_driver_t menu_display_ctx_d3d8 = {
    "d3d8",
    false,
    NULL,
-   NULL
+   NULL,
+   false
 };
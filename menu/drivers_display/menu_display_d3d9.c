@@ -359,5 +359,6 @@ menu_display_ctx_driver_t menu_display_ctx_d3d9 = {
    "d3d9",
    false,
    menu_display_d3d9_scissor_begin,
-   menu_display_d3d9_scissor_end
+   menu_display_d3d9_scissor_end,
+   false
 };
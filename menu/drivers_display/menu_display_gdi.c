@@ -175,5 +175,6 @@ menu_display_ctx_driver_t menu_display_ctx_gdi = {
    "gdi",
    false,
    NULL,
-   NULL
+   NULL,
+   false
 };
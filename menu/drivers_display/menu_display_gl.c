@@ -274,5 +274,6 @@ menu_display_ctx_driver_t menu_display_ctx_gl = {
    "gl",
    false,
    menu_display_gl_scissor_begin,
-   menu_display_gl_scissor_end
+   menu_display_gl_scissor_end,
+   true
 };
@@ -220,5 +220,6 @@ menu_display_ctx_driver_t menu_display_ctx_gl1 = {
    "gl1",
    false,
    menu_display_gl1_scissor_begin,
-   menu_display_gl1_scissor_end
+   menu_display_gl1_scissor_end,
+   false
 };
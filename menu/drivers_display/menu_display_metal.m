@@ -155,5 +155,6 @@ menu_display_ctx_driver_t menu_display_ctx_metal = {
    .ident                  = "menu_display_metal",
    .handles_transform      = NO,
    .scissor_begin          = menu_display_metal_scissor_begin,
-   .scissor_end            = menu_display_metal_scissor_end
+   .scissor_end            = menu_display_metal_scissor_end,
+   .supports_batching      = NO
 };
@@ -98,5 +98,6 @@ menu_display_ctx_driver_t menu_display_ctx_null = {
    "null",
    false,
    NULL,
-   NULL
+   NULL,
+   false
 };
@@ -110,5 +110,6 @@ menu_display_ctx_driver_t menu_display_ctx_sixel = {
    "sixel",
    false,
    NULL,
-   NULL
+   NULL,
+   false
 };
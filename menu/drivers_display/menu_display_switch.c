@@ -102,5 +102,6 @@ menu_display_ctx_driver_t menu_display_ctx_switch = {
    "switch",
    false,
    NULL,
-   NULL
+   NULL,
+   false
 };
@@ -104,5 +104,6 @@ menu_display_ctx_driver_t menu_display_ctx_vga = {
    "menu_display_vga",
    false,
    NULL,
-   NULL
+   NULL,
+   false
 };
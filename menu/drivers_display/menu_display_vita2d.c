@@ -249,5 +249,6 @@ menu_display_ctx_driver_t menu_display_ctx_vita2d = {
    "vita2d",
    true,
    NULL,
-   NULL
+   NULL,
+   false
 };
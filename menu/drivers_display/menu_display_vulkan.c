@@ -382,5 +382,6 @@ menu_display_ctx_driver_t menu_display_ctx_vulkan = {
    "vulkan",
    false,
    menu_display_vk_scissor_begin,
-   menu_display_vk_scissor_end
+   menu_display_vk_scissor_end,
+   false
 };
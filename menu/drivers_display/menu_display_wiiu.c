@@ -347,5 +347,6 @@ menu_display_ctx_driver_t menu_display_ctx_wiiu = {
    "gx2",
    true,
    menu_display_wiiu_scissor_begin,
-   menu_display_wiiu_scissor_end
+   menu_display_wiiu_scissor_end,
+   false
 };
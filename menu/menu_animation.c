@@ -34,27 +34,81 @@
 #include "../configuration.h"
 #include "../performance_counters.h"
 
+/* Number of chains tweens are hashed into by tag
+ * and by subject, must be a power of two. */
+#define TWEEN_HASH_BITS 10
+#define TWEEN_HASH_SIZE (1 << TWEEN_HASH_BITS)
+
+/* Tweens are stored structure-of-arrays style, one group per
+ * easing function, so that advancing all of them is a handful
+ * of tight loops over contiguous floats. Everything else
+ * about a tween is kept in a pooled slot, which also links
+ * it into the tag and subject chains used for cancellation.
+ *
+ * Slot and group indices are stored plus one, so that zero
+ * means none and a zeroed menu_animation_t is empty. */
+
+typedef void (*easing_batch_cb)(const float *t, const float *b,
+      const float *c, const float *d, float *out, size_t count);
+
 struct tween
 {
-   float       duration;
-   float       running_since;
-   float       initial_value;
    float       target_value;
    float       *subject;
    uintptr_t   tag;
-   easing_cb   easing;
    tween_cb    cb;
    void        *userdata;
+   /* Position in the easing group, 0 while pending */
+   unsigned    index;
+   unsigned    easing;
+   unsigned    tag_prev;
+   /* Next free slot for free slots */
+   unsigned    tag_next;
+   unsigned    subject_prev;
+   unsigned    subject_next;
    bool        deleted;
 };
 
+struct tween_group
+{
+   float       *running_since;
+   float       *duration;
+   float       *initial_value;
+   /* target_value - initial_value */
+   float       *change;
+   float       *value;
+   /* NULL once killed while updating */
+   float       **subject;
+   unsigned    *slot;
+   size_t      count;
+   size_t      capacity;
+};
+
+/* A tween pushed while updating */
+struct tween_pending
+{
+   unsigned    slot;
+   float       duration;
+   float       initial_value;
+};
+
 DA_TYPEDEF(struct tween, tween_array_t)
+DA_TYPEDEF(struct tween_pending, tween_pending_array_t)
+DA_TYPEDEF(unsigned, tween_index_array_t)
 
 struct menu_animation
 {
-   tween_array_t list;
-   tween_array_t pending;
-   bool pending_deletes;
+   tween_array_t pool;
+   /* Tweens pushed while updating, added to
+    * their group once the update is done */
+   tween_pending_array_t pending;
+   /* Tweens finished or killed while updating */
+   tween_index_array_t dead;
+   struct tween_group groups[EASING_LAST];
+   unsigned tag_hash[TWEEN_HASH_SIZE];
+   unsigned subject_hash[TWEEN_HASH_SIZE];
+   unsigned free_slot;
+   size_t count;
    bool in_update;
 };
 
@@ -85,13 +139,14 @@ static float easing_in_out_quad(float t, float b, float c, float d)
 {
    t = t / d * 2;
    if (t < 1)
-      return c / 2 * pow(t, 2) + b;
+      return c / 2 * t * t + b;
    return -c / 2 * ((t - 1) * (t - 3) - 1) + b;
 }
 
 static float easing_in_quad(float t, float b, float c, float d)
 {
-   return c * pow(t / d, 2) + b;
+   t = t / d;
+   return c * t * t + b;
 }
 
 static float easing_out_quad(float t, float b, float c, float d)
@@ -109,12 +164,14 @@ static float easing_out_in_quad(float t, float b, float c, float d)
 
 static float easing_in_cubic(float t, float b, float c, float d)
 {
-   return c * pow(t / d, 3) + b;
+   t = t / d;
+   return c * t * t * t + b;
 }
 
 static float easing_out_cubic(float t, float b, float c, float d)
 {
-   return c * (pow(t / d - 1, 3) + 1) + b;
+   t = t / d - 1;
+   return c * (t * t * t + 1) + b;
 }
 
 static float easing_in_out_cubic(float t, float b, float c, float d)
@@ -135,20 +192,23 @@ static float easing_out_in_cubic(float t, float b, float c, float d)
 
 static float easing_in_quart(float t, float b, float c, float d)
 {
-   return c * pow(t / d, 4) + b;
+   t = t / d;
+   return c * t * t * t * t + b;
 }
 
 static float easing_out_quart(float t, float b, float c, float d)
 {
-   return -c * (pow(t / d - 1, 4) - 1) + b;
+   t = t / d - 1;
+   return -c * (t * t * t * t - 1) + b;
 }
 
 static float easing_in_out_quart(float t, float b, float c, float d)
 {
    t = t / d * 2;
    if (t < 1)
-      return c / 2 * pow(t, 4) + b;
-   return -c / 2 * (pow(t - 2, 4) - 2) + b;
+      return c / 2 * t * t * t * t + b;
+   t = t - 2;
+   return -c / 2 * (t * t * t * t - 2) + b;
 }
 
 static float easing_out_in_quart(float t, float b, float c, float d)
@@ -160,20 +220,23 @@ static float easing_out_in_quart(float t, float b, float c, float d)
 
 static float easing_in_quint(float t, float b, float c, float d)
 {
-   return c * pow(t / d, 5) + b;
+   t = t / d;
+   return c * t * t * t * t * t + b;
 }
 
 static float easing_out_quint(float t, float b, float c, float d)
 {
-   return c * (pow(t / d - 1, 5) + 1) + b;
+   t = t / d - 1;
+   return c * (t * t * t * t * t + 1) + b;
 }
 
 static float easing_in_out_quint(float t, float b, float c, float d)
 {
    t = t / d * 2;
    if (t < 1)
-      return c / 2 * pow(t, 5) + b;
-   return c / 2 * (pow(t - 2, 5) + 2) + b;
+      return c / 2 * t * t * t * t * t + b;
+   t = t - 2;
+   return c / 2 * (t * t * t * t * t + 2) + b;
 }
 
 static float easing_out_in_quint(float t, float b, float c, float d)
@@ -302,6 +365,97 @@ static float easing_out_in_bounce(float t, float b, float c, float d)
    return easing_in_bounce((t * 2) - d, b + c / 2, c / 2, d);
 }
 
+/* Applies an easing function to a whole group at once.
+ * With the easing function inlined and branches turned
+ * into selects, the compiler can vectorize the loop. */
+#define EASING_BATCH(name) \
+static void name##_batch(const float *t, const float *b, \
+      const float *c, const float *d, float *out, size_t count) \
+{ \
+   size_t i; \
+   for (i = 0; i < count; i++) \
+      out[i] = name(t[i], b[i], c[i], d[i]); \
+}
+
+EASING_BATCH(easing_linear)
+EASING_BATCH(easing_in_quad)
+EASING_BATCH(easing_out_quad)
+EASING_BATCH(easing_in_out_quad)
+EASING_BATCH(easing_out_in_quad)
+EASING_BATCH(easing_in_cubic)
+EASING_BATCH(easing_out_cubic)
+EASING_BATCH(easing_in_out_cubic)
+EASING_BATCH(easing_out_in_cubic)
+EASING_BATCH(easing_in_quart)
+EASING_BATCH(easing_out_quart)
+EASING_BATCH(easing_in_out_quart)
+EASING_BATCH(easing_out_in_quart)
+EASING_BATCH(easing_in_quint)
+EASING_BATCH(easing_out_quint)
+EASING_BATCH(easing_in_out_quint)
+EASING_BATCH(easing_out_in_quint)
+EASING_BATCH(easing_in_sine)
+EASING_BATCH(easing_out_sine)
+EASING_BATCH(easing_in_out_sine)
+EASING_BATCH(easing_out_in_sine)
+EASING_BATCH(easing_in_expo)
+EASING_BATCH(easing_out_expo)
+EASING_BATCH(easing_in_out_expo)
+EASING_BATCH(easing_out_in_expo)
+EASING_BATCH(easing_in_circ)
+EASING_BATCH(easing_out_circ)
+EASING_BATCH(easing_in_out_circ)
+EASING_BATCH(easing_out_in_circ)
+EASING_BATCH(easing_in_bounce)
+EASING_BATCH(easing_out_bounce)
+EASING_BATCH(easing_in_out_bounce)
+EASING_BATCH(easing_out_in_bounce)
+
+/* Indexed by enum menu_animation_easing_type */
+static const easing_batch_cb easing_batch[EASING_LAST] = {
+   easing_linear_batch,
+   /* Quad */
+   easing_in_quad_batch,
+   easing_out_quad_batch,
+   easing_in_out_quad_batch,
+   easing_out_in_quad_batch,
+   /* Cubic */
+   easing_in_cubic_batch,
+   easing_out_cubic_batch,
+   easing_in_out_cubic_batch,
+   easing_out_in_cubic_batch,
+   /* Quart */
+   easing_in_quart_batch,
+   easing_out_quart_batch,
+   easing_in_out_quart_batch,
+   easing_out_in_quart_batch,
+   /* Quint */
+   easing_in_quint_batch,
+   easing_out_quint_batch,
+   easing_in_out_quint_batch,
+   easing_out_in_quint_batch,
+   /* Sine */
+   easing_in_sine_batch,
+   easing_out_sine_batch,
+   easing_in_out_sine_batch,
+   easing_out_in_sine_batch,
+   /* Expo */
+   easing_in_expo_batch,
+   easing_out_expo_batch,
+   easing_in_out_expo_batch,
+   easing_out_in_expo_batch,
+   /* Circ */
+   easing_in_circ_batch,
+   easing_out_circ_batch,
+   easing_in_out_circ_batch,
+   easing_out_in_circ_batch,
+   /* Bounce */
+   easing_in_bounce_batch,
+   easing_out_bounce_batch,
+   easing_in_out_bounce_batch,
+   easing_out_in_bounce_batch
+};
+
 static void menu_animation_ticker_generic(uint64_t idx,
       size_t max_width, size_t *offset, size_t *width)
 {
@@ -384,16 +538,225 @@ static void menu_animation_ticker_loop(uint64_t idx,
    *width3  = width;
 }
 
+static unsigned menu_animation_hash(uintptr_t key)
+{
+   /* Tags and subjects are mostly pointers,
+    * so skip the alignment bits */
+   return (unsigned)(((uint32_t)(key >> 2) * 2654435769U)
+         >> (32 - TWEEN_HASH_BITS));
+}
+
+static bool menu_animation_group_reserve(struct tween_group *group,
+      size_t capacity)
+{
+   unsigned i;
+   unsigned *slot   = NULL;
+   float **subject  = NULL;
+   float **floats[5];
+
+   if (capacity <= group->capacity)
+      return true;
+
+   if (capacity < group->capacity * 2)
+      capacity = group->capacity * 2;
+   if (capacity < 16)
+      capacity = 16;
+
+   floats[0] = &group->running_since;
+   floats[1] = &group->duration;
+   floats[2] = &group->initial_value;
+   floats[3] = &group->change;
+   floats[4] = &group->value;
+
+   for (i = 0; i < ARRAY_SIZE(floats); i++)
+   {
+      float *tmp = (float*)realloc(*floats[i], capacity * sizeof(float));
+
+      if (!tmp)
+         return false;
+      *floats[i] = tmp;
+   }
+
+   subject = (float**)realloc(group->subject, capacity * sizeof(float*));
+
+   if (!subject)
+      return false;
+
+   group->subject  = subject;
+
+   slot = (unsigned*)realloc(group->slot, capacity * sizeof(unsigned));
+
+   if (!slot)
+      return false;
+
+   group->slot     = slot;
+   group->capacity = capacity;
+
+   return true;
+}
+
+static bool menu_animation_group_add(unsigned slot,
+      float duration, float initial_value)
+{
+   struct tween       *tween = &anim.pool.p[slot];
+   struct tween_group *group = &anim.groups[tween->easing];
+   size_t i                  = group->count;
+
+   if (!menu_animation_group_reserve(group, i + 1))
+      return false;
+
+   group->running_since[i] = 0;
+   group->duration[i]      = duration;
+   group->initial_value[i] = initial_value;
+   group->change[i]        = tween->target_value - initial_value;
+   group->value[i]         = initial_value;
+   group->subject[i]       = tween->subject;
+   group->slot[i]          = slot;
+   group->count++;
+
+   tween->index            = (unsigned)i + 1;
+   anim.count++;
+
+   return true;
+}
+
+static void menu_animation_group_remove(struct tween *tween)
+{
+   struct tween_group *group = &anim.groups[tween->easing];
+   size_t i                  = tween->index - 1;
+   size_t last               = --group->count;
+
+   /* Move the last tween of the group into the gap */
+   if (i != last)
+   {
+      group->running_since[i] = group->running_since[last];
+      group->duration[i]      = group->duration[last];
+      group->initial_value[i] = group->initial_value[last];
+      group->change[i]        = group->change[last];
+      group->value[i]         = group->value[last];
+      group->subject[i]       = group->subject[last];
+      group->slot[i]          = group->slot[last];
+
+      anim.pool.p[group->slot[i]].index = (unsigned)i + 1;
+   }
+
+   tween->index = 0;
+   anim.count--;
+}
+
+static void menu_animation_link(unsigned slot)
+{
+   struct tween *tween = &anim.pool.p[slot];
+   unsigned *tag_head  = &anim.tag_hash[
+      menu_animation_hash(tween->tag)];
+   unsigned *sub_head  = &anim.subject_hash[
+      menu_animation_hash((uintptr_t)tween->subject)];
+
+   tween->tag_prev     = 0;
+   tween->tag_next     = *tag_head;
+   if (*tag_head)
+      anim.pool.p[*tag_head - 1].tag_prev = slot + 1;
+   *tag_head           = slot + 1;
+
+   tween->subject_prev = 0;
+   tween->subject_next = *sub_head;
+   if (*sub_head)
+      anim.pool.p[*sub_head - 1].subject_prev = slot + 1;
+   *sub_head           = slot + 1;
+}
+
+static void menu_animation_unlink(unsigned slot)
+{
+   struct tween *tween = &anim.pool.p[slot];
+
+   if (tween->tag_prev)
+      anim.pool.p[tween->tag_prev - 1].tag_next = tween->tag_next;
+   else
+      anim.tag_hash[menu_animation_hash(tween->tag)] = tween->tag_next;
+   if (tween->tag_next)
+      anim.pool.p[tween->tag_next - 1].tag_prev = tween->tag_prev;
+
+   if (tween->subject_prev)
+      anim.pool.p[tween->subject_prev - 1].subject_next =
+         tween->subject_next;
+   else
+      anim.subject_hash[menu_animation_hash(
+            (uintptr_t)tween->subject)] = tween->subject_next;
+   if (tween->subject_next)
+      anim.pool.p[tween->subject_next - 1].subject_prev =
+         tween->subject_prev;
+}
+
+/* Returns the slot to the pool. */
+static void menu_animation_release(unsigned slot)
+{
+   struct tween *tween = &anim.pool.p[slot];
+
+   if (tween->index)
+      menu_animation_group_remove(tween);
+
+   menu_animation_unlink(slot);
+
+   tween->subject  = NULL;
+   tween->cb       = NULL;
+   tween->userdata = NULL;
+   tween->deleted  = true;
+   tween->tag_next = anim.free_slot;
+   anim.free_slot  = slot + 1;
+}
+
+/* While updating, the groups must stay as they are,
+ * so killed tweens are only released afterwards. */
+static void menu_animation_kill(unsigned slot)
+{
+   struct tween *tween = &anim.pool.p[slot];
+
+   if (tween->deleted)
+      return;
+
+   if (anim.in_update)
+   {
+      if (tween->index)
+         anim.groups[tween->easing].subject[tween->index - 1] = NULL;
+      tween->deleted = true;
+      da_push(anim.dead, slot);
+   }
+   else
+      menu_animation_release(slot);
+}
+
+static void menu_animation_clear(void)
+{
+   unsigned i;
+
+   for (i = 0; i < EASING_LAST; i++)
+   {
+      struct tween_group *group = &anim.groups[i];
+
+      free(group->running_since);
+      free(group->duration);
+      free(group->initial_value);
+      free(group->change);
+      free(group->value);
+      free(group->subject);
+      free(group->slot);
+   }
+
+   da_free(anim.pool);
+   da_free(anim.pending);
+   da_free(anim.dead);
+
+   memset(&anim, 0, sizeof(menu_animation_t));
+}
+
 void menu_animation_init(void)
 {
-   da_init(anim.list);
-   da_init(anim.pending);
+   memset(&anim, 0, sizeof(menu_animation_t));
 }
 
 void menu_animation_free(void)
 {
-   da_free(anim.list);
-   da_free(anim.pending);
+   menu_animation_clear();
 }
 
 static void menu_delayed_animation_cb(void *userdata)
@@ -421,142 +784,59 @@ void menu_animation_push_delayed(unsigned delay, menu_animation_ctx_entry_t *ent
 
 bool menu_animation_push(menu_animation_ctx_entry_t *entry)
 {
-   struct tween t;
+   unsigned slot;
+   struct tween *tween = NULL;
+   float initial_value = *entry->subject;
 
-   t.duration           = entry->duration;
-   t.running_since      = 0;
-   t.initial_value      = *entry->subject;
-   t.target_value       = entry->target_value;
-   t.subject            = entry->subject;
-   t.tag                = entry->tag;
-   t.cb                 = entry->cb;
-   t.userdata           = entry->userdata;
-   t.easing             = NULL;
-   t.deleted            = false;
+   /* ignore born dead tweens */
+   if (     (unsigned)entry->easing_enum >= EASING_LAST
+         || entry->duration == 0
+         || initial_value == entry->target_value)
+      return false;
 
-   switch (entry->easing_enum)
+   if (anim.free_slot)
    {
-      case EASING_LINEAR:
-         t.easing       = &easing_linear;
-         break;
-         /* Quad */
-      case EASING_IN_QUAD:
-         t.easing       = &easing_in_quad;
-         break;
-      case EASING_OUT_QUAD:
-         t.easing       = &easing_out_quad;
-         break;
-      case EASING_IN_OUT_QUAD:
-         t.easing       = &easing_in_out_quad;
-         break;
-      case EASING_OUT_IN_QUAD:
-         t.easing       = &easing_out_in_quad;
-         break;
-         /* Cubic */
-      case EASING_IN_CUBIC:
-         t.easing       = &easing_in_cubic;
-         break;
-      case EASING_OUT_CUBIC:
-         t.easing       = &easing_out_cubic;
-         break;
-      case EASING_IN_OUT_CUBIC:
-         t.easing       = &easing_in_out_cubic;
-         break;
-      case EASING_OUT_IN_CUBIC:
-         t.easing       = &easing_out_in_cubic;
-         break;
-         /* Quart */
-      case EASING_IN_QUART:
-         t.easing       = &easing_in_quart;
-         break;
-      case EASING_OUT_QUART:
-         t.easing       = &easing_out_quart;
-         break;
-      case EASING_IN_OUT_QUART:
-         t.easing       = &easing_in_out_quart;
-         break;
-      case EASING_OUT_IN_QUART:
-         t.easing       = &easing_out_in_quart;
-         break;
-         /* Quint */
-      case EASING_IN_QUINT:
-         t.easing       = &easing_in_quint;
-         break;
-      case EASING_OUT_QUINT:
-         t.easing       = &easing_out_quint;
-         break;
-      case EASING_IN_OUT_QUINT:
-         t.easing       = &easing_in_out_quint;
-         break;
-      case EASING_OUT_IN_QUINT:
-         t.easing       = &easing_out_in_quint;
-         break;
-         /* Sine */
-      case EASING_IN_SINE:
-         t.easing       = &easing_in_sine;
-         break;
-      case EASING_OUT_SINE:
-         t.easing       = &easing_out_sine;
-         break;
-      case EASING_IN_OUT_SINE:
-         t.easing       = &easing_in_out_sine;
-         break;
-      case EASING_OUT_IN_SINE:
-         t.easing       = &easing_out_in_sine;
-         break;
-         /* Expo */
-      case EASING_IN_EXPO:
-         t.easing       = &easing_in_expo;
-         break;
-      case EASING_OUT_EXPO:
-         t.easing       = &easing_out_expo;
-         break;
-      case EASING_IN_OUT_EXPO:
-         t.easing       = &easing_in_out_expo;
-         break;
-      case EASING_OUT_IN_EXPO:
-         t.easing       = &easing_out_in_expo;
-         break;
-         /* Circ */
-      case EASING_IN_CIRC:
-         t.easing       = &easing_in_circ;
-         break;
-      case EASING_OUT_CIRC:
-         t.easing       = &easing_out_circ;
-         break;
-      case EASING_IN_OUT_CIRC:
-         t.easing       = &easing_in_out_circ;
-         break;
-      case EASING_OUT_IN_CIRC:
-         t.easing       = &easing_out_in_circ;
-         break;
-         /* Bounce */
-      case EASING_IN_BOUNCE:
-         t.easing       = &easing_in_bounce;
-         break;
-      case EASING_OUT_BOUNCE:
-         t.easing       = &easing_out_bounce;
-         break;
-      case EASING_IN_OUT_BOUNCE:
-         t.easing       = &easing_in_out_bounce;
-         break;
-      case EASING_OUT_IN_BOUNCE:
-         t.easing       = &easing_out_in_bounce;
-         break;
-      default:
-         break;
+      slot           = anim.free_slot - 1;
+      anim.free_slot = anim.pool.p[slot].tag_next;
    }
+   else
+   {
+      struct tween *added = da_addn_uninit(anim.pool, 1);
 
-   /* ignore born dead tweens */
-   if (!t.easing || t.duration == 0 || t.initial_value == t.target_value)
-      return false;
+      if (!added)
+         return false;
+      slot           = (unsigned)(added - anim.pool.p);
+   }
+
+   tween               = &anim.pool.p[slot];
+   tween->target_value = entry->target_value;
+   tween->subject      = entry->subject;
+   tween->tag          = entry->tag;
+   tween->cb           = entry->cb;
+   tween->userdata     = entry->userdata;
+   tween->index        = 0;
+   tween->easing       = entry->easing_enum;
+   tween->deleted      = false;
+
+   menu_animation_link(slot);
 
    if (anim.in_update)
-      da_push(anim.pending, t);
-   else
-      da_push(anim.list, t);
+   {
+      struct tween_pending *pending = da_addn_uninit(anim.pending, 1);
 
-   return true;
+      if (pending)
+      {
+         pending->slot          = slot;
+         pending->duration      = entry->duration;
+         pending->initial_value = initial_value;
+         return true;
+      }
+   }
+   else if (menu_animation_group_add(slot, entry->duration, initial_value))
+      return true;
+
+   menu_animation_release(slot);
+   return false;
 }
 
 static void menu_animation_update_time(bool timedate_enable)
@@ -604,58 +884,76 @@ static void menu_animation_update_time(bool timedate_enable)
 bool menu_animation_update(void)
 {
    unsigned i;
+   size_t j;
    settings_t *settings = config_get_ptr();
 
    menu_animation_update_time(settings->bools.menu_timedate_enable);
 
-   anim.in_update       = true;
-   anim.pending_deletes = false;
+   anim.in_update = true;
 
-   for(i = 0; i < da_count(anim.list); i++)
+   for (i = 0; i < EASING_LAST; i++)
    {
-      struct tween *tween   = da_getptr(anim.list, i);
-      tween->running_since += delta_time;
+      struct tween_group *group = &anim.groups[i];
+
+      if (!group->count)
+         continue;
 
-      *tween->subject = tween->easing(
-            tween->running_since,
-            tween->initial_value,
-            tween->target_value - tween->initial_value,
-            tween->duration);
+      for (j = 0; j < group->count; j++)
+         group->running_since[j] += delta_time;
 
-      if (tween->running_since >= tween->duration)
+      easing_batch[i](group->running_since, group->initial_value,
+            group->change, group->duration, group->value, group->count);
+
+      for (j = 0; j < group->count; j++)
       {
+         tween_cb cb;
+         void *userdata;
+         struct tween *tween = NULL;
+
+         if (!group->subject[j])
+            continue;
+
+         if (group->running_since[j] < group->duration[j])
+         {
+            *group->subject[j] = group->value[j];
+            continue;
+         }
+
+         tween           = &anim.pool.p[group->slot[j]];
          *tween->subject = tween->target_value;
+         cb              = tween->cb;
+         userdata        = tween->userdata;
 
-         if (tween->cb)
-            tween->cb(tween->userdata);
+         menu_animation_kill(group->slot[j]);
 
-         da_delete(anim.list, i);
-         i--;
+         if (cb)
+            cb(userdata);
       }
    }
 
-   if (anim.pending_deletes)
+   for (j = 0; j < da_count(anim.pending); j++)
    {
-      for(i = 0; i < da_count(anim.list); i++)
+      struct tween_pending *pending = da_getptr(anim.pending, j);
+
+      if (anim.pool.p[pending->slot].deleted)
+         continue;
+
+      if (!menu_animation_group_add(pending->slot,
+               pending->duration, pending->initial_value))
       {
-         struct tween *tween = da_getptr(anim.list, i);
-         if (tween->deleted)
-         {
-            da_delete(anim.list, i);
-            i--;
-         }
+         anim.pool.p[pending->slot].deleted = true;
+         da_push(anim.dead, pending->slot);
       }
-      anim.pending_deletes = false;
    }
 
-   if (da_count(anim.pending) > 0)
-   {
-      da_addn(anim.list, anim.pending.p, da_count(anim.pending));
-      da_clear(anim.pending);
-   }
+   for (j = 0; j < da_count(anim.dead); j++)
+      menu_animation_release(da_get(anim.dead, j));
+
+   da_clear(anim.pending);
+   da_clear(anim.dead);
 
    anim.in_update      = false;
-   animation_is_active = da_count(anim.list) > 0;
+   animation_is_active = anim.count > 0;
 
    return animation_is_active;
 }
@@ -780,22 +1078,15 @@ bool menu_animation_kill_by_tag(menu_animation_ctx_tag *tag)
    if (!tag || *tag == (uintptr_t)-1)
       return false;
 
-   for (i = 0; i < da_count(anim.list); ++i)
+   for (i = anim.tag_hash[menu_animation_hash(*tag)]; i; )
    {
-      struct tween *t = da_getptr(anim.list, i);
-      if (t->tag != *tag)
-         continue;
+      struct tween *t = &anim.pool.p[i - 1];
+      unsigned next   = t->tag_next;
 
-      if (anim.in_update)
-      {
-         t->deleted = true;
-         anim.pending_deletes = true;
-      }
-      else
-      {
-         da_delete(anim.list, i);
-         --i;
-      }
+      if (t->tag == *tag)
+         menu_animation_kill(i - 1);
+
+      i = next;
    }
 
    return true;
@@ -803,31 +1094,21 @@ bool menu_animation_kill_by_tag(menu_animation_ctx_tag *tag)
 
 void menu_animation_kill_by_subject(menu_animation_ctx_subject_t *subject)
 {
-   unsigned i, j,  killed = 0;
-   float            **sub = (float**)subject->data;
+   unsigned i, j;
+   float **sub = (float**)subject->data;
 
-   for (i = 0; i < da_count(anim.list) && killed < subject->count; ++i)
+   for (j = 0; j < subject->count; ++j)
    {
-      struct tween *t = da_getptr(anim.list, i);
-
-      for (j = 0; j < subject->count; ++j)
+      for (i = anim.subject_hash[menu_animation_hash(
+               (uintptr_t)sub[j])]; i; )
       {
-         if (t->subject != sub[j])
-            continue;
+         struct tween *t = &anim.pool.p[i - 1];
+         unsigned next   = t->subject_next;
 
-         if (anim.in_update)
-         {
-            t->deleted = true;
-            anim.pending_deletes = true;
-         }
-         else
-         {
-            da_delete(anim.list, i);
-            --i;
-         }
+         if (t->subject == sub[j])
+            menu_animation_kill(i - 1);
 
-         killed++;
-         break;
+         i = next;
       }
    }
 }
@@ -842,20 +1123,7 @@ bool menu_animation_ctl(enum menu_animation_ctl_state state, void *data)
    switch (state)
    {
       case MENU_ANIMATION_CTL_DEINIT:
-         {
-            size_t i;
-
-            for (i = 0; i < da_count(anim.list); i++)
-            {
-               struct tween *t = da_getptr(anim.list, i);
-               if (t->subject)
-                  t->subject = NULL;
-            }
-
-            da_free(anim.list);
-
-            memset(&anim, 0, sizeof(menu_animation_t));
-         }
+         menu_animation_clear();
          cur_time                  = 0;
          old_time                  = 0;
          delta_time                = 0.0f;
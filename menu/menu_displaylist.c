@@ -188,7 +188,7 @@ static int menu_displaylist_parse_core_info(menu_displaylist_info_t *info)
 
    core_info_get_current_core(&core_info);
 
-   if (!core_info || !core_info->config_data)
+   if (!core_info || !core_info->has_info)
    {
       menu_entries_append_enum(info->list,
             msg_hash_to_str(MENU_ENUM_LABEL_VALUE_NO_CORE_INFORMATION_AVAILABLE),
@@ -1317,29 +1317,118 @@ static int menu_displaylist_parse_system_info(menu_displaylist_info_t *info)
    return 0;
 }
 
+typedef struct menu_displaylist_playlist_source
+{
+   playlist_t *playlist;
+   /* Whether the playlist is the cached one, which goes
+    * away once another playlist gets cached */
+   bool is_cached;
+   bool is_collection;
+   char path_playlist[PATH_MAX_LENGTH];
+   char label_spacer[PL_LABEL_SPACER_MAXLEN];
+} menu_displaylist_playlist_source_t;
+
+static bool menu_displaylist_playlist_get_entry(void *data,
+      size_t entry_idx, unsigned type,
+      char *s, size_t len, char *s2, size_t len2,
+      enum msg_hash_enums *enum_idx)
+{
+   const char *path                           = NULL;
+   const char *label                          = NULL;
+   const char *core_name                      = NULL;
+   menu_displaylist_playlist_source_t *source =
+      (menu_displaylist_playlist_source_t*)data;
+   settings_t *settings                       = config_get_ptr();
+
+   if (source->is_cached && playlist_get_cached() != source->playlist)
+      return false;
+
+   if (entry_idx >= playlist_size(source->playlist))
+      return false;
+
+   playlist_get_index(source->playlist, entry_idx,
+         &path, &label, NULL, &core_name, NULL, NULL);
+
+   *enum_idx = MENU_ENUM_LABEL_PLAYLIST_ENTRY;
+
+   if (!string_is_empty(path))
+   {
+      /* Standard playlist entry
+       * > Base menu entry label is always playlist label
+       *   > If playlist label is NULL, fallback to playlist entry file name
+       * > If playlist sublabels are enabled, no further additions
+       *   are required
+       * > If playlist sublabels are disabled:
+       *   > If this is *not* a standard collection (i.e. a history list or
+       *     favourites) *or* 'show core name' is enabled, add currently
+       *     associated core (if set) */
+
+      if (string_is_empty(label))
+         fill_short_pathname_representation(s, path, len);
+      else
+         strlcpy(s, label, len);
+
+      if (!settings->bools.playlist_show_sublabels)
+      {
+         if (!source->is_collection || settings->bools.playlist_show_core_name)
+         {
+            if (!string_is_empty(core_name) && !string_is_equal(core_name, file_path_str(FILE_PATH_DETECT)))
+            {
+               strlcat(s, source->label_spacer, len);
+               strlcat(s, core_name, len);
+            }
+         }
+      }
+
+      strlcpy(s2, path, len2);
+   }
+   else
+   {
+      if (core_name)
+         strlcpy(s, core_name, len);
+
+      strlcpy(s2, source->path_playlist, len2);
+   }
+
+   return true;
+}
+
 static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
       playlist_t *playlist, const char *path_playlist, bool is_collection)
 {
    unsigned i;
+   menu_entries_virtual_source_t virtual_source;
    size_t selection = menu_navigation_get_selection();
    size_t list_size = playlist_size(playlist);
    settings_t *settings = config_get_ptr();
    bool is_rgui = string_is_equal(settings->arrays.menu_driver, "rgui");
    bool get_runtime = string_is_equal(path_playlist, "history") && g_defaults.content_runtime && settings->bools.content_runtime_log;
-   char label_spacer[PL_LABEL_SPACER_MAXLEN];
-
-   label_spacer[0] = '\0';
+   bool is_virtual  = false;
+   menu_displaylist_playlist_source_t *source = NULL;
 
    if (list_size == 0)
       goto error;
 
+   source = (menu_displaylist_playlist_source_t*)
+      calloc(1, sizeof(*source));
+
+   if (!source)
+      goto error;
+
+   source->playlist      = playlist;
+   source->is_cached     = playlist == playlist_get_cached();
+   source->is_collection = is_collection;
+
+   strlcpy(source->path_playlist, path_playlist,
+         sizeof(source->path_playlist));
+
    /* Get spacer for menu entry labels (<content><spacer><core>) */
    if (is_rgui)
-      strlcpy(label_spacer, PL_LABEL_SPACER_RGUI, sizeof(label_spacer));
+      strlcpy(source->label_spacer, PL_LABEL_SPACER_RGUI, sizeof(source->label_spacer));
    else if (string_is_equal(settings->arrays.menu_driver, "ozone"))
-      strlcpy(label_spacer, PL_LABEL_SPACER_OZONE, sizeof(label_spacer));
+      strlcpy(source->label_spacer, PL_LABEL_SPACER_OZONE, sizeof(source->label_spacer));
    else
-      strlcpy(label_spacer, PL_LABEL_SPACER_DEFAULT, sizeof(label_spacer));
+      strlcpy(source->label_spacer, PL_LABEL_SPACER_DEFAULT, sizeof(source->label_spacer));
 
    /* Inform menu driver of current system name */
    if (!string_is_empty(info->path))
@@ -1351,22 +1440,29 @@ static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
       menu_driver_set_thumbnail_system(lpl_basename, sizeof(lpl_basename));
    }
 
+   /* Entries are only built around the selection if the
+    * menu driver can do that, the rest is read from the
+    * playlist when needed */
+   virtual_source.data = source;
+   virtual_source.get  = menu_displaylist_playlist_get_entry;
+   virtual_source.free = free;
+
+   is_virtual          = menu_entries_virtual_begin(info->list,
+         &virtual_source);
+
    /* Preallocate the file list */
-   file_list_reserve(info->list, list_size);
+   file_list_reserve(info->list, info->list->size + list_size);
 
    for (i = 0; i < list_size; i++)
    {
-      char menu_entry_label[PATH_MAX_LENGTH];
       const char *path                = NULL;
       const char *label               = NULL;
       const char *core_path           = NULL;
-      const char *core_name           = NULL;
-
-      menu_entry_label[0] = '\0';
+      unsigned type                   = FILE_TYPE_PLAYLIST_ENTRY;
 
       /* Read playlist entry */
       playlist_get_index(playlist, i,
-            &path, &label, &core_path, &core_name, NULL, NULL);
+            &path, &label, &core_path, NULL, NULL, NULL);
 
       /* If this is the content history playlist and runtime logging
        * is enabled, extract any available runtime values */
@@ -1416,49 +1512,33 @@ static int menu_displaylist_parse_playlist(menu_displaylist_info_t *info,
       }
 
       if (!string_is_empty(path))
-      {
-         /* Standard playlist entry
-          * > Base menu entry label is always playlist label
-          *   > If playlist label is NULL, fallback to playlist entry file name
-          * > If playlist sublabels are enabled, no further additions
-          *   are required
-          * > If playlist sublabels are disabled:
-          *   > If this is *not* a standard collection (i.e. a history list or
-          *     favourites) *or* 'show core name' is enabled, add currently
-          *     associated core (if set) */
-
-         if (string_is_empty(label))
-            fill_short_pathname_representation(menu_entry_label, path, sizeof(menu_entry_label));
-         else
-            strlcpy(menu_entry_label, label, sizeof(menu_entry_label));
+         type = FILE_TYPE_RPL_ENTRY;
 
-         if (!settings->bools.playlist_show_sublabels)
-         {
-            if (!is_collection || settings->bools.playlist_show_core_name)
-            {
-               if (!string_is_empty(core_name) && !string_is_equal(core_name, file_path_str(FILE_PATH_DETECT)))
-               {
-                  strlcat(menu_entry_label, label_spacer, sizeof(menu_entry_label));
-                  strlcat(menu_entry_label, core_name, sizeof(menu_entry_label));
-               }
-            }
-         }
-
-         menu_entries_append_enum(info->list, menu_entry_label, path,
-               MENU_ENUM_LABEL_PLAYLIST_ENTRY, FILE_TYPE_RPL_ENTRY, 0, i);
-      }
+      if (is_virtual)
+         menu_entries_append_virtual(info->list, type, i);
       else
       {
-         if (core_name)
-            strlcpy(menu_entry_label, core_name, sizeof(menu_entry_label));
+         char menu_entry_label[PATH_MAX_LENGTH];
+         char menu_entry_path[PATH_MAX_LENGTH];
+         enum msg_hash_enums enum_idx = MSG_UNKNOWN;
 
-         menu_entries_append_enum(info->list, menu_entry_label, path_playlist,
-               MENU_ENUM_LABEL_PLAYLIST_ENTRY, FILE_TYPE_PLAYLIST_ENTRY, 0, i);
+         menu_entry_label[0] = '\0';
+         menu_entry_path[0]  = '\0';
+
+         menu_displaylist_playlist_get_entry(source, i, type,
+               menu_entry_label, sizeof(menu_entry_label),
+               menu_entry_path, sizeof(menu_entry_path), &enum_idx);
+
+         menu_entries_append_enum(info->list, menu_entry_label,
+               menu_entry_path, enum_idx, type, 0, i);
       }
 
       info->count++;
    }
 
+   if (!is_virtual)
+      free(source);
+
    return 0;
 
 error:
@@ -2121,7 +2201,9 @@ static int menu_database_parse_query(file_list_t *list, const char *path,
       const char *query)
 {
    unsigned i;
-   database_info_list_t *db_list = database_info_list_new(path, query);
+   static const char *fields[]   = { "name" };
+   database_info_list_t *db_list = database_info_list_new_fields(
+         path, query, fields, ARRAY_SIZE(fields));
 
    if (!db_list)
       return -1;
@@ -3020,7 +3102,7 @@ static int menu_displaylist_parse_information_list(
           !string_is_equal(system->library_name,
              msg_hash_to_str(MENU_ENUM_LABEL_VALUE_NO_CORE))
          )
-         && core_info && core_info->config_data
+         && core_info && core_info->has_info
       )
       menu_entries_append_enum(info->list,
             msg_hash_to_str(MENU_ENUM_LABEL_VALUE_CORE_INFORMATION),
@@ -4255,7 +4337,8 @@ bool menu_displaylist_process(menu_displaylist_info_t *info)
       menu_entries_ctl(MENU_ENTRIES_CTL_SET_REFRESH, &refresh);
    }
 
-   if (info->need_sort)
+   /* Virtual lists come in the order of their source */
+   if (info->need_sort && !menu_entries_is_virtual(info->list))
       file_list_sort_on_alt(info->list);
 
 #if defined(HAVE_NETWORKING)
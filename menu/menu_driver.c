@@ -25,6 +25,7 @@
 #include <streams/file_stream.h>
 #include <string/stdstring.h>
 #include <encodings/utf.h>
+#include <features/features_cpu.h>
 
 #ifdef WIIU
 #include <wiiu/os/energy.h>
@@ -50,7 +51,10 @@
 #include "menu_input.h"
 #include "menu_entries.h"
 #include "widgets/menu_dialog.h"
+#include "widgets/menu_input_dialog.h"
+#include "widgets/menu_filebrowser.h"
 #include "menu_shader.h"
+#include "menu_thumbnail_cache.h"
 
 #include "../config.def.h"
 #include "../content.h"
@@ -165,6 +169,14 @@ uintptr_t menu_display_white_texture;
 
 static video_coord_array_t menu_disp_ca;
 
+/* Quads collected between menu_display_batch_begin()
+ * and menu_display_batch_end(), in normalized screen
+ * coordinates, all using menu_disp_batch_texture. */
+static video_coord_array_t menu_disp_batch_ca;
+static video_frame_info_t *menu_disp_batch_info  = NULL;
+static uintptr_t menu_disp_batch_texture         = 0;
+static menu_display_draw_stats_t menu_disp_stats;
+
 static enum
 menu_toggle_reason menu_display_toggle_reason    = MENU_TOGGLE_REASON_NONE;
 
@@ -183,6 +195,29 @@ static bool menu_display_framebuf_dirty          = false;
 static const uint8_t *menu_display_font_framebuf = NULL;
 static menu_display_ctx_driver_t *menu_disp      = NULL;
 
+/* Redraw at least this often while idle, in microseconds,
+ * for the clock and battery level. */
+#define MENU_IDLE_REDRAW_INTERVAL 1000000
+
+/* Unchanged frames still drawn before the menu counts as
+ * idle, so every buffer of the swapchain and any OSD
+ * message that just expired are up to date. */
+#define MENU_IDLE_FRAMES          3
+
+static unsigned menu_idle_frames                = 0;
+static retro_time_t menu_idle_last_redraw       = 0;
+static unsigned menu_idle_width                 = 0;
+static unsigned menu_idle_height                = 0;
+static int16_t menu_idle_mouse_x                = 0;
+static int16_t menu_idle_mouse_y                = 0;
+static int16_t menu_idle_pointer_x              = 0;
+static int16_t menu_idle_pointer_y              = 0;
+static enum menu_action menu_idle_action        = MENU_ACTION_NOOP;
+static bool menu_idle_skip                      = false;
+/* Set when something the menu draws changed behind its
+ * back, like an image that finished loading */
+static bool menu_idle_damaged                   = false;
+
 /* when enabled, on next iteration the 'Quick Menu' list will
  * be pushed onto the stack */
 static bool menu_driver_pending_quick_menu      = false;
@@ -413,9 +448,145 @@ void menu_display_timedate(menu_display_ctx_datetime_t *datetime)
    }
 }
 
+/* Draws the quads collected so far in a single call. */
+static void menu_display_batch_flush(void)
+{
+   menu_display_ctx_draw_t draw;
+   struct video_coords coords;
+   video_frame_info_t *video_info = menu_disp_batch_info;
+
+   if (!video_info || !menu_disp || !menu_disp_batch_ca.coords.vertices)
+      return;
+
+   coords.vertex        = menu_disp_batch_ca.coords.vertex;
+   coords.color         = menu_disp_batch_ca.coords.color;
+   coords.tex_coord     = menu_disp_batch_ca.coords.tex_coord;
+   coords.lut_tex_coord = menu_disp_batch_ca.coords.lut_tex_coord;
+   coords.vertices      = menu_disp_batch_ca.coords.vertices;
+   coords.index         = NULL;
+   coords.indexes       = 0;
+
+   draw.x               = 0;
+   draw.y               = 0;
+   draw.width           = video_info->width;
+   draw.height          = video_info->height;
+   draw.coords          = &coords;
+   draw.matrix_data     = NULL;
+   draw.texture         = menu_disp_batch_texture;
+   draw.prim_type       = MENU_DISPLAY_PRIM_TRIANGLES;
+   draw.pipeline.id     = 0;
+
+   menu_disp->draw(&draw, video_info);
+
+   menu_disp_stats.draw_calls++;
+   menu_disp_stats.batched_quads += coords.vertices / 6 - 1;
+
+   menu_disp_batch_ca.coords.vertices = 0;
+}
+
+/* Adds a textured quad to the batch, transforming it
+ * to where the display driver would have drawn it.
+ *
+ * Returns: true if the quad was added, false if it has
+ * to be drawn on its own. */
+static bool menu_display_batch_add(menu_display_ctx_draw_t *draw)
+{
+   /* Triangle list order of a 4 vertex triangle strip */
+   static const unsigned strip_to_list[6] = { 0, 1, 2, 2, 1, 3 };
+   unsigned i;
+   float vertex[6 * 2];
+   float tex_coord[6 * 2];
+   float color[6 * 4];
+   float pos[4 * 2];
+   struct video_coords coords;
+   const math_matrix_4x4 *mat     = NULL;
+   const float *src_vertex        = NULL;
+   const float *src_tex_coord     = NULL;
+   video_frame_info_t *video_info = menu_disp_batch_info;
+
+   if (
+         !video_info                                  ||
+         !draw->coords                                ||
+         draw->coords->vertices != 4                  ||
+         !draw->coords->color                         ||
+         draw->prim_type != MENU_DISPLAY_PRIM_TRIANGLESTRIP ||
+         !video_info->width || !video_info->height
+      )
+      return false;
+
+   mat           = (const math_matrix_4x4*)(draw->matrix_data
+         ? draw->matrix_data : menu_disp->get_default_mvp(video_info));
+   src_vertex    = draw->coords->vertex
+      ? draw->coords->vertex : menu_disp->get_default_vertices();
+   src_tex_coord = draw->coords->tex_coord
+      ? draw->coords->tex_coord : menu_disp->get_default_tex_coords();
+
+   if (!mat || !src_vertex || !src_tex_coord)
+      return false;
+
+   for (i = 0; i < 4; i++)
+   {
+      float x = src_vertex[i * 2 + 0];
+      float y = src_vertex[i * 2 + 1];
+      float w = MAT_ELEM_4X4(*mat, 3, 0) * x
+         + MAT_ELEM_4X4(*mat, 3, 1) * y + MAT_ELEM_4X4(*mat, 3, 3);
+      float cx, cy;
+
+      if (w == 0.0f)
+         return false;
+
+      cx = (MAT_ELEM_4X4(*mat, 0, 0) * x
+            + MAT_ELEM_4X4(*mat, 0, 1) * y + MAT_ELEM_4X4(*mat, 0, 3)) / w;
+      cy = (MAT_ELEM_4X4(*mat, 1, 0) * x
+            + MAT_ELEM_4X4(*mat, 1, 1) * y + MAT_ELEM_4X4(*mat, 1, 3)) / w;
+
+      /* Drawn on its own, anything outside the quad's
+       * viewport would be clipped away. */
+      if (cx < -1.001f || cx > 1.001f || cy < -1.001f || cy > 1.001f)
+         return false;
+
+      /* Clip space of the quad's viewport to
+       * normalized coordinates of the whole screen. */
+      pos[i * 2 + 0] = (draw->x + (cx + 1.0f) * 0.5f * draw->width)
+         / video_info->width;
+      pos[i * 2 + 1] = (draw->y + (cy + 1.0f) * 0.5f * draw->height)
+         / video_info->height;
+   }
+
+   for (i = 0; i < 6; i++)
+   {
+      unsigned j          = strip_to_list[i];
+
+      vertex[i * 2 + 0]    = pos[j * 2 + 0];
+      vertex[i * 2 + 1]    = pos[j * 2 + 1];
+      tex_coord[i * 2 + 0] = src_tex_coord[j * 2 + 0];
+      tex_coord[i * 2 + 1] = src_tex_coord[j * 2 + 1];
+      memcpy(&color[i * 4], &draw->coords->color[j * 4],
+            4 * sizeof(float));
+   }
+
+   if (draw->texture != menu_disp_batch_texture)
+      menu_display_batch_flush();
+
+   coords.vertex           = vertex;
+   coords.color            = color;
+   coords.tex_coord        = tex_coord;
+   coords.lut_tex_coord    = tex_coord;
+   coords.vertices         = 6;
+
+   if (!video_coord_array_append(&menu_disp_batch_ca, &coords, 6))
+      return false;
+
+   menu_disp_batch_texture = draw->texture;
+
+   return true;
+}
+
 /* Begin blending operation */
 void menu_display_blend_begin(video_frame_info_t *video_info)
 {
+   menu_display_batch_flush();
+
    if (menu_disp && menu_disp->blend_begin)
       menu_disp->blend_begin(video_info);
 }
@@ -423,6 +594,8 @@ void menu_display_blend_begin(video_frame_info_t *video_info)
 /* End blending operation */
 void menu_display_blend_end(video_frame_info_t *video_info)
 {
+   menu_display_batch_flush();
+
    if (menu_disp && menu_disp->blend_end)
       menu_disp->blend_end(video_info);
 }
@@ -430,6 +603,8 @@ void menu_display_blend_end(video_frame_info_t *video_info)
 /* Begin scissoring operation */
 void menu_display_scissor_begin(video_frame_info_t *video_info, int x, int y, unsigned width, unsigned height)
 {
+   menu_display_batch_flush();
+
    if (menu_disp && menu_disp->scissor_begin)
       menu_disp->scissor_begin(video_info, x, y, width, height);
 }
@@ -437,6 +612,8 @@ void menu_display_scissor_begin(video_frame_info_t *video_info, int x, int y, un
 /* End scissoring operation */
 void menu_display_scissor_end(video_frame_info_t *video_info)
 {
+   menu_display_batch_flush();
+
    if (menu_disp && menu_disp->scissor_end)
       menu_disp->scissor_end(video_info);
 }
@@ -629,11 +806,13 @@ bool menu_display_get_update_pending(void)
 
 void menu_display_set_viewport(unsigned width, unsigned height)
 {
+   menu_display_batch_flush();
    video_driver_set_viewport(width, height, true, false);
 }
 
 void menu_display_unset_viewport(unsigned width, unsigned height)
 {
+   menu_display_batch_flush();
    video_driver_set_viewport(width, height, false, true);
 }
 
@@ -728,6 +907,8 @@ bool menu_display_restore_clear_color(void)
 void menu_display_clear_color(menu_display_ctx_clearcolor_t *color,
       video_frame_info_t *video_info)
 {
+   menu_display_batch_flush();
+
    if (menu_disp && menu_disp->clear_color)
       menu_disp->clear_color(color, video_info);
 }
@@ -742,14 +923,48 @@ void menu_display_draw(menu_display_ctx_draw_t *draw,
    if (draw->height <= 0)
       draw->height = 1;
 
+   if (menu_display_batch_add(draw))
+      return;
+
+   menu_display_batch_flush();
+
    menu_disp->draw(draw, video_info);
+   menu_disp_stats.draw_calls++;
 }
 
 void menu_display_draw_pipeline(menu_display_ctx_draw_t *draw,
       video_frame_info_t *video_info)
 {
+   menu_display_batch_flush();
+
    if (menu_disp && draw && menu_disp->draw_pipeline)
+   {
       menu_disp->draw_pipeline(draw, video_info);
+      menu_disp_stats.draw_calls++;
+   }
+}
+
+void menu_display_batch_begin(video_frame_info_t *video_info)
+{
+   if (!menu_disp || !menu_disp->supports_batching || !video_info)
+      return;
+
+   menu_display_batch_flush();
+
+   menu_disp_batch_info = video_info;
+}
+
+void menu_display_batch_end(video_frame_info_t *video_info)
+{
+   menu_display_batch_flush();
+
+   menu_disp_batch_info = NULL;
+}
+
+void menu_display_get_draw_stats(menu_display_draw_stats_t *stats)
+{
+   if (stats)
+      *stats = menu_disp_stats;
 }
 
 void menu_display_draw_bg(menu_display_ctx_draw_t *draw,
@@ -1256,6 +1471,8 @@ bool menu_display_get_tex_coords(menu_display_ctx_coord_draw_t *draw)
 
 static bool menu_driver_load_image(menu_ctx_load_image_t *load_image_info)
 {
+   menu_idle_damaged = true;
+
    if (menu_driver_ctx && menu_driver_ctx->load_image)
       return menu_driver_ctx->load_image(menu_userdata,
             load_image_info->data, load_image_info->type);
@@ -1591,6 +1808,8 @@ void menu_display_draw_text(
    if ((color & 0x000000FF) == 0)
       return;
 
+   menu_display_batch_flush();
+
    /* Don't draw outside of the screen */
    if (!draw_outside &&
            ((x < -64 || x > width  + 64)
@@ -1915,8 +2134,24 @@ const char *menu_driver_ident(void)
 
 void menu_driver_frame(video_frame_info_t *video_info)
 {
-   if (menu_driver_alive && menu_driver_ctx->frame)
-      menu_driver_ctx->frame(menu_userdata, video_info);
+   retro_time_t start;
+   uint64_t draw_calls;
+
+   if (!menu_driver_alive || !menu_driver_ctx->frame)
+      return;
+
+   start      = cpu_features_get_time_usec();
+   draw_calls = menu_disp_stats.draw_calls;
+
+   menu_driver_ctx->frame(menu_userdata, video_info);
+
+   /* In case the menu driver left a batch open */
+   menu_display_batch_end(video_info);
+
+   menu_disp_stats.frames++;
+   menu_disp_stats.frame_draw_calls = (unsigned)
+      (menu_disp_stats.draw_calls - draw_calls);
+   menu_disp_stats.frame_time      += cpu_features_get_time_usec() - start;
 }
 
 bool menu_driver_get_load_content_animation_data(menu_texture_item *icon, char **playlist_name)
@@ -1925,12 +2160,86 @@ bool menu_driver_get_load_content_animation_data(menu_texture_item *icon, char *
       && menu_driver_ctx->get_load_content_animation_data(menu_userdata, icon, playlist_name);
 }
 
+/* Returns true if the frame about to be drawn would be
+ * the same as the last one. @animating is whether the
+ * menu animations were active before the menu driver's
+ * render callback reset them for the coming frame. */
+static bool menu_driver_check_idle(bool animating,
+      bool rarch_is_inited, bool rarch_is_dummy_core)
+{
+   unsigned width, height;
+   bool damaged;
+   settings_t *settings = config_get_ptr();
+   retro_time_t now     = 0;
+   int16_t mouse_x      = 0;
+   int16_t mouse_y      = 0;
+   int16_t pointer_x    = 0;
+   int16_t pointer_y    = 0;
+
+   if (!settings->bools.menu_skip_idle_frames)
+      return false;
+
+   now       = cpu_features_get_time_usec();
+   mouse_x   = menu_input_mouse_state(MENU_MOUSE_X_AXIS);
+   mouse_y   = menu_input_mouse_state(MENU_MOUSE_Y_AXIS);
+   pointer_x = menu_input_pointer_state(MENU_POINTER_X_AXIS);
+   pointer_y = menu_input_pointer_state(MENU_POINTER_Y_AXIS);
+   video_driver_get_size(&width, &height);
+
+   /* The framebuffer dirty flag only means something
+    * to framebuffer based drivers like RGUI, which set
+    * it when render redrew the menu. */
+   damaged   =
+         animating
+      || menu_idle_damaged
+      || menu_idle_action != MENU_ACTION_NOOP
+      || BIT64_GET(menu_driver_data->state, MENU_STATE_RENDER_MESSAGEBOX)
+      || (menu_driver_ctx->set_texture && menu_display_framebuf_dirty)
+      || menu_display_libretro_running(rarch_is_inited, rarch_is_dummy_core)
+      || menu_input_dialog_get_display_kb()
+      || (settings->bools.video_font_enable && runloop_msg_queue_size() > 0)
+      || settings->bools.video_fps_show
+      || settings->bools.video_statistics_show
+      || settings->bools.video_framecount_show
+      || width     != menu_idle_width
+      || height    != menu_idle_height
+      || mouse_x   != menu_idle_mouse_x
+      || mouse_y   != menu_idle_mouse_y
+      || pointer_x != menu_idle_pointer_x
+      || pointer_y != menu_idle_pointer_y;
+
+   menu_idle_width     = width;
+   menu_idle_height    = height;
+   menu_idle_mouse_x   = mouse_x;
+   menu_idle_mouse_y   = mouse_y;
+   menu_idle_pointer_x = pointer_x;
+   menu_idle_pointer_y = pointer_y;
+   menu_idle_damaged   = false;
+
+   if (damaged)
+      menu_idle_frames = 0;
+   else if (menu_idle_frames >= MENU_IDLE_FRAMES
+         && now - menu_idle_last_redraw < MENU_IDLE_REDRAW_INTERVAL)
+      return true;
+
+   if (menu_idle_frames < MENU_IDLE_FRAMES)
+      menu_idle_frames++;
+   menu_idle_last_redraw = now;
+
+   return false;
+}
+
 bool menu_driver_render(bool is_idle, bool rarch_is_inited,
       bool rarch_is_dummy_core)
 {
+   bool animating = false;
+
    if (!menu_driver_data)
       return false;
 
+   animating = menu_animation_is_active()
+      || menu_entries_ctl(MENU_ENTRIES_CTL_NEEDS_REFRESH, NULL);
+
    if (BIT64_GET(menu_driver_data->state, MENU_STATE_RENDER_FRAMEBUFFER)
          != BIT64_GET(menu_driver_data->state, MENU_STATE_RENDER_MESSAGEBOX))
       BIT64_SET(menu_driver_data->state, MENU_STATE_RENDER_FRAMEBUFFER);
@@ -1955,11 +2264,16 @@ bool menu_driver_render(bool is_idle, bool rarch_is_inited,
 
    if (BIT64_GET(menu_driver_data->state, MENU_STATE_BLIT))
    {
+      menu_entries_virtual_update();
+
       if (menu_driver_ctx->render)
          menu_driver_ctx->render(menu_userdata, is_idle);
    }
 
-   if (menu_driver_alive && !is_idle)
+   menu_idle_skip = menu_driver_check_idle(animating,
+         rarch_is_inited, rarch_is_dummy_core);
+
+   if (menu_driver_alive && !is_idle && !menu_idle_skip)
       menu_display_libretro(is_idle, rarch_is_inited, rarch_is_dummy_core);
 
    if (menu_driver_ctx->set_texture)
@@ -1970,6 +2284,13 @@ bool menu_driver_render(bool is_idle, bool rarch_is_inited,
    return true;
 }
 
+/* Checks if the last menu_driver_render() left the
+ * screen as it was, since nothing on it changed. */
+bool menu_driver_skipped_frame(void)
+{
+   return menu_driver_alive && menu_idle_skip;
+}
+
 /* Checks if the menu is still running */
 bool menu_driver_is_alive(void)
 {
@@ -1986,9 +2307,18 @@ bool menu_driver_is_texture_set(void)
    return false;
 }
 
+/* Can the current menu driver display lists whose
+ * entries are built on demand? */
+bool menu_driver_supports_virtual_lists(void)
+{
+   return menu_driver_ctx && menu_driver_ctx->virtual_lists;
+}
+
 /* Iterate the menu driver for one frame. */
 bool menu_driver_iterate(menu_ctx_iterate_t *iterate)
 {
+   menu_idle_action = iterate->action;
+
    /* If the user had requested that the Quick Menu
     * be spawned during the previous frame, do this now
     * and exit the function to go to the next frame.
@@ -2036,6 +2366,12 @@ bool menu_driver_iterate(menu_ctx_iterate_t *iterate)
    if (!menu_driver_ctx || !menu_driver_ctx->iterate)
       return false;
 
+   filebrowser_listing_poll();
+
+   /* Build the entries around the selection before
+    * acting on it */
+   menu_entries_virtual_update();
+
    if (menu_driver_ctx->iterate(menu_driver_data,
             menu_userdata, iterate->action) == -1)
       return false;
@@ -2167,12 +2503,14 @@ bool menu_driver_push_list(menu_ctx_displaylist_t *disp_list)
 
 void menu_driver_set_thumbnail_system(char *s, size_t len)
 {
+   menu_idle_damaged = true;
    if (menu_driver_ctx && menu_driver_ctx->set_thumbnail_system)
       menu_driver_ctx->set_thumbnail_system(menu_userdata, s, len);
 }
 
 void menu_driver_set_thumbnail_content(char *s, size_t len)
 {
+   menu_idle_damaged = true;
    if (menu_driver_ctx && menu_driver_ctx->set_thumbnail_content)
       menu_driver_ctx->set_thumbnail_content(menu_userdata, s, len);
 }
@@ -2319,6 +2657,8 @@ bool menu_driver_ctl(enum rarch_menu_ctl_state state, void *data)
 
          playlist_free_cached();
          menu_shader_manager_free();
+         menu_thumbnail_cache_free();
+         filebrowser_listing_free();
 
          if (menu_driver_data)
          {
@@ -2349,7 +2689,17 @@ bool menu_driver_ctl(enum rarch_menu_ctl_state state, void *data)
                memset(&system->info, 0, sizeof(struct retro_system_info));
             }
 
+            if (menu_disp_stats.frames)
+               RARCH_LOG("[Menu]: %.1f draw calls per frame "
+                     "(%.1f quads batched), %.2f ms per frame.\n",
+                     (double)menu_disp_stats.draw_calls / menu_disp_stats.frames,
+                     (double)menu_disp_stats.batched_quads / menu_disp_stats.frames,
+                     menu_disp_stats.frame_time / 1000.0 / menu_disp_stats.frames);
+
             video_coord_array_free(&menu_disp_ca);
+            video_coord_array_free(&menu_disp_batch_ca);
+            memset(&menu_disp_stats, 0, sizeof(menu_disp_stats));
+            menu_disp_batch_info         = NULL;
             menu_display_msg_force       = false;
             menu_display_header_height   = 0;
             menu_disp                    = NULL;
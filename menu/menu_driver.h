@@ -28,6 +28,7 @@
 #include <retro_common_api.h>
 #include <gfx/math/matrix_4x4.h>
 #include <queues/task_queue.h>
+#include <features/features_cpu.h>
 
 #include "menu_defines.h"
 #include "menu_input.h"
@@ -233,6 +234,10 @@ typedef struct menu_display_ctx_driver
    /* Enables and disables scissoring */
    void (*scissor_begin)(video_frame_info_t *video_info, int x, int y, unsigned width, unsigned height);
    void (*scissor_end)(video_frame_info_t *video_info);
+   /* Quads can be merged into a single triangle list
+    * drawn with the default MVP over the whole screen.
+    * See menu_display_batch_begin(). */
+   bool supports_batching;
 } menu_display_ctx_driver_t;
 
 typedef struct
@@ -289,6 +294,20 @@ struct menu_display_ctx_draw
    float scale_factor;
 };
 
+typedef struct menu_display_draw_stats
+{
+   unsigned frames;
+   /* Draw calls submitted to the display driver */
+   uint64_t draw_calls;
+   /* Quads merged into another draw call */
+   uint64_t batched_quads;
+   /* Draw calls made by the last frame */
+   unsigned frame_draw_calls;
+   /* Time spent in the menu driver's frame callback,
+    * summed over all frames. */
+   retro_time_t frame_time;
+} menu_display_draw_stats_t;
+
 typedef struct menu_display_ctx_rotate_draw
 {
    bool scale_enable;
@@ -389,6 +408,12 @@ typedef struct menu_ctx_driver
          menu_file_list_cbs_t *cbs,
          menu_entry_t *entry, unsigned action);
    bool (*get_load_content_animation_data)(void *userdata, menu_texture_item *icon, char **playlist_name);
+   /* Whether the driver copes with lists whose entries
+    * are only built near the selection, see
+    * menu_entries_virtual_begin(). It must not walk
+    * entries outside of menu_entries_get_window() and
+    * list_free must only free the entry it is given. */
+   bool virtual_lists;
 } menu_ctx_driver_t;
 
 typedef struct menu_ctx_displaylist
@@ -500,8 +525,12 @@ bool menu_driver_get_load_content_animation_data(menu_texture_item *icon, char *
  * return true for RGUI, for instance. */
 bool menu_driver_is_texture_set(void);
 
+bool menu_driver_supports_virtual_lists(void);
+
 bool menu_driver_is_alive(void);
 
+bool menu_driver_skipped_frame(void);
+
 bool menu_driver_iterate(menu_ctx_iterate_t *iterate);
 
 bool menu_driver_list_clear(file_list_t *list);
@@ -590,6 +619,34 @@ void menu_display_draw_keyboard(
 
 void menu_display_draw_pipeline(menu_display_ctx_draw_t *draw,
       video_frame_info_t *video_info);
+
+/**
+ * menu_display_batch_begin:
+ * @video_info           : Video frame info of the current frame.
+ *
+ * Until menu_display_batch_end(), quads passed to
+ * menu_display_draw() are collected instead of being drawn
+ * right away, and consecutive ones sharing a texture go out
+ * in a single draw call. Any other menu_display_* call that
+ * changes render state (blending, scissoring, pipelines, text)
+ * flushes the collected quads first, so drawing order is kept.
+ * Drawing through the video or font driver directly in
+ * between is not allowed.
+ *
+ * Does nothing if the display driver can't batch.
+ **/
+void menu_display_batch_begin(video_frame_info_t *video_info);
+
+/**
+ * menu_display_batch_end:
+ * @video_info           : Video frame info of the current frame.
+ *
+ * Draws whatever quads are still pending and goes back
+ * to drawing each quad as it comes.
+ **/
+void menu_display_batch_end(video_frame_info_t *video_info);
+
+void menu_display_get_draw_stats(menu_display_draw_stats_t *stats);
 void menu_display_draw_bg(
       menu_display_ctx_draw_t *draw,
       video_frame_info_t *video_info,
@@ -17,7 +17,9 @@
 #include <string.h>
 
 #include <retro_inline.h>
+#include <retro_miscellaneous.h>
 #include <compat/strl.h>
+#include <compat/strcasestr.h>
 #include <string/stdstring.h>
 
 #include "menu_driver.h"
@@ -42,6 +44,131 @@ struct menu_list
    file_list_t **selection_buf;
 };
 
+/* Entries built on each side of the selection
+ * of a virtual list. */
+#define MENU_ENTRIES_VIRTUAL_MARGIN 128
+
+/* Entries built away from the selection, e.g. for
+ * a lookup, that are kept until the window moves. */
+#define MENU_ENTRIES_VIRTUAL_STRAYS 16
+
+struct menu_entries_virtual
+{
+   file_list_t *list;
+   menu_entries_virtual_source_t source;
+   char *menu_path;
+   /* Entries [first, first + count) of the list are virtual,
+    * holding just their type and the index of their item in
+    * the source until they are built. */
+   size_t first;
+   size_t count;
+   /* The virtual entries in [window_begin, window_end)
+    * are built. */
+   size_t window_begin;
+   size_t window_end;
+   /* Indices + 1 of the entries built outside of the window */
+   size_t strays[MENU_ENTRIES_VIRTUAL_STRAYS];
+   unsigned stray_ptr;
+};
+
+static struct menu_entries_virtual menu_entries_virtual_list;
+
+static bool menu_entries_virtual_contains(const file_list_t *list,
+      size_t idx)
+{
+   const struct menu_entries_virtual *v = &menu_entries_virtual_list;
+
+   return list && list == v->list
+      && idx >= v->first && idx < v->first + v->count;
+}
+
+static void menu_entries_virtual_build(file_list_t *list, size_t idx)
+{
+   char path[PATH_MAX_LENGTH];
+   char label[PATH_MAX_LENGTH];
+   menu_ctx_list_t list_info;
+   struct menu_entries_virtual *v = &menu_entries_virtual_list;
+   enum msg_hash_enums enum_idx   = MSG_UNKNOWN;
+   menu_file_list_cbs_t *cbs      = NULL;
+   unsigned type                  = list->list[idx].type;
+
+   path[0]  = '\0';
+   label[0] = '\0';
+
+   /* An item that is gone leaves an empty entry
+    * until the list gets refreshed. */
+   v->source.get(v->source.data, list->list[idx].entry_idx, type,
+         path, sizeof(path), label, sizeof(label), &enum_idx);
+
+   list->list[idx].path  = strdup(path);
+   list->list[idx].label = strdup(label);
+
+   list_info.list        = list;
+   list_info.path        = path;
+   list_info.fullpath    = v->menu_path;
+   list_info.label       = label;
+   list_info.idx         = idx;
+   list_info.entry_type  = type;
+
+   menu_driver_list_insert(&list_info);
+
+   cbs = (menu_file_list_cbs_t*)
+      calloc(1, sizeof(menu_file_list_cbs_t));
+
+   if (!cbs)
+      return;
+
+   file_list_set_actiondata(list, idx, cbs);
+
+   cbs->enum_idx = enum_idx;
+
+   if (enum_idx != MENU_ENUM_LABEL_PLAYLIST_ENTRY
+       && enum_idx != MENU_ENUM_LABEL_PLAYLIST_COLLECTION_ENTRY
+       && enum_idx != MENU_ENUM_LABEL_RDB_ENTRY)
+      cbs->setting  = menu_setting_find_enum(enum_idx);
+
+   menu_cbs_init(list, cbs, list->list[idx].path,
+         list->list[idx].label, type, idx);
+}
+
+/* Turns a built entry back into a virtual one. */
+static void menu_entries_virtual_release(file_list_t *list, size_t idx)
+{
+   menu_ctx_list_t list_info;
+
+   if (!menu_entries_virtual_contains(list, idx)
+         || !list->list[idx].actiondata)
+      return;
+
+   list_info.list      = list;
+   list_info.idx       = idx;
+   list_info.list_size = list->size;
+
+   menu_driver_ctl(RARCH_MENU_CTL_LIST_FREE, &list_info);
+
+   free(list->list[idx].path);
+   free(list->list[idx].label);
+   free(list->list[idx].alt);
+
+   list->list[idx].path  = NULL;
+   list->list[idx].label = NULL;
+   list->list[idx].alt   = NULL;
+}
+
+static void menu_entries_virtual_end(file_list_t *list)
+{
+   struct menu_entries_virtual *v = &menu_entries_virtual_list;
+
+   if (!list || list != v->list)
+      return;
+
+   if (v->source.free)
+      v->source.free(v->source.data);
+   free(v->menu_path);
+
+   memset(v, 0, sizeof(*v));
+}
+
 static void menu_list_free_list(file_list_t *list)
 {
    unsigned i;
@@ -57,6 +184,7 @@ static void menu_list_free_list(file_list_t *list)
       menu_driver_ctl(RARCH_MENU_CTL_LIST_FREE, &list_info);
    }
 
+   menu_entries_virtual_end(list);
    file_list_free(list);
 }
 
@@ -257,6 +385,8 @@ static bool menu_entries_clear(file_list_t *list)
    if (list)
       file_list_clear(list);
 
+   menu_entries_virtual_end(list);
+
    return true;
 }
 
@@ -292,12 +422,30 @@ static bool menu_entries_elem_is_dir(file_list_t *list,
 static int menu_entries_elem_get_first_char(
       file_list_t *list, unsigned offset)
 {
+   char buf[2];
    int ret          = 0;
    const char *path = NULL;
 
    menu_entries_get_at_offset(list, offset,
          NULL, NULL, NULL, NULL, &path);
 
+   /* Virtual entries that aren't built have no path yet,
+    * only its first character is needed */
+   if (!path && menu_entries_virtual_contains(list, offset))
+   {
+      char label[2];
+      enum msg_hash_enums enum_idx                 = MSG_UNKNOWN;
+      const menu_entries_virtual_source_t *source  =
+         &menu_entries_virtual_list.source;
+
+      buf[0] = '\0';
+
+      source->get(source->data, list->list[offset].entry_idx,
+            list->list[offset].type, buf, sizeof(buf),
+            label, sizeof(label), &enum_idx);
+      path = buf;
+   }
+
    if (path != NULL)
       ret = tolower((int)*path);
 
@@ -607,6 +755,24 @@ void menu_entries_prepend(file_list_t *list, const char *path, const char *label
 
    file_list_prepend(list, path, label, type, directory_ptr, entry_idx);
 
+   /* Everything after the new entry moved down by one */
+   if (list == menu_entries_virtual_list.list)
+   {
+      unsigned i;
+      struct menu_entries_virtual *v = &menu_entries_virtual_list;
+
+      v->first++;
+      if (v->window_end)
+      {
+         v->window_begin++;
+         v->window_end++;
+      }
+
+      for (i = 0; i < MENU_ENTRIES_VIRTUAL_STRAYS; i++)
+         if (v->strays[i])
+            v->strays[i]++;
+   }
+
    menu_entries_get_last_stack(&menu_path, NULL, NULL, NULL, NULL);
 
    idx              = 0;
@@ -641,6 +807,197 @@ void menu_entries_prepend(file_list_t *list, const char *path, const char *label
    menu_cbs_init(list, cbs, path, label, type, idx);
 }
 
+bool menu_entries_virtual_begin(file_list_t *list,
+      const menu_entries_virtual_source_t *source)
+{
+   const char *menu_path          = NULL;
+   struct menu_entries_virtual *v = &menu_entries_virtual_list;
+
+   if (!list || !source || !source->get || list == v->list)
+      return false;
+
+   /* Only the current list follows the selection */
+   if (list != menu_entries_get_selection_buf_ptr(0))
+      return false;
+
+   if (!menu_driver_supports_virtual_lists())
+      return false;
+
+   menu_entries_virtual_end(v->list);
+
+   menu_entries_get_last_stack(&menu_path, NULL, NULL, NULL, NULL);
+
+   v->list   = list;
+   v->source = *source;
+   v->first  = list->size;
+
+   if (!string_is_empty(menu_path))
+      v->menu_path = strdup(menu_path);
+
+   return true;
+}
+
+void menu_entries_append_virtual(file_list_t *list,
+      unsigned type, size_t entry_idx)
+{
+   struct menu_entries_virtual *v = &menu_entries_virtual_list;
+
+   /* The virtual entries have to stay in one block */
+   if (!list || list != v->list || v->first + v->count != list->size)
+      return;
+
+   if (file_list_append(list, NULL, NULL, type, 0, entry_idx))
+      v->count++;
+}
+
+void menu_entries_materialize(file_list_t *list, size_t idx)
+{
+   struct menu_entries_virtual *v = &menu_entries_virtual_list;
+
+   if (!menu_entries_virtual_contains(list, idx)
+         || list->list[idx].actiondata)
+      return;
+
+   if (idx < v->window_begin || idx >= v->window_end)
+   {
+      size_t stray = v->strays[v->stray_ptr];
+
+      if (stray && (stray - 1 < v->window_begin
+               || stray - 1 >= v->window_end))
+         menu_entries_virtual_release(list, stray - 1);
+
+      v->strays[v->stray_ptr] = idx + 1;
+      v->stray_ptr            = (v->stray_ptr + 1)
+         % MENU_ENTRIES_VIRTUAL_STRAYS;
+   }
+
+   menu_entries_virtual_build(list, idx);
+}
+
+void menu_entries_virtual_update(void)
+{
+   unsigned i;
+   size_t j, begin, end, selection;
+   struct menu_entries_virtual *v = &menu_entries_virtual_list;
+   file_list_t *list              = v->list;
+
+   if (!list || !list->size)
+      return;
+
+   selection = menu_navigation_get_selection();
+   if (selection >= list->size)
+      selection = list->size - 1;
+
+   begin     = selection > MENU_ENTRIES_VIRTUAL_MARGIN
+      ? selection - MENU_ENTRIES_VIRTUAL_MARGIN : 0;
+   end       = MIN(selection + MENU_ENTRIES_VIRTUAL_MARGIN + 1,
+         list->size);
+
+   if (begin == v->window_begin && end == v->window_end)
+      return;
+
+   for (j = v->window_begin; j < v->window_end && j < list->size; j++)
+      if (j < begin || j >= end)
+         menu_entries_virtual_release(list, j);
+
+   for (i = 0; i < MENU_ENTRIES_VIRTUAL_STRAYS; i++)
+   {
+      j = v->strays[i];
+      if (j && (j - 1 < begin || j - 1 >= end) && j - 1 < list->size)
+         menu_entries_virtual_release(list, j - 1);
+      v->strays[i] = 0;
+   }
+
+   v->window_begin = begin;
+   v->window_end   = end;
+
+   for (j = begin; j < end; j++)
+      menu_entries_materialize(list, j);
+}
+
+void menu_entries_get_window(file_list_t *list,
+      size_t *begin, size_t *end)
+{
+   struct menu_entries_virtual *v = &menu_entries_virtual_list;
+
+   *begin = 0;
+   *end   = file_list_get_size(list);
+
+   if (!list || list != v->list)
+      return;
+
+   menu_entries_virtual_update();
+
+   *begin = v->window_begin;
+   *end   = v->window_end;
+}
+
+bool menu_entries_is_virtual(const file_list_t *list)
+{
+   return list && list == menu_entries_virtual_list.list;
+}
+
+bool menu_entries_search(file_list_t *list,
+      const char *needle, size_t *idx)
+{
+   size_t i;
+   char path[PATH_MAX_LENGTH];
+   char label[PATH_MAX_LENGTH];
+   bool ret                                    = false;
+   const menu_entries_virtual_source_t *source =
+      &menu_entries_virtual_list.source;
+
+   if (!menu_entries_is_virtual(list))
+      return file_list_search(list, needle, idx);
+
+   for (i = 0; i < list->size; i++)
+   {
+      const char *str = NULL;
+      const char *alt = NULL;
+
+      if (     menu_entries_virtual_contains(list, i)
+            && !list->list[i].actiondata)
+      {
+         enum msg_hash_enums enum_idx = MSG_UNKNOWN;
+
+         path[0]  = '\0';
+         label[0] = '\0';
+
+         if (source->get(source->data, list->list[i].entry_idx,
+                  list->list[i].type, path, sizeof(path),
+                  label, sizeof(label), &enum_idx))
+            alt = path;
+      }
+      else
+      {
+         file_list_get_alt_at_offset(list, i, &alt);
+         if (!alt)
+            file_list_get_label_at_offset(list, i, &alt);
+      }
+
+      if (!alt)
+         continue;
+
+      str = (const char *)strcasestr(alt, needle);
+      if (str == alt)
+      {
+         /* Found match with first chars, best possible match. */
+         *idx = i;
+         ret  = true;
+         break;
+      }
+      else if (str && !ret)
+      {
+         /* Found mid-string match, but try to find a match with
+          * first characters before we settle. */
+         *idx = i;
+         ret  = true;
+      }
+   }
+
+   return ret;
+}
+
 menu_file_list_cbs_t *menu_entries_get_last_stack_actiondata(void)
 {
    menu_list_t *menu_list         = menu_entries_list;
@@ -61,6 +61,21 @@ enum menu_list_type
 
 typedef struct menu_list menu_list_t;
 
+/* Where the entries of a virtual list are built from,
+ * e.g. a playlist or a directory listing. */
+typedef struct menu_entries_virtual_source
+{
+   void *data;
+   /* Fills in the path, label and enum of the entry made
+    * from item @entry_idx of the source. Returns false
+    * if the item is gone. */
+   bool (*get)(void *data, size_t entry_idx, unsigned type,
+         char *path, size_t path_len,
+         char *label, size_t label_len,
+         enum msg_hash_enums *enum_idx);
+   void (*free)(void *data);
+} menu_entries_virtual_source_t;
+
 typedef struct menu_ctx_list
 {
    enum menu_list_type type;
@@ -185,6 +200,46 @@ bool menu_entries_ctl(enum menu_entries_ctl_state state, void *data);
 void menu_entries_set_checked(file_list_t *list, size_t entry_idx,
       bool checked);
 
+/**
+ * menu_entries_virtual_begin:
+ * @list                     : File list handle.
+ * @source                   : Source of the entries.
+ *
+ * Makes the entries appended to @list with
+ * menu_entries_append_virtual() virtual: they only get a
+ * path, label, menu driver node and callbacks while they
+ * are near the selection, so huge lists open and scroll
+ * as fast as short ones. @list takes ownership of the
+ * source data if this succeeds.
+ *
+ * Returns: false if the menu driver needs all entries
+ * built, in which case they have to be appended normally.
+ **/
+bool menu_entries_virtual_begin(file_list_t *list,
+      const menu_entries_virtual_source_t *source);
+
+void menu_entries_append_virtual(file_list_t *list,
+      unsigned type, size_t entry_idx);
+
+/* Builds entry @idx of @list if it is virtual
+ * and hasn't been built yet. */
+void menu_entries_materialize(file_list_t *list, size_t idx);
+
+/* Moves the window of built entries of the virtual
+ * list along with the selection. */
+void menu_entries_virtual_update(void);
+
+/* Gets the range [begin, end) of entries of @list that
+ * may be built. That's all of them unless @list is
+ * virtual. */
+void menu_entries_get_window(file_list_t *list,
+      size_t *begin, size_t *end);
+
+bool menu_entries_is_virtual(const file_list_t *list);
+
+bool menu_entries_search(file_list_t *list,
+      const char *needle, size_t *idx);
+
 RETRO_END_DECLS
 
 #endif
@@ -0,0 +1,799 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(VITA) && !defined(PSP) && !defined(PS2) && !defined(__CELLOS_LV2__)
+#include <sys/types.h>
+#include <sys/stat.h>
+#define HAVE_THUMBNAIL_MTIME
+#endif
+
+#include <compat/strl.h>
+#include <file/file_path.h>
+#include <formats/image.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+#include <retro_miscellaneous.h>
+
+#include "menu_thumbnail_cache.h"
+
+#include "../configuration.h"
+#include "../msg_hash.h"
+#include "../verbosity.h"
+#include "../gfx/video_driver.h"
+#include "../tasks/tasks_internal.h"
+
+/* Downscaled copies of the thumbnails, stored raw next to
+ * the thumbnails as <thumbnails>/.cache/<hash>_<w>x<h>.thumb:
+ * a menu_thumbnail_derivative_header, the source path and
+ * width * height pixels, already color converted for the
+ * video driver. They are only valid for the source size and
+ * modification time recorded in the header. */
+#define MENU_THUMBNAIL_DERIVATIVE_MAGIC   0x42485452 /* "RTHB" */
+#define MENU_THUMBNAIL_DERIVATIVE_VERSION 1
+
+typedef struct menu_thumbnail_derivative_header
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t width;
+   uint32_t height;
+   uint32_t supports_rgba;
+   uint32_t path_len;
+   int64_t src_size;
+   int64_t src_mtime;
+} menu_thumbnail_derivative_header_t;
+
+typedef struct menu_thumbnail_derivative_state
+{
+   char *src;
+   char *path;
+   bool supports_rgba;
+   unsigned max_width;
+   unsigned max_height;
+   /* Full size image, only set when saving */
+   struct texture_image *image;
+} menu_thumbnail_derivative_state_t;
+
+/* Decoded images, most recently used first. Everything
+ * here is only touched from the main thread: loads and
+ * prefetches are requested by the menu drivers, and task
+ * callbacks run when the task queue is gathered. */
+typedef struct menu_thumbnail_entry
+{
+   char *path;
+   uint32_t hash;
+   size_t size;
+   struct texture_image image;
+   struct menu_thumbnail_entry *prev;
+   struct menu_thumbnail_entry *next;
+} menu_thumbnail_entry_t;
+
+/* An image load in flight. cb is NULL while nothing but
+ * a prefetch is waiting for it. */
+typedef struct menu_thumbnail_request
+{
+   char *path;
+   uint32_t hash;
+   bool orphaned;
+   bool derived;
+   retro_time_t start;
+   retro_task_callback_t cb;
+   void *user_data;
+   struct menu_thumbnail_request *next;
+} menu_thumbnail_request_t;
+
+static menu_thumbnail_entry_t   *thumbnail_cache_head    = NULL;
+static menu_thumbnail_entry_t   *thumbnail_cache_tail    = NULL;
+static menu_thumbnail_request_t *thumbnail_cache_pending = NULL;
+static menu_thumbnail_cache_stats_t thumbnail_cache_stats = {0};
+static unsigned thumbnail_cache_max_width                 = 0;
+static unsigned thumbnail_cache_max_height                = 0;
+
+static void menu_thumbnail_cache_unlink(menu_thumbnail_entry_t *entry)
+{
+   if (entry->prev)
+      entry->prev->next    = entry->next;
+   else
+      thumbnail_cache_head = entry->next;
+
+   if (entry->next)
+      entry->next->prev    = entry->prev;
+   else
+      thumbnail_cache_tail = entry->prev;
+
+   entry->prev = NULL;
+   entry->next = NULL;
+}
+
+static void menu_thumbnail_cache_link_front(menu_thumbnail_entry_t *entry)
+{
+   entry->prev = NULL;
+   entry->next = thumbnail_cache_head;
+
+   if (thumbnail_cache_head)
+      thumbnail_cache_head->prev = entry;
+   else
+      thumbnail_cache_tail       = entry;
+
+   thumbnail_cache_head = entry;
+}
+
+static void menu_thumbnail_cache_entry_free(menu_thumbnail_entry_t *entry)
+{
+   thumbnail_cache_stats.size -= entry->size;
+   thumbnail_cache_stats.count--;
+
+   image_texture_free(&entry->image);
+   free(entry->path);
+   free(entry);
+}
+
+static menu_thumbnail_entry_t *menu_thumbnail_cache_find(
+      const char *path, uint32_t hash)
+{
+   menu_thumbnail_entry_t *entry = thumbnail_cache_head;
+
+   for (; entry; entry = entry->next)
+      if (entry->hash == hash && string_is_equal(entry->path, path))
+         return entry;
+
+   return NULL;
+}
+
+static menu_thumbnail_request_t *menu_thumbnail_cache_find_pending(
+      const char *path, uint32_t hash)
+{
+   menu_thumbnail_request_t *req = thumbnail_cache_pending;
+
+   for (; req; req = req->next)
+      if (req->hash == hash && string_is_equal(req->path, path))
+         return req;
+
+   return NULL;
+}
+
+static bool menu_thumbnail_cache_copy_image(struct texture_image *dst,
+      const struct texture_image *src)
+{
+   size_t size        = src->width * src->height * sizeof(uint32_t);
+
+   dst->pixels        = (uint32_t*)malloc(size);
+   if (!dst->pixels)
+      return false;
+
+   memcpy(dst->pixels, src->pixels, size);
+   dst->width         = src->width;
+   dst->height        = src->height;
+   dst->supports_rgba = src->supports_rgba;
+   return true;
+}
+
+static void menu_thumbnail_cache_insert(const char *path, uint32_t hash,
+      const struct texture_image *img)
+{
+   menu_thumbnail_entry_t *entry = NULL;
+   size_t size                   = img->width * img->height * sizeof(uint32_t);
+
+   if (!img->pixels || !size || size > MENU_THUMBNAIL_CACHE_SIZE)
+      return;
+
+   while (thumbnail_cache_tail &&
+         thumbnail_cache_stats.size + size > MENU_THUMBNAIL_CACHE_SIZE)
+   {
+      menu_thumbnail_entry_t *lru = thumbnail_cache_tail;
+      menu_thumbnail_cache_unlink(lru);
+      menu_thumbnail_cache_entry_free(lru);
+   }
+
+   entry = (menu_thumbnail_entry_t*)calloc(1, sizeof(*entry));
+   if (!entry)
+      return;
+
+   if (!menu_thumbnail_cache_copy_image(&entry->image, img))
+   {
+      free(entry);
+      return;
+   }
+
+   entry->path  = strdup(path);
+   entry->hash  = hash;
+   entry->size  = size;
+
+   thumbnail_cache_stats.size += size;
+   thumbnail_cache_stats.count++;
+
+   menu_thumbnail_cache_link_front(entry);
+}
+
+static bool menu_thumbnail_derivative_path(const char *src,
+      uint32_t hash, char *s, size_t len)
+{
+   char name[64];
+   char dir[PATH_MAX_LENGTH];
+   settings_t *settings = config_get_ptr();
+
+   if (     (!thumbnail_cache_max_width && !thumbnail_cache_max_height)
+         || !settings
+         || string_is_empty(settings->paths.directory_thumbnails))
+      return false;
+
+   fill_pathname_join(dir, settings->paths.directory_thumbnails,
+         ".cache", sizeof(dir));
+   snprintf(name, sizeof(name), "%08x_%ux%u.thumb", (unsigned)hash,
+         thumbnail_cache_max_width, thumbnail_cache_max_height);
+   fill_pathname_join(s, dir, name, len);
+
+   return true;
+}
+
+static bool menu_thumbnail_source_stamp(const char *path,
+      int64_t *size, int64_t *mtime)
+{
+#ifdef HAVE_THUMBNAIL_MTIME
+   struct stat buf;
+
+   if (stat(path, &buf) == 0)
+   {
+      *size  = (int64_t)buf.st_size;
+      *mtime = (int64_t)buf.st_mtime;
+      return true;
+   }
+#endif
+
+   /* Size only, for platforms (or paths) stat() can't handle */
+   *size  = path_get_size(path);
+   *mtime = 0;
+   return *size > 0;
+}
+
+static bool menu_thumbnail_needs_downscale(const struct texture_image *img,
+      unsigned max_width, unsigned max_height)
+{
+   return (max_width  && img->width  > max_width)
+       || (max_height && img->height > max_height);
+}
+
+/* Box filter, so that text on boxart survives
+ * large reductions better than with point sampling. */
+static bool menu_thumbnail_downscale(const struct texture_image *src,
+      struct texture_image *dst, unsigned max_width, unsigned max_height)
+{
+   unsigned x, y;
+   float scale = 1.0f;
+
+   if (max_width && src->width > max_width)
+      scale = (float)max_width / src->width;
+   if (max_height && src->height * scale > max_height)
+      scale = (float)max_height / src->height;
+
+   dst->width         = MAX(1, (unsigned)(src->width  * scale + 0.5f));
+   dst->height        = MAX(1, (unsigned)(src->height * scale + 0.5f));
+   dst->supports_rgba = src->supports_rgba;
+   dst->pixels        = (uint32_t*)
+      malloc(dst->width * dst->height * sizeof(uint32_t));
+
+   if (!dst->pixels)
+      return false;
+
+   for (y = 0; y < dst->height; y++)
+   {
+      unsigned y0 = y * src->height / dst->height;
+      unsigned y1 = (y + 1) * src->height / dst->height;
+
+      if (y1 <= y0)
+         y1 = y0 + 1;
+
+      for (x = 0; x < dst->width; x++)
+      {
+         unsigned sx, sy;
+         uint32_t sum[4] = {0};
+         unsigned x0     = x * src->width / dst->width;
+         unsigned x1     = (x + 1) * src->width / dst->width;
+         unsigned count;
+
+         if (x1 <= x0)
+            x1 = x0 + 1;
+
+         count = (x1 - x0) * (y1 - y0);
+
+         for (sy = y0; sy < y1; sy++)
+         {
+            const uint32_t *row = src->pixels + sy * src->width;
+
+            for (sx = x0; sx < x1; sx++)
+            {
+               uint32_t col = row[sx];
+               sum[0]      += (col >> 24) & 0xff;
+               sum[1]      += (col >> 16) & 0xff;
+               sum[2]      += (col >>  8) & 0xff;
+               sum[3]      += (col >>  0) & 0xff;
+            }
+         }
+
+         dst->pixels[y * dst->width + x] =
+                 ((sum[0] + count / 2) / count) << 24
+               | ((sum[1] + count / 2) / count) << 16
+               | ((sum[2] + count / 2) / count) <<  8
+               | ((sum[3] + count / 2) / count);
+      }
+   }
+
+   return true;
+}
+
+static void menu_thumbnail_derivative_state_free(
+      menu_thumbnail_derivative_state_t *state)
+{
+   if (!state)
+      return;
+
+   if (state->image)
+   {
+      image_texture_free(state->image);
+      free(state->image);
+   }
+   free(state->src);
+   free(state->path);
+   free(state);
+}
+
+static void task_menu_thumbnail_derivative_cleanup(retro_task_t *task)
+{
+   menu_thumbnail_derivative_state_free(
+         (menu_thumbnail_derivative_state_t*)task->state);
+   task->state = NULL;
+}
+
+static void task_menu_thumbnail_derivative_load_handler(retro_task_t *task)
+{
+   menu_thumbnail_derivative_header_t hdr;
+   int64_t src_size, src_mtime;
+   size_t pixels_size;
+   char *src_path                           = NULL;
+   RFILE *file                              = NULL;
+   struct texture_image *img                = NULL;
+   menu_thumbnail_derivative_state_t *state =
+      (menu_thumbnail_derivative_state_t*)task->state;
+   size_t src_len                           = strlen(state->src);
+
+   if (     !menu_thumbnail_source_stamp(state->src, &src_size, &src_mtime)
+         || !filestream_exists(state->path))
+      goto end;
+
+   file = filestream_open(state->path,
+         RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   if (!file)
+      goto end;
+
+   if (filestream_read(file, &hdr, sizeof(hdr)) != sizeof(hdr))
+      goto end;
+
+   if (     hdr.magic         != MENU_THUMBNAIL_DERIVATIVE_MAGIC
+         || hdr.version       != MENU_THUMBNAIL_DERIVATIVE_VERSION
+         || hdr.src_size      != src_size
+         || hdr.src_mtime     != src_mtime
+         || hdr.supports_rgba != (uint32_t)state->supports_rgba
+         || hdr.path_len      != src_len
+         || !hdr.width  || hdr.width  > 8192
+         || !hdr.height || hdr.height > 8192)
+      goto end;
+
+   pixels_size = hdr.width * hdr.height * sizeof(uint32_t);
+
+   if (filestream_get_size(file) !=
+         (int64_t)(sizeof(hdr) + src_len + pixels_size))
+      goto end;
+
+   /* The name is only a hash of the source path */
+   src_path = (char*)malloc(src_len + 1);
+   if (!src_path
+         || filestream_read(file, src_path, src_len) != (int64_t)src_len
+         || memcmp(src_path, state->src, src_len))
+      goto end;
+
+   img = (struct texture_image*)calloc(1, sizeof(*img));
+   if (!img)
+      goto end;
+
+   img->pixels = (uint32_t*)malloc(pixels_size);
+   if (!img->pixels
+         || filestream_read(file, img->pixels, pixels_size)
+         != (int64_t)pixels_size)
+   {
+      image_texture_free(img);
+      free(img);
+      img = NULL;
+      goto end;
+   }
+
+   img->width         = hdr.width;
+   img->height        = hdr.height;
+   img->supports_rgba = state->supports_rgba;
+
+end:
+   if (file)
+      filestream_close(file);
+   free(src_path);
+   task_set_data(task, img);
+   task_set_finished(task, true);
+}
+
+static void task_menu_thumbnail_derivative_save_handler(retro_task_t *task)
+{
+   menu_thumbnail_derivative_header_t hdr;
+   struct texture_image img;
+   char dir[PATH_MAX_LENGTH];
+   RFILE *file                              = NULL;
+   menu_thumbnail_derivative_state_t *state =
+      (menu_thumbnail_derivative_state_t*)task->state;
+   size_t src_len                           = strlen(state->src);
+   size_t pixels_size                       = 0;
+
+   img.pixels = NULL;
+
+   if (!menu_thumbnail_downscale(state->image, &img,
+            state->max_width, state->max_height))
+      goto end;
+
+   memset(&hdr, 0, sizeof(hdr));
+   hdr.magic         = MENU_THUMBNAIL_DERIVATIVE_MAGIC;
+   hdr.version       = MENU_THUMBNAIL_DERIVATIVE_VERSION;
+   hdr.width         = img.width;
+   hdr.height        = img.height;
+   hdr.supports_rgba = img.supports_rgba;
+   hdr.path_len      = (uint32_t)src_len;
+
+   if (!menu_thumbnail_source_stamp(state->src,
+            &hdr.src_size, &hdr.src_mtime))
+      goto end;
+
+   fill_pathname_basedir(dir, state->path, sizeof(dir));
+   if (!path_is_directory(dir) && !path_mkdir(dir))
+      goto end;
+
+   file = filestream_open(state->path,
+         RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   if (!file)
+      goto end;
+
+   /* A short write leaves a file whose size doesn't match
+    * its header, which the loader rejects. */
+   pixels_size = img.width * img.height * sizeof(uint32_t);
+   filestream_write(file, &hdr, sizeof(hdr));
+   filestream_write(file, state->src, src_len);
+   filestream_write(file, img.pixels, pixels_size);
+   filestream_close(file);
+
+end:
+   image_texture_free(&img);
+   task_set_finished(task, true);
+}
+
+static void menu_thumbnail_derivative_push(const char *src, uint32_t hash,
+      const struct texture_image *image)
+{
+   char path[PATH_MAX_LENGTH];
+   retro_task_t                      *task = NULL;
+   menu_thumbnail_derivative_state_t *state = NULL;
+
+   if (!menu_thumbnail_derivative_path(src, hash, path, sizeof(path)))
+      return;
+
+   state = (menu_thumbnail_derivative_state_t*)calloc(1, sizeof(*state));
+   if (!state)
+      return;
+
+   state->src        = strdup(src);
+   state->path       = strdup(path);
+   state->max_width  = thumbnail_cache_max_width;
+   state->max_height = thumbnail_cache_max_height;
+   state->image      = (struct texture_image*)calloc(1, sizeof(*state->image));
+
+   if (     !state->src || !state->path || !state->image
+         || !menu_thumbnail_cache_copy_image(state->image, image))
+      goto error;
+
+   task = task_init();
+   if (!task)
+      goto error;
+
+   task->state   = state;
+   task->handler = task_menu_thumbnail_derivative_save_handler;
+   task->cleanup = task_menu_thumbnail_derivative_cleanup;
+   task->mute    = true;
+
+   task_queue_push(task);
+   return;
+
+error:
+   menu_thumbnail_derivative_state_free(state);
+}
+
+static void menu_thumbnail_cache_loaded(retro_task_t *task,
+      void *task_data, void *user_data, const char *err)
+{
+   struct texture_image     *img = (struct texture_image*)task_data;
+   menu_thumbnail_request_t *req = (menu_thumbnail_request_t*)user_data;
+
+   if (!req->orphaned)
+   {
+      menu_thumbnail_request_t **prev = &thumbnail_cache_pending;
+
+      while (*prev && *prev != req)
+         prev = &(*prev)->next;
+      if (*prev)
+         *prev = req->next;
+
+      thumbnail_cache_stats.loads++;
+      thumbnail_cache_stats.load_time +=
+         cpu_features_get_time_usec() - req->start;
+
+      if (img && !menu_thumbnail_cache_find(req->path, req->hash))
+         menu_thumbnail_cache_insert(req->path, req->hash, img);
+
+      if (req->derived)
+         thumbnail_cache_stats.derived++;
+      else if (img && img->pixels && menu_thumbnail_needs_downscale(img,
+               thumbnail_cache_max_width, thumbnail_cache_max_height))
+         menu_thumbnail_derivative_push(req->path, req->hash, img);
+   }
+
+   if (req->cb)
+      req->cb(task, task_data, req->user_data, err);
+   else if (img)
+   {
+      image_texture_free(img);
+      free(img);
+   }
+
+   free(req->path);
+   free(req);
+}
+
+/* Falls back to decoding the full image
+ * when there is no usable derivative. */
+static void menu_thumbnail_derivative_loaded(retro_task_t *task,
+      void *task_data, void *user_data, const char *err)
+{
+   menu_thumbnail_request_t *req = (menu_thumbnail_request_t*)user_data;
+
+   if (task_data)
+      req->derived = true;
+   else if (task_push_image_load(req->path,
+            menu_thumbnail_cache_loaded, req))
+      return;
+
+   menu_thumbnail_cache_loaded(task, task_data, req, err);
+}
+
+static bool menu_thumbnail_derivative_load(menu_thumbnail_request_t *req)
+{
+   char path[PATH_MAX_LENGTH];
+   retro_task_t                      *task = NULL;
+   menu_thumbnail_derivative_state_t *state = NULL;
+
+   if (!menu_thumbnail_derivative_path(req->path, req->hash,
+            path, sizeof(path)))
+      return false;
+
+   state = (menu_thumbnail_derivative_state_t*)calloc(1, sizeof(*state));
+   if (!state)
+      return false;
+
+   state->src           = strdup(req->path);
+   state->path          = strdup(path);
+   state->supports_rgba = video_driver_supports_rgba();
+
+   if (!state->src || !state->path)
+      goto error;
+
+   task = task_init();
+   if (!task)
+      goto error;
+
+   task->state     = state;
+   task->handler   = task_menu_thumbnail_derivative_load_handler;
+   task->cleanup   = task_menu_thumbnail_derivative_cleanup;
+   task->callback  = menu_thumbnail_derivative_loaded;
+   task->user_data = req;
+   task->mute      = true;
+
+   task_queue_push(task);
+   return true;
+
+error:
+   menu_thumbnail_derivative_state_free(state);
+   return false;
+}
+
+static bool menu_thumbnail_cache_request(const char *path, uint32_t hash,
+      retro_task_callback_t cb, void *user_data)
+{
+   menu_thumbnail_request_t *req = (menu_thumbnail_request_t*)
+      calloc(1, sizeof(*req));
+
+   if (!req)
+      return false;
+
+   req->path      = strdup(path);
+   req->hash      = hash;
+   req->start     = cpu_features_get_time_usec();
+   req->cb        = cb;
+   req->user_data = user_data;
+
+   if (!req->path ||
+         (     !menu_thumbnail_derivative_load(req)
+            && !task_push_image_load(path, menu_thumbnail_cache_loaded, req)))
+   {
+      free(req->path);
+      free(req);
+      return false;
+   }
+
+   req->next               = thumbnail_cache_pending;
+   thumbnail_cache_pending = req;
+   return true;
+}
+
+static void task_menu_thumbnail_cache_hit_handler(retro_task_t *task)
+{
+   task_set_data(task, task->state);
+   task->state = NULL;
+   task_set_finished(task, true);
+}
+
+/* Hits still go through the task queue so that callbacks
+ * keep running at the same point of the frame, and in the
+ * same order relative to loads already in flight. */
+static bool menu_thumbnail_cache_push_hit(menu_thumbnail_entry_t *entry,
+      retro_task_callback_t cb, void *user_data)
+{
+   retro_task_t          *task = NULL;
+   struct texture_image   *img = (struct texture_image*)
+      calloc(1, sizeof(*img));
+
+   if (!img)
+      return false;
+
+   if (!menu_thumbnail_cache_copy_image(img, &entry->image))
+      goto error;
+
+   task = task_init();
+   if (!task)
+      goto error;
+
+   task->state     = img;
+   task->handler   = task_menu_thumbnail_cache_hit_handler;
+   task->callback  = cb;
+   task->user_data = user_data;
+   task->mute      = true;
+
+   task_queue_push(task);
+
+   return true;
+
+error:
+   image_texture_free(img);
+   free(img);
+   return false;
+}
+
+bool menu_thumbnail_cache_load(const char *path,
+      retro_task_callback_t cb, void *user_data)
+{
+   uint32_t hash;
+   menu_thumbnail_entry_t   *entry = NULL;
+   menu_thumbnail_request_t *req   = NULL;
+
+   if (string_is_empty(path))
+      return false;
+
+   hash  = msg_hash_calculate(path);
+   entry = menu_thumbnail_cache_find(path, hash);
+
+   if (entry)
+   {
+      thumbnail_cache_stats.hits++;
+
+      menu_thumbnail_cache_unlink(entry);
+      menu_thumbnail_cache_link_front(entry);
+
+      if (menu_thumbnail_cache_push_hit(entry, cb, user_data))
+         return true;
+   }
+
+   thumbnail_cache_stats.misses++;
+
+   /* Already being loaded (usually by a prefetch),
+    * take over the callback instead of decoding it twice.
+    * A previous waiter with the same path is superseded. */
+   req = menu_thumbnail_cache_find_pending(path, hash);
+   if (req)
+   {
+      if (req->cb)
+         free(req->user_data);
+      req->cb        = cb;
+      req->user_data = user_data;
+      return true;
+   }
+
+   return menu_thumbnail_cache_request(path, hash, cb, user_data);
+}
+
+void menu_thumbnail_cache_prefetch(const char *path)
+{
+   uint32_t hash;
+
+   if (string_is_empty(path))
+      return;
+
+   hash = msg_hash_calculate(path);
+
+   if (     menu_thumbnail_cache_find(path, hash)
+         || menu_thumbnail_cache_find_pending(path, hash)
+         || !filestream_exists(path))
+      return;
+
+   if (menu_thumbnail_cache_request(path, hash, NULL, NULL))
+      thumbnail_cache_stats.prefetches++;
+}
+
+void menu_thumbnail_cache_set_max_size(unsigned width, unsigned height)
+{
+   thumbnail_cache_max_width  = width;
+   thumbnail_cache_max_height = height;
+}
+
+void menu_thumbnail_cache_get_stats(menu_thumbnail_cache_stats_t *stats)
+{
+   if (stats)
+      *stats = thumbnail_cache_stats;
+}
+
+void menu_thumbnail_cache_free(void)
+{
+   menu_thumbnail_cache_stats_t *stats = &thumbnail_cache_stats;
+   unsigned requests                   = stats->hits + stats->misses;
+
+   if (requests)
+      RARCH_LOG("[Thumbnails]: Cache hit rate %.1f%% (%u of %u), "
+            "%u prefetched, %u loads (%u downscaled) averaging %.2f ms.\n",
+            100.0f * stats->hits / requests, stats->hits, requests,
+            stats->prefetches, stats->loads, stats->derived,
+            stats->loads ? stats->load_time / 1000.0 / stats->loads : 0.0);
+
+   while (thumbnail_cache_head)
+   {
+      menu_thumbnail_entry_t *entry = thumbnail_cache_head;
+      menu_thumbnail_cache_unlink(entry);
+      menu_thumbnail_cache_entry_free(entry);
+   }
+
+   /* Loads still on the task queue deliver their
+    * image to the callback without caching it. */
+   while (thumbnail_cache_pending)
+   {
+      menu_thumbnail_request_t *req = thumbnail_cache_pending;
+      thumbnail_cache_pending       = req->next;
+      req->orphaned                 = true;
+      req->next                     = NULL;
+   }
+
+   memset(stats, 0, sizeof(*stats));
+}
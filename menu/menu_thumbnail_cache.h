@@ -0,0 +1,99 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MENU_THUMBNAIL_CACHE_H
+#define _MENU_THUMBNAIL_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+#include <queues/task_queue.h>
+
+#include <features/features_cpu.h>
+
+RETRO_BEGIN_DECLS
+
+/* Total size of the decoded images kept around, in bytes. */
+#define MENU_THUMBNAIL_CACHE_SIZE (64 * 1024 * 1024)
+
+/* Number of entries above and below the selection
+ * whose thumbnails are loaded ahead of time. */
+#define MENU_THUMBNAIL_PREFETCH   3
+
+typedef struct menu_thumbnail_cache_stats
+{
+   unsigned hits;
+   unsigned misses;
+   unsigned prefetches;
+   unsigned loads;
+   /* Loads served from a downscaled copy on disk */
+   unsigned derived;
+   unsigned count;
+   size_t size;
+   /* Time from queueing an image load to
+    * receiving the decoded image, summed over all loads. */
+   retro_time_t load_time;
+} menu_thumbnail_cache_stats_t;
+
+/**
+ * menu_thumbnail_cache_load:
+ * @path                 : Path to the image file.
+ * @cb                   : Callback receiving the struct texture_image,
+ *                         same as for task_push_image_load().
+ * @user_data            : User data passed to @cb.
+ *
+ * Drop-in replacement for task_push_image_load() for menu
+ * thumbnails. Images already in the cache are handed to @cb
+ * without touching the disk, anything else is decoded on
+ * the task queue and added to the cache.
+ *
+ * Returns: true if @cb will be called, otherwise false.
+ **/
+bool menu_thumbnail_cache_load(const char *path,
+      retro_task_callback_t cb, void *user_data);
+
+/**
+ * menu_thumbnail_cache_prefetch:
+ * @path                 : Path to the image file.
+ *
+ * Decodes @path in the background if it exists and is
+ * neither cached nor already being loaded, so that a later
+ * menu_thumbnail_cache_load() on it is a hit.
+ **/
+void menu_thumbnail_cache_prefetch(const char *path);
+
+/**
+ * menu_thumbnail_cache_set_max_size:
+ * @width                : Largest width thumbnails are drawn at,
+ *                         0 if unbounded.
+ * @height               : Largest height thumbnails are drawn at,
+ *                         0 if unbounded.
+ *
+ * Thumbnails larger than this get a downscaled copy written
+ * to <thumbnails>/.cache in the background, which later
+ * loads use instead of decoding the full size image.
+ * Both 0 (the default) disables this.
+ **/
+void menu_thumbnail_cache_set_max_size(unsigned width, unsigned height);
+
+void menu_thumbnail_cache_get_stats(menu_thumbnail_cache_stats_t *stats);
+
+void menu_thumbnail_cache_free(void);
+
+RETRO_END_DECLS
+
+#endif
@@ -330,6 +330,8 @@ void menu_entry_get(menu_entry_t *entry, size_t stack_idx,
    if (!list)
       return;
 
+   menu_entries_materialize(list, i);
+
    file_list_get_at_offset(list, i, &path, &entry_label, &entry->type,
          &entry->entry_idx);
 
@@ -20,6 +20,7 @@
 #include <file/archive_file.h>
 
 #include <lists/dir_list.h>
+#include <features/features_cpu.h>
 
 #include <boolean.h>
 
@@ -41,8 +42,280 @@
 #include "../../verbosity.h"
 #include "../../dynamic.h"
 
+#include "../../tasks/tasks_internal.h"
+
+/* Minimum time between two refreshes of the
+ * list while a directory is being listed */
+#define FILEBROWSER_LISTING_INTERVAL 250000
+
+/* Directory listed in the background for as long
+ * as the menu shows it, so that the list can be
+ * refreshed with the files found so far */
+typedef struct filebrowser_listing
+{
+   /* NULL once the whole directory has been listed */
+   task_dir_list_t *task;
+   /* Sorted files found so far */
+   struct string_list *list;
+   char *exts;
+   retro_time_t refreshed;
+   /* Time the last refresh of the list took */
+   retro_time_t refresh_time;
+   size_t stack_size;
+   /* Selection to restore once enough files are in,
+    * e.g. when going back to a directory, 0 if none */
+   size_t selection;
+   /* The menu, plus every virtual list built from it */
+   unsigned refs;
+   bool include_hidden;
+   bool error;
+   char path[PATH_MAX_LENGTH];
+   char stack_path[PATH_MAX_LENGTH];
+   char stack_label[PATH_MAX_LENGTH];
+   /* Entry to keep selected on the next refresh */
+   char selected[PATH_MAX_LENGTH];
+} filebrowser_listing_t;
+
 static enum filebrowser_enums filebrowser_types = FILEBROWSER_NONE;
 
+static filebrowser_listing_t *filebrowser_current_listing = NULL;
+
+/* Directory listing that the entries of a virtual
+ * file browser list are built from */
+typedef struct filebrowser_source
+{
+   struct string_list *list;
+   /* Set if @list belongs to a listing */
+   filebrowser_listing_t *listing;
+   bool path_is_compressed;
+} filebrowser_source_t;
+
+static void filebrowser_listing_unref(filebrowser_listing_t *listing)
+{
+   if (--listing->refs)
+      return;
+
+   task_dir_list_free(listing->task);
+   string_list_free(listing->list);
+   free(listing->exts);
+   free(listing);
+}
+
+/* Stops listing the directory on display and lets
+ * go of it once no list is built from it anymore */
+void filebrowser_listing_free(void)
+{
+   filebrowser_listing_t *listing = filebrowser_current_listing;
+
+   if (!listing)
+      return;
+
+   task_dir_list_free(listing->task);
+   listing->task               = NULL;
+   filebrowser_current_listing = NULL;
+
+   filebrowser_listing_unref(listing);
+}
+
+/* Gets the listing of @path, starting to list it
+ * if it isn't the directory on display already,
+ * and takes the files found since the last call.
+ *
+ * Returns: NULL if the directory can't be listed
+ * in the background. */
+static filebrowser_listing_t *filebrowser_listing_get(const char *path,
+      const char *exts, bool include_hidden)
+{
+   const char *stack_path         = NULL;
+   const char *stack_label        = NULL;
+   filebrowser_listing_t *listing = filebrowser_current_listing;
+
+   if (     !listing
+         || !string_is_equal(listing->path, path)
+         || !string_is_equal(listing->exts, exts ? exts : "")
+         || listing->include_hidden != include_hidden)
+   {
+      filebrowser_listing_free();
+
+      listing = (filebrowser_listing_t*)calloc(1, sizeof(*listing));
+
+      if (!listing)
+         return NULL;
+
+      listing->list           = string_list_new();
+      listing->exts           = strdup(exts ? exts : "");
+      listing->include_hidden = include_hidden;
+      listing->refs           = 1;
+
+      if (listing->list && listing->exts)
+         listing->task        = task_push_dir_list(path, exts,
+               true, include_hidden, true);
+
+      if (!listing->task)
+      {
+         filebrowser_listing_unref(listing);
+         return NULL;
+      }
+
+      strlcpy(listing->path, path, sizeof(listing->path));
+
+      listing->selection          = menu_navigation_get_selection();
+
+      filebrowser_current_listing = listing;
+   }
+
+   /* The listing is dropped once the menu leaves this level */
+   menu_entries_get_last_stack(&stack_path, &stack_label,
+         NULL, NULL, NULL);
+
+   listing->stack_size = menu_entries_get_stack_size(0);
+   strlcpy(listing->stack_path, stack_path ? stack_path : "",
+         sizeof(listing->stack_path));
+   strlcpy(listing->stack_label, stack_label ? stack_label : "",
+         sizeof(listing->stack_label));
+
+   if (listing->task)
+   {
+      bool error = false;
+
+      if (task_dir_list_take(listing->task, listing->list, &error))
+      {
+         task_dir_list_free(listing->task);
+         listing->task  = NULL;
+         listing->error = error;
+      }
+   }
+
+   listing->refreshed = cpu_features_get_time_usec();
+
+   return listing;
+}
+
+void filebrowser_listing_poll(void)
+{
+   bool finished                  = false;
+   bool pending                   = false;
+   bool refresh                   = false;
+   const char *path               = NULL;
+   const char *label              = NULL;
+   const char *entry_path         = NULL;
+   file_list_t *selection_buf     = NULL;
+   size_t selection               = 0;
+   filebrowser_listing_t *listing = filebrowser_current_listing;
+
+   if (!listing)
+      return;
+
+   menu_entries_get_last_stack(&path, &label, NULL, NULL, NULL);
+
+   if (     menu_entries_get_stack_size(0) != listing->stack_size
+         || !string_is_equal(path  ? path  : "", listing->stack_path)
+         || !string_is_equal(label ? label : "", listing->stack_label))
+   {
+      filebrowser_listing_free();
+      return;
+   }
+
+   if (!listing->task)
+      return;
+
+   /* Don't take the user back once they moved on */
+   if (     listing->selection
+         && menu_navigation_get_selection() + 1 != menu_entries_get_size())
+      listing->selection = 0;
+
+   finished = task_dir_list_poll(listing->task, &pending);
+
+   /* Rebuilding the list gets slower as it grows, so
+    * it is kept to a fraction of the time either way */
+   if (!finished && (!pending || cpu_features_get_time_usec()
+            - listing->refreshed < MAX(FILEBROWSER_LISTING_INTERVAL,
+               4 * listing->refresh_time)))
+      return;
+
+   /* Files may get in before the selection, so it is
+    * looked up again by name after the refresh */
+   selection_buf        = menu_entries_get_selection_buf_ptr(0);
+   selection            = menu_navigation_get_selection();
+   listing->selected[0] = '\0';
+
+   if (!listing->selection
+         && selection_buf && selection < selection_buf->size)
+   {
+      menu_entries_materialize(selection_buf, selection);
+      file_list_get_at_offset(selection_buf, selection,
+            &entry_path, NULL, NULL, NULL);
+
+      if (!string_is_empty(entry_path))
+         strlcpy(listing->selected, entry_path,
+               sizeof(listing->selected));
+   }
+
+   menu_driver_ctl(RARCH_MENU_CTL_SET_PREVENT_POPULATE, NULL);
+   menu_entries_ctl(MENU_ENTRIES_CTL_SET_REFRESH, &refresh);
+}
+
+static enum msg_hash_enums filebrowser_type_to_enum(unsigned file_type)
+{
+   switch (file_type)
+   {
+      case FILE_TYPE_PLAIN:
+#if 0
+         return MENU_ENUM_LABEL_FILE_BROWSER_PLAIN_FILE;
+#endif
+         break;
+      case FILE_TYPE_MOVIE:
+         return MENU_ENUM_LABEL_FILE_BROWSER_MOVIE_OPEN;
+      case FILE_TYPE_MUSIC:
+         return MENU_ENUM_LABEL_FILE_BROWSER_MUSIC_OPEN;
+      case FILE_TYPE_IMAGE:
+         return MENU_ENUM_LABEL_FILE_BROWSER_IMAGE;
+      case FILE_TYPE_IMAGEVIEWER:
+         return MENU_ENUM_LABEL_FILE_BROWSER_IMAGE_OPEN_WITH_VIEWER;
+      case FILE_TYPE_DIRECTORY:
+         return MENU_ENUM_LABEL_FILE_BROWSER_DIRECTORY;
+      default:
+         break;
+   }
+
+   return MSG_UNKNOWN;
+}
+
+static bool filebrowser_get_entry(void *data, size_t entry_idx,
+      unsigned type, char *s, size_t len, char *s2, size_t len2,
+      enum msg_hash_enums *enum_idx)
+{
+   const char *path             = NULL;
+   filebrowser_source_t *source = (filebrowser_source_t*)data;
+
+   if (entry_idx >= source->list->size)
+      return false;
+
+   path = source->list->elems[entry_idx].data;
+
+   /* Need to preserve slash first time. */
+   if (!string_is_empty(path) && !source->path_is_compressed)
+      path = path_basename(path);
+
+   if (path)
+      strlcpy(s, path, len);
+
+   *enum_idx = filebrowser_type_to_enum(type);
+
+   return true;
+}
+
+static void filebrowser_free_source(void *data)
+{
+   filebrowser_source_t *source = (filebrowser_source_t*)data;
+
+   if (source->listing)
+      filebrowser_listing_unref(source->listing);
+   else
+      string_list_free(source->list);
+   free(source);
+}
+
 enum filebrowser_enums filebrowser_get_type(void)
 {
    return filebrowser_types;
@@ -61,7 +334,11 @@ void filebrowser_set_type(enum filebrowser_enums type)
 void filebrowser_parse(menu_displaylist_info_t *info, unsigned type_data)
 {
    size_t i, list_size;
+   size_t selected                      = 0;
    struct string_list *str_list         = NULL;
+   filebrowser_listing_t *listing       = NULL;
+   bool is_virtual                      = false;
+   bool is_selected                     = false;
    unsigned items_found                 = 0;
    unsigned files_count                 = 0;
    unsigned dirs_count                  = 0;
@@ -97,16 +374,33 @@ void filebrowser_parse(menu_displaylist_info_t *info, unsigned type_data)
    }
    else if (!string_is_empty(path))
    {
+      const char *exts = NULL;
+      bool can_list    = true;
+
       if (filebrowser_types == FILEBROWSER_SELECT_FILE_SUBSYSTEM)
       {
          if (subsystem && subsystem_current_count > 0 && content_get_subsystem_rom_id() < subsystem->num_roms)
-            str_list = dir_list_new(path,
-                  (filter_ext && info) ? subsystem->roms[content_get_subsystem_rom_id()].valid_extensions : NULL,
-                  true, settings->bools.show_hidden_files, true, false);
+            exts = (filter_ext && info) ? subsystem->roms[content_get_subsystem_rom_id()].valid_extensions : NULL;
+         else
+            can_list = false;
       }
       else
-         str_list = dir_list_new(path,
-               (filter_ext && info) ? info->exts : NULL,
+         exts = (filter_ext && info) ? info->exts : NULL;
+
+      /* The list on display is filled in while the
+       * directory is being listed in the background */
+      if (can_list && info
+            && info->list == menu_entries_get_selection_buf_ptr(0))
+         listing = filebrowser_listing_get(path, exts,
+               settings->bools.show_hidden_files);
+
+      if (listing)
+      {
+         if (!listing->error)
+            str_list = listing->list;
+      }
+      else if (can_list)
+         str_list = dir_list_new(path, exts,
                true, settings->bools.show_hidden_files, true, false);
    }
 
@@ -146,23 +440,53 @@ void filebrowser_parse(menu_displaylist_info_t *info, unsigned type_data)
       goto end;
    }
 
-   dir_list_sort(str_list, true);
+   /* A listing is sorted as it comes in */
+   if (!listing)
+      dir_list_sort(str_list, true);
 
    list_size = str_list->size;
 
    if (list_size == 0)
    {
-      string_list_free(str_list);
+      if (!listing)
+         string_list_free(str_list);
       str_list = NULL;
    }
    else
    {
+      filebrowser_source_t *source = NULL;
+
+      /* Entries are only built around the selection if the
+       * menu driver can do that, the list keeps the listing
+       * to build the others from */
+      if (info && (source = (filebrowser_source_t*)
+               calloc(1, sizeof(*source))))
+      {
+         menu_entries_virtual_source_t virtual_source;
+
+         source->list               = str_list;
+         source->listing            = listing;
+         source->path_is_compressed = path_is_compressed;
+
+         virtual_source.data        = source;
+         virtual_source.get         = filebrowser_get_entry;
+         virtual_source.free        = filebrowser_free_source;
+
+         is_virtual = menu_entries_virtual_begin(info->list,
+               &virtual_source);
+
+         if (!is_virtual)
+            free(source);
+         else if (listing)
+            listing->refs++;
+      }
+
       for (i = 0; i < list_size; i++)
       {
          char label[64];
          bool is_dir                   = false;
-         enum msg_hash_enums enum_idx  = MSG_UNKNOWN;
          enum msg_file_type file_type  = FILE_TYPE_NONE;
+         enum rarch_content_type media_type = RARCH_CONTENT_NONE;
          const char *path              = str_list->elems[i].data;
 
          label[0] = '\0';
@@ -222,13 +546,16 @@ void filebrowser_parse(menu_displaylist_info_t *info, unsigned type_data)
                file_type = FILE_TYPE_PLAYLIST_COLLECTION;
          }
 
-         if (!is_dir && path_is_media_type(path) == RARCH_CONTENT_MUSIC)
+         if (!is_dir)
+            media_type = path_is_media_type(path);
+
+         if (media_type == RARCH_CONTENT_MUSIC)
             file_type = FILE_TYPE_MUSIC;
          else if (!is_dir &&
                (settings->bools.multimedia_builtin_mediaplayer_enable ||
                 settings->bools.multimedia_builtin_imageviewer_enable))
          {
-            switch (path_is_media_type(path))
+            switch (media_type)
             {
                case RARCH_CONTENT_MOVIE:
 #if defined(HAVE_FFMPEG) || defined(HAVE_MPV)
@@ -255,29 +582,13 @@ void filebrowser_parse(menu_displaylist_info_t *info, unsigned type_data)
          switch (file_type)
          {
             case FILE_TYPE_PLAIN:
-#if 0
-               enum_idx = MENU_ENUM_LABEL_FILE_BROWSER_PLAIN_FILE;
-#endif
-               files_count++;
-               break;
             case FILE_TYPE_MOVIE:
-               enum_idx = MENU_ENUM_LABEL_FILE_BROWSER_MOVIE_OPEN;
-               files_count++;
-               break;
             case FILE_TYPE_MUSIC:
-               enum_idx = MENU_ENUM_LABEL_FILE_BROWSER_MUSIC_OPEN;
-               files_count++;
-               break;
             case FILE_TYPE_IMAGE:
-               enum_idx = MENU_ENUM_LABEL_FILE_BROWSER_IMAGE;
-               files_count++;
-               break;
             case FILE_TYPE_IMAGEVIEWER:
-               enum_idx = MENU_ENUM_LABEL_FILE_BROWSER_IMAGE_OPEN_WITH_VIEWER;
                files_count++;
                break;
             case FILE_TYPE_DIRECTORY:
-               enum_idx = MENU_ENUM_LABEL_FILE_BROWSER_DIRECTORY;
                dirs_count++;
                break;
             default:
@@ -285,29 +596,77 @@ void filebrowser_parse(menu_displaylist_info_t *info, unsigned type_data)
          }
 
          items_found++;
-         menu_entries_append_enum(info->list, path, label,
-               enum_idx,
-               file_type, 0, 0);
+
+         if (     listing
+               && !is_selected
+               && string_is_equal(path, listing->selected))
+         {
+            selected    = info->list->size;
+            is_selected = true;
+         }
+
+         if (is_virtual)
+            menu_entries_append_virtual(info->list, file_type, i);
+         else
+            menu_entries_append_enum(info->list, path, label,
+                  filebrowser_type_to_enum(file_type),
+                  file_type, 0, 0);
       }
    }
 
-   if (str_list && str_list->size > 0)
+   /* A virtual list owns the listing now */
+   if (str_list && str_list->size > 0 && !is_virtual && !listing)
       string_list_free(str_list);
 
    if (items_found == 0)
    {
-      menu_entries_append_enum(info->list,
-            msg_hash_to_str(MENU_ENUM_LABEL_VALUE_NO_ITEMS),
-            msg_hash_to_str(MENU_ENUM_LABEL_NO_ITEMS),
-            MENU_ENUM_LABEL_NO_ITEMS,
-            MENU_SETTING_NO_ITEM, 0, 0);
+      /* Don't tell there's nothing before the
+       * whole directory has been listed */
+      if (listing && listing->task)
+         menu_entries_append_enum(info->list,
+               msg_hash_to_str(MSG_LOADING),
+               msg_hash_to_str(MENU_ENUM_LABEL_NO_ITEMS),
+               MENU_ENUM_LABEL_NO_ITEMS,
+               MENU_SETTING_NO_ITEM, 0, 0);
+      else
+         menu_entries_append_enum(info->list,
+               msg_hash_to_str(MENU_ENUM_LABEL_VALUE_NO_ITEMS),
+               msg_hash_to_str(MENU_ENUM_LABEL_NO_ITEMS),
+               MENU_ENUM_LABEL_NO_ITEMS,
+               MENU_SETTING_NO_ITEM, 0, 0);
    }
 
 end:
    if (info && !path_is_compressed)
+   {
       menu_entries_prepend(info->list,
             msg_hash_to_str(MENU_ENUM_LABEL_VALUE_PARENT_DIRECTORY),
             path,
             MENU_ENUM_LABEL_PARENT_DIRECTORY,
             FILE_TYPE_PARENT_DIRECTORY, 0, 0);
+      selected++;
+   }
+
+   if (listing)
+   {
+      if (listing->selection)
+      {
+         /* Stays on the last entry until there are enough */
+         if (listing->selection < info->list->size)
+         {
+            menu_navigation_set_selection(listing->selection);
+            listing->selection = 0;
+         }
+         else if (listing->task)
+            menu_navigation_set_selection(info->list->size - 1);
+         else
+            listing->selection = 0;
+      }
+      else if (is_selected)
+         menu_navigation_set_selection(selected);
+
+      listing->selected[0]  = '\0';
+      listing->refresh_time = cpu_features_get_time_usec()
+         - listing->refreshed;
+   }
 }
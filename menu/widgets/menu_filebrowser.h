@@ -47,6 +47,13 @@ void filebrowser_set_type(enum filebrowser_enums type);
 
 void filebrowser_parse(menu_displaylist_info_t *data, unsigned type);
 
+/* Refreshes the list on display as files of the
+ * directory being listed come in, and stops listing
+ * once the menu leaves it. Called once per frame. */
+void filebrowser_listing_poll(void);
+
+void filebrowser_listing_free(void);
+
 RETRO_END_DECLS
 
 #endif
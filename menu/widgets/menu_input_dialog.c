@@ -42,7 +42,7 @@ static void menu_input_search_cb(void *userdata, const char *str)
    if (!selection_buf)
       return;
 
-   if (str && *str && file_list_search(selection_buf, str, &idx))
+   if (str && *str && menu_entries_search(selection_buf, str, &idx))
    {
       menu_navigation_set_selection(idx);
       menu_driver_navigation_set(true);
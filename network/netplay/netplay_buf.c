@@ -20,6 +20,11 @@
 
 #include "netplay_private.h"
 
+#ifdef HAVE_NETPLAY_SENDMSG
+#include <sys/uio.h>
+#include <sys/socket.h>
+#endif
+
 static size_t buf_used(struct socket_buffer *sbuf)
 {
    if (sbuf->end < sbuf->start)
@@ -165,6 +170,38 @@ bool netplay_send(struct socket_buffer *sbuf, int sockfd, const void *buf,
    return true;
 }
 
+/**
+ * netplay_send_direct
+ *
+ * Send the given data straight from the caller's buffer if nothing is queued
+ * ahead of it, queueing only what the socket won't take yet.
+ *
+ * Returns false only on socket failures, true otherwise.
+ */
+bool netplay_send_direct(struct socket_buffer *sbuf, int sockfd,
+   const void *buf, size_t len)
+{
+   ssize_t sent;
+
+   if (buf_used(sbuf) != 0)
+   {
+      /* Keep it in order behind what's queued */
+      if (!netplay_send(sbuf, sockfd, buf, len))
+         return false;
+      return netplay_send_flush(sbuf, sockfd, false);
+   }
+
+   sent = socket_send_all_nonblocking(sockfd, buf, len, true);
+   if (sent < 0)
+      return false;
+
+   if ((size_t)sent < len)
+      return netplay_send(sbuf, sockfd,
+            (const unsigned char*)buf + sent, len - sent);
+
+   return true;
+}
+
 /**
  * netplay_send_flush
  *
@@ -205,6 +242,46 @@ bool netplay_send_flush(struct socket_buffer *sbuf, int sockfd, bool block)
    }
    else
    {
+#ifdef HAVE_NETPLAY_SENDMSG
+      /* Unusual case: Buffer overlaps break. Send both halves at once. */
+      while (sbuf->end < sbuf->start)
+      {
+         struct iovec iov[2];
+         struct msghdr msg = {0};
+
+         iov[0].iov_base = sbuf->data + sbuf->start;
+         iov[0].iov_len  = sbuf->bufsz - sbuf->start;
+         iov[1].iov_base = sbuf->data;
+         iov[1].iov_len  = sbuf->end;
+         msg.msg_iov     = iov;
+         msg.msg_iovlen  = 2;
+
+         sent = sendmsg(sockfd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+         if (sent < 0)
+         {
+            if (!isagain((int)sent))
+               return false;
+            sent = 0;
+         }
+
+         if (sent == 0)
+         {
+            if (block)
+               continue;
+            return true;
+         }
+
+         sbuf->start += sent;
+         if (sbuf->start >= sbuf->bufsz)
+            sbuf->start -= sbuf->bufsz;
+      }
+
+      /* Anything left is now in order */
+      if (sbuf->start == sbuf->end)
+         sbuf->start = sbuf->end = 0;
+      else
+         return netplay_send_flush(sbuf, sockfd, block);
+#else
       /* Unusual case: Buffer overlaps break */
       if (block)
       {
@@ -229,6 +306,7 @@ bool netplay_send_flush(struct socket_buffer *sbuf, int sockfd, bool block)
          }
 
       }
+#endif
 
    }
 
@@ -354,3 +432,14 @@ void netplay_recv_flush(struct socket_buffer *sbuf)
 {
    sbuf->start = sbuf->read;
 }
+
+/**
+ * netplay_recv_pending
+ *
+ * Returns true if our recv buffer holds data that hasn't been flushed, such
+ * as a command that was reset to be read again later.
+ */
+bool netplay_recv_pending(struct socket_buffer *sbuf)
+{
+   return buf_used(sbuf) > 0;
+}
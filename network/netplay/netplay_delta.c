@@ -16,9 +16,11 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 
 #include <boolean.h>
+#include <retro_endianness.h>
 #include <encodings/crc32.h>
 
 #include "netplay_private.h"
@@ -53,10 +55,31 @@ bool netplay_delta_frame_ready(netplay_t *netplay, struct delta_frame *delta,
          /* We haven't even replayed this frame yet, so we can't overwrite it! */
          return false;
       }
+      if (netplay->snapshot_interval > 1)
+      {
+         /* A replay starts from the last snapshot at or before
+          * other_frame_count, and runs every frame from there */
+         size_t ptr     = netplay->other_ptr;
+         uint32_t other = netplay->other_frame_count;
+         size_t snapshot_ptr;
+
+         /* other_frame_count may not have been run yet */
+         if (netplay->buffer[ptr].frame != other && other > 0)
+         {
+            ptr = PREV_PTR(ptr);
+            other--;
+         }
+
+         if (netplay_find_snapshot(netplay, ptr, other, &snapshot_ptr) &&
+             netplay->buffer[snapshot_ptr].frame <= delta->frame)
+            return false;
+      }
    }
    delta->used = true;
    delta->frame = frame;
    delta->crc = 0;
+   delta->have_hash = false;
+   delta->has_state = false;
    for (i = 0; i < MAX_INPUT_DEVICES; i++)
    {
       clear_input(delta->resolved_input[i]);
@@ -69,6 +92,43 @@ bool netplay_delta_frame_ready(netplay_t *netplay, struct delta_frame *delta,
    return true;
 }
 
+/**
+ * netplay_find_snapshot
+ *
+ * Walks back from @ptr, which should hold @frame, through consecutive frames
+ * to the nearest one holding a snapshot.
+ *
+ * Returns: True and the buffer index of that frame in @snapshot_ptr, or
+ * false if a gap or a recycled frame comes first.
+ */
+bool netplay_find_snapshot(netplay_t *netplay, size_t ptr, uint32_t frame,
+   size_t *snapshot_ptr)
+{
+   size_t i;
+
+   for (i = 0; i < netplay->buffer_size; i++)
+   {
+      struct delta_frame *delta = &netplay->buffer[ptr];
+
+      if (!delta->used || delta->frame != frame)
+         return false;
+
+      if (delta->has_state)
+      {
+         *snapshot_ptr = ptr;
+         return true;
+      }
+
+      if (frame == 0)
+         return false;
+
+      ptr = PREV_PTR(ptr);
+      frame--;
+   }
+
+   return false;
+}
+
 /**
  * netplay_delta_frame_crc
  *
@@ -81,6 +141,182 @@ uint32_t netplay_delta_frame_crc(netplay_t *netplay, struct delta_frame *delta)
    return encoding_crc32(0L, (const unsigned char*)delta->state, netplay->state_size);
 }
 
+/* State hashing: the XXH64 algorithm, reading words little-endian so that
+ * every platform agrees on the result. */
+#define HASH_PRIME64_1 UINT64_C(0x9E3779B185EBCA87)
+#define HASH_PRIME64_2 UINT64_C(0xC2B2AE3D27D4EB4F)
+#define HASH_PRIME64_3 UINT64_C(0x165667B19E3779F9)
+#define HASH_PRIME64_4 UINT64_C(0x85EBCA77C2B2AE63)
+#define HASH_PRIME64_5 UINT64_C(0x27D4EB2F165667C5)
+
+#define HASH_ROTL64(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+static INLINE uint64_t hash_read64(const uint8_t *p)
+{
+   uint64_t v;
+   memcpy(&v, p, sizeof(v));
+   return swap_if_big64(v);
+}
+
+static INLINE uint32_t hash_read32(const uint8_t *p)
+{
+   uint32_t v;
+   memcpy(&v, p, sizeof(v));
+   return swap_if_big32(v);
+}
+
+static INLINE uint64_t hash_round(uint64_t acc, uint64_t input)
+{
+   acc += input * HASH_PRIME64_2;
+   acc  = HASH_ROTL64(acc, 31);
+   return acc * HASH_PRIME64_1;
+}
+
+static INLINE uint64_t hash_merge(uint64_t acc, uint64_t val)
+{
+   acc ^= hash_round(0, val);
+   return acc * HASH_PRIME64_1 + HASH_PRIME64_4;
+}
+
+static uint64_t netplay_hash64(const uint8_t *data, size_t len)
+{
+   const uint8_t *end = data + len;
+   uint64_t h;
+
+   if (len >= 32)
+   {
+      /* Four independent lanes, so the multiplies can overlap */
+      const uint8_t *limit = end - 32;
+      uint64_t v1          = HASH_PRIME64_1 + HASH_PRIME64_2;
+      uint64_t v2          = HASH_PRIME64_2;
+      uint64_t v3          = 0;
+      uint64_t v4          = (uint64_t)0 - HASH_PRIME64_1;
+
+      do
+      {
+         v1    = hash_round(v1, hash_read64(data));
+         v2    = hash_round(v2, hash_read64(data + 8));
+         v3    = hash_round(v3, hash_read64(data + 16));
+         v4    = hash_round(v4, hash_read64(data + 24));
+         data += 32;
+      } while (data <= limit);
+
+      h = HASH_ROTL64(v1, 1) + HASH_ROTL64(v2, 7) +
+          HASH_ROTL64(v3, 12) + HASH_ROTL64(v4, 18);
+      h = hash_merge(h, v1);
+      h = hash_merge(h, v2);
+      h = hash_merge(h, v3);
+      h = hash_merge(h, v4);
+   }
+   else
+      h = HASH_PRIME64_5;
+
+   h += (uint64_t)len;
+
+   while (data + 8 <= end)
+   {
+      h    ^= hash_round(0, hash_read64(data));
+      h     = HASH_ROTL64(h, 27) * HASH_PRIME64_1 + HASH_PRIME64_4;
+      data += 8;
+   }
+
+   if (data + 4 <= end)
+   {
+      h    ^= (uint64_t)hash_read32(data) * HASH_PRIME64_1;
+      h     = HASH_ROTL64(h, 23) * HASH_PRIME64_2 + HASH_PRIME64_3;
+      data += 4;
+   }
+
+   while (data < end)
+   {
+      h ^= (*data++) * HASH_PRIME64_5;
+      h  = HASH_ROTL64(h, 11) * HASH_PRIME64_1;
+   }
+
+   h ^= h >> 33;
+   h *= HASH_PRIME64_2;
+   h ^= h >> 29;
+   h *= HASH_PRIME64_3;
+   h ^= h >> 32;
+
+   return h;
+}
+
+/* Byte range covered by a hash region */
+static void netplay_hash_region(size_t state_size, unsigned region,
+      size_t *start, size_t *len)
+{
+   size_t region_size = (state_size + NETPLAY_HASH_REGIONS - 1) /
+      NETPLAY_HASH_REGIONS;
+
+   *start = region * region_size;
+   if (*start > state_size)
+      *start = state_size;
+   *len   = state_size - *start;
+   if (*len > region_size)
+      *len = region_size;
+}
+
+/**
+ * netplay_delta_frame_hash
+ *
+ * Get the 64-bit hash for the serialization of this frame, and the hashes of
+ * its NETPLAY_HASH_REGIONS regions in regions.
+ */
+uint64_t netplay_delta_frame_hash(netplay_t *netplay, struct delta_frame *delta,
+   uint64_t *regions)
+{
+   unsigned i;
+   uint8_t top[NETPLAY_HASH_REGIONS * sizeof(uint64_t)];
+
+   for (i = 0; i < NETPLAY_HASH_REGIONS; i++)
+   {
+      size_t start, len;
+      uint64_t le;
+
+      netplay_hash_region(netplay->state_size, i, &start, &len);
+      regions[i] = netplay_hash64(
+            (const uint8_t*)delta->state + start, len);
+
+      le = swap_if_big64(regions[i]);
+      memcpy(top + i * sizeof(uint64_t), &le, sizeof(le));
+   }
+
+   return netplay_hash64(top, sizeof(top));
+}
+
+/**
+ * netplay_delta_frame_check_hash
+ *
+ * Check our serialization of this frame against the hash stored in it,
+ * logging which regions of the state differ.
+ *
+ * Returns: true if the hashes match.
+ */
+bool netplay_delta_frame_check_hash(netplay_t *netplay,
+   struct delta_frame *delta)
+{
+   unsigned i;
+   uint64_t regions[NETPLAY_HASH_REGIONS];
+
+   if (netplay_delta_frame_hash(netplay, delta, regions) == delta->hash)
+      return true;
+
+   for (i = 0; i < NETPLAY_HASH_REGIONS; i++)
+   {
+      size_t start, len;
+
+      if (regions[i] == delta->region_hash[i])
+         continue;
+
+      netplay_hash_region(netplay->state_size, i, &start, &len);
+      RARCH_LOG("[netplay] State mismatch at frame %u in bytes %u-%u.\n",
+            delta->frame, (unsigned)start, (unsigned)(start + len - 1));
+   }
+
+   return false;
+}
+
 /*
  * Free an input state list
  */
@@ -187,3 +423,133 @@ uint32_t netplay_expected_input_size(netplay_t *netplay, uint32_t devices)
    }
    return ret;
 }
+
+static void netplay_delta_put_u32(uint8_t *out, uint32_t val)
+{
+   out[0] = (uint8_t)(val >> 24);
+   out[1] = (uint8_t)(val >> 16);
+   out[2] = (uint8_t)(val >> 8);
+   out[3] = (uint8_t)(val);
+}
+
+static uint32_t netplay_delta_get_u32(const uint8_t *in)
+{
+   return ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) |
+          ((uint32_t)in[2] << 8)  |  (uint32_t)in[3];
+}
+
+/**
+ * netplay_savestate_delta_encode
+ *
+ * Encode the blocks of state which differ from base as a list of runs, each
+ * an offset and a length (uint32, network byte order) followed by the new
+ * bytes. Adjacent changed blocks are merged into one run.
+ *
+ * Returns: True and the encoded size if the delta fits in out_size bytes,
+ * false if a full state would be no larger.
+ */
+bool netplay_savestate_delta_encode(const uint8_t *base, const uint8_t *state,
+      size_t size, uint8_t *out, size_t out_size, size_t *out_len)
+{
+   size_t pos = 0;
+   size_t len = 0;
+
+   while (pos < size)
+   {
+      size_t start, block;
+
+      /* Skip unchanged blocks */
+      block = size - pos;
+      if (block > NETPLAY_DELTA_BLOCK_SIZE)
+         block = NETPLAY_DELTA_BLOCK_SIZE;
+      if (!memcmp(base + pos, state + pos, block))
+      {
+         pos += block;
+         continue;
+      }
+
+      /* Extend the run over every following changed block */
+      start = pos;
+      pos  += block;
+      while (pos < size)
+      {
+         block = size - pos;
+         if (block > NETPLAY_DELTA_BLOCK_SIZE)
+            block = NETPLAY_DELTA_BLOCK_SIZE;
+         if (!memcmp(base + pos, state + pos, block))
+            break;
+         pos += block;
+      }
+
+      if (len + 2*sizeof(uint32_t) + (pos - start) >= out_size)
+         return false;
+
+      netplay_delta_put_u32(out + len, (uint32_t)start);
+      netplay_delta_put_u32(out + len + sizeof(uint32_t),
+            (uint32_t)(pos - start));
+      len += 2*sizeof(uint32_t);
+      memcpy(out + len, state + start, pos - start);
+      len += pos - start;
+   }
+
+   *out_len = len;
+   return true;
+}
+
+/**
+ * netplay_savestate_delta_apply
+ *
+ * Apply a delta produced by netplay_savestate_delta_encode to state, which
+ * must hold the base it was computed against.
+ *
+ * Returns: False if the delta is malformed.
+ */
+bool netplay_savestate_delta_apply(const uint8_t *delta, size_t delta_len,
+      uint8_t *state, size_t size)
+{
+   size_t pos = 0;
+
+   while (pos < delta_len)
+   {
+      uint32_t offset, len;
+
+      if (delta_len - pos < 2*sizeof(uint32_t))
+         return false;
+
+      offset = netplay_delta_get_u32(delta + pos);
+      len    = netplay_delta_get_u32(delta + pos + sizeof(uint32_t));
+      pos   += 2*sizeof(uint32_t);
+
+      if (offset > size || len > size - offset || len > delta_len - pos)
+         return false;
+
+      memcpy(state + offset, delta + pos, len);
+      pos += len;
+   }
+
+   return true;
+}
+
+/**
+ * netplay_savestate_delta_store
+ *
+ * Remember state as the base of the next delta in one direction of a
+ * connection. A state of unexpected size drops the base, so the next
+ * transfer is a full one.
+ */
+void netplay_savestate_delta_store(netplay_t *netplay, uint8_t **base,
+      const void *state, size_t size)
+{
+   if (size != netplay->state_size)
+   {
+      free(*base);
+      *base = NULL;
+      return;
+   }
+
+   if (!*base)
+      *base = (uint8_t*)malloc(size);
+
+   if (*base)
+      memcpy(*base, state, size);
+}
@@ -248,12 +248,7 @@ static bool get_self_input_state(netplay_t *netplay)
    }
 
    /* And send this input to our peers */
-   for (i = 0; i < netplay->connections_size; i++)
-   {
-      struct netplay_connection *connection = &netplay->connections[i];
-      if (connection->active && connection->mode >= NETPLAY_CONNECTION_CONNECTED)
-         netplay_send_cur_input(netplay, &netplay->connections[i]);
-   }
+   netplay_send_cur_input_all(netplay);
 
    /* Handle any delayed state changes */
    if (netplay->is_server)
@@ -1191,7 +1186,8 @@ static void netplay_force_future(netplay_t *netplay)
  * @z                    : compression backend to use
  *
  * Send a loaded savestate to those connected peers using the given compression
- * scheme.
+ * scheme. Peers which support it and already hold an earlier state from us
+ * are sent only the blocks that changed since.
  */
 void netplay_send_savestate(netplay_t *netplay,
    retro_ctx_serialize_info_t *serial_info, uint32_t cx,
@@ -1200,39 +1196,79 @@ void netplay_send_savestate(netplay_t *netplay,
    uint32_t header[4];
    uint32_t rd, wn;
    size_t i;
+   uint32_t full_wn = 0;
 
-   /* Compress it */
-   z->compression_backend->set_in(z->compression_stream,
-      (const uint8_t*)serial_info->data_const, (uint32_t)serial_info->size);
-   z->compression_backend->set_out(z->compression_stream,
-      netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
-   if (!z->compression_backend->trans(z->compression_stream, true, &rd,
-         &wn, NULL))
-   {
-      /* Catastrophe! */
-      for (i = 0; i < netplay->connections_size; i++)
-         netplay_hangup(netplay, &netplay->connections[i]);
-      return;
-   }
-
-   /* Send it to relevant peers */
-   header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
-   header[1] = htonl(wn + 2*sizeof(uint32_t));
    header[2] = htonl(netplay->run_frame_count);
    header[3] = htonl(serial_info->size);
 
    for (i = 0; i < netplay->connections_size; i++)
    {
+      size_t delta_len                      = 0;
       struct netplay_connection *connection = &netplay->connections[i];
       if (!connection->active ||
           connection->mode < NETPLAY_CONNECTION_CONNECTED ||
           connection->compression_supported != cx) continue;
 
+      if (connection->savestate_sent && netplay->delta_buffer &&
+          serial_info->size == netplay->state_size &&
+          netplay_savestate_delta_encode(connection->savestate_sent,
+            (const uint8_t*)serial_info->data_const, serial_info->size,
+            netplay->delta_buffer, serial_info->size, &delta_len))
+      {
+         /* Compress the delta, which overwrites any full state in zbuffer */
+         full_wn = 0;
+         z->compression_backend->set_in(z->compression_stream,
+            netplay->delta_buffer, (uint32_t)delta_len);
+         z->compression_backend->set_out(z->compression_stream,
+            netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
+         if (!z->compression_backend->trans(z->compression_stream, true, &rd,
+               &wn, NULL))
+         {
+            netplay_hangup(netplay, connection);
+            continue;
+         }
+
+         header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE_DELTA);
+      }
+      else
+      {
+         if (!full_wn)
+         {
+            /* Compress it */
+            z->compression_backend->set_in(z->compression_stream,
+               (const uint8_t*)serial_info->data_const,
+               (uint32_t)serial_info->size);
+            z->compression_backend->set_out(z->compression_stream,
+               netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
+            if (!z->compression_backend->trans(z->compression_stream, true,
+                  &rd, &full_wn, NULL))
+            {
+               /* Catastrophe! */
+               for (i = 0; i < netplay->connections_size; i++)
+                  netplay_hangup(netplay, &netplay->connections[i]);
+               return;
+            }
+         }
+
+         wn        = full_wn;
+         header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
+      }
+
+      /* Send it to this peer */
+      header[1] = htonl(wn + 2*sizeof(uint32_t));
+
       if (!netplay_send(&connection->send_packet_buffer, connection->fd, header,
             sizeof(header)) ||
           !netplay_send(&connection->send_packet_buffer, connection->fd,
             netplay->zbuffer, wn))
+      {
          netplay_hangup(netplay, connection);
+         continue;
+      }
+
+      if (connection->savestate_delta)
+         netplay_savestate_delta_store(netplay, &connection->savestate_sent,
+            serial_info->data_const, serial_info->size);
    }
 }
 
@@ -1276,6 +1312,8 @@ void netplay_load_savestate(netplay_t *netplay,
                      serial_info->data_const, serial_info->size);
             }
          }
+         netplay->buffer[netplay->run_ptr].has_state = true;
+         netplay->snapshot_frame_count = netplay->run_frame_count;
       }
       else
       {
@@ -1513,6 +1551,8 @@ bool init_netplay(void *direct_host, const char *server, unsigned port)
             : server_port_deferred   ) : (port != 0 ? port : RARCH_DEFAULT_PORT),
          settings->bools.netplay_stateless_mode,
          settings->ints.netplay_check_frames,
+         settings->uints.netplay_snapshot_interval,
+         settings->bools.netplay_udp_input,
          &cbs,
          settings->bools.netplay_nat_traversal,
 #ifdef HAVE_DISCORD
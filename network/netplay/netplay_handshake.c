@@ -210,7 +210,8 @@ bool netplay_handshake_init_send(netplay_t *netplay,
 
    header[0] = htonl(netplay_magic);
    header[1] = htonl(netplay_platform_magic());
-   header[2] = htonl(NETPLAY_COMPRESSION_SUPPORTED);
+   header[2] = htonl(NETPLAY_COMPRESSION_SUPPORTED |
+         (netplay->udp_fd >= 0 ? NETPLAY_COMPRESSION_UDP_INPUT : 0));
    header[3] = 0;
    header[4] = htonl(NETPLAY_PROTOCOL_VERSION);
    header[5] = htonl(netplay_impl_magic());
@@ -374,8 +375,22 @@ bool netplay_handshake_init(netplay_t *netplay,
 
    /* Check what compression is supported */
    compression  = ntohl(header[2]);
+
+   /* Input datagrams are used only if both sides have a socket for them */
+   connection->udp = (compression & NETPLAY_COMPRESSION_UDP_INPUT) &&
+      netplay->udp_fd >= 0;
+   if (connection->udp && netplay->is_server)
+   {
+      if (simple_rand_next == 1)
+         simple_srand((unsigned int) time(NULL));
+      connection->udp_token = simple_rand_uint32();
+   }
+
    compression &= NETPLAY_COMPRESSION_SUPPORTED;
 
+   connection->savestate_delta = !!(compression & NETPLAY_COMPRESSION_DELTA);
+   connection->state_hash      = !!(compression & NETPLAY_COMPRESSION_STATE_HASH);
+
    if (compression & NETPLAY_COMPRESSION_ZLIB)
    {
       ctrans = &netplay->compress_zlib;
@@ -110,7 +110,7 @@ end:
 }
 
 static bool init_tcp_socket(netplay_t *netplay, void *direct_host,
-      const char *server, uint16_t port)
+      const char *server, uint16_t port, bool udp_input)
 {
    char port_buf[16];
    bool ret                        = false;
@@ -204,6 +204,8 @@ static bool init_tcp_socket(netplay_t *netplay, void *direct_host,
          {
             netplay->listen_fd = fd;
          }
+         if (udp_input)
+            netplay_udp_init(netplay, tmp_info);
          break;
       }
 
@@ -220,12 +222,12 @@ static bool init_tcp_socket(netplay_t *netplay, void *direct_host,
 }
 
 static bool init_socket(netplay_t *netplay, void *direct_host,
-      const char *server, uint16_t port)
+      const char *server, uint16_t port, bool udp_input)
 {
    if (!network_init())
       return false;
 
-   if (!init_tcp_socket(netplay, direct_host, server, port))
+   if (!init_tcp_socket(netplay, direct_host, server, port, udp_input))
       return false;
 
    if (netplay->is_server && netplay->nat_traversal)
@@ -298,7 +300,8 @@ bool netplay_init_serialization(netplay_t *netplay)
 
    netplay->zbuffer_size = netplay->state_size * 2;
    netplay->zbuffer = (uint8_t *) calloc(netplay->zbuffer_size, 1);
-   if (!netplay->zbuffer)
+   netplay->delta_buffer = (uint8_t *) malloc(netplay->state_size);
+   if (!netplay->zbuffer || !netplay->delta_buffer)
    {
       netplay->quirks |= NETPLAY_QUIRK_NO_TRANSMISSION;
       netplay->zbuffer_size = 0;
@@ -385,6 +388,10 @@ static bool netplay_init_buffers(netplay_t *netplay)
    if (netplay->is_server)
       netplay->buffer_size *= 2;
 
+   /* Plus enough to reach back to the last snapshot when replaying */
+   if (netplay->snapshot_interval > 1)
+      netplay->buffer_size += netplay->snapshot_interval;
+
    delta_frames = (struct delta_frame*)calloc(netplay->buffer_size,
          sizeof(*delta_frames));
 
@@ -406,6 +413,8 @@ static bool netplay_init_buffers(netplay_t *netplay)
  * @port                 : Port of server.
  * @stateless_mode       : Shall we use stateless mode?
  * @check_frames         : Frequency with which to check CRCs.
+ * @snapshot_interval    : Serialize the core every this many frames.
+ * @udp_input            : Also exchange input over UDP?
  * @cb                   : Libretro callbacks.
  * @nat_traversal        : If true, attempt NAT traversal.
  * @nick                 : Nickname of user.
@@ -417,8 +426,8 @@ static bool netplay_init_buffers(netplay_t *netplay)
  * Returns: new netplay data.
  */
 netplay_t *netplay_new(void *direct_host, const char *server, uint16_t port,
-   bool stateless_mode, int check_frames,
-   const struct retro_callbacks *cb, bool nat_traversal, const char *nick,
+   bool stateless_mode, int check_frames, unsigned snapshot_interval,
+   bool udp_input, const struct retro_callbacks *cb, bool nat_traversal, const char *nick,
    uint64_t quirks)
 {
    netplay_t *netplay = (netplay_t*)calloc(1, sizeof(*netplay));
@@ -426,6 +435,8 @@ netplay_t *netplay_new(void *direct_host, const char *server, uint16_t port,
       return NULL;
 
    netplay->listen_fd            = -1;
+   netplay->poll_fd              = -1;
+   netplay->udp_fd               = -1;
    netplay->tcp_port             = port;
    netplay->cbs                  = *cb;
    netplay->is_server            = (direct_host == NULL && server == NULL);
@@ -433,6 +444,9 @@ netplay_t *netplay_new(void *direct_host, const char *server, uint16_t port,
    netplay->nat_traversal        = netplay->is_server ? nat_traversal : false;
    netplay->stateless_mode       = stateless_mode;
    netplay->check_frames         = check_frames;
+   netplay->snapshot_interval    = snapshot_interval ? snapshot_interval : 1;
+   if (netplay->snapshot_interval > NETPLAY_MAX_STALL_FRAMES)
+      netplay->snapshot_interval = NETPLAY_MAX_STALL_FRAMES;
    netplay->crc_validity_checked = false;
    netplay->crcs_valid           = true;
    netplay->quirks               = quirks;
@@ -456,7 +470,7 @@ netplay_t *netplay_new(void *direct_host, const char *server, uint16_t port,
          ? nick : RARCH_DEFAULT_NICK,
          sizeof(netplay->nick));
 
-   if (!init_socket(netplay, direct_host, server, port))
+   if (!init_socket(netplay, direct_host, server, port, udp_input))
    {
       free(netplay);
       return NULL;
@@ -468,6 +482,8 @@ netplay_t *netplay_new(void *direct_host, const char *server, uint16_t port,
       return NULL;
    }
 
+   netplay_poll_init(netplay);
+
    if (netplay->is_server)
    {
       /* Clients get device info from the server */
@@ -530,6 +546,12 @@ void netplay_free(netplay_t *netplay)
 {
    size_t i;
 
+   if (netplay->rollback_count)
+      RARCH_LOG("[netplay] %u rollbacks, %.1f frames deep on average, %u at most.\n",
+            netplay->rollback_count,
+            (double)netplay->rollback_frames / netplay->rollback_count,
+            netplay->rollback_max);
+
    if (netplay->listen_fd >= 0)
       socket_close(netplay->listen_fd);
 
@@ -542,11 +564,17 @@ void netplay_free(netplay_t *netplay)
          netplay_deinit_socket_buffer(&connection->send_packet_buffer);
          netplay_deinit_socket_buffer(&connection->recv_packet_buffer);
       }
+      free(connection->savestate_sent);
+      free(connection->savestate_recv);
+      netplay_udp_free_connection(connection);
    }
 
    if (netplay->connections && netplay->connections != &netplay->one_connection)
       free(netplay->connections);
 
+   netplay_poll_deinit(netplay);
+   netplay_udp_deinit(netplay);
+
    if (netplay->nat_traversal)
       natt_free(&netplay->nat_traversal_state);
 
@@ -561,6 +589,9 @@ void netplay_free(netplay_t *netplay)
    if (netplay->zbuffer)
       free(netplay->zbuffer);
 
+   if (netplay->delta_buffer)
+      free(netplay->delta_buffer);
+
    if (netplay->compress_nil.compression_stream)
    {
       netplay->compress_nil.compression_backend->stream_free(netplay->compress_nil.compression_stream);
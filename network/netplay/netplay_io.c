@@ -17,6 +17,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <errno.h>
 #include <sys/types.h>
 
 #include <boolean.h>
@@ -24,6 +25,11 @@
 
 #include "netplay_private.h"
 
+#ifdef HAVE_NETPLAY_EPOLL
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
 #include "../../configuration.h"
 #include "../../retroarch.h"
 #include "../../command.h"
@@ -133,11 +139,27 @@ void netplay_hangup(netplay_t *netplay, struct netplay_connection *connection)
    RARCH_LOG("[netplay] %s\n", dmsg);
    runloop_msg_queue_push(dmsg, 1, 180, false, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
 
+#ifdef HAVE_NETPLAY_EPOLL
+   if (netplay->poll_fd >= 0)
+   {
+      struct epoll_event ev = {0};
+      if (epoll_ctl(netplay->poll_fd, EPOLL_CTL_DEL, connection->fd, &ev) == 0)
+         netplay->poll_count--;
+   }
+#endif
+
    socket_close(connection->fd);
    connection->active = false;
    netplay_deinit_socket_buffer(&connection->send_packet_buffer);
    netplay_deinit_socket_buffer(&connection->recv_packet_buffer);
 
+   free(connection->savestate_sent);
+   free(connection->savestate_recv);
+   connection->savestate_sent = NULL;
+   connection->savestate_recv = NULL;
+
+   netplay_udp_free_connection(connection);
+
    if (!netplay->is_server)
    {
       netplay->self_mode = NETPLAY_CONNECTION_NONE;
@@ -224,12 +246,21 @@ void netplay_delayed_state_change(netplay_t *netplay)
 }
 
 /* Send the specified input data */
-static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
-      struct netplay_connection *only, struct netplay_connection *except,
-      uint32_t client_num, bool slave)
+/* Room for one encoded INPUT command */
+#define INPUT_FRAME_BUFSZ 16 /* FIXME: Arbitrary restriction */
+
+/**
+ * encode_input_frame
+ *
+ * Encode an INPUT command for the given client's input in the given frame.
+ *
+ * Returns the size of the command in words.
+ */
+static size_t encode_input_frame(netplay_t *netplay,
+      struct delta_frame *dframe, uint32_t client_num, bool slave,
+      uint32_t *buffer)
 {
-#define BUFSZ 16 /* FIXME: Arbitrary restriction */
-   uint32_t buffer[BUFSZ], devices, device;
+   uint32_t devices, device;
    size_t bufused, i;
 
    /* Set up the basic buffer */
@@ -250,7 +281,7 @@ static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
          istate = istate->next;
       if (!istate)
          continue;
-      if (bufused + istate->size >= BUFSZ)
+      if (bufused + istate->size >= INPUT_FRAME_BUFSZ)
          continue; /* FIXME: More severe? */
       for (i = 0; i < istate->size; i++)
          buffer[bufused+i] = htonl(istate->data[i]);
@@ -258,6 +289,18 @@ static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
    }
    buffer[1] = htonl((bufused-2) * sizeof(uint32_t));
 
+   return bufused;
+}
+
+static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
+      struct netplay_connection *only, struct netplay_connection *except,
+      uint32_t client_num, bool slave)
+{
+   uint32_t buffer[INPUT_FRAME_BUFSZ];
+   size_t bufused, i;
+
+   bufused = encode_input_frame(netplay, dframe, client_num, slave, buffer);
+
 #ifdef DEBUG_NETPLAY_STEPS
    RARCH_LOG("[netplay] Sending input for client %u\n", (unsigned) client_num);
    print_state(netplay);
@@ -270,6 +313,7 @@ static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
          netplay_hangup(netplay, only);
          return false;
       }
+      netplay_udp_record(netplay, only, buffer, bufused);
    }
    else
    {
@@ -285,12 +329,13 @@ static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
             if (!netplay_send(&connection->send_packet_buffer, connection->fd,
                   buffer, bufused*sizeof(uint32_t)))
                netplay_hangup(netplay, connection);
+            else
+               netplay_udp_record(netplay, connection, buffer, bufused);
          }
       }
    }
 
    return true;
-#undef BUFSZ
 }
 
 /**
@@ -330,10 +375,14 @@ bool netplay_send_cur_input(netplay_t *netplay,
       /* If we're not playing, send a NOINPUT */
       if (netplay->self_mode != NETPLAY_CONNECTION_PLAYING)
       {
-         uint32_t payload = htonl(netplay->self_frame_count);
+         uint32_t noinput[3];
+         noinput[0] = htonl(NETPLAY_CMD_NOINPUT);
+         noinput[1] = htonl(sizeof(uint32_t));
+         noinput[2] = htonl(netplay->self_frame_count);
          if (!netplay_send_raw_cmd(netplay, connection, NETPLAY_CMD_NOINPUT,
-               &payload, sizeof(payload)))
+               &noinput[2], sizeof(uint32_t)))
             return false;
+         netplay_udp_record(netplay, connection, noinput, 3);
       }
 
    }
@@ -352,9 +401,80 @@ bool netplay_send_cur_input(netplay_t *netplay,
          false))
       return false;
 
+   netplay_udp_send(netplay, connection);
+
    return true;
 }
 
+/**
+ * netplay_send_cur_input_all
+ *
+ * Send the current input frame to every connected peer. Every spectator
+ * gets the same commands, so for them they're encoded once and sent to each
+ * straight from that one buffer.
+ */
+void netplay_send_cur_input_all(netplay_t *netplay)
+{
+   uint32_t spectator_packet[(MAX_CLIENTS + 1) * INPUT_FRAME_BUFSZ + 3];
+   size_t spectator_words = 0;
+   bool have_spectator    = false;
+   struct delta_frame *dframe = &netplay->buffer[netplay->self_ptr];
+   size_t i;
+
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      struct netplay_connection *connection = &netplay->connections[i];
+
+      if (!connection->active ||
+            connection->mode < NETPLAY_CONNECTION_CONNECTED)
+         continue;
+
+      if (!netplay->is_server ||
+            connection->mode != NETPLAY_CONNECTION_SPECTATING)
+      {
+         netplay_send_cur_input(netplay, connection);
+         continue;
+      }
+
+      if (!have_spectator)
+      {
+         /* What netplay_send_cur_input would queue for a spectator, which is
+          * never among the players it skips */
+         uint32_t from_client;
+
+         for (from_client = 1; from_client < MAX_CLIENTS; from_client++)
+         {
+            if ((netplay->connected_players & (1<<from_client)) &&
+                  dframe->have_real[from_client])
+               spectator_words += encode_input_frame(netplay, dframe,
+                     from_client, false, spectator_packet + spectator_words);
+         }
+
+         if (netplay->self_mode != NETPLAY_CONNECTION_PLAYING)
+         {
+            spectator_packet[spectator_words++] = htonl(NETPLAY_CMD_NOINPUT);
+            spectator_packet[spectator_words++] = htonl(sizeof(uint32_t));
+            spectator_packet[spectator_words++] =
+               htonl(netplay->self_frame_count);
+         }
+
+         if (netplay->self_mode == NETPLAY_CONNECTION_PLAYING
+               || netplay->self_mode == NETPLAY_CONNECTION_SLAVE)
+            spectator_words += encode_input_frame(netplay, dframe,
+                  netplay->self_client_num,
+                  netplay->self_mode == NETPLAY_CONNECTION_SLAVE,
+                  spectator_packet + spectator_words);
+
+         have_spectator = true;
+      }
+
+      if (!netplay_send_direct(&connection->send_packet_buffer,
+               connection->fd, spectator_packet,
+               spectator_words * sizeof(uint32_t)))
+         netplay_hangup(netplay, connection);
+   }
+}
+
 /**
  * netplay_send_raw_cmd
  *
@@ -444,15 +564,38 @@ static bool netplay_cmd_nak(netplay_t *netplay,
 bool netplay_cmd_crc(netplay_t *netplay, struct delta_frame *delta)
 {
    uint32_t payload[2];
+   uint32_t hash_payload[3 + 2*NETPLAY_HASH_REGIONS];
    bool success = true;
    size_t i;
    payload[0] = htonl(delta->frame);
    payload[1] = htonl(delta->crc);
+
+   if (delta->have_hash)
+   {
+      hash_payload[0] = htonl(delta->frame);
+      hash_payload[1] = htonl((uint32_t)(delta->hash >> 32));
+      hash_payload[2] = htonl((uint32_t)delta->hash);
+      for (i = 0; i < NETPLAY_HASH_REGIONS; i++)
+      {
+         hash_payload[3 + 2*i]     = htonl((uint32_t)(delta->region_hash[i] >> 32));
+         hash_payload[3 + 2*i + 1] = htonl((uint32_t)delta->region_hash[i]);
+      }
+   }
+
    for (i = 0; i < netplay->connections_size; i++)
    {
-      if (netplay->connections[i].active &&
-            netplay->connections[i].mode >= NETPLAY_CONNECTION_CONNECTED)
-         success = netplay_send_raw_cmd(netplay, &netplay->connections[i],
+      struct netplay_connection *connection = &netplay->connections[i];
+
+      if (!connection->active ||
+            connection->mode < NETPLAY_CONNECTION_CONNECTED)
+         continue;
+
+      if (connection->state_hash && delta->have_hash)
+         success = netplay_send_raw_cmd(netplay, connection,
+            NETPLAY_CMD_STATE_HASH, hash_payload, sizeof(hash_payload))
+            && success;
+      else
+         success = netplay_send_raw_cmd(netplay, connection,
             NETPLAY_CMD_CRC, payload, sizeof(payload)) && success;
    }
    return success;
@@ -899,6 +1042,72 @@ static void handle_play_spectate(netplay_t *netplay, uint32_t client_num,
    }
 }
 
+/**
+ * netplay_store_input
+ *
+ * Store the given input for the next frame we expect from this client,
+ * advancing its read pointer and, on the server, forwarding it to the other
+ * peers. input holds the client's device data in host order.
+ *
+ * Returns 1 on success, 0 if the frame isn't ready yet, -1 on failure.
+ */
+int netplay_store_input(netplay_t *netplay,
+   struct netplay_connection *connection, uint32_t client_num,
+   const uint32_t *input)
+{
+   uint32_t devices = netplay->client_devices[client_num];
+   uint32_t device;
+   struct delta_frame *dframe = &netplay->buffer[netplay->read_ptr[client_num]];
+
+   if (!netplay_delta_frame_ready(netplay, dframe, netplay->read_frame_count[client_num]))
+      return 0;
+
+   /* Copy in the input */
+   for (device = 0; device < MAX_INPUT_DEVICES; device++)
+   {
+      netplay_input_state_t istate;
+      uint32_t dsize;
+      if (!(devices & (1<<device)))
+         continue;
+
+      dsize = netplay_expected_input_size(netplay, 1 << device);
+      istate = netplay_input_state_for(&dframe->real_input[device],
+            client_num, dsize,
+            false /* Must be false because of slave-mode clients */,
+            false);
+      if (!istate)
+         return -1;
+      memcpy(istate->data, input, dsize*sizeof(uint32_t));
+      input += dsize;
+   }
+   dframe->have_real[client_num] = true;
+
+   /* Slaves may go through several packets of data in the same frame
+    * if latency is choppy, so we advance and send their data after
+    * handling all network data this frame */
+   if (connection->mode == NETPLAY_CONNECTION_PLAYING)
+   {
+      netplay->read_ptr[client_num] = NEXT_PTR(netplay->read_ptr[client_num]);
+      netplay->read_frame_count[client_num]++;
+
+      if (netplay->is_server)
+      {
+         /* Forward it on if it's past data */
+         if (dframe->frame <= netplay->self_frame_count)
+            send_input_frame(netplay, dframe, NULL, connection, client_num, false);
+      }
+   }
+
+   /* If this was server data, advance our server pointer too */
+   if (!netplay->is_server && client_num == 0)
+   {
+      netplay->server_ptr = netplay->read_ptr[0];
+      netplay->server_frame_count = netplay->read_frame_count[0];
+   }
+
+   return 1;
+}
+
 #undef RECV
 #define RECV(buf, sz) \
 recvd = netplay_recv(&connection->recv_packet_buffer, connection->fd, (buf), \
@@ -946,8 +1155,8 @@ static bool netplay_get_cmd(netplay_t *netplay,
 
       case NETPLAY_CMD_INPUT:
          {
-            uint32_t frame_num, client_num, input_size, devices, device;
-            struct delta_frame *dframe;
+            uint32_t frame_num, client_num, input_size, devices, i;
+            uint32_t input[NETPLAY_MAX_INPUT_WORDS];
 
             if (cmd_size < 2*sizeof(uint32_t))
             {
@@ -1020,59 +1229,27 @@ static bool netplay_get_cmd(netplay_t *netplay,
             }
 
             /* The data's good! */
-            dframe = &netplay->buffer[netplay->read_ptr[client_num]];
-            if (!netplay_delta_frame_ready(netplay, dframe, netplay->read_frame_count[client_num]))
+            if (input_size > NETPLAY_MAX_INPUT_WORDS)
             {
-               /* Hopefully we'll be ready after another round of input */
-               goto shrt;
+               RARCH_ERR("NETPLAY_CMD_INPUT received too much input.\n");
+               return netplay_cmd_nak(netplay, connection);
             }
+            RECV(input, input_size*sizeof(uint32_t))
+               return false;
+            for (i = 0; i < input_size; i++)
+               input[i] = ntohl(input[i]);
 
-            /* Copy in the input */
-            for (device = 0; device < MAX_INPUT_DEVICES; device++)
+            switch (netplay_store_input(netplay, connection, client_num,
+                     input))
             {
-               netplay_input_state_t istate;
-               uint32_t dsize, di;
-               if (!(devices & (1<<device)))
-                  continue;
-
-               dsize = netplay_expected_input_size(netplay, 1 << device);
-               istate = netplay_input_state_for(&dframe->real_input[device],
-                     client_num, dsize,
-                     false /* Must be false because of slave-mode clients */,
-                     false);
-               if (!istate)
-               {
+               case 0:
+                  /* Hopefully we'll be ready after another round of input */
+                  goto shrt;
+               case -1:
                   /* Catastrophe! */
                   return netplay_cmd_nak(netplay, connection);
-               }
-               RECV(istate->data, dsize*sizeof(uint32_t))
-                  return false;
-               for (di = 0; di < dsize; di++)
-                  istate->data[di] = ntohl(istate->data[di]);
-            }
-            dframe->have_real[client_num] = true;
-
-            /* Slaves may go through several packets of data in the same frame
-             * if latency is choppy, so we advance and send their data after
-             * handling all network data this frame */
-            if (connection->mode == NETPLAY_CONNECTION_PLAYING)
-            {
-               netplay->read_ptr[client_num] = NEXT_PTR(netplay->read_ptr[client_num]);
-               netplay->read_frame_count[client_num]++;
-
-               if (netplay->is_server)
-               {
-                  /* Forward it on if it's past data */
-                  if (dframe->frame <= netplay->self_frame_count)
-                     send_input_frame(netplay, dframe, NULL, connection, client_num, false);
-               }
-            }
-
-            /* If this was server data, advance our server pointer too */
-            if (!netplay->is_server && client_num == 0)
-            {
-               netplay->server_ptr = netplay->read_ptr[0];
-               netplay->server_frame_count = netplay->read_frame_count[0];
+               default:
+                  break;
             }
 
 #ifdef DEBUG_NETPLAY_STEPS
@@ -1533,6 +1710,14 @@ static bool netplay_get_cmd(netplay_t *netplay,
                break;
             }
 
+            if (buffer[0] <= netplay->other_frame_count &&
+                !netplay->buffer[tmp_ptr].has_state)
+            {
+               /* Already passed, but between snapshots, so there's no
+                * state to check */
+               break;
+            }
+
             if (buffer[0] <= netplay->other_frame_count)
             {
                /* We've already replayed up to this frame, so we can check it
@@ -1555,6 +1740,100 @@ static bool netplay_get_cmd(netplay_t *netplay,
             break;
          }
 
+      case NETPLAY_CMD_UDP_TOKEN:
+         {
+            uint32_t token;
+
+            if (netplay->is_server)
+            {
+               RARCH_ERR("NETPLAY_CMD_UDP_TOKEN from a client.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            if (cmd_size != sizeof(token))
+            {
+               RARCH_ERR("NETPLAY_CMD_UDP_TOKEN received unexpected payload size.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            RECV(&token, sizeof(token))
+            {
+               RARCH_ERR("NETPLAY_CMD_UDP_TOKEN failed to receive payload.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            /* From now on our datagrams carry it */
+            if (connection->udp)
+            {
+               connection->udp_token      = ntohl(token);
+               connection->udp_token_sent = true;
+            }
+            break;
+         }
+
+      case NETPLAY_CMD_STATE_HASH:
+         {
+            uint32_t buffer[3 + 2*NETPLAY_HASH_REGIONS];
+            size_t tmp_ptr = netplay->run_ptr;
+            struct delta_frame *delta = NULL;
+            uint32_t frame;
+            unsigned i;
+
+            if (cmd_size != sizeof(buffer))
+            {
+               RARCH_ERR("NETPLAY_CMD_STATE_HASH received unexpected payload size.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            RECV(buffer, sizeof(buffer))
+            {
+               RARCH_ERR("NETPLAY_CMD_STATE_HASH failed to receive payload.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            frame = ntohl(buffer[0]);
+
+            /* Same as for CRC: find the frame if we still have it */
+            do
+            {
+               if (     netplay->buffer[tmp_ptr].used
+                     && netplay->buffer[tmp_ptr].frame == frame)
+               {
+                  delta = &netplay->buffer[tmp_ptr];
+                  break;
+               }
+
+               tmp_ptr = PREV_PTR(tmp_ptr);
+            } while (tmp_ptr != netplay->run_ptr);
+
+            if (!delta)
+               break;
+
+            if (frame <= netplay->other_frame_count && !delta->has_state)
+               break;
+
+            delta->hash = ((uint64_t)ntohl(buffer[1]) << 32) | ntohl(buffer[2]);
+            for (i = 0; i < NETPLAY_HASH_REGIONS; i++)
+               delta->region_hash[i] =
+                  ((uint64_t)ntohl(buffer[3 + 2*i]) << 32) |
+                  ntohl(buffer[3 + 2*i + 1]);
+
+            if (frame <= netplay->other_frame_count)
+            {
+               /* We've already replayed up to this frame, so we can check it
+                * directly */
+               if (!netplay_delta_frame_check_hash(netplay, delta))
+                  netplay_cmd_request_savestate(netplay);
+            }
+            else
+            {
+               /* We'll have to check it when we catch up */
+               delta->have_hash = true;
+            }
+
+            break;
+         }
+
       case NETPLAY_CMD_REQUEST_SAVESTATE:
          /* Delay until next frame so we don't send the savestate after the
           * input */
@@ -1562,6 +1841,7 @@ static bool netplay_get_cmd(netplay_t *netplay,
          break;
 
       case NETPLAY_CMD_LOAD_SAVESTATE:
+      case NETPLAY_CMD_LOAD_SAVESTATE_DELTA:
       case NETPLAY_CMD_RESET:
          {
             uint32_t frame;
@@ -1619,7 +1899,7 @@ static bool netplay_get_cmd(netplay_t *netplay,
              * too many places. */
 
             /* Check the payload size */
-            if ((cmd == NETPLAY_CMD_LOAD_SAVESTATE &&
+            if ((cmd != NETPLAY_CMD_RESET &&
                  (cmd_size < 2*sizeof(uint32_t) || cmd_size > netplay->zbuffer_size + 2*sizeof(uint32_t))) ||
                 (cmd == NETPLAY_CMD_RESET && cmd_size != sizeof(uint32_t)))
             {
@@ -1658,8 +1938,10 @@ static bool netplay_get_cmd(netplay_t *netplay,
             }
 
             /* Now we switch based on whether we're loading a state or resetting */
-            if (cmd == NETPLAY_CMD_LOAD_SAVESTATE)
+            if (cmd != NETPLAY_CMD_RESET)
             {
+               uint8_t *state = (uint8_t*)netplay->buffer[load_ptr].state;
+
                RECV(&isize, sizeof(isize))
                {
                   RARCH_ERR("CMD_LOAD_SAVESTATE failed to receive inflated size.\n");
@@ -1690,11 +1972,47 @@ static bool netplay_get_cmd(netplay_t *netplay,
                }
                ctrans->decompression_backend->set_in(ctrans->decompression_stream,
                   netplay->zbuffer, cmd_size - 2*sizeof(uint32_t));
-               ctrans->decompression_backend->set_out(ctrans->decompression_stream,
-                  (uint8_t*)netplay->buffer[load_ptr].state,
-                  (unsigned)netplay->state_size);
-               ctrans->decompression_backend->trans(ctrans->decompression_stream,
-                  true, &rd, &wn, NULL);
+
+               if (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA)
+               {
+                  /* A delta against the last state this peer sent us */
+                  if (!connection->savestate_recv || !netplay->delta_buffer)
+                  {
+                     RARCH_ERR("CMD_LOAD_SAVESTATE_DELTA received without a base state.\n");
+                     return netplay_cmd_nak(netplay, connection);
+                  }
+
+                  ctrans->decompression_backend->set_out(ctrans->decompression_stream,
+                     netplay->delta_buffer, (unsigned)netplay->state_size);
+                  if (!ctrans->decompression_backend->trans(
+                        ctrans->decompression_stream, true, &rd, &wn, NULL))
+                  {
+                     RARCH_ERR("CMD_LOAD_SAVESTATE_DELTA failed to decompress.\n");
+                     return netplay_cmd_nak(netplay, connection);
+                  }
+
+                  memcpy(state, connection->savestate_recv, netplay->state_size);
+                  if (!netplay_savestate_delta_apply(netplay->delta_buffer, wn,
+                        state, netplay->state_size))
+                  {
+                     RARCH_ERR("CMD_LOAD_SAVESTATE_DELTA received a malformed delta.\n");
+                     return netplay_cmd_nak(netplay, connection);
+                  }
+               }
+               else
+               {
+                  ctrans->decompression_backend->set_out(ctrans->decompression_stream,
+                     state, (unsigned)netplay->state_size);
+                  ctrans->decompression_backend->trans(ctrans->decompression_stream,
+                     true, &rd, &wn, NULL);
+               }
+
+               if (connection->savestate_delta)
+                  netplay_savestate_delta_store(netplay,
+                     &connection->savestate_recv, state, netplay->state_size);
+
+               netplay->buffer[load_ptr].has_state = true;
+               netplay->snapshot_frame_count       = load_frame_count;
 
                /* Force a rewind to the relevant frame */
                netplay->force_rewind = true;
@@ -1851,6 +2169,241 @@ shrt:
 #undef RECV
 }
 
+/**
+ * netplay_poll_init
+ *
+ * Set up the server's connection poller, if the platform has one.
+ */
+void netplay_poll_init(netplay_t *netplay)
+{
+   netplay->poll_fd = -1;
+#ifdef HAVE_NETPLAY_EPOLL
+   if (netplay->is_server)
+   {
+      netplay->poll_fd = epoll_create(NETPLAY_POLL_EVENTS);
+      if (netplay->poll_fd < 0)
+         RARCH_WARN("[netplay] Could not create epoll instance, falling back to select.\n");
+      else if (netplay->udp_fd >= 0)
+      {
+         /* Only to wake us; it's read on every pass regardless */
+         struct epoll_event ev = {0};
+         ev.events   = EPOLLIN;
+         ev.data.u32 = UINT32_MAX;
+         epoll_ctl(netplay->poll_fd, EPOLL_CTL_ADD, netplay->udp_fd, &ev);
+      }
+   }
+#endif
+}
+
+/**
+ * netplay_poll_deinit
+ *
+ * Free the server's connection poller.
+ */
+void netplay_poll_deinit(netplay_t *netplay)
+{
+#ifdef HAVE_NETPLAY_EPOLL
+   if (netplay->poll_fd >= 0)
+      close(netplay->poll_fd);
+#endif
+   netplay->poll_fd = -1;
+   if (netplay->poll_ready)
+      free(netplay->poll_ready);
+   netplay->poll_ready          = NULL;
+   netplay->poll_ready_count    = 0;
+   netplay->poll_ready_capacity = 0;
+}
+
+#ifdef HAVE_NETPLAY_EPOLL
+/**
+ * netplay_poll_queue
+ *
+ * Put a connection on the list of connections to read.
+ */
+static bool netplay_poll_queue(netplay_t *netplay, size_t idx)
+{
+   struct netplay_connection *connection = &netplay->connections[idx];
+
+   if (connection->poll_queued)
+      return true;
+
+   if (netplay->poll_ready_count >= netplay->poll_ready_capacity)
+   {
+      size_t new_capacity = netplay->poll_ready_capacity ?
+         netplay->poll_ready_capacity * 2 : NETPLAY_POLL_EVENTS;
+      size_t *new_ready   = (size_t*)realloc(netplay->poll_ready,
+            new_capacity * sizeof(size_t));
+
+      if (!new_ready)
+         return false;
+
+      netplay->poll_ready          = new_ready;
+      netplay->poll_ready_capacity = new_capacity;
+   }
+
+   netplay->poll_ready[netplay->poll_ready_count++] = idx;
+   connection->poll_queued                         = true;
+   return true;
+}
+
+/**
+ * netplay_poll_wait
+ *
+ * Queue every connection epoll reports as readable, waiting up to
+ * timeout_ms for the first.
+ *
+ * Returns -1 on error, 0 otherwise.
+ */
+static int netplay_poll_wait(netplay_t *netplay, int timeout_ms)
+{
+   struct epoll_event events[NETPLAY_POLL_EVENTS];
+   size_t rounds = netplay->connections_size / NETPLAY_POLL_EVENTS + 1;
+
+   while (rounds--)
+   {
+      int i;
+      int n = epoll_wait(netplay->poll_fd, events, NETPLAY_POLL_EVENTS,
+            timeout_ms);
+
+      if (n < 0)
+         return (errno == EINTR) ? 0 : -1;
+
+      for (i = 0; i < n; i++)
+      {
+         size_t idx = events[i].data.u32;
+         if (idx < netplay->connections_size &&
+               !netplay_poll_queue(netplay, idx))
+            return -1;
+      }
+
+      if (n < NETPLAY_POLL_EVENTS)
+         break;
+
+      timeout_ms = 0;
+   }
+
+   return 0;
+}
+
+/**
+ * netplay_poll_net_input_epoll
+ *
+ * netplay_poll_net_input for servers with a poller: only connections epoll
+ * reported, or which still had commands buffered, are read.
+ */
+static int netplay_poll_net_input_epoll(netplay_t *netplay, bool block)
+{
+   bool had_input = false;
+
+   if (netplay->poll_count == 0)
+      return 0;
+
+   netplay->timeout_cnt = 0;
+
+   do
+   {
+      size_t i, kept;
+
+      had_input = false;
+
+      netplay->timeout_cnt++;
+
+      if (netplay_poll_wait(netplay, 0) < 0)
+         return -1;
+
+      if (netplay_udp_receive(netplay))
+         had_input = true;
+
+      /* Read input from each ready connection. One that yielded a command
+       * may have more buffered, and one still shaking hands is read every
+       * time, as with select. So is one holding a command it couldn't act
+       * on yet: its bytes are already out of the socket, so epoll won't
+       * report it again. The rest wait for epoll to report them. */
+      for (i = kept = 0; i < netplay->poll_ready_count; i++)
+      {
+         size_t idx = netplay->poll_ready[i];
+         struct netplay_connection *connection = &netplay->connections[idx];
+         bool conn_input = false;
+
+         if (connection->active &&
+               !netplay_get_cmd(netplay, connection, &conn_input))
+            netplay_hangup(netplay, connection);
+
+         if (conn_input)
+            had_input = true;
+
+         if (connection->active && (conn_input ||
+                  connection->mode < NETPLAY_CONNECTION_CONNECTED ||
+                  netplay_recv_pending(&connection->recv_packet_buffer)))
+            netplay->poll_ready[kept++] = idx;
+         else
+            connection->poll_queued = false;
+      }
+      netplay->poll_ready_count = kept;
+
+      if (block)
+      {
+         netplay_update_unread_ptr(netplay);
+
+         /* If we were blocked for input, pass if we have this frame's input */
+         if (netplay->unread_frame_count > netplay->run_frame_count)
+            break;
+
+         /* If we're supposed to block but we didn't have enough input, wait for it */
+         if (!had_input)
+         {
+            if (netplay_poll_wait(netplay, RETRY_MS) < 0)
+               return -1;
+
+            RARCH_LOG("[netplay] Network is stalling at frame %u, count %u of %d ...\n",
+                  netplay->run_frame_count, netplay->timeout_cnt, MAX_RETRIES);
+
+            if (netplay->timeout_cnt >= MAX_RETRIES && !netplay->remote_paused)
+               return -1;
+         }
+      }
+   } while (had_input || block);
+
+   return 0;
+}
+#endif
+
+/**
+ * netplay_poll_add
+ *
+ * Start watching a newly accepted connection.
+ *
+ * Returns true if successful or if there's no poller, false otherwise.
+ */
+bool netplay_poll_add(netplay_t *netplay,
+   struct netplay_connection *connection)
+{
+#ifdef HAVE_NETPLAY_EPOLL
+   size_t i;
+   struct epoll_event ev = {0};
+   size_t idx            = connection - netplay->connections;
+
+   if (netplay->poll_fd < 0)
+      return true;
+
+   ev.events   = EPOLLIN;
+   ev.data.u32 = (uint32_t)idx;
+   if (epoll_ctl(netplay->poll_fd, EPOLL_CTL_ADD, connection->fd, &ev) < 0)
+      return false;
+   netplay->poll_count++;
+
+   /* Read it at once, like any other new connection. A slot reused since
+    * its last hangup may still be on the list. */
+   connection->poll_queued = false;
+   for (i = 0; i < netplay->poll_ready_count; i++)
+      if (netplay->poll_ready[i] == idx)
+         connection->poll_queued = true;
+   return netplay_poll_queue(netplay, idx);
+#else
+   return true;
+#endif
+}
+
 /**
  * netplay_poll_net_input
  *
@@ -1862,6 +2415,11 @@ int netplay_poll_net_input(netplay_t *netplay, bool block)
    int max_fd = 0;
    size_t i;
 
+#ifdef HAVE_NETPLAY_EPOLL
+   if (netplay->poll_fd >= 0)
+      return netplay_poll_net_input_epoll(netplay, block);
+#endif
+
    for (i = 0; i < netplay->connections_size; i++)
    {
       struct netplay_connection *connection = &netplay->connections[i];
@@ -1872,6 +2430,9 @@ int netplay_poll_net_input(netplay_t *netplay, bool block)
    if (max_fd == 0)
       return 0;
 
+   if (netplay->udp_fd >= max_fd)
+      max_fd = netplay->udp_fd + 1;
+
    netplay->timeout_cnt = 0;
 
    do
@@ -1880,6 +2441,9 @@ int netplay_poll_net_input(netplay_t *netplay, bool block)
 
       netplay->timeout_cnt++;
 
+      if (netplay_udp_receive(netplay))
+         had_input = true;
+
       /* Read input from each connection */
       for (i = 0; i < netplay->connections_size; i++)
       {
@@ -1910,6 +2474,8 @@ int netplay_poll_net_input(netplay_t *netplay, bool block)
                if (connection->active)
                   FD_SET(connection->fd, &fds);
             }
+            if (netplay->udp_fd >= 0)
+               FD_SET(netplay->udp_fd, &fds);
 
             if (socket_select(max_fd, &fds, NULL, NULL, &tv) < 0)
                return -1;
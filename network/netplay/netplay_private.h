@@ -52,6 +52,36 @@ typedef uint32_t client_bitmap_t;
  * callbacks are in use, we assign a pseudodevice for it */
 #define RETRO_DEVICE_NETPLAY_KEYBOARD RETRO_DEVICE_SUBCLASS(RETRO_DEVICE_KEYBOARD, 65535)
 
+/* The server waits on its connections with epoll and flushes wrapped send
+ * buffers with a single sendmsg where available */
+#if defined(__linux__)
+#define HAVE_NETPLAY_EPOLL   1
+#define HAVE_NETPLAY_SENDMSG 1
+#endif
+
+/* Most connection events handled per epoll_wait */
+#define NETPLAY_POLL_EVENTS  64
+
+/* Most input words a client may send for one frame; the keyboard is the
+ * largest device at 5 words */
+#define NETPLAY_MAX_INPUT_WORDS (MAX_INPUT_DEVICES * 5)
+
+/* Each input datagram repeats the commands of this many frames, so that a
+ * lost datagram is covered by the next one */
+#define NETPLAY_UDP_REDUNDANCY 8
+
+/* Commands remembered per connection for the redundant copies */
+#define NETPLAY_UDP_HISTORY    64
+
+/* Largest input command kept for them, as netplay_io.c encodes them */
+#define NETPLAY_UDP_CMD_WORDS  16
+
+/* Largest input datagram, to stay clear of fragmentation */
+#define NETPLAY_UDP_MAX_WORDS  300
+
+/* First word of every input datagram */
+#define NETPLAY_UDP_MAGIC      0x52414E55 /* RANU */
+
 #define NETPLAY_MAX_STALL_FRAMES       60
 #define NETPLAY_FRAME_RUN_TIME_WINDOW  120
 #define NETPLAY_MAX_REQ_STALL_TIME     60
@@ -89,12 +119,34 @@ typedef uint32_t client_bitmap_t;
 
 /* Compression protocols supported */
 #define NETPLAY_COMPRESSION_ZLIB (1<<0)
+
+/* Not a compression protocol of its own: advertises that the peer
+ * understands NETPLAY_CMD_LOAD_SAVESTATE_DELTA */
+#define NETPLAY_COMPRESSION_DELTA (1<<1)
+
+/* Likewise, advertises that the peer understands NETPLAY_CMD_STATE_HASH */
+#define NETPLAY_COMPRESSION_STATE_HASH (1<<2)
+
+/* Advertises an input datagram socket. Only sent when enabled, so it's not
+ * part of NETPLAY_COMPRESSION_SUPPORTED */
+#define NETPLAY_COMPRESSION_UDP_INPUT (1<<3)
+
 #if HAVE_ZLIB
-#define NETPLAY_COMPRESSION_SUPPORTED NETPLAY_COMPRESSION_ZLIB
+#define NETPLAY_COMPRESSION_SUPPORTED \
+   (NETPLAY_COMPRESSION_ZLIB | NETPLAY_COMPRESSION_DELTA | \
+    NETPLAY_COMPRESSION_STATE_HASH)
 #else
-#define NETPLAY_COMPRESSION_SUPPORTED 0
+#define NETPLAY_COMPRESSION_SUPPORTED \
+   (NETPLAY_COMPRESSION_DELTA | NETPLAY_COMPRESSION_STATE_HASH)
 #endif
 
+/* Granularity at which savestate deltas are computed */
+#define NETPLAY_DELTA_BLOCK_SIZE 64
+
+/* Number of equal regions a state hash is split into. The state hash is
+ * the hash of the region hashes, so a mismatch can be narrowed down. */
+#define NETPLAY_HASH_REGIONS 16
+
 enum netplay_cmd
 {
    /* Basic commands */
@@ -166,6 +218,15 @@ enum netplay_cmd
    /* Sends over cheats enabled on client (unsupported) */
    NETPLAY_CMD_CHEATS         = 0x0047,
 
+   /* Send a savestate as a delta against the last one exchanged */
+   NETPLAY_CMD_LOAD_SAVESTATE_DELTA = 0x0049,
+
+   /* Like CRC, with a 64-bit state hash and its region hashes */
+   NETPLAY_CMD_STATE_HASH     = 0x004A,
+
+   /* Token identifying the client's input datagrams */
+   NETPLAY_CMD_UDP_TOKEN      = 0x004B,
+
    /* Misc. commands */
 
    /* Sends multiple config requests over,
@@ -295,9 +356,20 @@ struct delta_frame
    /* The serialized state of the core at this frame, before input */
    void *state;
 
+   /* Does state hold a snapshot for this frame? With a snapshot interval
+    * above 1, most frames are not serialized and are reconstructed by
+    * replaying from the nearest earlier snapshot. */
+   bool has_state;
+
    /* The CRC-32 of the serialized state if we've calculated it, else 0 */
    uint32_t crc;
 
+   /* The state hash and region hashes, if have_hash. On the server these are
+    * ours; on a client they are the server's, waiting to be checked. */
+   bool have_hash;
+   uint64_t hash;
+   uint64_t region_hash[NETPLAY_HASH_REGIONS];
+
    /* The resolved input, i.e., what's actually going to the core. One input
     * per device. */
    netplay_input_state_t resolved_input[MAX_INPUT_DEVICES];
@@ -324,6 +396,14 @@ struct socket_buffer
    size_t read;
 };
 
+/* An input command kept for the redundant datagram copies */
+struct netplay_udp_entry
+{
+   uint32_t frame;
+   uint32_t words;
+   uint32_t data[NETPLAY_UDP_CMD_WORDS];
+};
+
 /* Each connection gets a connection struct */
 struct netplay_connection
 {
@@ -333,6 +413,9 @@ struct netplay_connection
    /* fd associated with this connection */
    int fd;
 
+   /* Is this connection on the server's list of connections to read? */
+   bool poll_queued;
+
    /* Address of peer */
    struct sockaddr_storage addr;
 
@@ -359,6 +442,34 @@ struct netplay_connection
    /* What compression does this peer support? */
    uint32_t compression_supported;
 
+   /* Does this peer accept savestate deltas? */
+   bool savestate_delta;
+
+   /* Does this peer check state hashes rather than CRCs? */
+   bool state_hash;
+
+   /* Do we exchange input datagrams with this peer? */
+   bool udp;
+
+   /* Token the client prefixes its datagrams with, and whether the server
+    * has sent it (server) or received it (client) */
+   uint32_t udp_token;
+   bool udp_token_sent;
+
+   /* Where this client's datagrams come from (server only) */
+   struct sockaddr_storage udp_addr;
+   socklen_t udp_addr_len;
+
+   /* Recent input commands sent to this peer, repeated in each datagram */
+   struct netplay_udp_entry *udp_history;
+   size_t udp_history_ptr;
+
+   /* The last savestate sent to and received from this peer, which the
+    * next delta in either direction is computed against. NULL until a
+    * first state has been exchanged. */
+   uint8_t *savestate_sent;
+   uint8_t *savestate_recv;
+
    /* Is this player paused? */
    bool paused;
 
@@ -405,6 +516,20 @@ struct netplay
    size_t connections_size;
    struct netplay_connection one_connection; /* Client only */
 
+   /* epoll instance watching the connections, or -1 (server only) */
+   int poll_fd;
+
+   /* Number of connections registered with poll_fd */
+   size_t poll_count;
+
+   /* Indices of connections which may have data to read */
+   size_t *poll_ready;
+   size_t poll_ready_count;
+   size_t poll_ready_capacity;
+
+   /* Input datagram socket, or -1 */
+   int udp_fd;
+
    /* Bitmap of clients with input devices */
    uint32_t connected_players;
 
@@ -459,6 +584,10 @@ struct netplay
    uint8_t *zbuffer;
    size_t zbuffer_size;
 
+   /* Scratch space of state_size bytes for building and unpacking
+    * savestate deltas */
+   uint8_t *delta_buffer;
+
    /* The size of our packet buffers */
    size_t packet_buffer_size;
 
@@ -562,6 +691,17 @@ struct netplay
    /* Frequency with which to check CRCs */
    int check_frames;
 
+   /* Serialize the core every this many frames (1 = every frame) */
+   unsigned snapshot_interval;
+
+   /* Frame of the most recent snapshot */
+   uint32_t snapshot_frame_count;
+
+   /* Replays performed, frames replayed in total and the deepest replay */
+   uint32_t rollback_count;
+   uint64_t rollback_frames;
+   uint32_t rollback_max;
+
    /* Have we checked whether CRCs are valid at all? */
    bool crc_validity_checked;
 
@@ -602,6 +742,17 @@ void netplay_deinit_socket_buffer(struct socket_buffer *sbuf);
 bool netplay_send(struct socket_buffer *sbuf, int sockfd, const void *buf,
    size_t len);
 
+/**
+ * netplay_send_direct
+ *
+ * Send the given data straight from the caller's buffer if nothing is queued
+ * ahead of it, queueing only what the socket won't take yet.
+ *
+ * Returns false only on socket failures, true otherwise.
+ */
+bool netplay_send_direct(struct socket_buffer *sbuf, int sockfd,
+   const void *buf, size_t len);
+
 /**
  * netplay_send_flush
  *
@@ -638,6 +789,14 @@ void netplay_recv_reset(struct socket_buffer *sbuf);
  */
 void netplay_recv_flush(struct socket_buffer *sbuf);
 
+/**
+ * netplay_recv_pending
+ *
+ * Returns true if our recv buffer holds data that hasn't been flushed, such
+ * as a command that was reset to be read again later.
+ */
+bool netplay_recv_pending(struct socket_buffer *sbuf);
+
 /***************************************************************
  * NETPLAY-DELTA.C
  **************************************************************/
@@ -654,6 +813,18 @@ void netplay_recv_flush(struct socket_buffer *sbuf);
 bool netplay_delta_frame_ready(netplay_t *netplay, struct delta_frame *delta,
    uint32_t frame);
 
+/**
+ * netplay_find_snapshot
+ *
+ * Walks back from @ptr, which should hold @frame, through consecutive frames
+ * to the nearest one holding a snapshot.
+ *
+ * Returns: True and the buffer index of that frame in @snapshot_ptr, or
+ * false if a gap or a recycled frame comes first.
+ */
+bool netplay_find_snapshot(netplay_t *netplay, size_t ptr, uint32_t frame,
+   size_t *snapshot_ptr);
+
 /**
  * netplay_delta_frame_crc
  *
@@ -661,6 +832,26 @@ bool netplay_delta_frame_ready(netplay_t *netplay, struct delta_frame *delta,
  */
 uint32_t netplay_delta_frame_crc(netplay_t *netplay, struct delta_frame *delta);
 
+/**
+ * netplay_delta_frame_hash
+ *
+ * Get the 64-bit hash for the serialization of this frame, and the hashes of
+ * its NETPLAY_HASH_REGIONS regions in regions.
+ */
+uint64_t netplay_delta_frame_hash(netplay_t *netplay, struct delta_frame *delta,
+   uint64_t *regions);
+
+/**
+ * netplay_delta_frame_check_hash
+ *
+ * Check our serialization of this frame against the hash stored in it,
+ * logging which regions of the state differ.
+ *
+ * Returns: true if the hashes match.
+ */
+bool netplay_delta_frame_check_hash(netplay_t *netplay,
+   struct delta_frame *delta);
+
 /**
  * netplay_delta_frame_free
  *
@@ -683,6 +874,37 @@ netplay_input_state_t netplay_input_state_for(netplay_input_state_t *list,
  */
 uint32_t netplay_expected_input_size(netplay_t *netplay, uint32_t devices);
 
+/**
+ * netplay_savestate_delta_encode
+ *
+ * Encode the blocks of state which differ from base as a list of runs.
+ *
+ * Returns: True and the encoded size if the delta fits in out_size bytes,
+ * false if a full state would be no larger.
+ */
+bool netplay_savestate_delta_encode(const uint8_t *base, const uint8_t *state,
+      size_t size, uint8_t *out, size_t out_size, size_t *out_len);
+
+/**
+ * netplay_savestate_delta_apply
+ *
+ * Apply a delta produced by netplay_savestate_delta_encode to state, which
+ * must hold the base it was computed against.
+ *
+ * Returns: False if the delta is malformed.
+ */
+bool netplay_savestate_delta_apply(const uint8_t *delta, size_t delta_len,
+      uint8_t *state, size_t size);
+
+/**
+ * netplay_savestate_delta_store
+ *
+ * Remember state as the base of the next delta in one direction of a
+ * connection.
+ */
+void netplay_savestate_delta_store(netplay_t *netplay, uint8_t **base,
+      const void *state, size_t size);
+
 /***************************************************************
  * NETPLAY-DISCOVERY.C
  **************************************************************/
@@ -775,6 +997,8 @@ bool netplay_wait_and_init_serialization(netplay_t *netplay);
  * @port                 : Port of server.
  * @stateless_mode       : Shall we run in stateless mode?
  * @check_frames         : Frequency with which to check CRCs.
+ * @snapshot_interval    : Serialize the core every this many frames.
+ * @udp_input            : Also exchange input over UDP?
  * @cb                   : Libretro callbacks.
  * @nat_traversal        : If true, attempt NAT traversal.
  * @nick                 : Nickname of user.
@@ -786,8 +1010,8 @@ bool netplay_wait_and_init_serialization(netplay_t *netplay);
  * Returns: new netplay data.
  */
 netplay_t *netplay_new(void *direct_host, const char *server, uint16_t port,
-   bool stateless_mode, int check_frames,
-   const struct retro_callbacks *cb, bool nat_traversal, const char *nick,
+   bool stateless_mode, int check_frames, unsigned snapshot_interval,
+   bool udp_input, const struct retro_callbacks *cb, bool nat_traversal, const char *nick,
    uint64_t quirks);
 
 /**
@@ -827,6 +1051,24 @@ void netplay_delayed_state_change(netplay_t *netplay);
 bool netplay_send_cur_input(netplay_t *netplay,
    struct netplay_connection *connection);
 
+/**
+ * netplay_send_cur_input_all
+ *
+ * Send the current input frame to every connected peer.
+ */
+void netplay_send_cur_input_all(netplay_t *netplay);
+
+/**
+ * netplay_store_input
+ *
+ * Store the given input for the next frame we expect from this client.
+ *
+ * Returns 1 on success, 0 if the frame isn't ready yet, -1 on failure.
+ */
+int netplay_store_input(netplay_t *netplay,
+   struct netplay_connection *connection, uint32_t client_num,
+   const uint32_t *input);
+
 /**
  * netplay_send_raw_cmd
  *
@@ -880,6 +1122,30 @@ bool netplay_cmd_stall(netplay_t *netplay,
    struct netplay_connection *connection,
    uint32_t frames);
 
+/**
+ * netplay_poll_init
+ *
+ * Set up the server's connection poller, if the platform has one.
+ */
+void netplay_poll_init(netplay_t *netplay);
+
+/**
+ * netplay_poll_deinit
+ *
+ * Free the server's connection poller.
+ */
+void netplay_poll_deinit(netplay_t *netplay);
+
+/**
+ * netplay_poll_add
+ *
+ * Start watching a newly accepted connection.
+ *
+ * Returns true if successful or if there's no poller, false otherwise.
+ */
+bool netplay_poll_add(netplay_t *netplay,
+   struct netplay_connection *connection);
+
 /**
  * netplay_poll_net_input
  *
@@ -977,4 +1243,66 @@ bool netplay_sync_pre_frame(netplay_t *netplay);
  */
 void netplay_sync_post_frame(netplay_t *netplay, bool stalled);
 
+/***************************************************************
+ * NETPLAY-UDP.C
+ **************************************************************/
+
+/**
+ * netplay_udp_init
+ * @netplay              : pointer to netplay object
+ * @addr                 : address the TCP socket was set up with
+ *
+ * Open the input datagram socket: the server binds the same address and port
+ * as it listens on, the client connects to the server's.
+ *
+ * Returns true if successful, false otherwise.
+ */
+bool netplay_udp_init(netplay_t *netplay, const struct addrinfo *addr);
+
+/**
+ * netplay_udp_deinit
+ *
+ * Close the input datagram socket.
+ */
+void netplay_udp_deinit(netplay_t *netplay);
+
+/**
+ * netplay_udp_free_connection
+ *
+ * Forget a connection's datagram state, when it hangs up.
+ */
+void netplay_udp_free_connection(struct netplay_connection *connection);
+
+/**
+ * netplay_udp_record
+ * @netplay              : pointer to netplay object
+ * @connection           : connection the command was sent to
+ * @cmd                  : the command, in network order
+ * @words                : size of the command in words
+ *
+ * Remember an INPUT or NOINPUT command sent over TCP so that the following
+ * datagrams repeat it.
+ */
+void netplay_udp_record(netplay_t *netplay,
+   struct netplay_connection *connection, const uint32_t *cmd, size_t words);
+
+/**
+ * netplay_udp_send
+ *
+ * Send the connection a datagram holding the input commands of the last
+ * NETPLAY_UDP_REDUNDANCY frames.
+ */
+void netplay_udp_send(netplay_t *netplay,
+   struct netplay_connection *connection);
+
+/**
+ * netplay_udp_receive
+ *
+ * Read every pending input datagram, storing any input that's the next
+ * expected from its client.
+ *
+ * Returns true if any input was stored.
+ */
+bool netplay_udp_receive(netplay_t *netplay);
+
 #endif
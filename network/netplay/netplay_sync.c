@@ -500,20 +500,50 @@ bool netplay_resolve_input(netplay_t *netplay, size_t sim_ptr, bool resim)
 static void netplay_handle_frame_hash(netplay_t *netplay,
       struct delta_frame *delta)
 {
+   /* Nothing to hash on a frame we never serialized */
+   if (!delta->has_state)
+      return;
+
    if (netplay->is_server)
    {
       if (netplay->check_frames &&
           delta->frame % abs(netplay->check_frames) == 0)
       {
-         delta->crc = netplay_delta_frame_crc(netplay, delta);
+         size_t i;
+         bool want_crc  = false;
+         bool want_hash = false;
+
+         /* Only compute what the connected clients will check */
+         for (i = 0; i < netplay->connections_size; i++)
+         {
+            struct netplay_connection *connection = &netplay->connections[i];
+            if (!connection->active ||
+                  connection->mode < NETPLAY_CONNECTION_CONNECTED)
+               continue;
+            if (connection->state_hash)
+               want_hash = true;
+            else
+               want_crc  = true;
+         }
+
+         if (want_crc)
+            delta->crc = netplay_delta_frame_crc(netplay, delta);
+         if (want_hash)
+         {
+            delta->hash      = netplay_delta_frame_hash(netplay, delta,
+                  delta->region_hash);
+            delta->have_hash = true;
+         }
          netplay_cmd_crc(netplay, delta);
       }
    }
-   else if (delta->crc && netplay->crcs_valid)
+   else if ((delta->have_hash || delta->crc) && netplay->crcs_valid)
    {
-      /* We have a remote CRC, so check it */
-      uint32_t local_crc = netplay_delta_frame_crc(netplay, delta);
-      if (local_crc != delta->crc)
+      /* We have a remote hash, so check it */
+      bool match = delta->have_hash
+         ? netplay_delta_frame_check_hash(netplay, delta)
+         : netplay_delta_frame_crc(netplay, delta) == delta->crc;
+      if (!match)
       {
          /* If the very first check frame is wrong,
           * they probably just don't work */
@@ -536,6 +566,31 @@ static void netplay_handle_frame_hash(netplay_t *netplay,
    }
 }
 
+/**
+ * netplay_want_snapshot
+ * @netplay              : pointer to netplay object
+ * @frame                : frame about to be run
+ * @last_frame           : frame of the previous snapshot
+ *
+ * Decides whether the state before @frame should be serialized. Frames
+ * without a snapshot are rebuilt by replaying from an earlier one, so
+ * the gap between snapshots never exceeds the snapshot interval. CRC
+ * check frames are always serialized.
+ *
+ * Returns: true if @frame needs a snapshot.
+ */
+static bool netplay_want_snapshot(netplay_t *netplay,
+      uint32_t frame, uint32_t last_frame)
+{
+   if (netplay->snapshot_interval <= 1)
+      return true;
+   if (netplay->check_frames &&
+       frame % abs(netplay->check_frames) == 0)
+      return true;
+   return last_frame > frame ||
+      frame - last_frame >= netplay->snapshot_interval;
+}
+
 /**
  * netplay_sync_pre_frame
  * @netplay              : pointer to netplay object
@@ -549,45 +604,61 @@ bool netplay_sync_pre_frame(netplay_t *netplay)
    if (netplay_delta_frame_ready(netplay,
             &netplay->buffer[netplay->run_ptr], netplay->run_frame_count))
    {
+      struct delta_frame *prev = &netplay->buffer[PREV_PTR(netplay->run_ptr)];
+      bool snapshot            = netplay->force_send_savestate ||
+         !prev->used || prev->frame + 1 != netplay->run_frame_count ||
+         netplay_want_snapshot(netplay, netplay->run_frame_count,
+               netplay->snapshot_frame_count);
+
       serial_info.data_const = NULL;
       serial_info.data       = netplay->buffer[netplay->run_ptr].state;
       serial_info.size       = netplay->state_size;
 
-      memset(serial_info.data, 0, serial_info.size);
-      if ((netplay->quirks & NETPLAY_QUIRK_INITIALIZATION)
-            || netplay->run_frame_count == 0)
+      /* Frames without a snapshot are rebuilt from the last one
+       * if we ever rewind to them */
+      if (snapshot)
       {
-         /* Don't serialize until it's safe */
-      }
-      else if (!(netplay->quirks & NETPLAY_QUIRK_NO_SAVESTATES)
-            && core_serialize(&serial_info))
-      {
-         if (netplay->force_send_savestate && !netplay->stall
-               && !netplay->remote_paused)
+         netplay->buffer[netplay->run_ptr].has_state = true;
+         netplay->snapshot_frame_count = netplay->run_frame_count;
+         memset(serial_info.data, 0, serial_info.size);
+
+         if ((netplay->quirks & NETPLAY_QUIRK_INITIALIZATION)
+               || netplay->run_frame_count == 0)
+         {
+            /* Don't serialize until it's safe */
+         }
+         else if (!(netplay->quirks & NETPLAY_QUIRK_NO_SAVESTATES)
+               && core_serialize(&serial_info))
          {
-            /* Bring our running frame and input frames into
-             * parity so we don't send old info. */
-            if (netplay->run_ptr != netplay->self_ptr)
+            if (netplay->force_send_savestate && !netplay->stall
+                  && !netplay->remote_paused)
             {
-               memcpy(netplay->buffer[netplay->self_ptr].state,
-                  netplay->buffer[netplay->run_ptr].state,
-                  netplay->state_size);
-               netplay->run_ptr         = netplay->self_ptr;
-               netplay->run_frame_count = netplay->self_frame_count;
-            }
+               /* Bring our running frame and input frames into
+                * parity so we don't send old info. */
+               if (netplay->run_ptr != netplay->self_ptr)
+               {
+                  memcpy(netplay->buffer[netplay->self_ptr].state,
+                     netplay->buffer[netplay->run_ptr].state,
+                     netplay->state_size);
+                  netplay->buffer[netplay->self_ptr].has_state = true;
+                  netplay->snapshot_frame_count = netplay->self_frame_count;
+                  netplay->run_ptr         = netplay->self_ptr;
+                  netplay->run_frame_count = netplay->self_frame_count;
+               }
 
-            /* Send this along to the other side */
-            serial_info.data_const = netplay->buffer[netplay->run_ptr].state;
-            netplay_load_savestate(netplay, &serial_info, false);
-            netplay->force_send_savestate = false;
+               /* Send this along to the other side */
+               serial_info.data_const = netplay->buffer[netplay->run_ptr].state;
+               netplay_load_savestate(netplay, &serial_info, false);
+               netplay->force_send_savestate = false;
+            }
+         }
+         else
+         {
+            /* If the core can't serialize properly, we must stall for the
+             * remote input on EVERY frame, because we can't recover */
+            netplay->quirks |= NETPLAY_QUIRK_NO_SAVESTATES;
+            netplay->stateless_mode = true;
          }
-      }
-      else
-      {
-         /* If the core can't serialize properly, we must stall for the
-          * remote input on EVERY frame, because we can't recover */
-         netplay->quirks |= NETPLAY_QUIRK_NO_SAVESTATES;
-         netplay->stateless_mode = true;
       }
 
       /* If we can't transmit savestates, we must stall
@@ -716,6 +787,15 @@ bool netplay_sync_pre_frame(netplay_t *netplay)
             goto process;
          }
 
+         if (!netplay_poll_add(netplay, connection))
+         {
+            netplay_deinit_socket_buffer(&connection->send_packet_buffer);
+            netplay_deinit_socket_buffer(&connection->recv_packet_buffer);
+            connection->active = false;
+            socket_close(new_fd);
+            goto process;
+         }
+
          netplay_handshake_init_send(netplay, connection);
 
       }
@@ -738,6 +818,7 @@ process:
 void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
 {
    uint32_t lo_frame_count, hi_frame_count;
+   size_t snapshot_ptr = 0;
 
    /* Unless we're stalling, we've just finished running a frame */
    if (!stalled)
@@ -821,15 +902,65 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
    }
 #endif
 
-   /* Now replay the real input if we've gotten ahead of it */
-   if (netplay->force_rewind ||
+   /* Now replay the real input if we've gotten ahead of it, starting from
+    * the nearest snapshot at or before the rewind point */
+   if ((netplay->force_rewind ||
+        netplay->replay_frame_count < netplay->run_frame_count) &&
+       !netplay_find_snapshot(netplay, netplay->replay_ptr,
+          netplay->replay_frame_count, &snapshot_ptr))
+   {
+      /* Replaying from a frame that was never serialized would desync
+       * without telling anyone, so keep what we predicted and get the
+       * state from the server instead */
+      if (netplay->is_server)
+      {
+         if (!netplay->force_send_savestate)
+            RARCH_WARN("Netplay has no snapshot to rewind to frame %u, "
+                  "resending the state.\n", netplay->replay_frame_count);
+         netplay->force_send_savestate = true;
+      }
+      else
+      {
+         if (!netplay->savestate_request_outstanding)
+            RARCH_WARN("Netplay has no snapshot to rewind to frame %u, "
+                  "requesting the state.\n", netplay->replay_frame_count);
+         netplay_cmd_request_savestate(netplay);
+      }
+
+      if (netplay->unread_frame_count < netplay->run_frame_count)
+      {
+         netplay->other_ptr = netplay->unread_ptr;
+         netplay->other_frame_count = netplay->unread_frame_count;
+      }
+      else
+      {
+         netplay->other_ptr = netplay->run_ptr;
+         netplay->other_frame_count = netplay->run_frame_count;
+      }
+      netplay->force_rewind = false;
+   }
+   else if (netplay->force_rewind ||
        netplay->replay_frame_count < netplay->run_frame_count)
    {
       retro_ctx_serialize_info_t serial_info;
+      uint32_t rewind_frame_count = netplay->replay_frame_count;
 
       /* Replay frames. */
       netplay->is_replay = true;
 
+      netplay->replay_ptr           = snapshot_ptr;
+      netplay->replay_frame_count   = netplay->buffer[snapshot_ptr].frame;
+      netplay->snapshot_frame_count = netplay->replay_frame_count;
+
+      /* Keep track of how deep we have to go */
+      {
+         uint32_t depth = netplay->run_frame_count - netplay->replay_frame_count;
+         netplay->rollback_count++;
+         netplay->rollback_frames += depth;
+         if (depth > netplay->rollback_max)
+            netplay->rollback_max = depth;
+      }
+
       /* If we have a keyboard device, we replay the previous frame's input
        * just to assert that the keydown/keyup events work if the core
        * translates them in that way */
@@ -869,9 +1000,21 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
          start = cpu_features_get_time_usec();
 
          /* Remember the current state */
-         memset(serial_info.data, 0, serial_info.size);
-         core_serialize(&serial_info);
-         if (netplay->replay_frame_count < netplay->unread_frame_count)
+         if (netplay->replay_frame_count == netplay->snapshot_frame_count ||
+             netplay_want_snapshot(netplay, netplay->replay_frame_count,
+                netplay->snapshot_frame_count))
+         {
+            memset(serial_info.data, 0, serial_info.size);
+            core_serialize(&serial_info);
+            ptr->has_state                = true;
+            netplay->snapshot_frame_count = netplay->replay_frame_count;
+         }
+         else if (netplay->replay_frame_count > rewind_frame_count)
+            ptr->has_state = false;
+
+         /* Frames before the rewind point were already checked */
+         if (netplay->replay_frame_count >= rewind_frame_count &&
+             netplay->replay_frame_count < netplay->unread_frame_count)
             netplay_handle_frame_hash(netplay, ptr);
 
          /* Re-simulate this frame's input */
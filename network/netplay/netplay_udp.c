@@ -0,0 +1,539 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2016-2017 - Gregor Richards
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <net/net_compat.h>
+#include <net/net_socket.h>
+
+#include "netplay_private.h"
+
+#if defined(AF_INET6) && !defined(HAVE_SOCKET_LEGACY)
+#define HAVE_UDP_INET6 1
+#endif
+
+/* Debugging aids for the redundancy: DEBUG_NETPLAY_UDP_LOSS drops that
+ * percentage of outgoing datagrams, DEBUG_NETPLAY_UDP_DELAY holds each back
+ * that many milliseconds, plus up to DEBUG_NETPLAY_UDP_JITTER more, which
+ * reorders them. */
+#if defined(DEBUG_NETPLAY_UDP_LOSS) || defined(DEBUG_NETPLAY_UDP_DELAY) || \
+    defined(DEBUG_NETPLAY_UDP_JITTER)
+#define DEBUG_NETPLAY_UDP_SHIM 1
+#include <features/features_cpu.h>
+#ifndef DEBUG_NETPLAY_UDP_LOSS
+#define DEBUG_NETPLAY_UDP_LOSS 0
+#endif
+#ifndef DEBUG_NETPLAY_UDP_DELAY
+#define DEBUG_NETPLAY_UDP_DELAY 0
+#endif
+#ifndef DEBUG_NETPLAY_UDP_JITTER
+#define DEBUG_NETPLAY_UDP_JITTER 0
+#endif
+
+/* Most datagrams held back at once; past that they go out at once */
+#define NETPLAY_UDP_SHIM_QUEUE 256
+#endif
+
+/* Input over datagrams: each frame, every peer that negotiated it also gets
+ * the INPUT and NOINPUT commands of the last few frames in one datagram. TCP
+ * still carries everything, so a lost datagram costs nothing, but one that
+ * arrives lets the input through while TCP is still waiting to retransmit.
+ * Whichever copy arrives second is ignored as already read. */
+
+#ifdef DEBUG_NETPLAY_UDP_SHIM
+struct netplay_udp_delayed
+{
+   retro_time_t due;
+   int fd;
+   struct sockaddr_storage addr;
+   socklen_t addr_len;
+   size_t len;
+   uint32_t data[NETPLAY_UDP_MAX_WORDS];
+};
+
+static struct netplay_udp_delayed *netplay_udp_shim_queue = NULL;
+static size_t netplay_udp_shim_count                      = 0;
+
+static void netplay_udp_shim_sendto(int fd, const void *data, size_t len,
+      const struct sockaddr_storage *addr, socklen_t addr_len)
+{
+   if (addr_len)
+      sendto(fd, (const char*)data, len, 0, (const struct sockaddr*)addr,
+            addr_len);
+   else
+      send(fd, (const char*)data, len, 0);
+}
+
+/**
+ * netplay_udp_shim_flush
+ *
+ * Send every held back datagram that's due.
+ */
+static void netplay_udp_shim_flush(void)
+{
+   retro_time_t now = cpu_features_get_time_usec();
+   size_t i         = 0;
+
+   while (i < netplay_udp_shim_count)
+   {
+      struct netplay_udp_delayed *delayed = &netplay_udp_shim_queue[i];
+
+      if (delayed->due > now)
+      {
+         i++;
+         continue;
+      }
+
+      netplay_udp_shim_sendto(delayed->fd, delayed->data, delayed->len,
+            &delayed->addr, delayed->addr_len);
+      *delayed = netplay_udp_shim_queue[--netplay_udp_shim_count];
+   }
+}
+
+/**
+ * netplay_udp_shim_send
+ *
+ * Drop, delay or send a datagram, as configured.
+ */
+static void netplay_udp_shim_send(int fd, const void *data, size_t len,
+      const struct sockaddr_storage *addr, socklen_t addr_len)
+{
+   struct netplay_udp_delayed *delayed;
+   retro_time_t delay = DEBUG_NETPLAY_UDP_DELAY * 1000;
+
+   if (rand() % 100 < DEBUG_NETPLAY_UDP_LOSS)
+      return;
+
+   if (DEBUG_NETPLAY_UDP_JITTER > 0)
+      delay += rand() % (DEBUG_NETPLAY_UDP_JITTER * 1000 + 1);
+
+   if (!netplay_udp_shim_queue)
+      netplay_udp_shim_queue = (struct netplay_udp_delayed*)
+         calloc(NETPLAY_UDP_SHIM_QUEUE, sizeof(*netplay_udp_shim_queue));
+
+   if (delay <= 0 || !netplay_udp_shim_queue ||
+         netplay_udp_shim_count >= NETPLAY_UDP_SHIM_QUEUE ||
+         len > sizeof(netplay_udp_shim_queue->data))
+   {
+      netplay_udp_shim_sendto(fd, data, len, addr, addr_len);
+      return;
+   }
+
+   delayed           = &netplay_udp_shim_queue[netplay_udp_shim_count++];
+   delayed->due      = cpu_features_get_time_usec() + delay;
+   delayed->fd       = fd;
+   delayed->addr_len = addr_len;
+   delayed->len      = len;
+   if (addr_len)
+      memcpy(&delayed->addr, addr, addr_len);
+   memcpy(delayed->data, data, len);
+}
+#endif
+
+/**
+ * netplay_udp_init
+ * @netplay              : pointer to netplay object
+ * @addr                 : address the TCP socket was set up with
+ *
+ * Open the input datagram socket: the server binds the same address and port
+ * as it listens on, the client connects to the server's.
+ *
+ * Returns true if successful, false otherwise.
+ */
+bool netplay_udp_init(netplay_t *netplay, const struct addrinfo *addr)
+{
+   int fd = socket(addr->ai_family, SOCK_DGRAM, 0);
+
+   if (fd < 0)
+      goto error;
+
+   if (netplay->is_server)
+   {
+#if defined(HAVE_UDP_INET6) && defined(IPPROTO_IPV6) && defined(IPV6_V6ONLY)
+      /* Like the listening socket, take both IPv6 and IPv4 */
+      int on = 0;
+      if (addr->ai_family == AF_INET6)
+         setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, (const char*)&on, sizeof(on));
+#endif
+      if (!socket_bind(fd, (void*)addr))
+         goto error;
+   }
+   else if (connect(fd, addr->ai_addr, (socklen_t)addr->ai_addrlen) < 0)
+      goto error;
+
+   if (!socket_nonblock(fd))
+      goto error;
+
+   netplay->udp_fd = fd;
+   return true;
+
+error:
+   RARCH_WARN("[netplay] Could not open the input datagram socket, sending input over TCP only.\n");
+   if (fd >= 0)
+      socket_close(fd);
+   return false;
+}
+
+/**
+ * netplay_udp_deinit
+ *
+ * Close the input datagram socket.
+ */
+void netplay_udp_deinit(netplay_t *netplay)
+{
+   if (netplay->udp_fd >= 0)
+      socket_close(netplay->udp_fd);
+   netplay->udp_fd = -1;
+
+#ifdef DEBUG_NETPLAY_UDP_SHIM
+   free(netplay_udp_shim_queue);
+   netplay_udp_shim_queue = NULL;
+   netplay_udp_shim_count = 0;
+#endif
+}
+
+/**
+ * netplay_udp_free_connection
+ *
+ * Forget a connection's datagram state, when it hangs up.
+ */
+void netplay_udp_free_connection(struct netplay_connection *connection)
+{
+   free(connection->udp_history);
+   connection->udp_history     = NULL;
+   connection->udp_history_ptr = 0;
+   connection->udp             = false;
+   connection->udp_token_sent  = false;
+   connection->udp_addr_len    = 0;
+}
+
+/**
+ * netplay_udp_record
+ * @netplay              : pointer to netplay object
+ * @connection           : connection the command was sent to
+ * @cmd                  : the command, in network order
+ * @words                : size of the command in words
+ *
+ * Remember an INPUT or NOINPUT command sent over TCP so that the following
+ * datagrams repeat it.
+ */
+void netplay_udp_record(netplay_t *netplay,
+   struct netplay_connection *connection, const uint32_t *cmd, size_t words)
+{
+   struct netplay_udp_entry *entry;
+
+   /* Slaves and spectators don't rewind, so TCP's delays don't cost them */
+   if (!connection->udp || connection->mode != NETPLAY_CONNECTION_PLAYING ||
+         words < 3 || words > NETPLAY_UDP_CMD_WORDS)
+      return;
+
+   if (!connection->udp_history)
+   {
+      connection->udp_history = (struct netplay_udp_entry*)
+         calloc(NETPLAY_UDP_HISTORY, sizeof(*connection->udp_history));
+      if (!connection->udp_history)
+      {
+         connection->udp = false;
+         return;
+      }
+   }
+
+   entry        = &connection->udp_history[connection->udp_history_ptr];
+   entry->frame = ntohl(cmd[2]);
+   entry->words = (uint32_t)words;
+   memcpy(entry->data, cmd, words * sizeof(uint32_t));
+
+   connection->udp_history_ptr =
+      (connection->udp_history_ptr + 1) % NETPLAY_UDP_HISTORY;
+}
+
+/**
+ * netplay_udp_send
+ *
+ * Send the connection a datagram holding the input commands of the last
+ * NETPLAY_UDP_REDUNDANCY frames.
+ */
+void netplay_udp_send(netplay_t *netplay,
+   struct netplay_connection *connection)
+{
+   uint32_t packet[NETPLAY_UDP_MAX_WORDS];
+   size_t words = 2;
+   size_t first, count, i;
+   uint32_t newest;
+
+   if (netplay->udp_fd < 0 || !connection->udp)
+      return;
+
+   if (netplay->is_server)
+   {
+      /* The client needs its token before it can send, and we need its
+       * first datagram to know where to send ours */
+      if (!connection->udp_token_sent)
+      {
+         uint32_t token = htonl(connection->udp_token);
+         if (!netplay_send_raw_cmd(netplay, connection, NETPLAY_CMD_UDP_TOKEN,
+                  &token, sizeof(token)))
+            return;
+         connection->udp_token_sent = true;
+      }
+      if (!connection->udp_addr_len)
+         return;
+   }
+   else if (!connection->udp_token_sent)
+      return;
+
+   packet[0] = htonl(NETPLAY_UDP_MAGIC);
+   packet[1] = htonl(connection->udp_token);
+
+   /* Walk back from the newest command to the oldest one that's recent
+    * enough and still fits, then send them in the order they were sent */
+   count = 0;
+   if (connection->udp_history)
+   {
+      size_t budget = NETPLAY_UDP_MAX_WORDS - words;
+      size_t ptr    = connection->udp_history_ptr;
+
+      newest = connection->udp_history[
+         (ptr + NETPLAY_UDP_HISTORY - 1) % NETPLAY_UDP_HISTORY].frame;
+
+      for (count = 0; count < NETPLAY_UDP_HISTORY; count++)
+      {
+         struct netplay_udp_entry *entry = &connection->udp_history[
+            (ptr + NETPLAY_UDP_HISTORY - 1 - count) % NETPLAY_UDP_HISTORY];
+         if (!entry->words || entry->words > budget ||
+               entry->frame + NETPLAY_UDP_REDUNDANCY <= newest)
+            break;
+         budget -= entry->words;
+      }
+
+      first = (ptr + NETPLAY_UDP_HISTORY - count) % NETPLAY_UDP_HISTORY;
+      for (i = 0; i < count; i++)
+      {
+         struct netplay_udp_entry *entry =
+            &connection->udp_history[(first + i) % NETPLAY_UDP_HISTORY];
+         memcpy(packet + words, entry->data, entry->words * sizeof(uint32_t));
+         words += entry->words;
+      }
+   }
+
+   /* The client sends even with nothing to say, so that the server learns
+    * its address. Failures are TCP's problem. */
+#ifdef DEBUG_NETPLAY_UDP_SHIM
+   netplay_udp_shim_flush();
+   netplay_udp_shim_send(netplay->udp_fd, packet, words * sizeof(uint32_t),
+         &connection->udp_addr,
+         netplay->is_server ? connection->udp_addr_len : 0);
+#else
+   if (netplay->is_server)
+      sendto(netplay->udp_fd, (const char*)packet, words * sizeof(uint32_t),
+            0, (struct sockaddr*)&connection->udp_addr,
+            connection->udp_addr_len);
+   else
+      send(netplay->udp_fd, (const char*)packet, words * sizeof(uint32_t), 0);
+#endif
+}
+
+/**
+ * netplay_udp_same_host
+ *
+ * Are these two addresses on the same host, whatever the port?
+ */
+static bool netplay_udp_same_host(const struct sockaddr_storage *a,
+      const struct sockaddr_storage *b)
+{
+   if (a->ss_family != b->ss_family)
+      return false;
+
+   if (a->ss_family == AF_INET)
+      return !memcmp(&((const struct sockaddr_in*)a)->sin_addr,
+            &((const struct sockaddr_in*)b)->sin_addr,
+            sizeof(struct in_addr));
+
+#ifdef HAVE_UDP_INET6
+   if (a->ss_family == AF_INET6)
+      return !memcmp(&((const struct sockaddr_in6*)a)->sin6_addr,
+            &((const struct sockaddr_in6*)b)->sin6_addr,
+            sizeof(struct in6_addr));
+#endif
+
+   return false;
+}
+
+/**
+ * netplay_udp_connection
+ *
+ * Find the connection a datagram belongs to. On the server, the first
+ * datagram from a client tells us where to send ours.
+ */
+static struct netplay_connection *netplay_udp_connection(netplay_t *netplay,
+      uint32_t token, const struct sockaddr_storage *addr, socklen_t addr_len)
+{
+   size_t i;
+
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      struct netplay_connection *connection = &netplay->connections[i];
+
+      if (!connection->active || !connection->udp ||
+            !connection->udp_token_sent ||
+            connection->mode < NETPLAY_CONNECTION_CONNECTED ||
+            connection->udp_token != token)
+         continue;
+
+      if (netplay->is_server)
+      {
+         /* The token isn't much of a secret, so it must at least come from
+          * the host the connection did */
+         if (!netplay_udp_same_host(addr, &connection->addr))
+            continue;
+         memcpy(&connection->udp_addr, addr, addr_len);
+         connection->udp_addr_len = addr_len;
+      }
+
+      return connection;
+   }
+
+   return NULL;
+}
+
+/**
+ * netplay_udp_read_input
+ *
+ * Store a datagram's INPUT payload if it's the next expected from its client.
+ *
+ * Returns true if it was stored.
+ */
+static bool netplay_udp_read_input(netplay_t *netplay,
+      struct netplay_connection *connection, const uint32_t *payload,
+      size_t words)
+{
+   uint32_t input[NETPLAY_MAX_INPUT_WORDS];
+   uint32_t frame_num, client_num, input_size, i;
+
+   if (words < 2)
+      return false;
+
+   frame_num  = ntohl(payload[0]);
+   client_num = ntohl(payload[1]) & 0xFFFF;
+
+   if (netplay->is_server)
+   {
+      if (connection->mode != NETPLAY_CONNECTION_PLAYING)
+         return false;
+      client_num = (uint32_t)(connection - netplay->connections + 1);
+   }
+
+   if (client_num >= MAX_CLIENTS ||
+         !(netplay->connected_players & (1<<client_num)))
+      return false;
+
+   /* Anything else is either read already or must wait for what's before
+    * it, which TCP will deliver */
+   if (frame_num != netplay->read_frame_count[client_num])
+      return false;
+
+   input_size = netplay_expected_input_size(netplay,
+         netplay->client_devices[client_num]);
+   if (input_size > NETPLAY_MAX_INPUT_WORDS || words != 2 + input_size)
+      return false;
+
+   for (i = 0; i < input_size; i++)
+      input[i] = ntohl(payload[2 + i]);
+
+   return netplay_store_input(netplay, connection, client_num, input) == 1;
+}
+
+/**
+ * netplay_udp_receive
+ *
+ * Read every pending input datagram, storing any input that's the next
+ * expected from its client.
+ *
+ * Returns true if any input was stored.
+ */
+bool netplay_udp_receive(netplay_t *netplay)
+{
+   uint32_t packet[NETPLAY_UDP_MAX_WORDS];
+   bool had_input = false;
+
+   if (netplay->udp_fd < 0)
+      return false;
+
+#ifdef DEBUG_NETPLAY_UDP_SHIM
+   netplay_udp_shim_flush();
+#endif
+
+   for (;;)
+   {
+      struct netplay_connection *connection;
+      struct sockaddr_storage addr;
+      const uint32_t *cmds;
+      socklen_t addr_len = sizeof(addr);
+      size_t words;
+      int len = (int)recvfrom(netplay->udp_fd, (char*)packet, sizeof(packet),
+            0, (struct sockaddr*)&addr, &addr_len);
+
+      if (len < 0)
+         break;
+
+      if (len % sizeof(uint32_t) || len < 2 * (int)sizeof(uint32_t) ||
+            ntohl(packet[0]) != NETPLAY_UDP_MAGIC)
+         continue;
+
+      connection = netplay_udp_connection(netplay, ntohl(packet[1]), &addr,
+            addr_len);
+      if (!connection)
+         continue;
+
+      cmds  = packet + 2;
+      words = len / sizeof(uint32_t) - 2;
+      while (words >= 2)
+      {
+         uint32_t cmd      = ntohl(cmds[0]);
+         uint32_t cmd_size = ntohl(cmds[1]);
+         size_t cmd_words  = cmd_size / sizeof(uint32_t);
+
+         if (cmd_size % sizeof(uint32_t) || cmd_words > words - 2)
+            break;
+
+         switch (cmd)
+         {
+            case NETPLAY_CMD_INPUT:
+               if (netplay_udp_read_input(netplay, connection, cmds + 2, cmd_words))
+                  had_input = true;
+               break;
+
+            case NETPLAY_CMD_NOINPUT:
+               if (!netplay->is_server && cmd_words == 1 &&
+                     ntohl(cmds[2]) == netplay->server_frame_count)
+               {
+                  netplay->server_ptr = NEXT_PTR(netplay->server_ptr);
+                  netplay->server_frame_count++;
+                  had_input = true;
+               }
+               break;
+
+            default:
+               break;
+         }
+
+         cmds  += 2 + cmd_words;
+         words -= 2 + cmd_words;
+      }
+   }
+
+   return had_input;
+}
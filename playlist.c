@@ -18,12 +18,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 #include <libretro.h>
 #include <boolean.h>
 #include <retro_assert.h>
 #include <compat/posix_string.h>
 #include <string/stdstring.h>
+#include <encodings/crc32.h>
 #include <streams/interface_stream.h>
 #include <streams/file_stream.h>
 #include <file/file_path.h>
@@ -33,10 +35,44 @@
 #include "verbosity.h"
 #include "configuration.h"
 
+#if !defined(RARCH_CONSOLE) && !defined(__WINRT__)
+#define PLAYLIST_HAVE_STAT
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
 #ifndef PLAYLIST_ENTRIES
 #define PLAYLIST_ENTRIES 6
 #endif
 
+#define PLAYLIST_JOURNAL_EXTENSION   ".jrn"
+#define PLAYLIST_JOURNAL_MAGIC       "RPLJ"
+#define PLAYLIST_JOURNAL_VERSION     3
+#define PLAYLIST_JOURNAL_HEADER_SIZE 25
+
+/* Bytes at each end of the playlist file hashed to tell
+ * whether the journal still applies to it */
+#define PLAYLIST_JOURNAL_HASH_BLOCK  4096
+
+/* Slots of the table used to share identical core paths,
+ * core names etc. between entries while reading a playlist */
+#define PLAYLIST_INTERN_SLOTS        256
+
+/* Number of journaled changes after which the playlist
+ * file gets rewritten and the journal discarded */
+#ifndef PLAYLIST_JOURNAL_MAX_RECORDS
+#define PLAYLIST_JOURNAL_MAX_RECORDS 256
+#endif
+
+enum playlist_journal_op
+{
+   PLAYLIST_JOURNAL_PUSH = 1,
+   PLAYLIST_JOURNAL_MOVE_TO_TOP,
+   PLAYLIST_JOURNAL_DELETE,
+   PLAYLIST_JOURNAL_SET,
+   PLAYLIST_JOURNAL_CLEAR
+};
+
 struct playlist_entry
 {
    char *path;
@@ -48,6 +84,7 @@ struct playlist_entry
    unsigned runtime_hours;
    unsigned runtime_minutes;
    unsigned runtime_seconds;
+   uint32_t path_hash;
 };
 
 struct content_playlist
@@ -56,6 +93,41 @@ struct content_playlist
    size_t size;
    size_t cap;
 
+   /* Entries form a ring buffer starting at 'head', so that
+    * pushing to the top of the list doesn't move the others. */
+   size_t head;
+
+   /* Open-addressed hash of entry paths, each cell holds
+    * the slot of an entry + 1 (0 marks an empty cell). */
+   uint32_t *index;
+   size_t index_cap;
+
+   /* Changes made since the last write, appended to the
+    * journal file next to the playlist instead of rewriting
+    * the whole playlist file. */
+   uint8_t *journal;
+   size_t journal_len;
+   size_t journal_cap;
+   unsigned journal_pending;
+   /* Records and bytes already in the journal file */
+   unsigned journal_records;
+   int64_t journal_size;
+   /* Size, modification time and hash of the playlist file
+    * the journal applies to, size is -1 if unknown */
+   int64_t journal_base_size;
+   int64_t journal_base_mtime;
+   uint32_t journal_base_hash;
+   /* Set when a change couldn't be journaled, the next
+    * write then rewrites the playlist file */
+   bool journal_invalid;
+   char *journal_path;
+
+   /* Strings of the entries read from the playlist file,
+    * allocated in one go and released all at once. Entries
+    * changed later on own their strings individually. */
+   char *arena;
+   size_t arena_size;
+
    char *conf_path;
    struct playlist_entry *entries;
 };
@@ -74,14 +146,820 @@ typedef struct
    unsigned *current_entry_uint_val;
    char *current_meta_string;
    bool in_items;
+   bool current_entry_intern;
+   size_t arena_len;
+   const char *interned[PLAYLIST_INTERN_SLOTS];
 } JSONContext;
 
 static playlist_t *playlist_cached = NULL;
 
+static void playlist_free_entry(playlist_t *playlist,
+      struct playlist_entry *entry);
+
 typedef int (playlist_sort_fun_t)(
       const struct playlist_entry *a,
       const struct playlist_entry *b);
 
+static struct playlist_entry *playlist_entry_at(
+      playlist_t *playlist, size_t idx)
+{
+   size_t slot = playlist->head + idx;
+   if (slot >= playlist->cap)
+      slot -= playlist->cap;
+   return &playlist->entries[slot];
+}
+
+static size_t playlist_slot_to_index(playlist_t *playlist, size_t slot)
+{
+   if (slot >= playlist->head)
+      return slot - playlist->head;
+   return slot + playlist->cap - playlist->head;
+}
+
+static uint32_t playlist_path_hash(const char *path)
+{
+   uint32_t hash = 5381;
+
+   if (!path)
+      return hash;
+
+   /* Case-insensitive on Windows, where duplicates are
+    * detected regardless of case */
+   for (; *path; path++)
+#ifdef _WIN32
+      hash = (hash << 5) + hash + (uint8_t)tolower((uint8_t)*path);
+#else
+      hash = (hash << 5) + hash + (uint8_t)*path;
+#endif
+
+   return hash;
+}
+
+static void playlist_index_insert(playlist_t *playlist, size_t slot)
+{
+   size_t mask = playlist->index_cap - 1;
+   size_t i    = playlist->entries[slot].path_hash & mask;
+
+   while (playlist->index[i])
+      i = (i + 1) & mask;
+
+   playlist->index[i] = (uint32_t)(slot + 1);
+}
+
+static void playlist_index_remove(playlist_t *playlist, size_t slot)
+{
+   size_t mask = playlist->index_cap - 1;
+   size_t i    = playlist->entries[slot].path_hash & mask;
+   size_t j;
+
+   while (playlist->index[i] != slot + 1)
+   {
+      if (!playlist->index[i])
+         return;
+      i = (i + 1) & mask;
+   }
+
+   /* Backward-shift deletion, keeps probe sequences
+    * intact without leaving tombstones behind */
+   for (j = (i + 1) & mask; playlist->index[j]; j = (j + 1) & mask)
+   {
+      size_t home = playlist->entries[
+         playlist->index[j] - 1].path_hash & mask;
+
+      if ((i <= j) ? (i < home && home <= j) : (i < home || home <= j))
+         continue;
+
+      playlist->index[i] = playlist->index[j];
+      i                  = j;
+   }
+
+   playlist->index[i] = 0;
+}
+
+/* The entry at slot @from has been copied to slot @to */
+static void playlist_index_move(playlist_t *playlist,
+      size_t from, size_t to)
+{
+   size_t mask = playlist->index_cap - 1;
+   size_t i    = playlist->entries[to].path_hash & mask;
+
+   for (; playlist->index[i]; i = (i + 1) & mask)
+   {
+      if (playlist->index[i] == from + 1)
+      {
+         playlist->index[i] = (uint32_t)(to + 1);
+         return;
+      }
+   }
+}
+
+static bool playlist_index_rebuild(playlist_t *playlist, size_t min_size)
+{
+   size_t i;
+   size_t index_cap = 16;
+
+   while (index_cap < min_size * 2)
+      index_cap <<= 1;
+
+   if (index_cap != playlist->index_cap)
+   {
+      uint32_t *index = (uint32_t*)calloc(index_cap, sizeof(*index));
+
+      if (!index)
+         return false;
+
+      free(playlist->index);
+      playlist->index     = index;
+      playlist->index_cap = index_cap;
+   }
+   else
+      memset(playlist->index, 0, index_cap * sizeof(*playlist->index));
+
+   for (i = 0; i < playlist->size; i++)
+   {
+      struct playlist_entry *entry = playlist_entry_at(playlist, i);
+      entry->path_hash             = playlist_path_hash(entry->path);
+      playlist_index_insert(playlist, entry - playlist->entries);
+   }
+
+   return true;
+}
+
+/* Makes room in the index for one more entry */
+static bool playlist_index_reserve(playlist_t *playlist)
+{
+   if ((playlist->size + 1) * 2 <= playlist->index_cap)
+      return true;
+   return playlist_index_rebuild(playlist, playlist->size + 1);
+}
+
+/**
+ * playlist_find_entry:
+ * @playlist            : Playlist handle.
+ * @path                : Path to look for, NULL matches entries without one.
+ * @core_path           : Core path the entry must have as well, or NULL.
+ * @noncase             : Compare paths case-insensitively.
+ * @idx                 : Index of the topmost matching entry.
+ *
+ * Returns: true if a matching entry was found.
+ **/
+static bool playlist_find_entry(playlist_t *playlist,
+      const char *path, const char *core_path, bool noncase, size_t *idx)
+{
+   bool found    = false;
+   size_t mask   = playlist->index_cap - 1;
+   uint32_t hash = playlist_path_hash(path);
+   size_t i;
+
+   for (i = hash & mask; playlist->index[i]; i = (i + 1) & mask)
+   {
+      size_t slot                        = playlist->index[i] - 1;
+      const struct playlist_entry *entry = &playlist->entries[slot];
+      size_t entry_idx;
+
+      if (entry->path_hash != hash)
+         continue;
+
+      if (!path || !entry->path)
+      {
+         if (path || entry->path)
+            continue;
+      }
+      else if (noncase ? !string_is_equal_noncase(path, entry->path)
+            : !string_is_equal(path, entry->path))
+         continue;
+
+      if (core_path && !string_is_equal(entry->core_path, core_path))
+         continue;
+
+      entry_idx = playlist_slot_to_index(playlist, slot);
+
+      if (!found || entry_idx < *idx)
+         *idx = entry_idx;
+      found = true;
+   }
+
+   return found;
+}
+
+/* Moves the entry at @idx to the top, shifting the ones above it down */
+static void playlist_move_to_top(playlist_t *playlist, size_t idx)
+{
+   size_t k;
+   struct playlist_entry *entry = playlist_entry_at(playlist, idx);
+   struct playlist_entry tmp    = *entry;
+
+   playlist_index_remove(playlist, entry - playlist->entries);
+
+   for (k = idx; k > 0; k--)
+   {
+      struct playlist_entry *dst = playlist_entry_at(playlist, k);
+      struct playlist_entry *src = playlist_entry_at(playlist, k - 1);
+
+      *dst = *src;
+      playlist_index_move(playlist,
+            src - playlist->entries, dst - playlist->entries);
+   }
+
+   *playlist_entry_at(playlist, 0) = tmp;
+   playlist_index_insert(playlist, playlist->head);
+}
+
+/* Makes room for a new entry at the top of the playlist,
+ * dropping the bottom one if the playlist is full. */
+static struct playlist_entry *playlist_push_slot(playlist_t *playlist)
+{
+   struct playlist_entry *entry = NULL;
+
+   if (playlist->cap == 0)
+      return NULL;
+
+   if (playlist->size == playlist->cap)
+   {
+      entry = playlist_entry_at(playlist, playlist->size - 1);
+      playlist_index_remove(playlist, entry - playlist->entries);
+      playlist_free_entry(playlist, entry);
+      playlist->size--;
+   }
+
+   if (!playlist_index_reserve(playlist))
+      return NULL;
+
+   playlist->head = playlist->head ? playlist->head - 1 : playlist->cap - 1;
+   entry          = &playlist->entries[playlist->head];
+
+   memset(entry, 0, sizeof(*entry));
+
+   return entry;
+}
+
+/* Removes the entry at @idx, shifting the ones below it up */
+static void playlist_remove_entry(playlist_t *playlist, size_t idx)
+{
+   size_t k;
+   struct playlist_entry *entry = playlist_entry_at(playlist, idx);
+
+   playlist_index_remove(playlist, entry - playlist->entries);
+   playlist_free_entry(playlist, entry);
+
+   for (k = idx; k + 1 < playlist->size; k++)
+   {
+      struct playlist_entry *dst = playlist_entry_at(playlist, k);
+      struct playlist_entry *src = playlist_entry_at(playlist, k + 1);
+
+      *dst = *src;
+      playlist_index_move(playlist,
+            src - playlist->entries, dst - playlist->entries);
+   }
+
+   playlist->size = playlist->size - 1;
+}
+
+/* Replaces the entry at @idx, taking ownership of @entry's strings */
+static void playlist_replace_entry(playlist_t *playlist, size_t idx,
+      const struct playlist_entry *entry)
+{
+   struct playlist_entry *dst = playlist_entry_at(playlist, idx);
+   size_t slot                = dst - playlist->entries;
+
+   playlist_index_remove(playlist, slot);
+   playlist_free_entry(playlist, dst);
+
+   *dst           = *entry;
+   dst->path_hash = playlist_path_hash(dst->path);
+   playlist_index_insert(playlist, slot);
+}
+
+static void playlist_clear_entries(playlist_t *playlist)
+{
+   size_t i;
+
+   for (i = 0; i < playlist->size; i++)
+      playlist_free_entry(playlist, playlist_entry_at(playlist, i));
+   playlist->size = 0;
+   playlist->head = 0;
+
+   free(playlist->arena);
+   playlist->arena      = NULL;
+   playlist->arena_size = 0;
+
+   if (playlist->index)
+      memset(playlist->index, 0,
+            playlist->index_cap * sizeof(*playlist->index));
+}
+
+/**
+ * playlist_file_stat:
+ * @path                : Path to playlist file.
+ * @size                : Size of the file, -1 if missing.
+ * @mtime               : Modification time of the file, in
+ *                        nanoseconds where the platform has
+ *                        them, 0 where it can't tell.
+ **/
+static void playlist_file_stat(const char *path,
+      int64_t *size, int64_t *mtime)
+{
+#ifdef PLAYLIST_HAVE_STAT
+   struct stat buf;
+
+   if (stat(path, &buf) == 0)
+   {
+      *size  = (int64_t)buf.st_size;
+#if defined(__APPLE__)
+      *mtime = (int64_t)buf.st_mtimespec.tv_sec * 1000000000
+         + buf.st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+      *mtime = (int64_t)buf.st_mtim.tv_sec * 1000000000
+         + buf.st_mtim.tv_nsec;
+#else
+      *mtime = (int64_t)buf.st_mtime;
+#endif
+      return;
+   }
+
+   *size  = -1;
+   *mtime = 0;
+#else
+   *size  = path_get_size(path);
+   *mtime = 0;
+#endif
+}
+
+/**
+ * playlist_file_hash:
+ * @path                : Path to playlist file.
+ * @size                : Size of the file.
+ *
+ * Hashes the first and last PLAYLIST_JOURNAL_HASH_BLOCK bytes
+ * of the file, which catches a rewrite that kept its size and
+ * modification time, since a playlist's entries and its
+ * closing bracket end up in those blocks.
+ *
+ * Returns: CRC32 of those bytes, 0 if the file can't be read.
+ **/
+static uint32_t playlist_file_hash(const char *path, int64_t size)
+{
+   uint8_t buf[PLAYLIST_JOURNAL_HASH_BLOCK];
+   uint32_t hash = 0;
+   int64_t len   = size < PLAYLIST_JOURNAL_HASH_BLOCK
+      ? size : PLAYLIST_JOURNAL_HASH_BLOCK;
+   RFILE *file   = NULL;
+
+   if (size <= 0)
+      return 0;
+
+   file = filestream_open(path, RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return 0;
+
+   if (filestream_read(file, buf, len) != len)
+      goto error;
+
+   hash = encoding_crc32(hash, buf, (size_t)len);
+
+   if (size > PLAYLIST_JOURNAL_HASH_BLOCK)
+   {
+      int64_t tail = size - PLAYLIST_JOURNAL_HASH_BLOCK;
+
+      if (tail < PLAYLIST_JOURNAL_HASH_BLOCK)
+         tail = PLAYLIST_JOURNAL_HASH_BLOCK;
+
+      len = size - tail;
+
+      if (     filestream_seek(file, tail, RETRO_VFS_SEEK_POSITION_START) < 0
+            || filestream_read(file, buf, len) != len)
+         goto error;
+
+      hash = encoding_crc32(hash, buf, (size_t)len);
+   }
+
+   filestream_close(file);
+   return hash;
+
+error:
+   filestream_close(file);
+   return 0;
+}
+
+/* Called once the playlist file has been rewritten in full */
+static void playlist_journal_rebase(playlist_t *playlist)
+{
+   playlist_file_stat(playlist->conf_path,
+         &playlist->journal_base_size, &playlist->journal_base_mtime);
+   playlist->journal_base_hash = playlist_file_hash(playlist->conf_path,
+         playlist->journal_base_size);
+}
+
+static bool playlist_journal_reserve(playlist_t *playlist, size_t len)
+{
+   uint8_t *journal = NULL;
+   size_t cap       = playlist->journal_cap ? playlist->journal_cap : 256;
+
+   if (playlist->journal_invalid)
+      return false;
+
+   if (playlist->journal_len + len <= playlist->journal_cap)
+      return true;
+
+   while (cap < playlist->journal_len + len)
+      cap *= 2;
+
+   journal = (uint8_t*)realloc(playlist->journal, cap);
+
+   if (!journal)
+   {
+      playlist->journal_invalid = true;
+      return false;
+   }
+
+   playlist->journal     = journal;
+   playlist->journal_cap = cap;
+   return true;
+}
+
+static void playlist_journal_put_u32(playlist_t *playlist, uint32_t val)
+{
+   uint8_t *buf = NULL;
+
+   if (!playlist_journal_reserve(playlist, 4))
+      return;
+
+   buf    = playlist->journal + playlist->journal_len;
+   buf[0] = (uint8_t)(val);
+   buf[1] = (uint8_t)(val >> 8);
+   buf[2] = (uint8_t)(val >> 16);
+   buf[3] = (uint8_t)(val >> 24);
+   playlist->journal_len += 4;
+}
+
+/* Strings are stored as their length + 1 followed by the
+ * characters, a length of 0 stands for NULL */
+static void playlist_journal_put_string(playlist_t *playlist,
+      const char *str)
+{
+   size_t len = str ? strlen(str) : 0;
+
+   playlist_journal_put_u32(playlist, str ? (uint32_t)(len + 1) : 0);
+
+   if (!len || !playlist_journal_reserve(playlist, len))
+      return;
+
+   memcpy(playlist->journal + playlist->journal_len, str, len);
+   playlist->journal_len += len;
+}
+
+/**
+ * playlist_journal_record:
+ * @playlist            : Playlist handle.
+ * @op                  : Kind of change.
+ * @idx                 : Index of the entry that changed.
+ * @entry               : New contents of the entry, or NULL.
+ *
+ * Queues a change to be appended to the journal on
+ * the next write.
+ **/
+static void playlist_journal_record(playlist_t *playlist,
+      enum playlist_journal_op op, size_t idx,
+      const struct playlist_entry *entry)
+{
+   size_t len = playlist->journal_len;
+
+   if (!playlist_journal_reserve(playlist, 1))
+      return;
+
+   playlist->journal[playlist->journal_len++] = (uint8_t)op;
+
+   if (     op == PLAYLIST_JOURNAL_MOVE_TO_TOP
+         || op == PLAYLIST_JOURNAL_DELETE
+         || op == PLAYLIST_JOURNAL_SET)
+      playlist_journal_put_u32(playlist, (uint32_t)idx);
+
+   if (entry)
+   {
+      playlist_journal_put_string(playlist, entry->path);
+      playlist_journal_put_string(playlist, entry->label);
+      playlist_journal_put_string(playlist, entry->core_path);
+      playlist_journal_put_string(playlist, entry->core_name);
+      playlist_journal_put_string(playlist, entry->db_name);
+      playlist_journal_put_string(playlist, entry->crc32);
+      playlist_journal_put_u32(playlist, entry->runtime_hours);
+      playlist_journal_put_u32(playlist, entry->runtime_minutes);
+      playlist_journal_put_u32(playlist, entry->runtime_seconds);
+   }
+
+   if (playlist->journal_invalid)
+   {
+      playlist->journal_len = len;
+      return;
+   }
+
+   playlist->journal_pending++;
+}
+
+static bool playlist_journal_get_u32(const uint8_t *buf, size_t len,
+      size_t *pos, uint32_t *val)
+{
+   if (len - *pos < 4)
+      return false;
+
+   *val  = (uint32_t)buf[*pos]
+         | ((uint32_t)buf[*pos + 1] << 8)
+         | ((uint32_t)buf[*pos + 2] << 16)
+         | ((uint32_t)buf[*pos + 3] << 24);
+   *pos += 4;
+   return true;
+}
+
+static bool playlist_journal_get_string(const uint8_t *buf, size_t len,
+      size_t *pos, char **str)
+{
+   uint32_t size = 0;
+
+   *str = NULL;
+
+   if (!playlist_journal_get_u32(buf, len, pos, &size))
+      return false;
+
+   if (!size)
+      return true;
+
+   if (len - *pos < size - 1)
+      return false;
+
+   *str = (char*)malloc(size);
+
+   if (!*str)
+      return false;
+
+   memcpy(*str, buf + *pos, size - 1);
+   (*str)[size - 1] = '\0';
+   *pos            += size - 1;
+   return true;
+}
+
+static bool playlist_journal_get_entry(playlist_t *playlist,
+      const uint8_t *buf, size_t len,
+      size_t *pos, struct playlist_entry *entry)
+{
+   memset(entry, 0, sizeof(*entry));
+
+   if (     playlist_journal_get_string(buf, len, pos, &entry->path)
+         && playlist_journal_get_string(buf, len, pos, &entry->label)
+         && playlist_journal_get_string(buf, len, pos, &entry->core_path)
+         && playlist_journal_get_string(buf, len, pos, &entry->core_name)
+         && playlist_journal_get_string(buf, len, pos, &entry->db_name)
+         && playlist_journal_get_string(buf, len, pos, &entry->crc32)
+         && playlist_journal_get_u32(buf, len, pos, &entry->runtime_hours)
+         && playlist_journal_get_u32(buf, len, pos, &entry->runtime_minutes)
+         && playlist_journal_get_u32(buf, len, pos, &entry->runtime_seconds))
+      return true;
+
+   playlist_free_entry(playlist, entry);
+   return false;
+}
+
+/**
+ * playlist_journal_replay:
+ * @playlist            : Playlist handle.
+ *
+ * Applies the changes recorded in the journal file on top
+ * of the entries just read from the playlist file. A journal
+ * written against a different version of the playlist file
+ * is discarded.
+ **/
+static void playlist_journal_replay(playlist_t *playlist)
+{
+   size_t pos;
+   size_t len            = 0;
+   int64_t file_len      = 0;
+   uint64_t base_size    = 0;
+   uint64_t base_mtime   = 0;
+   uint32_t base_hash    = 0;
+   void *data            = NULL;
+   const uint8_t *buf    = NULL;
+   unsigned i;
+
+   if (!path_is_valid(playlist->journal_path))
+      return;
+
+   if (!filestream_read_file(playlist->journal_path, &data, &file_len))
+      return;
+
+   buf = (const uint8_t*)data;
+   len = (size_t)file_len;
+
+   if (len >= PLAYLIST_JOURNAL_HEADER_SIZE)
+   {
+      for (i = 0; i < 8; i++)
+      {
+         base_size  |= (uint64_t)buf[5 + i]  << (i * 8);
+         base_mtime |= (uint64_t)buf[13 + i] << (i * 8);
+      }
+      for (i = 0; i < 4; i++)
+         base_hash  |= (uint32_t)buf[21 + i] << (i * 8);
+   }
+
+   if (     len < PLAYLIST_JOURNAL_HEADER_SIZE
+         || memcmp(buf, PLAYLIST_JOURNAL_MAGIC, 4)
+         || buf[4] != PLAYLIST_JOURNAL_VERSION
+         || playlist->journal_base_size < 0
+         || base_size  != (uint64_t)playlist->journal_base_size
+         || base_mtime != (uint64_t)playlist->journal_base_mtime
+         || base_hash  != playlist->journal_base_hash)
+   {
+      RARCH_WARN("Discarding stale playlist journal: %s\n",
+            playlist->journal_path);
+      filestream_delete(playlist->journal_path);
+      free(data);
+      return;
+   }
+
+   playlist->journal_size = file_len;
+
+   for (pos = PLAYLIST_JOURNAL_HEADER_SIZE; pos < len; )
+   {
+      struct playlist_entry entry;
+      struct playlist_entry *slot = NULL;
+      uint32_t idx                = 0;
+
+      switch (buf[pos++])
+      {
+         case PLAYLIST_JOURNAL_PUSH:
+            if (!playlist_journal_get_entry(playlist, buf, len, &pos, &entry))
+               goto error;
+            if (!(slot = playlist_push_slot(playlist)))
+            {
+               playlist_free_entry(playlist, &entry);
+               goto error;
+            }
+            *slot           = entry;
+            slot->path_hash = playlist_path_hash(slot->path);
+            playlist->size++;
+            playlist_index_insert(playlist, playlist->head);
+            break;
+         case PLAYLIST_JOURNAL_MOVE_TO_TOP:
+            if (  !playlist_journal_get_u32(buf, len, &pos, &idx)
+                  || idx >= playlist->size)
+               goto error;
+            playlist_move_to_top(playlist, idx);
+            break;
+         case PLAYLIST_JOURNAL_DELETE:
+            if (  !playlist_journal_get_u32(buf, len, &pos, &idx)
+                  || idx >= playlist->size)
+               goto error;
+            playlist_remove_entry(playlist, idx);
+            break;
+         case PLAYLIST_JOURNAL_SET:
+            if (!playlist_journal_get_u32(buf, len, &pos, &idx))
+               goto error;
+            if (!playlist_journal_get_entry(playlist, buf, len, &pos, &entry))
+               goto error;
+            if (idx >= playlist->size)
+            {
+               playlist_free_entry(playlist, &entry);
+               goto error;
+            }
+            playlist_replace_entry(playlist, idx, &entry);
+            break;
+         case PLAYLIST_JOURNAL_CLEAR:
+            playlist_clear_entries(playlist);
+            break;
+         default:
+            goto error;
+      }
+
+      playlist->journal_records++;
+   }
+
+   free(data);
+   return;
+
+error:
+   /* Most likely a write interrupted halfway, keep what
+    * could be replayed and rewrite the playlist next time */
+   RARCH_WARN("Invalid record in playlist journal: %s\n",
+         playlist->journal_path);
+   playlist->journal_invalid = true;
+   free(data);
+}
+
+/**
+ * playlist_journal_write:
+ * @playlist            : Playlist handle.
+ *
+ * Appends the pending changes to the journal file.
+ *
+ * Returns: true if the changes were written, false if the
+ * playlist file has to be rewritten instead.
+ **/
+static bool playlist_journal_write(playlist_t *playlist)
+{
+   RFILE *file  = NULL;
+   bool success = false;
+
+   if (     playlist->journal_invalid
+         || !playlist->journal_path
+         || playlist->journal_base_size < 0
+         || playlist->journal_records + playlist->journal_pending
+            > PLAYLIST_JOURNAL_MAX_RECORDS)
+      return false;
+
+   if (!playlist->journal_pending)
+      return true;
+
+   /* Someone else rewrote the playlist file */
+   {
+      int64_t size  = 0;
+      int64_t mtime = 0;
+
+      playlist_file_stat(playlist->conf_path, &size, &mtime);
+
+      if (     size  != playlist->journal_base_size
+            || mtime != playlist->journal_base_mtime
+            || playlist_file_hash(playlist->conf_path, size)
+               != playlist->journal_base_hash)
+         return false;
+   }
+
+   if (playlist->journal_records)
+   {
+      file = filestream_open(playlist->journal_path,
+            RETRO_VFS_FILE_ACCESS_READ_WRITE
+            | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+            RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+      if (!file)
+         return false;
+
+      if (filestream_get_size(file) != playlist->journal_size)
+         goto end;
+
+      filestream_seek(file, 0, RETRO_VFS_SEEK_POSITION_END);
+   }
+   else
+   {
+      uint8_t header[PLAYLIST_JOURNAL_HEADER_SIZE];
+      uint64_t base_size  = (uint64_t)playlist->journal_base_size;
+      uint64_t base_mtime = (uint64_t)playlist->journal_base_mtime;
+      uint32_t base_hash  = playlist->journal_base_hash;
+      unsigned i;
+
+      memcpy(header, PLAYLIST_JOURNAL_MAGIC, 4);
+      header[4] = PLAYLIST_JOURNAL_VERSION;
+      for (i = 0; i < 8; i++)
+      {
+         header[5 + i]  = (uint8_t)(base_size  >> (i * 8));
+         header[13 + i] = (uint8_t)(base_mtime >> (i * 8));
+      }
+      for (i = 0; i < 4; i++)
+         header[21 + i] = (uint8_t)(base_hash  >> (i * 8));
+
+      file = filestream_open(playlist->journal_path,
+            RETRO_VFS_FILE_ACCESS_WRITE,
+            RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+      if (!file)
+         return false;
+
+      if (filestream_write(file, header, sizeof(header)) != sizeof(header))
+         goto end;
+
+      playlist->journal_size = sizeof(header);
+   }
+
+   if (filestream_write(file, playlist->journal, playlist->journal_len)
+         != (int64_t)playlist->journal_len)
+      goto end;
+
+   playlist->journal_records += playlist->journal_pending;
+   playlist->journal_size    += playlist->journal_len;
+   playlist->journal_pending  = 0;
+   playlist->journal_len      = 0;
+   success                    = true;
+
+end:
+   filestream_close(file);
+   return success;
+}
+
+/* Called before the playlist file gets rewritten in full */
+static void playlist_journal_discard(playlist_t *playlist)
+{
+   if (playlist->journal_path && path_is_valid(playlist->journal_path))
+      filestream_delete(playlist->journal_path);
+
+   playlist->journal_len        = 0;
+   playlist->journal_pending    = 0;
+   playlist->journal_records    = 0;
+   playlist->journal_size       = 0;
+   playlist->journal_base_size  = -1;
+   playlist->journal_base_mtime = 0;
+   playlist->journal_base_hash  = 0;
+   playlist->journal_invalid    = false;
+}
+
 uint32_t playlist_get_size(playlist_t *playlist)
 {
    if (!playlist)
@@ -113,21 +991,25 @@ void playlist_get_index(playlist_t *playlist,
       const char **crc32,
       const char **db_name)
 {
+   const struct playlist_entry *entry = NULL;
+
    if (!playlist)
       return;
 
+   entry = playlist_entry_at(playlist, idx);
+
    if (path)
-      *path      = playlist->entries[idx].path;
+      *path      = entry->path;
    if (label)
-      *label     = playlist->entries[idx].label;
+      *label     = entry->label;
    if (core_path)
-      *core_path = playlist->entries[idx].core_path;
+      *core_path = entry->core_path;
    if (core_name)
-      *core_name = playlist->entries[idx].core_name;
+      *core_name = entry->core_name;
    if (db_name)
-      *db_name   = playlist->entries[idx].db_name;
+      *db_name   = entry->db_name;
    if (crc32)
-      *crc32     = playlist->entries[idx].crc32;
+      *crc32     = entry->crc32;
 }
 
 void playlist_get_runtime_index(playlist_t *playlist,
@@ -136,19 +1018,23 @@ void playlist_get_runtime_index(playlist_t *playlist,
       unsigned *runtime_hours, unsigned *runtime_minutes,
       unsigned *runtime_seconds)
 {
+   const struct playlist_entry *entry = NULL;
+
    if (!playlist)
       return;
 
+   entry = playlist_entry_at(playlist, idx);
+
    if (path)
-      *path      = playlist->entries[idx].path;
+      *path      = entry->path;
    if (core_path)
-      *core_path = playlist->entries[idx].core_path;
+      *core_path = entry->core_path;
    if (runtime_hours)
-      *runtime_hours = playlist->entries[idx].runtime_hours;
+      *runtime_hours = entry->runtime_hours;
    if (runtime_minutes)
-      *runtime_minutes = playlist->entries[idx].runtime_minutes;
+      *runtime_minutes = entry->runtime_minutes;
    if (runtime_seconds)
-      *runtime_seconds = playlist->entries[idx].runtime_seconds;
+      *runtime_seconds = entry->runtime_seconds;
 }
 
 /**
@@ -161,13 +1047,11 @@ void playlist_get_runtime_index(playlist_t *playlist,
 void playlist_delete_index(playlist_t *playlist,
       size_t idx)
 {
-   if (!playlist)
+   if (!playlist || idx >= playlist->size)
       return;
 
-   playlist->size     = playlist->size - 1;
-
-   memmove(playlist->entries + idx, playlist->entries + idx + 1,
-         (playlist->size - idx) * sizeof(struct playlist_entry));
+   playlist_remove_entry(playlist, idx);
+   playlist_journal_record(playlist, PLAYLIST_JOURNAL_DELETE, idx, NULL);
 
    playlist->modified = true;
 }
@@ -180,28 +1064,28 @@ void playlist_get_index_by_path(playlist_t *playlist,
       char **db_name)
 {
    size_t i;
-   if (!playlist)
+   const struct playlist_entry *entry = NULL;
+
+   if (!playlist || !search_path)
       return;
 
-   for (i = 0; i < playlist->size; i++)
-   {
-      if (!string_is_equal(playlist->entries[i].path, search_path))
-         continue;
+   if (!playlist_find_entry(playlist, search_path, NULL, false, &i))
+      return;
 
-      if (path)
-         *path      = playlist->entries[i].path;
-      if (label)
-         *label     = playlist->entries[i].label;
-      if (core_path)
-         *core_path = playlist->entries[i].core_path;
-      if (core_name)
-         *core_name = playlist->entries[i].core_name;
-      if (db_name)
-         *db_name   = playlist->entries[i].db_name;
-      if (crc32)
-         *crc32     = playlist->entries[i].crc32;
-      break;
-   }
+   entry = playlist_entry_at(playlist, i);
+
+   if (path)
+      *path      = entry->path;
+   if (label)
+      *label     = entry->label;
+   if (core_path)
+      *core_path = entry->core_path;
+   if (core_name)
+      *core_name = entry->core_name;
+   if (db_name)
+      *db_name   = entry->db_name;
+   if (crc32)
+      *crc32     = entry->crc32;
 }
 
 bool playlist_entry_exists(playlist_t *playlist,
@@ -209,39 +1093,48 @@ bool playlist_entry_exists(playlist_t *playlist,
       const char *crc32)
 {
    size_t i;
-   if (!playlist)
+   if (!playlist || !path)
       return false;
 
-   for (i = 0; i < playlist->size; i++)
-      if (string_is_equal(playlist->entries[i].path, path))
-         return true;
+   return playlist_find_entry(playlist, path, NULL, false, &i);
+}
 
-   return false;
+/* Frees an entry string, unless it lives in the arena */
+static void playlist_free_string(playlist_t *playlist, char *str)
+{
+   if (     playlist->arena
+         && str >= playlist->arena
+         && str <  playlist->arena + playlist->arena_size)
+      return;
+
+   free(str);
 }
 
 /**
  * playlist_free_entry:
+ * @playlist            : Playlist handle.
  * @entry               : Playlist entry handle.
  *
  * Frees playlist entry.
  **/
-static void playlist_free_entry(struct playlist_entry *entry)
+static void playlist_free_entry(playlist_t *playlist,
+      struct playlist_entry *entry)
 {
    if (!entry)
       return;
 
    if (entry->path != NULL)
-      free(entry->path);
+      playlist_free_string(playlist, entry->path);
    if (entry->label != NULL)
-      free(entry->label);
+      playlist_free_string(playlist, entry->label);
    if (entry->core_path != NULL)
-      free(entry->core_path);
+      playlist_free_string(playlist, entry->core_path);
    if (entry->core_name != NULL)
-      free(entry->core_name);
+      playlist_free_string(playlist, entry->core_name);
    if (entry->db_name != NULL)
-      free(entry->db_name);
+      playlist_free_string(playlist, entry->db_name);
    if (entry->crc32 != NULL)
-      free(entry->crc32);
+      playlist_free_string(playlist, entry->crc32);
 
    entry->path      = NULL;
    entry->label     = NULL;
@@ -261,58 +1154,68 @@ void playlist_update(playlist_t *playlist, size_t idx,
       const char *db_name)
 {
    struct playlist_entry *entry = NULL;
+   bool modified                = false;
 
-   if (!playlist || idx > playlist->size)
+   if (!playlist || idx >= playlist->size)
       return;
 
-   entry            = &playlist->entries[idx];
+   entry            = playlist_entry_at(playlist, idx);
 
    if (path && (path != entry->path))
    {
+      playlist_index_remove(playlist, entry - playlist->entries);
       if (entry->path != NULL)
-         free(entry->path);
+         playlist_free_string(playlist, entry->path);
       entry->path        = strdup(path);
-      playlist->modified = true;
+      entry->path_hash   = playlist_path_hash(entry->path);
+      playlist_index_insert(playlist, entry - playlist->entries);
+      modified           = true;
    }
 
    if (label && (label != entry->label))
    {
       if (entry->label != NULL)
-         free(entry->label);
+         playlist_free_string(playlist, entry->label);
       entry->label       = strdup(label);
-      playlist->modified = true;
+      modified           = true;
    }
 
    if (core_path && (core_path != entry->core_path))
    {
       if (entry->core_path != NULL)
-         free(entry->core_path);
+         playlist_free_string(playlist, entry->core_path);
       entry->core_path   = NULL;
       entry->core_path   = strdup(core_path);
-      playlist->modified = true;
+      modified           = true;
    }
 
    if (core_name && (core_name != entry->core_name))
    {
       if (entry->core_name != NULL)
-         free(entry->core_name);
+         playlist_free_string(playlist, entry->core_name);
       entry->core_name   = strdup(core_name);
-      playlist->modified = true;
+      modified           = true;
    }
 
    if (db_name && (db_name != entry->db_name))
    {
       if (entry->db_name != NULL)
-         free(entry->db_name);
+         playlist_free_string(playlist, entry->db_name);
       entry->db_name     = strdup(db_name);
-      playlist->modified = true;
+      modified           = true;
    }
 
    if (crc32 && (crc32 != entry->crc32))
    {
       if (entry->crc32 != NULL)
-         free(entry->crc32);
+         playlist_free_string(playlist, entry->crc32);
       entry->crc32       = strdup(crc32);
+      modified           = true;
+   }
+
+   if (modified)
+   {
+      playlist_journal_record(playlist, PLAYLIST_JOURNAL_SET, idx, entry);
       playlist->modified = true;
    }
 }
@@ -323,44 +1226,54 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
       unsigned runtime_seconds)
 {
    struct playlist_entry *entry = NULL;
+   bool modified                = false;
 
-   if (!playlist || idx > playlist->size)
+   if (!playlist || idx >= playlist->size)
       return;
 
-   entry            = &playlist->entries[idx];
+   entry            = playlist_entry_at(playlist, idx);
 
    if (path && (path != entry->path))
    {
+      playlist_index_remove(playlist, entry - playlist->entries);
       if (entry->path != NULL)
-         free(entry->path);
+         playlist_free_string(playlist, entry->path);
       entry->path        = strdup(path);
-      playlist->modified = true;
+      entry->path_hash   = playlist_path_hash(entry->path);
+      playlist_index_insert(playlist, entry - playlist->entries);
+      modified           = true;
    }
 
    if (core_path && (core_path != entry->core_path))
    {
       if (entry->core_path != NULL)
-         free(entry->core_path);
+         playlist_free_string(playlist, entry->core_path);
       entry->core_path   = NULL;
       entry->core_path   = strdup(core_path);
-      playlist->modified = true;
+      modified           = true;
    }
 
    if (runtime_hours != entry->runtime_hours)
    {
       entry->runtime_hours = runtime_hours;
-      playlist->modified = true;
+      modified           = true;
    }
 
    if (runtime_minutes != entry->runtime_minutes)
    {
       entry->runtime_minutes = runtime_minutes;
-      playlist->modified = true;
+      modified           = true;
    }
 
    if (runtime_seconds != entry->runtime_seconds)
    {
       entry->runtime_seconds = runtime_seconds;
+      modified           = true;
+   }
+
+   if (modified)
+   {
+      playlist_journal_record(playlist, PLAYLIST_JOURNAL_SET, idx, entry);
       playlist->modified = true;
    }
 }
@@ -371,6 +1284,7 @@ bool playlist_push_runtime(playlist_t *playlist,
       unsigned runtime_seconds)
 {
    size_t i;
+   struct playlist_entry *entry = NULL;
    bool core_path_empty = string_is_empty(core_path);
 
    if (core_path_empty)
@@ -385,71 +1299,46 @@ bool playlist_push_runtime(playlist_t *playlist,
    if (!playlist)
       return false;
 
-   for (i = 0; i < playlist->size; i++)
-   {
-      struct playlist_entry tmp;
-      bool equal_path;
-
-      equal_path = (!path && !playlist->entries[i].path) ||
-         (path && playlist->entries[i].path &&
+   /* Core name can have changed while still being the same core.
+    * Differentiate based on the core path only. */
 #ifdef _WIN32
-          /*prevent duplicates on case-insensitive operating systems*/
-          string_is_equal_noncase(path,playlist->entries[i].path)
+   /*prevent duplicates on case-insensitive operating systems*/
+   if (playlist_find_entry(playlist, path, core_path, true, &i))
 #else
-          string_is_equal(path,playlist->entries[i].path)
+   if (playlist_find_entry(playlist, path, core_path, false, &i))
 #endif
-          );
-
-      /* Core name can have changed while still being the same core.
-       * Differentiate based on the core path only. */
-      if (!equal_path)
-         continue;
-
-      if (!string_is_equal(playlist->entries[i].core_path, core_path))
-         continue;
-
+   {
       /* If top entry, we don't want to push a new entry since
        * the top and the entry to be pushed are the same. */
       if (i == 0)
          return false;
 
       /* Seen it before, bump to top. */
-      tmp = playlist->entries[i];
-      memmove(playlist->entries + 1, playlist->entries,
-            i * sizeof(struct playlist_entry));
-      playlist->entries[0] = tmp;
+      playlist_move_to_top(playlist, i);
+      playlist_journal_record(playlist,
+            PLAYLIST_JOURNAL_MOVE_TO_TOP, i, NULL);
 
       goto success;
    }
 
-   if (playlist->size == playlist->cap)
-   {
-      struct playlist_entry *entry = &playlist->entries[playlist->cap - 1];
+   entry = playlist_push_slot(playlist);
 
-      if (entry)
-         playlist_free_entry(entry);
-      playlist->size--;
-   }
-
-   if (playlist->entries)
-   {
-      memmove(playlist->entries + 1, playlist->entries,
-            (playlist->cap - 1) * sizeof(struct playlist_entry));
-
-      playlist->entries[0].path            = NULL;
-      playlist->entries[0].core_path       = NULL;
+   if (!entry)
+      return false;
 
-      if (!string_is_empty(path))
-         playlist->entries[0].path      = strdup(path);
-      if (!string_is_empty(core_path))
-         playlist->entries[0].core_path = strdup(core_path);
+   if (!string_is_empty(path))
+      entry->path      = strdup(path);
+   if (!string_is_empty(core_path))
+      entry->core_path = strdup(core_path);
 
-      playlist->entries[0].runtime_hours = runtime_hours;
-      playlist->entries[0].runtime_minutes = runtime_minutes;
-      playlist->entries[0].runtime_seconds = runtime_seconds;
-   }
+   entry->runtime_hours   = runtime_hours;
+   entry->runtime_minutes = runtime_minutes;
+   entry->runtime_seconds = runtime_seconds;
+   entry->path_hash       = playlist_path_hash(entry->path);
 
    playlist->size++;
+   playlist_index_insert(playlist, playlist->head);
+   playlist_journal_record(playlist, PLAYLIST_JOURNAL_PUSH, 0, entry);
 
 success:
    playlist->modified = true;
@@ -473,6 +1362,7 @@ bool playlist_push(playlist_t *playlist,
       const char *db_name)
 {
    size_t i;
+   struct playlist_entry *entry = NULL;
    bool core_path_empty = string_is_empty(core_path);
    bool core_name_empty = string_is_empty(core_name);
 
@@ -498,81 +1388,50 @@ bool playlist_push(playlist_t *playlist,
    if (!playlist)
       return false;
 
-   for (i = 0; i < playlist->size; i++)
-   {
-      struct playlist_entry tmp;
-      bool equal_path;
-
-      equal_path = (!path && !playlist->entries[i].path) ||
-         (path && playlist->entries[i].path &&
+   /* Core name can have changed while still being the same core.
+    * Differentiate based on the core path only. */
 #ifdef _WIN32
-          /*prevent duplicates on case-insensitive operating systems*/
-          string_is_equal_noncase(path,playlist->entries[i].path)
+   /*prevent duplicates on case-insensitive operating systems*/
+   if (playlist_find_entry(playlist, path, core_path, true, &i))
 #else
-          string_is_equal(path,playlist->entries[i].path)
+   if (playlist_find_entry(playlist, path, core_path, false, &i))
 #endif
-          );
-
-      /* Core name can have changed while still being the same core.
-       * Differentiate based on the core path only. */
-      if (!equal_path)
-         continue;
-
-      if (!string_is_equal(playlist->entries[i].core_path, core_path))
-         continue;
-
+   {
       /* If top entry, we don't want to push a new entry since
        * the top and the entry to be pushed are the same. */
       if (i == 0)
          return false;
 
       /* Seen it before, bump to top. */
-      tmp = playlist->entries[i];
-      memmove(playlist->entries + 1, playlist->entries,
-            i * sizeof(struct playlist_entry));
-      playlist->entries[0] = tmp;
+      playlist_move_to_top(playlist, i);
+      playlist_journal_record(playlist,
+            PLAYLIST_JOURNAL_MOVE_TO_TOP, i, NULL);
 
       goto success;
    }
 
-   if (playlist->size == playlist->cap)
-   {
-      struct playlist_entry *entry = &playlist->entries[playlist->cap - 1];
+   entry = playlist_push_slot(playlist);
 
-      if (entry)
-         playlist_free_entry(entry);
-      playlist->size--;
-   }
+   if (!entry)
+      return false;
 
-   if (playlist->entries)
-   {
-      memmove(playlist->entries + 1, playlist->entries,
-            (playlist->cap - 1) * sizeof(struct playlist_entry));
-
-      playlist->entries[0].path            = NULL;
-      playlist->entries[0].label           = NULL;
-      playlist->entries[0].core_path       = NULL;
-      playlist->entries[0].core_name       = NULL;
-      playlist->entries[0].db_name         = NULL;
-      playlist->entries[0].crc32           = NULL;
-      playlist->entries[0].runtime_hours   = 0;
-      playlist->entries[0].runtime_minutes = 0;
-      playlist->entries[0].runtime_seconds = 0;
-      if (!string_is_empty(path))
-         playlist->entries[0].path      = strdup(path);
-      if (!string_is_empty(label))
-         playlist->entries[0].label     = strdup(label);
-      if (!string_is_empty(core_path))
-         playlist->entries[0].core_path = strdup(core_path);
-      if (!string_is_empty(core_name))
-         playlist->entries[0].core_name = strdup(core_name);
-      if (!string_is_empty(db_name))
-         playlist->entries[0].db_name   = strdup(db_name);
-      if (!string_is_empty(crc32))
-         playlist->entries[0].crc32     = strdup(crc32);
-   }
+   if (!string_is_empty(path))
+      entry->path      = strdup(path);
+   if (!string_is_empty(label))
+      entry->label     = strdup(label);
+   if (!string_is_empty(core_path))
+      entry->core_path = strdup(core_path);
+   if (!string_is_empty(core_name))
+      entry->core_name = strdup(core_name);
+   if (!string_is_empty(db_name))
+      entry->db_name   = strdup(db_name);
+   if (!string_is_empty(crc32))
+      entry->crc32     = strdup(crc32);
+   entry->path_hash    = playlist_path_hash(entry->path);
 
    playlist->size++;
+   playlist_index_insert(playlist, playlist->head);
+   playlist_journal_record(playlist, PLAYLIST_JOURNAL_PUSH, 0, entry);
 
 success:
    playlist->modified = true;
@@ -617,6 +1476,14 @@ void playlist_write_runtime_file(playlist_t *playlist)
    if (!playlist || !playlist->modified)
       return;
 
+   if (playlist_journal_write(playlist))
+   {
+      playlist->modified = false;
+      return;
+   }
+
+   playlist_journal_discard(playlist);
+
    file = filestream_open(playlist->conf_path,
          RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
 
@@ -657,6 +1524,8 @@ void playlist_write_runtime_file(playlist_t *playlist)
 
    for (i = 0; i < playlist->size; i++)
    {
+      const struct playlist_entry *entry = playlist_entry_at(playlist, i);
+
       JSON_Writer_WriteSpace(context.writer, 4);
       JSON_Writer_WriteStartObject(context.writer);
 
@@ -665,7 +1534,7 @@ void playlist_write_runtime_file(playlist_t *playlist)
       JSON_Writer_WriteString(context.writer, "path", strlen("path"), JSON_UTF8);
       JSON_Writer_WriteColon(context.writer);
       JSON_Writer_WriteSpace(context.writer, 1);
-      JSON_Writer_WriteString(context.writer, playlist->entries[i].path ? playlist->entries[i].path : "", playlist->entries[i].path ? strlen(playlist->entries[i].path) : 0, JSON_UTF8);
+      JSON_Writer_WriteString(context.writer, entry->path ? entry->path : "", entry->path ? strlen(entry->path) : 0, JSON_UTF8);
       JSON_Writer_WriteComma(context.writer);
 
       JSON_Writer_WriteNewLine(context.writer);
@@ -673,14 +1542,14 @@ void playlist_write_runtime_file(playlist_t *playlist)
       JSON_Writer_WriteString(context.writer, "core_path", strlen("core_path"), JSON_UTF8);
       JSON_Writer_WriteColon(context.writer);
       JSON_Writer_WriteSpace(context.writer, 1);
-      JSON_Writer_WriteString(context.writer, playlist->entries[i].core_path, strlen(playlist->entries[i].core_path), JSON_UTF8);
+      JSON_Writer_WriteString(context.writer, entry->core_path, strlen(entry->core_path), JSON_UTF8);
       JSON_Writer_WriteComma(context.writer);
       JSON_Writer_WriteNewLine(context.writer);
 
       {
          char tmp[32] = {0};
 
-         snprintf(tmp, sizeof(tmp), "%u", playlist->entries[i].runtime_hours);
+         snprintf(tmp, sizeof(tmp), "%u", entry->runtime_hours);
 
          JSON_Writer_WriteSpace(context.writer, 6);
          JSON_Writer_WriteString(context.writer, "runtime_hours", strlen("runtime_hours"), JSON_UTF8);
@@ -692,7 +1561,7 @@ void playlist_write_runtime_file(playlist_t *playlist)
 
          memset(tmp, 0, sizeof(tmp));
 
-         snprintf(tmp, sizeof(tmp), "%u", playlist->entries[i].runtime_minutes);
+         snprintf(tmp, sizeof(tmp), "%u", entry->runtime_minutes);
 
          JSON_Writer_WriteSpace(context.writer, 6);
          JSON_Writer_WriteString(context.writer, "runtime_minutes", strlen("runtime_minutes"), JSON_UTF8);
@@ -704,7 +1573,7 @@ void playlist_write_runtime_file(playlist_t *playlist)
 
          memset(tmp, 0, sizeof(tmp));
 
-         snprintf(tmp, sizeof(tmp), "%u", playlist->entries[i].runtime_seconds);
+         snprintf(tmp, sizeof(tmp), "%u", entry->runtime_seconds);
 
          JSON_Writer_WriteSpace(context.writer, 6);
          JSON_Writer_WriteString(context.writer, "runtime_seconds", strlen("runtime_seconds"), JSON_UTF8);
@@ -735,6 +1604,9 @@ void playlist_write_runtime_file(playlist_t *playlist)
    RARCH_LOG("Written to playlist file: %s\n", playlist->conf_path);
 end:
    filestream_close(file);
+
+   if (!playlist->modified)
+      playlist_journal_rebase(playlist);
 }
 
 void playlist_write_file(playlist_t *playlist)
@@ -746,6 +1618,14 @@ void playlist_write_file(playlist_t *playlist)
    if (!playlist || !playlist->modified)
       return;
 
+   if (playlist_journal_write(playlist))
+   {
+      playlist->modified = false;
+      return;
+   }
+
+   playlist_journal_discard(playlist);
+
    file = filestream_open(playlist->conf_path,
          RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
 
@@ -758,14 +1638,18 @@ void playlist_write_file(playlist_t *playlist)
    if (settings->bools.playlist_use_old_format)
    {
       for (i = 0; i < playlist->size; i++)
+      {
+         const struct playlist_entry *entry = playlist_entry_at(playlist, i);
+
          filestream_printf(file, "%s\n%s\n%s\n%s\n%s\n%s\n",
-               playlist->entries[i].path    ? playlist->entries[i].path    : "",
-               playlist->entries[i].label   ? playlist->entries[i].label   : "",
-               playlist->entries[i].core_path,
-               playlist->entries[i].core_name,
-               playlist->entries[i].crc32   ? playlist->entries[i].crc32   : "",
-               playlist->entries[i].db_name ? playlist->entries[i].db_name : ""
+               entry->path    ? entry->path    : "",
+               entry->label   ? entry->label   : "",
+               entry->core_path,
+               entry->core_name,
+               entry->crc32   ? entry->crc32   : "",
+               entry->db_name ? entry->db_name : ""
                );
+      }
    }
    else
    {
@@ -801,6 +1685,8 @@ void playlist_write_file(playlist_t *playlist)
 
       for (i = 0; i < playlist->size; i++)
       {
+         const struct playlist_entry *entry = playlist_entry_at(playlist, i);
+
          JSON_Writer_WriteSpace(context.writer, 4);
          JSON_Writer_WriteStartObject(context.writer);
 
@@ -809,7 +1695,7 @@ void playlist_write_file(playlist_t *playlist)
          JSON_Writer_WriteString(context.writer, "path", strlen("path"), JSON_UTF8);
          JSON_Writer_WriteColon(context.writer);
          JSON_Writer_WriteSpace(context.writer, 1);
-         JSON_Writer_WriteString(context.writer, playlist->entries[i].path ? playlist->entries[i].path : "", playlist->entries[i].path ? strlen(playlist->entries[i].path) : 0, JSON_UTF8);
+         JSON_Writer_WriteString(context.writer, entry->path ? entry->path : "", entry->path ? strlen(entry->path) : 0, JSON_UTF8);
          JSON_Writer_WriteComma(context.writer);
 
          JSON_Writer_WriteNewLine(context.writer);
@@ -817,7 +1703,7 @@ void playlist_write_file(playlist_t *playlist)
          JSON_Writer_WriteString(context.writer, "label", strlen("label"), JSON_UTF8);
          JSON_Writer_WriteColon(context.writer);
          JSON_Writer_WriteSpace(context.writer, 1);
-         JSON_Writer_WriteString(context.writer, playlist->entries[i].label ? playlist->entries[i].label : "", playlist->entries[i].label ? strlen(playlist->entries[i].label) : 0, JSON_UTF8);
+         JSON_Writer_WriteString(context.writer, entry->label ? entry->label : "", entry->label ? strlen(entry->label) : 0, JSON_UTF8);
          JSON_Writer_WriteComma(context.writer);
 
          JSON_Writer_WriteNewLine(context.writer);
@@ -825,7 +1711,7 @@ void playlist_write_file(playlist_t *playlist)
          JSON_Writer_WriteString(context.writer, "core_path", strlen("core_path"), JSON_UTF8);
          JSON_Writer_WriteColon(context.writer);
          JSON_Writer_WriteSpace(context.writer, 1);
-         JSON_Writer_WriteString(context.writer, playlist->entries[i].core_path, strlen(playlist->entries[i].core_path), JSON_UTF8);
+         JSON_Writer_WriteString(context.writer, entry->core_path, strlen(entry->core_path), JSON_UTF8);
          JSON_Writer_WriteComma(context.writer);
 
          JSON_Writer_WriteNewLine(context.writer);
@@ -833,7 +1719,7 @@ void playlist_write_file(playlist_t *playlist)
          JSON_Writer_WriteString(context.writer, "core_name", strlen("core_name"), JSON_UTF8);
          JSON_Writer_WriteColon(context.writer);
          JSON_Writer_WriteSpace(context.writer, 1);
-         JSON_Writer_WriteString(context.writer, playlist->entries[i].core_name, strlen(playlist->entries[i].core_name), JSON_UTF8);
+         JSON_Writer_WriteString(context.writer, entry->core_name, strlen(entry->core_name), JSON_UTF8);
          JSON_Writer_WriteComma(context.writer);
 
          JSON_Writer_WriteNewLine(context.writer);
@@ -841,7 +1727,7 @@ void playlist_write_file(playlist_t *playlist)
          JSON_Writer_WriteString(context.writer, "crc32", strlen("crc32"), JSON_UTF8);
          JSON_Writer_WriteColon(context.writer);
          JSON_Writer_WriteSpace(context.writer, 1);
-         JSON_Writer_WriteString(context.writer, playlist->entries[i].crc32 ? playlist->entries[i].crc32 : "", playlist->entries[i].crc32 ? strlen(playlist->entries[i].crc32) : 0, JSON_UTF8);
+         JSON_Writer_WriteString(context.writer, entry->crc32 ? entry->crc32 : "", entry->crc32 ? strlen(entry->crc32) : 0, JSON_UTF8);
          JSON_Writer_WriteComma(context.writer);
 
          JSON_Writer_WriteNewLine(context.writer);
@@ -849,7 +1735,7 @@ void playlist_write_file(playlist_t *playlist)
          JSON_Writer_WriteString(context.writer, "db_name", strlen("db_name"), JSON_UTF8);
          JSON_Writer_WriteColon(context.writer);
          JSON_Writer_WriteSpace(context.writer, 1);
-         JSON_Writer_WriteString(context.writer, playlist->entries[i].db_name ? playlist->entries[i].db_name : "", playlist->entries[i].db_name ? strlen(playlist->entries[i].db_name) : 0, JSON_UTF8);
+         JSON_Writer_WriteString(context.writer, entry->db_name ? entry->db_name : "", entry->db_name ? strlen(entry->db_name) : 0, JSON_UTF8);
          JSON_Writer_WriteNewLine(context.writer);
 
          JSON_Writer_WriteSpace(context.writer, 4);
@@ -874,6 +1760,9 @@ void playlist_write_file(playlist_t *playlist)
    RARCH_LOG("Written to playlist file: %s\n", playlist->conf_path);
 end:
    filestream_close(file);
+
+   if (!playlist->modified)
+      playlist_journal_rebase(playlist);
 }
 
 /**
@@ -895,16 +1784,18 @@ void playlist_free(playlist_t *playlist)
    playlist->conf_path = NULL;
 
    for (i = 0; i < playlist->size; i++)
-   {
-      struct playlist_entry *entry = &playlist->entries[i];
-
-      if (entry)
-         playlist_free_entry(entry);
-   }
+      playlist_free_entry(playlist, playlist_entry_at(playlist, i));
 
    free(playlist->entries);
    playlist->entries = NULL;
 
+   free(playlist->index);
+   playlist->index   = NULL;
+
+   free(playlist->journal);
+   free(playlist->journal_path);
+   free(playlist->arena);
+
    free(playlist);
 }
 
@@ -916,18 +1807,11 @@ void playlist_free(playlist_t *playlist)
  **/
 void playlist_clear(playlist_t *playlist)
 {
-   size_t i;
    if (!playlist)
       return;
 
-   for (i = 0; i < playlist->size; i++)
-   {
-      struct playlist_entry *entry = &playlist->entries[i];
-
-      if (entry)
-         playlist_free_entry(entry);
-   }
-   playlist->size = 0;
+   playlist_clear_entries(playlist);
+   playlist_journal_record(playlist, PLAYLIST_JOURNAL_CLEAR, 0, NULL);
 }
 
 /**
@@ -944,6 +1828,489 @@ size_t playlist_size(playlist_t *playlist)
    return playlist->size;
 }
 
+/**
+ * playlist_json_store:
+ * @pCtx                : JSON parsing context.
+ * @str                 : String at the current end of the arena.
+ * @len                 : Length of @str.
+ * @intern              : Share the string with other entries having
+ *                        the same value (core paths, names, ...).
+ *
+ * Keeps a string that was just written to the arena.
+ *
+ * Returns: the string, owned by the playlist.
+ **/
+static char *playlist_json_store(JSONContext *pCtx,
+      char *str, size_t len, bool intern)
+{
+   const char **slot = NULL;
+
+   if (intern)
+   {
+      slot = &pCtx->interned[
+         playlist_path_hash(str) & (PLAYLIST_INTERN_SLOTS - 1)];
+
+      if (*slot && string_is_equal(*slot, str))
+         return (char*)*slot;
+   }
+
+   pCtx->arena_len += len + 1;
+
+   if (slot)
+      *slot = str;
+
+   return str;
+}
+
+/* Copies a string into the arena, or onto the heap once it is full */
+static char *playlist_json_strdup(JSONContext *pCtx,
+      const char *str, size_t len, bool intern)
+{
+   playlist_t *playlist = pCtx->playlist;
+   char *copy           = NULL;
+
+   if (!playlist->arena || playlist->arena_size - pCtx->arena_len < len + 1)
+      return strdup(str);
+
+   copy      = playlist->arena + pCtx->arena_len;
+   memcpy(copy, str, len);
+   copy[len] = '\0';
+
+   return playlist_json_store(pCtx, copy, len, intern);
+}
+
+/* Finds the entry field a JSON object member is read into */
+static void playlist_json_lookup_member(struct playlist_entry *entry,
+      const char *name, char ***str_val, unsigned **uint_val, bool *intern)
+{
+   if (string_is_equal(name, "path"))
+      *str_val  = &entry->path;
+   else if (string_is_equal(name, "label"))
+      *str_val  = &entry->label;
+   else if (string_is_equal(name, "core_path"))
+   {
+      *str_val  = &entry->core_path;
+      *intern   = true;
+   }
+   else if (string_is_equal(name, "core_name"))
+   {
+      *str_val  = &entry->core_name;
+      *intern   = true;
+   }
+   else if (string_is_equal(name, "crc32"))
+      *str_val  = &entry->crc32;
+   else if (string_is_equal(name, "db_name"))
+   {
+      *str_val  = &entry->db_name;
+      *intern   = true;
+   }
+   else if (string_is_equal(name, "runtime_hours"))
+      *uint_val = &entry->runtime_hours;
+   else if (string_is_equal(name, "runtime_minutes"))
+      *uint_val = &entry->runtime_minutes;
+   else if (string_is_equal(name, "runtime_seconds"))
+      *uint_val = &entry->runtime_seconds;
+   else
+   {
+      /* ignore unknown members */
+   }
+}
+
+static void playlist_json_skip_whitespace(const char **pos, const char *end)
+{
+   while (*pos < end && (**pos == ' ' || **pos == '\n'
+            || **pos == '\r' || **pos == '\t'))
+      (*pos)++;
+}
+
+static bool playlist_json_hex4(const char *pos, uint32_t *val)
+{
+   unsigned i;
+
+   *val = 0;
+
+   for (i = 0; i < 4; i++)
+   {
+      char c = pos[i];
+
+      *val <<= 4;
+
+      if (c >= '0' && c <= '9')
+         *val |= c - '0';
+      else if (c >= 'a' && c <= 'f')
+         *val |= c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F')
+         *val |= c - 'A' + 10;
+      else
+         return false;
+   }
+
+   return true;
+}
+
+/**
+ * playlist_json_read_string:
+ * @pos                 : Position of the opening quote, advanced
+ *                        past the closing one.
+ * @end                 : End of the input.
+ * @out                 : Where to write the decoded string.
+ * @out_end             : End of the space available at @out.
+ * @len                 : Length of the decoded string.
+ *
+ * Decodes a JSON string, NUL-terminated. Anything the full
+ * parser would have to repair (invalid UTF-8, lone surrogates)
+ * is rejected.
+ *
+ * Returns: true if the string could be decoded.
+ **/
+static bool playlist_json_read_string(const char **pos, const char *end,
+      char *out, const char *out_end, size_t *len)
+{
+   const char *r = *pos + 1;
+   char *w       = out;
+
+   if (*pos >= end || **pos != '"')
+      return false;
+
+   while (r < end && w < out_end)
+   {
+      uint8_t c = (uint8_t)*r++;
+
+      if (c == '"')
+      {
+         *w   = '\0';
+         *len = w - out;
+         *pos = r;
+         return true;
+      }
+
+      if (c == '\\')
+      {
+         uint32_t cp = 0;
+
+         if (r >= end)
+            return false;
+
+         switch (*r++)
+         {
+            case '"':
+               *w++ = '"';
+               continue;
+            case '\\':
+               *w++ = '\\';
+               continue;
+            case '/':
+               *w++ = '/';
+               continue;
+            case 'b':
+               *w++ = '\b';
+               continue;
+            case 'f':
+               *w++ = '\f';
+               continue;
+            case 'n':
+               *w++ = '\n';
+               continue;
+            case 'r':
+               *w++ = '\r';
+               continue;
+            case 't':
+               *w++ = '\t';
+               continue;
+            case 'u':
+               if (end - r < 4 || !playlist_json_hex4(r, &cp))
+                  return false;
+               r += 4;
+               break;
+            default:
+               return false;
+         }
+
+         if (cp >= 0xDC00 && cp <= 0xDFFF)
+            return false;
+
+         if (cp >= 0xD800 && cp <= 0xDBFF)
+         {
+            uint32_t low = 0;
+
+            if (     end - r < 6 || r[0] != '\\' || r[1] != 'u'
+                  || !playlist_json_hex4(r + 2, &low)
+                  || low < 0xDC00 || low > 0xDFFF)
+               return false;
+
+            r  += 6;
+            cp  = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+         }
+
+         /* The escape sequence is always longer than its encoding */
+         if (out_end - w < 4)
+            return false;
+
+         if (cp < 0x80)
+            *w++ = (char)cp;
+         else if (cp < 0x800)
+         {
+            *w++ = (char)(0xC0 | (cp >> 6));
+            *w++ = (char)(0x80 | (cp & 0x3F));
+         }
+         else if (cp < 0x10000)
+         {
+            *w++ = (char)(0xE0 | (cp >> 12));
+            *w++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+            *w++ = (char)(0x80 | (cp & 0x3F));
+         }
+         else
+         {
+            *w++ = (char)(0xF0 | (cp >> 18));
+            *w++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+            *w++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+            *w++ = (char)(0x80 | (cp & 0x3F));
+         }
+      }
+      else if (c >= 0x80)
+      {
+         unsigned i;
+         unsigned extra = 0;
+         uint8_t min    = 0x80;
+         uint8_t max    = 0xBF;
+
+         if (c >= 0xC2 && c <= 0xDF)
+            extra = 1;
+         else if (c >= 0xE0 && c <= 0xEF)
+         {
+            extra = 2;
+            if (c == 0xE0)
+               min = 0xA0;
+            else if (c == 0xED)
+               max = 0x9F;
+         }
+         else if (c >= 0xF0 && c <= 0xF4)
+         {
+            extra = 3;
+            if (c == 0xF0)
+               min = 0x90;
+            else if (c == 0xF4)
+               max = 0x8F;
+         }
+         else
+            return false;
+
+         if (end - r < (ptrdiff_t)extra || out_end - w < (ptrdiff_t)extra + 1)
+            return false;
+
+         if ((uint8_t)r[0] < min || (uint8_t)r[0] > max)
+            return false;
+
+         for (i = 1; i < extra; i++)
+            if (((uint8_t)r[i] & 0xC0) != 0x80)
+               return false;
+
+         *w++ = (char)c;
+         for (i = 0; i < extra; i++)
+            *w++ = *r++;
+      }
+      else
+         *w++ = (char)c;
+   }
+
+   return false;
+}
+
+/* Reads a plain unsigned integer, anything fancier is rejected */
+static bool playlist_json_read_uint(const char **pos, const char *end,
+      unsigned *val)
+{
+   const char *r = *pos;
+   unsigned digits = 0;
+
+   *val = 0;
+
+   while (r < end && *r >= '0' && *r <= '9')
+   {
+      if (++digits > 9)
+         return false;
+      *val = *val * 10 + (*r++ - '0');
+   }
+
+   if (!digits || (r < end && *r != ',' && *r != '}' && *r != ']'
+            && *r != ' ' && *r != '\n' && *r != '\r' && *r != '\t'))
+      return false;
+
+   *pos = r;
+   return true;
+}
+
+/**
+ * playlist_json_read_fast:
+ * @pCtx                : JSON parsing context.
+ * @data                : Contents of the playlist file.
+ * @len                 : Length of @data.
+ *
+ * Reads a playlist laid out the way playlist_write_file and
+ * playlist_write_runtime_file write it, in a single pass, decoding
+ * strings straight into the arena. Gives up on anything else
+ * (comments, nested values, special numbers, ...), so that the
+ * full parser can deal with it.
+ *
+ * Returns: true if the playlist was read.
+ **/
+static bool playlist_json_read_fast(JSONContext *pCtx,
+      const char *data, size_t len)
+{
+   size_t slen;
+   playlist_t *playlist = pCtx->playlist;
+   const char *pos      = data;
+   const char *end      = data + len;
+   const char *out_end  = playlist->arena + playlist->arena_size;
+   char *name           = NULL;
+
+   playlist_json_skip_whitespace(&pos, end);
+   if (pos >= end || *pos++ != '{')
+      return false;
+
+   for (;;)
+   {
+      playlist_json_skip_whitespace(&pos, end);
+
+      name = playlist->arena + pCtx->arena_len;
+      if (!playlist_json_read_string(&pos, end, name, out_end, &slen))
+         return false;
+
+      playlist_json_skip_whitespace(&pos, end);
+      if (pos >= end || *pos++ != ':')
+         return false;
+      playlist_json_skip_whitespace(&pos, end);
+
+      if (string_is_equal(name, "items") && pos < end && *pos == '[')
+      {
+         pos++;
+         playlist_json_skip_whitespace(&pos, end);
+
+         if (pos < end && *pos == ']')
+            pos++;
+         else for (;;)
+         {
+            struct playlist_entry *entry = NULL;
+
+            /* hit max item limit */
+            if (playlist->size >= playlist->cap)
+               return true;
+
+            entry = playlist_entry_at(playlist, playlist->size);
+
+            playlist_json_skip_whitespace(&pos, end);
+            if (pos >= end || *pos++ != '{')
+               return false;
+            playlist_json_skip_whitespace(&pos, end);
+
+            if (pos < end && *pos == '}')
+               pos++;
+            else for (;;)
+            {
+               char **str_val     = NULL;
+               unsigned *uint_val = NULL;
+               unsigned uint_tmp  = 0;
+               bool intern        = false;
+
+               playlist_json_skip_whitespace(&pos, end);
+
+               name = playlist->arena + pCtx->arena_len;
+               if (!playlist_json_read_string(&pos, end, name, out_end, &slen))
+                  return false;
+               playlist_json_lookup_member(entry, name,
+                     &str_val, &uint_val, &intern);
+
+               playlist_json_skip_whitespace(&pos, end);
+               if (pos >= end || *pos++ != ':')
+                  return false;
+               playlist_json_skip_whitespace(&pos, end);
+
+               if (pos < end && *pos == '"' && !uint_val)
+               {
+                  char *str = playlist->arena + pCtx->arena_len;
+
+                  if (!playlist_json_read_string(&pos, end, str, out_end, &slen))
+                     return false;
+
+                  if (str_val && slen && *str)
+                  {
+                     if (*str_val)
+                        playlist_free_string(playlist, *str_val);
+                     *str_val = playlist_json_store(pCtx, str, slen, intern);
+                  }
+               }
+               else if (!str_val)
+               {
+                  if (!playlist_json_read_uint(&pos, end,
+                           uint_val ? uint_val : &uint_tmp))
+                     return false;
+               }
+               else
+                  return false;
+
+               playlist_json_skip_whitespace(&pos, end);
+               if (pos < end && *pos == ',')
+               {
+                  pos++;
+                  continue;
+               }
+               if (pos >= end || *pos++ != '}')
+                  return false;
+               break;
+            }
+
+            playlist->size++;
+
+            playlist_json_skip_whitespace(&pos, end);
+            if (pos < end && *pos == ',')
+            {
+               pos++;
+               continue;
+            }
+            if (pos >= end || *pos++ != ']')
+               return false;
+            break;
+         }
+      }
+      else if (pos < end && *pos == '"')
+      {
+         /* top-level playlist metadata, not used yet */
+         char *str = playlist->arena + pCtx->arena_len;
+         if (!playlist_json_read_string(&pos, end, str, out_end, &slen))
+            return false;
+      }
+      else
+         return false;
+
+      playlist_json_skip_whitespace(&pos, end);
+      if (pos < end && *pos == ',')
+      {
+         pos++;
+         continue;
+      }
+      if (pos >= end || *pos++ != '}')
+         return false;
+      break;
+   }
+
+   playlist_json_skip_whitespace(&pos, end);
+   return pos == end;
+}
+
+/* Drops whatever playlist_json_read_fast read before giving up */
+static void playlist_json_reset(JSONContext *pCtx)
+{
+   size_t i;
+   playlist_t *playlist = pCtx->playlist;
+
+   for (i = 0; i <= playlist->size && i < playlist->cap; i++)
+      playlist_free_entry(playlist, playlist_entry_at(playlist, i));
+
+   playlist->size  = 0;
+   pCtx->arena_len = 0;
+   memset(pCtx->interned, 0, sizeof(pCtx->interned));
+}
+
 static JSON_Parser_HandlerResult JSONStartArrayHandler(JSON_Parser parser)
 {
    JSONContext *pCtx = (JSONContext*)JSON_Parser_GetUserData(parser);
@@ -994,7 +2361,7 @@ static JSON_Parser_HandlerResult JSONStartObjectHandler(JSON_Parser parser)
       {
          if (pCtx->playlist->size < pCtx->playlist->cap)
          {
-            pCtx->current_entry = &pCtx->playlist->entries[pCtx->playlist->size];
+            pCtx->current_entry = playlist_entry_at(pCtx->playlist, pCtx->playlist->size);
          }
          else
          {
@@ -1038,9 +2405,10 @@ static JSON_Parser_HandlerResult JSONStringHandler(JSON_Parser parser, char *pVa
          if (pCtx->current_entry_val && length && !string_is_empty(pValue))
          {
             if (*pCtx->current_entry_val)
-               free(*pCtx->current_entry_val);
+               playlist_free_string(pCtx->playlist, *pCtx->current_entry_val);
 
-            *pCtx->current_entry_val = strdup(pValue);
+            *pCtx->current_entry_val = playlist_json_strdup(pCtx,
+                  pValue, length, pCtx->current_entry_intern);
          }
          else
          {
@@ -1063,7 +2431,8 @@ static JSON_Parser_HandlerResult JSONStringHandler(JSON_Parser parser, char *pVa
       }
    }
 
-   pCtx->current_entry_val = NULL;
+   pCtx->current_entry_val    = NULL;
+   pCtx->current_entry_intern = false;
 
    return JSON_Parser_Continue;
 }
@@ -1129,30 +2498,9 @@ static JSON_Parser_HandlerResult JSONObjectMemberHandler(JSON_Parser parser, cha
          }
 
          if (length)
-         {
-            if (string_is_equal(pValue, "path"))
-               pCtx->current_entry_val = &pCtx->current_entry->path;
-            else if (string_is_equal(pValue, "label"))
-               pCtx->current_entry_val = &pCtx->current_entry->label;
-            else if (string_is_equal(pValue, "core_path"))
-               pCtx->current_entry_val = &pCtx->current_entry->core_path;
-            else if (string_is_equal(pValue, "core_name"))
-               pCtx->current_entry_val = &pCtx->current_entry->core_name;
-            else if (string_is_equal(pValue, "crc32"))
-               pCtx->current_entry_val = &pCtx->current_entry->crc32;
-            else if (string_is_equal(pValue, "db_name"))
-               pCtx->current_entry_val = &pCtx->current_entry->db_name;
-            else if (string_is_equal(pValue, "runtime_hours"))
-               pCtx->current_entry_uint_val = &pCtx->current_entry->runtime_hours;
-            else if (string_is_equal(pValue, "runtime_minutes"))
-               pCtx->current_entry_uint_val = &pCtx->current_entry->runtime_minutes;
-            else if (string_is_equal(pValue, "runtime_seconds"))
-               pCtx->current_entry_uint_val = &pCtx->current_entry->runtime_seconds;
-            else
-            {
-               /* ignore unknown members */
-            }
-         }
+            playlist_json_lookup_member(pCtx->current_entry, pValue,
+                  &pCtx->current_entry_val, &pCtx->current_entry_uint_val,
+                  &pCtx->current_entry_intern);
       }
    }
    else if (pCtx->object_depth == 1)
@@ -1225,6 +2573,9 @@ static bool playlist_read_file(
    if (new_format)
    {
       JSONContext context = {0};
+      int64_t length      = filestream_get_size(file);
+      char *data          = NULL;
+
       context.parser = JSON_Parser_Create(NULL);
       context.file = file;
       context.playlist = playlist;
@@ -1235,6 +2586,35 @@ static bool playlist_read_file(
          goto end;
       }
 
+      /* Parse the whole file at once. Decoded strings are never
+       * longer than their quoted form, so an arena the size of
+       * the file holds all of them. */
+      if (length > 0)
+         data = (char*)malloc((size_t)length);
+
+      if (!data || filestream_read(file, data, length) != length)
+      {
+         RARCH_WARN("Could not read JSON input.\n");
+         free(data);
+         JSON_Parser_Free(context.parser);
+         goto end;
+      }
+
+      free(playlist->arena);
+      playlist->arena      = (char*)malloc((size_t)length);
+      playlist->arena_size = playlist->arena ? (size_t)length : 0;
+
+      if (playlist->arena && playlist_json_read_fast(&context, data, (size_t)length))
+      {
+         JSON_Parser_Free(context.parser);
+         free(data);
+         goto end;
+      }
+
+      /* Not laid out the way we write playlists,
+       * start over with the full parser */
+      playlist_json_reset(&context);
+
       /*JSON_Parser_SetTrackObjectMembers(context.parser, JSON_True);*/
       JSON_Parser_SetAllowBOM(context.parser, JSON_True);
       JSON_Parser_SetAllowComments(context.parser, JSON_True);
@@ -1257,36 +2637,17 @@ static bool playlist_read_file(
       JSON_Parser_SetEndArrayHandler(context.parser, &JSONEndArrayHandler);
       JSON_Parser_SetUserData(context.parser, &context);
 
-      while (!filestream_eof(file))
-      {
-         char chunk[4096] = {0};
-         int64_t length = filestream_read(file, chunk, sizeof(chunk));
-
-         if (!length && !filestream_eof(file))
-         {
-            RARCH_WARN("Could not read JSON input.\n");
-            JSON_Parser_Free(context.parser);
-            goto end;
-         }
-
-         if (!JSON_Parser_Parse(context.parser, chunk, length, JSON_False))
-         {
-            RARCH_WARN("Error parsing chunk:\n---snip---\n%s\n---snip---\n", chunk);
-            JSONLogError(&context);
-            JSON_Parser_Free(context.parser);
-            goto end;
-         }
-      }
-
-      if (!JSON_Parser_Parse(context.parser, NULL, 0, JSON_True))
+      if (!JSON_Parser_Parse(context.parser, data, (size_t)length, JSON_True))
       {
          RARCH_WARN("Error parsing JSON.\n");
          JSONLogError(&context);
          JSON_Parser_Free(context.parser);
+         free(data);
          goto end;
       }
 
       JSON_Parser_Free(context.parser);
+      free(data);
 
       if (context.current_meta_string)
          free(context.current_meta_string);
@@ -1319,7 +2680,7 @@ static bool playlist_read_file(
                *last = '\0';
          }
 
-         entry = &playlist->entries[playlist->size];
+         entry = playlist_entry_at(playlist, playlist->size);
 
          if (!*buf[2] || !*buf[3])
             continue;
@@ -1393,11 +2754,47 @@ playlist_t *playlist_init(const char *path, size_t size)
    playlist->modified  = false;
    playlist->size      = 0;
    playlist->cap       = size;
+   playlist->head      = 0;
+   playlist->index     = NULL;
+   playlist->index_cap = 0;
    playlist->conf_path = strdup(path);
    playlist->entries   = entries;
 
+   playlist->arena              = NULL;
+   playlist->arena_size         = 0;
+   playlist->journal            = NULL;
+   playlist->journal_len        = 0;
+   playlist->journal_cap        = 0;
+   playlist->journal_pending    = 0;
+   playlist->journal_records    = 0;
+   playlist->journal_size       = 0;
+   playlist->journal_base_size  = -1;
+   playlist->journal_base_mtime = 0;
+   playlist->journal_base_hash  = 0;
+   playlist->journal_invalid    = false;
+   playlist->journal_path       = (char*)malloc(
+         strlen(path) + sizeof(PLAYLIST_JOURNAL_EXTENSION));
+
+   if (playlist->journal_path)
+   {
+      strcpy(playlist->journal_path, path);
+      strcat(playlist->journal_path, PLAYLIST_JOURNAL_EXTENSION);
+   }
+
    playlist_read_file(playlist, path);
 
+   if (!playlist_index_rebuild(playlist, playlist->size))
+   {
+      playlist_free(playlist);
+      return NULL;
+   }
+
+   if (playlist->journal_path && playlist->conf_path && path_is_valid(path))
+   {
+      playlist_journal_rebase(playlist);
+      playlist_journal_replay(playlist);
+   }
+
    return playlist;
 }
 
@@ -1413,11 +2810,42 @@ static int playlist_qsort_func(const struct playlist_entry *a,
    return strcasecmp(a_label, b_label);
 }
 
+static void playlist_reverse_entries(struct playlist_entry *entries,
+      size_t len)
+{
+   size_t i;
+   for (i = 0; i < len / 2; i++)
+   {
+      struct playlist_entry tmp = entries[i];
+      entries[i]                = entries[len - 1 - i];
+      entries[len - 1 - i]      = tmp;
+   }
+}
+
 void playlist_qsort(playlist_t *playlist)
 {
+   if (!playlist)
+      return;
+
+   /* Rotate the ring buffer so the entries are contiguous again */
+   if (playlist->head)
+   {
+      playlist_reverse_entries(playlist->entries, playlist->head);
+      playlist_reverse_entries(playlist->entries + playlist->head,
+            playlist->cap - playlist->head);
+      playlist_reverse_entries(playlist->entries, playlist->cap);
+      playlist->head = 0;
+   }
+
    qsort(playlist->entries, playlist->size,
          sizeof(struct playlist_entry),
          (int (*)(const void *, const void *))playlist_qsort_func);
+
+   playlist_index_rebuild(playlist, playlist->size);
+
+   /* The new order isn't journaled, rewrite the
+    * playlist file the next time it gets saved */
+   playlist->journal_invalid = true;
 }
 
 void command_playlist_push_write(
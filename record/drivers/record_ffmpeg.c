@@ -17,6 +17,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <retro_assert.h>
 #include <compat/msvc.h>
@@ -122,13 +123,17 @@ extern "C" {
 #define av_frame_free avcodec_free_frame
 #endif
 
+#define MAX_FRAMES 32
+
+/* Scaled pictures between the scale and the video encode stage; the encoder
+ * keeps one of them to repeat for duplicate frames */
+#define MAX_SCALED_FRAMES 4
+
 struct ff_video_info
 {
    AVCodecContext *codec;
    AVCodec *encoder;
 
-   AVFrame *conv_frame;
-   uint8_t *conv_frame_buf;
    int64_t frame_cnt;
 
    uint8_t *outbuf;
@@ -219,10 +224,43 @@ struct ff_config_param
    int video_global_quality;
    int video_bit_rate;
 
+   /* Skip frames rather than make the frontend wait for the encoder. */
+   bool drop_frames;
+
    AVDictionary *video_opts;
    AVDictionary *audio_opts;
 };
 
+/* A picture buffer along with an AVFrame pointing into it. */
+struct ff_frame_buffer
+{
+   AVFrame *frame;
+   uint8_t *buf;
+};
+
+/* An entry of the frontend's queue (attr_fifo) or of the scaled queue.
+ * The picture is in raw or in slot of scaled, or neither for a duplicate
+ * of the previous frame. skipped counts the frames dropped right before
+ * this one, which the encoder leaves as a gap in the timestamps. */
+struct ff_queued_frame
+{
+   struct record_video_data data;
+   int raw;
+   int slot;
+   unsigned skipped;
+};
+
+/* Reported when the recording ends. */
+struct ff_pipeline_stats
+{
+   unsigned raw_depth_max;
+   unsigned scaled_depth_max;
+   unsigned audio_depth_max;
+   unsigned frames_encoded;
+   unsigned frames_dropped;
+   unsigned frontend_waits;
+};
+
 typedef struct ffmpeg
 {
    struct ff_video_info video;
@@ -232,16 +270,39 @@ typedef struct ffmpeg
 
    struct record_params params;
 
-   scond_t *cond;
-   slock_t *cond_lock;
-   slock_t *lock;
+   /* Frontend to the scale stage (attr_fifo, with the pixels in raw) and
+    * to the audio encode stage (audio_fifo). skipped counts the frames
+    * dropped since the last one queued. A raw buffer stays busy until
+    * it's been scaled, or encoded when it can go to the encoder as is. */
    fifo_buffer_t *audio_fifo;
-   fifo_buffer_t *video_fifo;
    fifo_buffer_t *attr_fifo;
-   sthread_t *thread;
+   struct ff_frame_buffer raw[MAX_FRAMES];
+   bool raw_busy[MAX_FRAMES];
+   unsigned skipped;
+
+   /* Scale stage to the video encode stage. held is the encoder's
+    * previous frame, which it repeats for duplicates. */
+   struct ff_frame_buffer scaled[MAX_SCALED_FRAMES];
+   bool scaled_busy[MAX_SCALED_FRAMES];
+   struct ff_queued_frame scaled_queue[MAX_FRAMES];
+   unsigned scaled_head;
+   unsigned scaled_count;
+   struct ff_queued_frame held;
+
+   /* lock guards the queues and stats, and cond is broadcast whenever one
+    * of them changes. mux_lock guards the muxer, which both encode stages
+    * write to. */
+   slock_t *lock;
+   slock_t *mux_lock;
+   scond_t *cond;
+
+   sthread_t *scale_thread;
+   sthread_t *video_thread;
+   sthread_t *audio_thread;
+
+   struct ff_pipeline_stats stats;
 
    volatile bool alive;
-   volatile bool can_sleep;
 } ffmpeg_t;
 
 AVFormatContext *ctx;
@@ -419,6 +480,7 @@ static bool ffmpeg_init_audio(ffmpeg_t *handle)
 
 static bool ffmpeg_init_video(ffmpeg_t *handle)
 {
+   unsigned i;
    size_t size;
    struct ff_config_param *params  = &handle->config;
    struct ff_video_info *video     = &handle->video;
@@ -517,7 +579,10 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
          param->aspect_ratio * param->out_height / param->out_width, 255);
    video->codec->pix_fmt             = video->pix_fmt;
 
+   /* Let the codec spread its work over frames where it can, and over
+    * slices otherwise */
    video->codec->thread_count = params->threads;
+   video->codec->thread_type  = FF_THREAD_FRAME | FF_THREAD_SLICE;
 
    if (params->video_qscale)
    {
@@ -543,15 +608,23 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
 
    size = avpicture_get_size(video->pix_fmt, param->out_width,
          param->out_height);
-   video->conv_frame_buf = (uint8_t*)av_malloc(size);
-   video->conv_frame = av_frame_alloc();
 
-   avpicture_fill((AVPicture*)video->conv_frame, video->conv_frame_buf,
-         video->pix_fmt, param->out_width, param->out_height);
+   for (i = 0; i < MAX_SCALED_FRAMES; i++)
+   {
+      struct ff_frame_buffer *scaled = &handle->scaled[i];
+
+      scaled->buf   = (uint8_t*)av_malloc(size);
+      scaled->frame = av_frame_alloc();
+      if (!scaled->buf || !scaled->frame)
+         return false;
+
+      avpicture_fill((AVPicture*)scaled->frame, scaled->buf,
+            video->pix_fmt, param->out_width, param->out_height);
 
-   video->conv_frame->width  = param->out_width;
-   video->conv_frame->height = param->out_height;
-   video->conv_frame->format = video->pix_fmt;
+      scaled->frame->width  = param->out_width;
+      scaled->frame->height = param->out_height;
+      scaled->frame->format = video->pix_fmt;
+   }
 
    return true;
 }
@@ -783,6 +856,7 @@ static bool ffmpeg_init_config(struct ff_config_param *params,
          sizeof(params->format));
 
    config_get_uint(params->conf, "threads", &params->threads);
+   config_get_bool(params->conf, "drop_frames", &params->drop_frames);
 
    if (!config_get_uint(params->conf, "frame_drop_ratio",
             &params->frame_drop_ratio) || !params->frame_drop_ratio)
@@ -880,54 +954,73 @@ static bool ffmpeg_init_muxer_post(ffmpeg_t *handle)
    return avformat_write_header(handle->muxer.ctx, NULL) >= 0;
 }
 
-#define MAX_FRAMES 32
-
-static void ffmpeg_thread(void *data);
+static void ffmpeg_scale_thread(void *data);
+static void ffmpeg_video_thread(void *data);
+static void ffmpeg_audio_thread(void *data);
 
 static bool init_thread(ffmpeg_t *handle)
 {
+   unsigned i;
+   /* For some reason, FFmpeg has a tendency to crash
+    * if we don't overallocate a bit. */
+   size_t raw_size = handle->params.fb_width *
+      (handle->params.fb_height + 1) * handle->video.pix_size;
+
    handle->lock = slock_new();
-   handle->cond_lock = slock_new();
+   handle->mux_lock = slock_new();
    handle->cond = scond_new();
    handle->audio_fifo = fifo_new(32000 * sizeof(int16_t) *
          handle->params.channels * MAX_FRAMES / 60); /* Some arbitrary max size. */
-   handle->attr_fifo = fifo_new(sizeof(struct record_video_data) * MAX_FRAMES);
-   handle->video_fifo = fifo_new(handle->params.fb_width * handle->params.fb_height *
-            handle->video.pix_size * MAX_FRAMES);
+   handle->attr_fifo = fifo_new(sizeof(struct ff_queued_frame) * MAX_FRAMES);
+
+   for (i = 0; i < MAX_FRAMES; i++)
+   {
+      handle->raw[i].buf   = (uint8_t*)av_malloc(raw_size);
+      handle->raw[i].frame = av_frame_alloc();
+      retro_assert(handle->raw[i].buf && handle->raw[i].frame);
+   }
+
+   handle->held.raw  = -1;
+   handle->held.slot = -1;
+   handle->alive     = true;
 
-   handle->alive = true;
-   handle->can_sleep = true;
-   handle->thread = sthread_create(ffmpeg_thread, handle);
+   handle->scale_thread = sthread_create(ffmpeg_scale_thread, handle);
+   handle->video_thread = sthread_create(ffmpeg_video_thread, handle);
+   if (handle->config.audio_enable)
+      handle->audio_thread = sthread_create(ffmpeg_audio_thread, handle);
 
-   retro_assert(handle->lock && handle->cond_lock &&
+   retro_assert(handle->lock && handle->mux_lock &&
       handle->cond && handle->audio_fifo &&
-      handle->attr_fifo && handle->video_fifo && handle->thread);
+      handle->attr_fifo &&
+      handle->scale_thread && handle->video_thread &&
+      (handle->audio_thread || !handle->config.audio_enable));
 
    return true;
 }
 
 static void deinit_thread(ffmpeg_t *handle)
 {
-   if (!handle->thread)
+   if (!handle->scale_thread)
       return;
 
-   slock_lock(handle->cond_lock);
+   slock_lock(handle->lock);
    handle->alive = false;
-   handle->can_sleep = false;
-   slock_unlock(handle->cond_lock);
-
-   scond_signal(handle->cond);
-   sthread_join(handle->thread);
+   scond_broadcast(handle->cond);
+   slock_unlock(handle->lock);
 
-   slock_free(handle->lock);
-   slock_free(handle->cond_lock);
-   scond_free(handle->cond);
+   sthread_join(handle->scale_thread);
+   sthread_join(handle->video_thread);
+   sthread_join(handle->audio_thread);
 
-   handle->thread = NULL;
+   handle->scale_thread = NULL;
+   handle->video_thread = NULL;
+   handle->audio_thread = NULL;
 }
 
 static void deinit_thread_buf(ffmpeg_t *handle)
 {
+   unsigned i;
+
    if (handle->audio_fifo)
    {
       fifo_free(handle->audio_fifo);
@@ -940,15 +1033,24 @@ static void deinit_thread_buf(ffmpeg_t *handle)
       handle->attr_fifo = NULL;
    }
 
-   if (handle->video_fifo)
+   for (i = 0; i < MAX_FRAMES; i++)
    {
-      fifo_free(handle->video_fifo);
-      handle->video_fifo = NULL;
+      av_frame_free(&handle->raw[i].frame);
+      av_free(handle->raw[i].buf);
+      handle->raw[i].buf = NULL;
    }
+
+   slock_free(handle->lock);
+   slock_free(handle->mux_lock);
+   scond_free(handle->cond);
+   handle->lock     = NULL;
+   handle->mux_lock = NULL;
+   handle->cond     = NULL;
 }
 
 static void ffmpeg_free(void *data)
 {
+   unsigned i;
    ffmpeg_t *handle = (ffmpeg_t*)data;
    if (!handle)
       return;
@@ -970,8 +1072,11 @@ static void ffmpeg_free(void *data)
       av_free(handle->video.codec);
    }
 
-   av_frame_free(&handle->video.conv_frame);
-   av_free(handle->video.conv_frame_buf);
+   for (i = 0; i < MAX_SCALED_FRAMES; i++)
+   {
+      av_frame_free(&handle->scaled[i].frame);
+      av_free(handle->scaled[i].buf);
+   }
 
    scaler_ctx_gen_reset(&handle->video.scaler);
 
@@ -1009,6 +1114,10 @@ static void *ffmpeg_new(const struct record_params *params)
 
    handle->params = *params;
 
+   /* A live stream can't wait for the encoder, a recording can */
+   handle->config.drop_frames =
+      params->preset >= RECORD_CONFIG_TYPE_STREAMING_CUSTOM;
+
    if (params->preset == RECORD_CONFIG_TYPE_RECORDING_CUSTOM || params->preset == RECORD_CONFIG_TYPE_STREAMING_CUSTOM)
    {
       RARCH_LOG("config: %s %s\n", &handle->config, params->config);
@@ -1040,12 +1149,32 @@ error:
    return NULL;
 }
 
+/* Claim a free buffer out of the count in busy, or return -1 if there's
+ * none. */
+static int ffmpeg_buffer_get(bool *busy, unsigned count)
+{
+   unsigned i;
+
+   for (i = 0; i < count; i++)
+   {
+      if (!busy[i])
+      {
+         busy[i] = true;
+         return (int)i;
+      }
+   }
+
+   return -1;
+}
+
 static bool ffmpeg_push_video(void *data,
       const struct record_video_data *vid)
 {
-   unsigned y;
+   unsigned y, depth;
    bool drop_frame;
-   struct record_video_data attr_data;
+   uint8_t *out;
+   bool waited      = false;
+   struct ff_queued_frame attr_data;
    ffmpeg_t *handle = (ffmpeg_t*)data;
    int       offset = 0;
 
@@ -1060,52 +1189,78 @@ static bool ffmpeg_push_video(void *data,
    if (drop_frame)
       return true;
 
+   attr_data.data = *vid;
+   attr_data.raw  = -1;
+   attr_data.slot = -1;
+
+   slock_lock(handle->lock);
+
    for (;;)
    {
-      unsigned avail;
-      slock_lock(handle->lock);
-      avail = fifo_write_avail(handle->attr_fifo);
-      slock_unlock(handle->lock);
-
       if (!handle->alive)
+      {
+         slock_unlock(handle->lock);
          return false;
+      }
 
-      if (avail >= sizeof(*vid))
-         break;
-
-      slock_lock(handle->cond_lock);
-      if (handle->can_sleep)
+      /* Once half the pipeline is backed up, skip frames altogether
+       * so the encoder can catch up. */
+      if (handle->config.drop_frames &&
+            fifo_read_avail(handle->attr_fifo) / sizeof(attr_data) +
+            handle->scaled_count >= MAX_FRAMES / 2)
       {
-         handle->can_sleep = false;
-         scond_wait(handle->cond, handle->cond_lock);
-         handle->can_sleep = true;
+         handle->skipped++;
+         handle->stats.frames_dropped++;
+         slock_unlock(handle->lock);
+         return true;
       }
-      else
-         scond_signal(handle->cond);
 
-      slock_unlock(handle->cond_lock);
+      if (fifo_write_avail(handle->attr_fifo) >= sizeof(attr_data) &&
+            (attr_data.data.is_dupe || (attr_data.raw =
+               ffmpeg_buffer_get(handle->raw_busy, MAX_FRAMES)) >= 0))
+         break;
+
+      if (!waited)
+         handle->stats.frontend_waits++;
+      waited = true;
+      scond_wait(handle->cond, handle->lock);
    }
 
-   slock_lock(handle->lock);
+   slock_unlock(handle->lock);
 
    /* Tightly pack our frame to conserve memory.
     * libretro tends to use a very large pitch.
+    *
+    * This is the only copy of the pixels: the raw buffer is ours until
+    * it's queued, and goes on to the scaler or the encoder as is.
     */
-   attr_data = *vid;
-
-   if (attr_data.is_dupe)
-      attr_data.width = attr_data.height = attr_data.pitch = 0;
+   if (attr_data.data.is_dupe)
+      attr_data.data.width = attr_data.data.height = attr_data.data.pitch = 0;
    else
-      attr_data.pitch = attr_data.width * handle->video.pix_size;
+   {
+      out                  = handle->raw[attr_data.raw].buf;
+      attr_data.data.data  = out;
+      attr_data.data.pitch = attr_data.data.width * handle->video.pix_size;
+
+      for (y = 0; y < attr_data.data.height;
+            y++, offset += vid->pitch, out += attr_data.data.pitch)
+         memcpy(out, (const uint8_t*)vid->data + offset,
+               attr_data.data.pitch);
+   }
+
+   slock_lock(handle->lock);
+
+   attr_data.skipped = handle->skipped;
+   handle->skipped   = 0;
 
    fifo_write(handle->attr_fifo, &attr_data, sizeof(attr_data));
 
-   for (y = 0; y < attr_data.height; y++, offset += vid->pitch)
-      fifo_write(handle->video_fifo,
-            (const uint8_t*)vid->data + offset, attr_data.pitch);
+   depth = (unsigned)(fifo_read_avail(handle->attr_fifo) / sizeof(attr_data));
+   if (depth > handle->stats.raw_depth_max)
+      handle->stats.raw_depth_max = depth;
 
+   scond_broadcast(handle->cond);
    slock_unlock(handle->lock);
-   scond_signal(handle->cond);
 
    return true;
 }
@@ -1113,6 +1268,8 @@ static bool ffmpeg_push_video(void *data,
 static bool ffmpeg_push_audio(void *data,
       const struct record_audio_data *audio_data)
 {
+   unsigned depth;
+   bool waited      = false;
    ffmpeg_t *handle = (ffmpeg_t*)data;
 
    if (!handle || !audio_data)
@@ -1121,42 +1278,51 @@ static bool ffmpeg_push_audio(void *data,
    if (!handle->config.audio_enable)
       return true;
 
+   slock_lock(handle->lock);
+
    for (;;)
    {
-      unsigned avail;
-      slock_lock(handle->lock);
-      avail = fifo_write_avail(handle->audio_fifo);
-      slock_unlock(handle->lock);
-
       if (!handle->alive)
+      {
+         slock_unlock(handle->lock);
          return false;
+      }
 
-      if (avail >= audio_data->frames * handle->params.channels
-            * sizeof(int16_t))
+      if (fifo_write_avail(handle->audio_fifo) >= audio_data->frames *
+            handle->params.channels * sizeof(int16_t))
          break;
 
-      slock_lock(handle->cond_lock);
-      if (handle->can_sleep)
-      {
-         handle->can_sleep = false;
-         scond_wait(handle->cond, handle->cond_lock);
-         handle->can_sleep = true;
-      }
-      else
-         scond_signal(handle->cond);
-
-      slock_unlock(handle->cond_lock);
+      if (!waited)
+         handle->stats.frontend_waits++;
+      waited = true;
+      scond_wait(handle->cond, handle->lock);
    }
 
-   slock_lock(handle->lock);
    fifo_write(handle->audio_fifo, audio_data->data,
          audio_data->frames * handle->params.channels * sizeof(int16_t));
+
+   depth = (unsigned)(fifo_read_avail(handle->audio_fifo) /
+         (handle->params.channels * sizeof(int16_t)));
+   if (depth > handle->stats.audio_depth_max)
+      handle->stats.audio_depth_max = depth;
+
+   scond_broadcast(handle->cond);
    slock_unlock(handle->lock);
-   scond_signal(handle->cond);
 
    return true;
 }
 
+static bool ffmpeg_write_packet(ffmpeg_t *handle, AVPacket *pkt)
+{
+   int ret;
+
+   slock_lock(handle->mux_lock);
+   ret = av_interleaved_write_frame(handle->muxer.ctx, pkt);
+   slock_unlock(handle->mux_lock);
+
+   return ret >= 0;
+}
+
 static bool encode_video(ffmpeg_t *handle, AVPacket *pkt, AVFrame *frame)
 {
    int got_packet = 0;
@@ -1193,7 +1359,7 @@ static bool encode_video(ffmpeg_t *handle, AVPacket *pkt, AVFrame *frame)
 }
 
 static void ffmpeg_scale_input(ffmpeg_t *handle,
-      const struct record_video_data *vid)
+      const struct record_video_data *vid, AVFrame *out)
 {
    /* Attempt to preserve more information if we scale down. */
    bool shrunk = handle->params.out_width < vid->width
@@ -1210,18 +1376,17 @@ static void ffmpeg_scale_input(ffmpeg_t *handle,
             shrunk ? SWS_BILINEAR : SWS_POINT, NULL, NULL, NULL);
 
       sws_scale(handle->video.sws, (const uint8_t* const*)&vid->data,
-            &linesize, 0, vid->height, handle->video.conv_frame->data,
-            handle->video.conv_frame->linesize);
+            &linesize, 0, vid->height, out->data, out->linesize);
    }
    else
    {
       video_frame_record_scale(
             &handle->video.scaler,
-            handle->video.conv_frame->data[0],
+            out->data[0],
             vid->data,
             handle->params.out_width,
             handle->params.out_height,
-            handle->video.conv_frame->linesize[0],
+            out->linesize[0],
             vid->width,
             vid->height,
             vid->pitch,
@@ -1229,27 +1394,105 @@ static void ffmpeg_scale_input(ffmpeg_t *handle,
    }
 }
 
+/* Get the queued raw frame in entry ready for the encoder. When it already
+ * has the output size and format, it goes to the encoder as is; otherwise
+ * it's scaled into slot of scaled, and true is returned to say the raw
+ * buffer can be released. */
+static bool ffmpeg_prepare_frame(ffmpeg_t *handle,
+      struct ff_queued_frame *entry, int slot)
+{
+   struct ff_frame_buffer *raw = &handle->raw[entry->raw];
+
+   if (     handle->video.in_pix_fmt == handle->video.pix_fmt
+         && entry->data.width  == handle->params.out_width
+         && entry->data.height == handle->params.out_height)
+   {
+      avpicture_fill((AVPicture*)raw->frame, raw->buf,
+            handle->video.pix_fmt, entry->data.width, entry->data.height);
+
+      raw->frame->width  = entry->data.width;
+      raw->frame->height = entry->data.height;
+      raw->frame->format = handle->video.pix_fmt;
+      return false;
+   }
+
+   ffmpeg_scale_input(handle, &entry->data, handle->scaled[slot].frame);
+   entry->slot = slot;
+   return true;
+}
+
+/* Release the buffers of a frame the encoder is done with. */
+static void ffmpeg_release_frame(ffmpeg_t *handle,
+      const struct ff_queued_frame *entry)
+{
+   if (entry->raw >= 0)
+      handle->raw_busy[entry->raw] = false;
+   if (entry->slot >= 0)
+      handle->scaled_busy[entry->slot] = false;
+}
+
+static void ffmpeg_scaled_push(ffmpeg_t *handle,
+      const struct ff_queued_frame *entry)
+{
+   handle->scaled_queue[(handle->scaled_head + handle->scaled_count)
+      % MAX_FRAMES] = *entry;
+   handle->scaled_count++;
+
+   if (handle->scaled_count > handle->stats.scaled_depth_max)
+      handle->stats.scaled_depth_max = handle->scaled_count;
+}
+
+static struct ff_queued_frame ffmpeg_scaled_pop(ffmpeg_t *handle)
+{
+   struct ff_queued_frame entry = handle->scaled_queue[handle->scaled_head];
+
+   handle->scaled_head = (handle->scaled_head + 1) % MAX_FRAMES;
+   handle->scaled_count--;
+
+   return entry;
+}
+
+/* Encode the frame in entry, or the previous one again for a duplicate,
+ * after leaving a gap for the frames skipped before it. The previous
+ * frame's buffers are released once a new one replaces it. */
 static bool ffmpeg_push_video_thread(ffmpeg_t *handle,
-      const struct record_video_data *vid)
+      const struct ff_queued_frame *entry)
 {
    AVPacket pkt;
+   AVFrame *frame = NULL;
+   bool repeat    = entry->raw < 0 && entry->slot < 0;
+   const struct ff_queued_frame *held = repeat ? &handle->held : entry;
+   bool ret       = true;
 
-   if (!vid->is_dupe)
-      ffmpeg_scale_input(handle, vid);
+   handle->video.frame_cnt += entry->skipped;
 
-   handle->video.conv_frame->pts = handle->video.frame_cnt;
+   if (held->slot >= 0)
+      frame = handle->scaled[held->slot].frame;
+   else if (held->raw >= 0)
+      frame = handle->raw[held->raw].frame;
 
-   if (!encode_video(handle, &pkt, handle->video.conv_frame))
-      return false;
-
-   if (pkt.size)
+   if (frame)
    {
-      if (av_interleaved_write_frame(handle->muxer.ctx, &pkt) < 0)
-         return false;
+      frame->pts = handle->video.frame_cnt;
+
+      if (!encode_video(handle, &pkt, frame))
+         ret = false;
+      else if (pkt.size && !ffmpeg_write_packet(handle, &pkt))
+         ret = false;
    }
 
    handle->video.frame_cnt++;
-   return true;
+
+   slock_lock(handle->lock);
+   if (!repeat)
+   {
+      ffmpeg_release_frame(handle, &handle->held);
+      handle->held = *entry;
+   }
+   handle->stats.frames_encoded++;
+   slock_unlock(handle->lock);
+
+   return ret;
 }
 
 static void planarize_float(float *out, const float *in, size_t frames)
@@ -1473,7 +1716,7 @@ static bool ffmpeg_push_audio_thread(ffmpeg_t *handle,
 
       if (pkt.size)
       {
-         if (av_interleaved_write_frame(handle->muxer.ctx, &pkt) < 0)
+         if (!ffmpeg_write_packet(handle, &pkt))
             return false;
       }
    }
@@ -1502,7 +1745,7 @@ static void ffmpeg_flush_audio(ffmpeg_t *handle, void *audio_buf,
    {
       AVPacket pkt;
       if (!encode_audio(handle, &pkt, true) || !pkt.size ||
-            av_interleaved_write_frame(handle->muxer.ctx, &pkt) < 0)
+            !ffmpeg_write_packet(handle, &pkt))
          break;
    }
 }
@@ -1513,7 +1756,7 @@ static void ffmpeg_flush_video(ffmpeg_t *handle)
    {
       AVPacket pkt;
       if (!encode_video(handle, &pkt, NULL) || !pkt.size ||
-            av_interleaved_write_frame(handle->muxer.ctx, &pkt) < 0)
+            !ffmpeg_write_packet(handle, &pkt))
          break;
    }
 }
@@ -1521,8 +1764,6 @@ static void ffmpeg_flush_video(ffmpeg_t *handle)
 static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 {
    bool did_work;
-   void *video_buf = av_malloc(2 * handle->params.fb_width *
-         handle->params.fb_height * handle->video.pix_size);
    size_t audio_buf_size = handle->config.audio_enable ?
       (handle->audio.codec->frame_size *
        handle->params.channels * sizeof(int16_t)) : 0;
@@ -1530,12 +1771,20 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 
    if (audio_buf_size)
       audio_buf = av_malloc(audio_buf_size);
+
+   /* Frames already scaled go first. */
+   while (handle->scaled_count)
+   {
+      struct ff_queued_frame entry = ffmpeg_scaled_pop(handle);
+      ffmpeg_push_video_thread(handle, &entry);
+   }
+
    /* Try pushing data in an interleaving pattern to
     * ease the work of the muxer a bit. */
 
    do
    {
-      struct record_video_data attr_buf;
+      struct ff_queued_frame attr_buf;
 
       did_work = false;
 
@@ -1558,9 +1807,21 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
       if (fifo_read_avail(handle->attr_fifo) >= sizeof(attr_buf))
       {
          fifo_read(handle->attr_fifo, &attr_buf, sizeof(attr_buf));
-         fifo_read(handle->video_fifo, video_buf,
-               attr_buf.height * attr_buf.pitch);
-         attr_buf.data = video_buf;
+
+         /* Only the encoder's previous frame is still held */
+         if (attr_buf.raw >= 0)
+         {
+            int slot = ffmpeg_buffer_get(handle->scaled_busy,
+                  MAX_SCALED_FRAMES);
+
+            if (ffmpeg_prepare_frame(handle, &attr_buf, slot))
+            {
+               handle->raw_busy[attr_buf.raw] = false;
+               attr_buf.raw                   = -1;
+            }
+            else
+               handle->scaled_busy[slot]      = false;
+         }
          ffmpeg_push_video_thread(handle, &attr_buf);
 
          did_work = true;
@@ -1574,7 +1835,6 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
    /* Flush out last video. */
    ffmpeg_flush_video(handle);
 
-   av_free(video_buf);
    av_free(audio_buf);
 }
 
@@ -1591,6 +1851,15 @@ static bool ffmpeg_finalize(void *data)
 
    deinit_thread_buf(handle);
 
+   RARCH_LOG("[FFmpeg]: Encoded %u frames, skipped %u to keep up, "
+         "made the frontend wait %u times.\n",
+         handle->stats.frames_encoded, handle->stats.frames_dropped,
+         handle->stats.frontend_waits);
+   RARCH_LOG("[FFmpeg]: Deepest queues: %u raw frames, %u scaled frames, "
+         "%u audio frames.\n",
+         handle->stats.raw_depth_max, handle->stats.scaled_depth_max,
+         handle->stats.audio_depth_max);
+
    /* Write final data. */
    av_write_trailer(handle->muxer.ctx);
 
@@ -1599,83 +1868,115 @@ static bool ffmpeg_finalize(void *data)
    return true;
 }
 
-static void ffmpeg_thread(void *data)
+/* Scale stage: turns raw frames from the frontend into frames for the
+ * video encode stage. */
+static void ffmpeg_scale_thread(void *data)
 {
-   size_t audio_buf_size;
-   void *audio_buf = NULL;
-   ffmpeg_t *ff    = (ffmpeg_t*)data;
-   /* For some reason, FFmpeg has a tendency to crash
-    * if we don't overallocate a bit. */
-   void *video_buf = av_malloc(2 * ff->params.fb_width *
-         ff->params.fb_height * ff->video.pix_size);
-
-   retro_assert(video_buf);
+   ffmpeg_t *ff = (ffmpeg_t*)data;
 
-   audio_buf_size = ff->config.audio_enable ?
-      (ff->audio.codec->frame_size * ff->params.channels * sizeof(int16_t)) : 0;
-   audio_buf      = audio_buf_size ? av_malloc(audio_buf_size) : NULL;
+   slock_lock(ff->lock);
 
    while (ff->alive)
    {
-      struct record_video_data attr_buf;
-
-      bool avail_video = false;
-      bool avail_audio = false;
+      struct ff_queued_frame attr_buf;
+      int slot = -1;
 
-      slock_lock(ff->lock);
-      if (fifo_read_avail(ff->attr_fifo) >= sizeof(attr_buf))
-         avail_video = true;
+      if (fifo_read_avail(ff->attr_fifo) < sizeof(attr_buf) ||
+            ff->scaled_count >= MAX_FRAMES ||
+            (slot = ffmpeg_buffer_get(ff->scaled_busy,
+                                      MAX_SCALED_FRAMES)) < 0)
+      {
+         scond_wait(ff->cond, ff->lock);
+         continue;
+      }
 
-      if (ff->config.audio_enable)
-         if (fifo_read_avail(ff->audio_fifo) >= audio_buf_size)
-            avail_audio = true;
+      fifo_read(ff->attr_fifo, &attr_buf, sizeof(attr_buf));
+      scond_broadcast(ff->cond);
       slock_unlock(ff->lock);
 
-      if (!avail_video && !avail_audio)
+      if (attr_buf.raw >= 0 && ffmpeg_prepare_frame(ff, &attr_buf, slot))
       {
-         slock_lock(ff->cond_lock);
-         if (ff->can_sleep)
-         {
-            ff->can_sleep = false;
-            scond_wait(ff->cond, ff->cond_lock);
-            ff->can_sleep = true;
-         }
-         else
-            scond_signal(ff->cond);
-
-         slock_unlock(ff->cond_lock);
+         slock_lock(ff->lock);
+         ff->raw_busy[attr_buf.raw] = false;
+         attr_buf.raw               = -1;
       }
-
-      if (avail_video && video_buf)
+      else
       {
          slock_lock(ff->lock);
-         fifo_read(ff->attr_fifo, &attr_buf, sizeof(attr_buf));
-         fifo_read(ff->video_fifo, video_buf,
-               attr_buf.height * attr_buf.pitch);
-         slock_unlock(ff->lock);
-         scond_signal(ff->cond);
-
-         attr_buf.data = video_buf;
-         ffmpeg_push_video_thread(ff, &attr_buf);
+         ff->scaled_busy[slot]      = false;
       }
+      ffmpeg_scaled_push(ff, &attr_buf);
+      scond_broadcast(ff->cond);
+   }
+
+   slock_unlock(ff->lock);
+}
+
+/* Video encode stage: encodes and muxes the scaled frames. */
+static void ffmpeg_video_thread(void *data)
+{
+   ffmpeg_t *ff = (ffmpeg_t*)data;
 
-      if (avail_audio && audio_buf)
+   slock_lock(ff->lock);
+
+   while (ff->alive)
+   {
+      struct ff_queued_frame entry;
+
+      if (!ff->scaled_count)
       {
-         struct record_audio_data aud = {0};
+         scond_wait(ff->cond, ff->lock);
+         continue;
+      }
 
-         slock_lock(ff->lock);
-         fifo_read(ff->audio_fifo, audio_buf, audio_buf_size);
-         slock_unlock(ff->lock);
-         scond_signal(ff->cond);
+      entry = ffmpeg_scaled_pop(ff);
+      slock_unlock(ff->lock);
+
+      ffmpeg_push_video_thread(ff, &entry);
+
+      slock_lock(ff->lock);
+      scond_broadcast(ff->cond);
+   }
+
+   slock_unlock(ff->lock);
+}
+
+/* Audio encode stage: resamples, encodes and muxes the audio. */
+static void ffmpeg_audio_thread(void *data)
+{
+   ffmpeg_t *ff          = (ffmpeg_t*)data;
+   size_t audio_buf_size = ff->audio.codec->frame_size *
+      ff->params.channels * sizeof(int16_t);
+   void *audio_buf       = av_malloc(audio_buf_size);
 
-         aud.frames = ff->audio.codec->frame_size;
-         aud.data = audio_buf;
+   retro_assert(audio_buf);
 
-         ffmpeg_push_audio_thread(ff, &aud, true);
+   slock_lock(ff->lock);
+
+   while (ff->alive)
+   {
+      struct record_audio_data aud = {0};
+
+      if (fifo_read_avail(ff->audio_fifo) < audio_buf_size)
+      {
+         scond_wait(ff->cond, ff->lock);
+         continue;
       }
+
+      fifo_read(ff->audio_fifo, audio_buf, audio_buf_size);
+      scond_broadcast(ff->cond);
+      slock_unlock(ff->lock);
+
+      aud.frames = ff->audio.codec->frame_size;
+      aud.data = audio_buf;
+
+      ffmpeg_push_audio_thread(ff, &aud, true);
+
+      slock_lock(ff->lock);
    }
 
-   av_free(video_buf);
+   slock_unlock(ff->lock);
+
    av_free(audio_buf);
 }
 
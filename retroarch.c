@@ -2618,6 +2618,19 @@ bool runloop_msg_queue_pull(const char **ret)
    return true;
 }
 
+size_t runloop_msg_queue_size(void)
+{
+   size_t size;
+#ifdef HAVE_THREADS
+   runloop_msg_queue_lock();
+#endif
+   size = msg_queue_size(runloop_msg_queue);
+#ifdef HAVE_THREADS
+   runloop_msg_queue_unlock();
+#endif
+   return size;
+}
+
 #define bsv_movie_is_end_of_file() (bsv_movie_state.movie_end && bsv_movie_state.eof_exit)
 
 /* Time to exit out of the main loop?
@@ -3148,6 +3161,11 @@ static enum runloop_state runloop_check_state(
 
    if (menu_driver_is_alive())
    {
+      /* Nothing changed on screen, poll again
+       * in a bit instead of waiting for vsync. */
+      if (menu_driver_skipped_frame())
+         return RUNLOOP_STATE_POLLED_AND_SLEEP;
+
       if (!settings->bools.menu_throttle_framerate && !fastforward_ratio)
          return RUNLOOP_STATE_MENU_ITERATE;
 
@@ -393,6 +393,8 @@ void runloop_msg_queue_push(const char *msg,
 
 bool runloop_msg_queue_pull(const char **ret);
 
+size_t runloop_msg_queue_size(void);
+
 void runloop_get_status(bool *is_paused, bool *is_idle, bool *is_slowmotion,
       bool *is_perfcnt_enable);
 
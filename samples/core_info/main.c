@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
+
+#include "../../core_info.h"
+#include "../../file_path_special.h"
+
+/*
+ * Measures core info list creation with and without
+ * the binary cache (core_info.cache in the info dir).
+ *
+ * return codes -
+ * normal   exit: 0
+ * error    exit: 1
+ */
+
+static retro_time_t time_init_list(const char *core_dir,
+      const char *core_info_dir, const char *exts)
+{
+   core_info_list_t *list = NULL;
+   retro_time_t start     = cpu_features_get_time_usec();
+
+   if (!core_info_init_list(core_info_dir, core_dir, exts, true))
+      return -1;
+
+   start = cpu_features_get_time_usec() - start;
+
+   core_info_get_list(&list);
+   if (!list || !core_info_list_num_info_files(list))
+      fprintf(stderr, "No core info files found.\n");
+
+   core_info_deinit_list();
+   return start;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i;
+   char cache_path[PATH_MAX_LENGTH];
+   retro_time_t cold         = 0;
+   retro_time_t warm         = 0;
+   unsigned runs             = 5;
+   const char *core_dir      = NULL;
+   const char *core_info_dir = NULL;
+#if defined(_WIN32)
+   const char *exts          = "dll";
+#elif defined(__MACH__)
+   const char *exts          = "dylib";
+#else
+   const char *exts          = "so";
+#endif
+
+   if (argc < 3)
+   {
+      fprintf(stderr, "Usage: %s <core dir> <core info dir> [runs]\n", argv[0]);
+      return 1;
+   }
+
+   core_dir      = argv[1];
+   core_info_dir = argv[2];
+
+   if (argc > 3)
+      runs = (unsigned)strtoul(argv[3], NULL, 10);
+   if (!runs)
+      runs = 1;
+
+   fill_pathname_join(cache_path, core_info_dir,
+         file_path_str(FILE_PATH_CORE_INFO_CACHE), sizeof(cache_path));
+
+   for (i = 0; i < runs; i++)
+   {
+      retro_time_t t;
+
+      filestream_delete(cache_path);
+
+      if ((t = time_init_list(core_dir, core_info_dir, exts)) < 0)
+      {
+         fprintf(stderr, "Could not read core dir: %s\n", core_dir);
+         return 1;
+      }
+      cold += t;
+
+      if ((t = time_init_list(core_dir, core_info_dir, exts)) < 0)
+         return 1;
+      warm += t;
+   }
+
+   fprintf(stderr, "Cold startup (no cache): %.3f ms\n",
+         cold / 1000.0 / runs);
+   fprintf(stderr, "Warm startup (cache)   : %.3f ms\n",
+         warm / 1000.0 / runs);
+
+   return 0;
+}
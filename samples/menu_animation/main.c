@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <features/features_cpu.h>
+
+#include "../../configuration.h"
+#include "../../menu/menu_animation.h"
+
+/*
+ * Simulates scrolling through a long list as fast as
+ * possible, animating it the way XMB does: every selection
+ * change kills the list's tweens by tag and pushes alpha,
+ * label alpha, zoom and y tweens for each entry near the
+ * selection, then runs a frame.
+ *
+ * Usage: menu_animation_bench [-n entries] [-w window]
+ *                             [-s steps] [-b background tweens]
+ *
+ * return codes -
+ * normal   exit: 0
+ * error    exit: 1
+ */
+
+#define BENCH_DURATION 166.0f
+
+struct bench_node
+{
+   float alpha;
+   float label_alpha;
+   float zoom;
+   float y;
+};
+
+static settings_t bench_settings;
+
+settings_t *config_get_ptr(void)
+{
+   return &bench_settings;
+}
+
+static void push_tween(float *subject, float target, uintptr_t tag)
+{
+   menu_animation_ctx_entry_t entry;
+
+   entry.easing_enum  = EASING_OUT_QUAD;
+   entry.tag          = tag;
+   entry.duration     = BENCH_DURATION;
+   entry.target_value = target;
+   entry.subject      = subject;
+   entry.cb           = NULL;
+   entry.userdata     = NULL;
+
+   menu_animation_push(&entry);
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned step;
+   struct bench_node *nodes  = NULL;
+   float *background         = NULL;
+   unsigned entries          = 10000;
+   unsigned window           = 32;
+   unsigned steps            = 100000;
+   unsigned num_background   = 0;
+   retro_time_t change_time  = 0;
+   retro_time_t update_time  = 0;
+   uint64_t pushed           = 0;
+   menu_animation_ctx_tag tag;
+
+   for (i = 1; i < argc; i++)
+   {
+      unsigned *opt = NULL;
+
+      if (!strcmp(argv[i], "-n"))
+         opt = &entries;
+      else if (!strcmp(argv[i], "-w"))
+         opt = &window;
+      else if (!strcmp(argv[i], "-s"))
+         opt = &steps;
+      else if (!strcmp(argv[i], "-b"))
+         opt = &num_background;
+
+      if (!opt || i + 1 >= argc)
+      {
+         fprintf(stderr, "Usage: %s [-n entries] [-w window] "
+               "[-s steps] [-b background tweens]\n", argv[0]);
+         return 1;
+      }
+
+      *opt = (unsigned)strtoul(argv[++i], NULL, 10);
+   }
+
+   if (!entries || !steps)
+      return 1;
+
+   nodes      = (struct bench_node*)calloc(entries, sizeof(*nodes));
+   background = (float*)calloc(num_background + 1, sizeof(*background));
+   if (!nodes || !background)
+      return 1;
+
+   menu_animation_init();
+
+   /* Tweens that stay alive for the whole run under another
+    * tag, e.g. the category icons, which kills must not touch. */
+   for (step = 0; step < num_background; step++)
+   {
+      menu_animation_ctx_entry_t entry;
+
+      entry.easing_enum  = EASING_LINEAR;
+      entry.tag          = (uintptr_t)background;
+      entry.duration     = 1e9f;
+      entry.target_value = 1.0f;
+      entry.subject      = &background[step];
+      entry.cb           = NULL;
+      entry.userdata     = NULL;
+
+      menu_animation_push(&entry);
+   }
+
+   tag = (uintptr_t)nodes;
+
+   for (step = 0; step < steps; step++)
+   {
+      unsigned j, first, last;
+      unsigned selection = step % entries;
+      retro_time_t start = cpu_features_get_time_usec();
+      retro_time_t mid;
+
+      first = selection > window ? selection - window : 0;
+      last  = selection + window < entries
+         ? selection + window : entries - 1;
+
+      menu_animation_kill_by_tag(&tag);
+
+      for (j = first; j <= last; j++)
+      {
+         struct bench_node *node = &nodes[j];
+         float y                 = ((float)j - selection) * 64.0f;
+
+         push_tween(&node->alpha,       j == selection ? 1.0f : 0.5f, tag);
+         push_tween(&node->label_alpha, j == selection ? 1.0f : 0.5f, tag);
+         push_tween(&node->zoom,        j == selection ? 1.0f : 0.5f, tag);
+         push_tween(&node->y,           y, tag);
+      }
+
+      pushed      += 4 * (last - first + 1);
+
+      mid          = cpu_features_get_time_usec();
+      change_time += mid - start;
+
+      menu_animation_update();
+
+      update_time += cpu_features_get_time_usec() - mid;
+   }
+
+   fprintf(stderr, "%u entries, %u steps, window %u, %u background tweens\n",
+         entries, steps, window, num_background);
+   fprintf(stderr, "  kill + push: %.3f us per selection change\n",
+         (double)change_time / steps);
+   fprintf(stderr, "  update     : %.3f us per frame\n",
+         (double)update_time / steps);
+   fprintf(stderr, "  %.1f M tweens pushed per second\n",
+         (double)pushed / (change_time + update_time));
+
+   menu_animation_free();
+
+   free(nodes);
+   free(background);
+
+   return 0;
+}
@@ -0,0 +1,423 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <netinet/tcp.h>
+
+#include <features/features_cpu.h>
+#include <net/net_compat.h>
+#include <net/net_socket.h>
+#include <retro_timers.h>
+
+#include "../../command.h"
+#include "../../configuration.h"
+#include "../../msg_hash.h"
+#include "../../retroarch.h"
+#include "../../tasks/tasks_internal.h"
+#include "../../network/netplay/netplay_private.h"
+
+/*
+ * Sets up a netplay server with N spectators connected over
+ * loopback and measures what its own code spends on them per
+ * frame. Nothing is reimplemented here: the server is a
+ * netplay_t, and the timed calls are netplay_io.c's.
+ *
+ * poll: a few of the spectators send an ACK each frame, and
+ * the server reads them with netplay_poll_net_input, on
+ * alternate frames through the epoll path and through the
+ * select path, which reads every connection.
+ *
+ * fanout: two players' input is sent to every spectator,
+ * alternately by calling netplay_send_cur_input for each
+ * spectator, as the server used to, and by one call to
+ * netplay_send_cur_input_all. A bare send() of as many bytes
+ * to each spectator is the floor either can reach.
+ *
+ * Linux only, like the epoll path.
+ *
+ * Usage: netplay_spectators_bench [-m poll|fanout] [-n spectators]
+ *                                 [-f frames] [-k senders per frame]
+ *
+ * return codes -
+ * normal   exit: 0
+ * error    exit: 1
+ */
+
+#define BENCH_PLAYERS 2
+
+/* Called from paths this benchmark doesn't take */
+bool discord_is_inited = false;
+static settings_t bench_settings;
+
+settings_t *config_get_ptr(void)
+{
+   return &bench_settings;
+}
+
+bool command_event(enum event_command action, void *data)
+{
+   return false;
+}
+
+const char *msg_hash_to_str(enum msg_hash_enums msg)
+{
+   return "";
+}
+
+void runloop_msg_queue_push(const char *msg,
+      unsigned prio, unsigned duration,
+      bool flush,
+      char *title,
+      enum message_queue_icon icon, enum message_queue_category category)
+{
+}
+
+bool task_push_netplay_nat_traversal(void *nat_traversal_state, uint16_t port)
+{
+   return false;
+}
+
+bool netplay_handshake(netplay_t *netplay,
+   struct netplay_connection *connection, bool *had_input)
+{
+   return false;
+}
+
+uint8_t netplay_settings_share_mode(void)
+{
+   return 0;
+}
+
+bool netplay_wait_and_init_serialization(netplay_t *netplay)
+{
+   return true;
+}
+
+void netplay_update_unread_ptr(netplay_t *netplay)
+{
+}
+
+/* Connects @num spectators, returning their ends of the connections and
+ * registering the server's ends with @netplay */
+static int *bench_connect(netplay_t *netplay, unsigned num)
+{
+   unsigned i;
+   int one            = 1;
+   int listen_fd      = -1;
+   struct sockaddr_in addr;
+   socklen_t addr_len = sizeof(addr);
+   int *client_fds    = (int*)calloc(num, sizeof(*client_fds));
+
+   netplay->connections      = (struct netplay_connection*)
+      calloc(num, sizeof(*netplay->connections));
+   netplay->connections_size = num;
+
+   if (!client_fds || !netplay->connections)
+      goto error;
+
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family      = AF_INET;
+   addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+   listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+   if (     listen_fd < 0
+         || bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0
+         || listen(listen_fd, 128) < 0
+         || getsockname(listen_fd, (struct sockaddr*)&addr, &addr_len) < 0)
+      goto error;
+
+   for (i = 0; i < num; i++)
+   {
+      struct netplay_connection *connection = &netplay->connections[i];
+
+      client_fds[i] = socket(AF_INET, SOCK_STREAM, 0);
+      if (     client_fds[i] < 0
+            || connect(client_fds[i], (struct sockaddr*)&addr,
+               sizeof(addr)) < 0)
+         goto error;
+
+      connection->fd = accept(listen_fd, NULL, NULL);
+      if (     connection->fd < 0
+            || !socket_nonblock(connection->fd)
+            || !socket_nonblock(client_fds[i])
+            || !netplay_init_socket_buffer(&connection->recv_packet_buffer,
+               netplay->packet_buffer_size)
+            || !netplay_init_socket_buffer(&connection->send_packet_buffer,
+               netplay->packet_buffer_size))
+         goto error;
+
+      setsockopt(client_fds[i], IPPROTO_TCP, TCP_NODELAY,
+            (const char*)&one, sizeof(one));
+      setsockopt(connection->fd, IPPROTO_TCP, TCP_NODELAY,
+            (const char*)&one, sizeof(one));
+
+      connection->active = true;
+      connection->mode   = NETPLAY_CONNECTION_SPECTATING;
+
+      if (!netplay_poll_add(netplay, connection))
+         goto error;
+   }
+
+   socket_close(listen_fd);
+   return client_fds;
+
+error:
+   fprintf(stderr, "Could not connect spectator %u\n", i);
+   if (listen_fd >= 0)
+      socket_close(listen_fd);
+   free(client_fds);
+   return NULL;
+}
+
+static unsigned bench_active(netplay_t *netplay)
+{
+   size_t i;
+   unsigned active = 0;
+
+   for (i = 0; i < netplay->connections_size; i++)
+      if (netplay->connections[i].active)
+         active++;
+
+   return active;
+}
+
+static void bench_poll(netplay_t *netplay, int *client_fds,
+      unsigned frames, unsigned senders)
+{
+   unsigned i, frame;
+   uint32_t ack[2];
+   unsigned num            = (unsigned)netplay->connections_size;
+   int poll_fd             = netplay->poll_fd;
+   retro_time_t all_time   = 0;
+   retro_time_t epoll_time = 0;
+
+   if (poll_fd < 0)
+      return;
+
+   ack[0] = htonl(NETPLAY_CMD_ACK);
+   ack[1] = htonl(0);
+
+   for (frame = 0; frame < frames; frame++)
+   {
+      retro_time_t start;
+
+      for (i = 0; i < senders; i++)
+         send(client_fds[(frame * 7 + i * 13) % num],
+               (const char*)ack, sizeof(ack), 0);
+
+      /* Let loopback deliver them */
+      retro_sleep(1);
+
+      /* Without a poller, netplay_poll_net_input takes the select path */
+      netplay->poll_fd = (frame & 1) ? poll_fd : -1;
+
+      start = cpu_features_get_time_usec();
+      netplay_poll_net_input(netplay, false);
+
+      if (frame & 1)
+         epoll_time += cpu_features_get_time_usec() - start;
+      else
+         all_time   += cpu_features_get_time_usec() - start;
+   }
+
+   netplay->poll_fd = poll_fd;
+
+   fprintf(stderr, "poll: %u spectators, %u senders per frame\n",
+         num, senders);
+   fprintf(stderr, "  select path: %9.1f us per frame\n",
+         (double)all_time / (frames / 2));
+   fprintf(stderr, "  epoll path : %9.1f us per frame\n",
+         (double)epoll_time / (frames - frames / 2));
+   fprintf(stderr, "  %u of %u spectators still connected\n",
+         bench_active(netplay), num);
+}
+
+/* The spectators read what they're sent, so that their windows stay open.
+ * Returns how much the first of them got. */
+static size_t bench_drain(int *client_fds, unsigned num)
+{
+   unsigned i;
+   char buf[4096];
+   size_t first = 0;
+
+   for (i = 0; i < num; i++)
+   {
+      ssize_t got;
+
+      while ((got = recv(client_fds[i], buf, sizeof(buf), 0)) > 0)
+         if (i == 0)
+            first += got;
+   }
+
+   return first;
+}
+
+static void bench_fanout(netplay_t *netplay, int *client_fds,
+      unsigned frames)
+{
+   unsigned i, frame;
+   char packet[4096];
+   struct delta_frame *dframe = &netplay->buffer[netplay->self_ptr];
+   unsigned num               = (unsigned)netplay->connections_size;
+   size_t packet_size         = 0;
+   retro_time_t spent[3]      = {0};
+   unsigned runs[3]           = {0};
+
+   memset(packet, 0, sizeof(packet));
+
+   for (frame = 0; frame < frames; frame++)
+   {
+      unsigned mode = frame % 3;
+      retro_time_t start;
+      uint32_t client;
+      size_t got;
+
+      netplay->self_frame_count = frame;
+      dframe->frame             = frame;
+      for (client = 1; client <= BENCH_PLAYERS; client++)
+         dframe->real_input[client - 1]->data[0] = frame * client;
+
+      start = cpu_features_get_time_usec();
+
+      switch (mode)
+      {
+         case 0:
+            for (i = 0; i < num; i++)
+               netplay_send_cur_input(netplay, &netplay->connections[i]);
+            break;
+         case 1:
+            netplay_send_cur_input_all(netplay);
+            break;
+         default:
+            for (i = 0; i < num; i++)
+               send(netplay->connections[i].fd, packet, packet_size,
+                     MSG_NOSIGNAL);
+            break;
+      }
+
+      spent[mode] += cpu_features_get_time_usec() - start;
+      runs[mode]++;
+
+      got = bench_drain(client_fds, num);
+      if (mode == 1 && got <= sizeof(packet))
+         packet_size = got;
+   }
+
+   fprintf(stderr, "fanout: %u spectators, %u players, %u bytes each\n",
+         num, BENCH_PLAYERS, (unsigned)packet_size);
+   fprintf(stderr, "  netplay_send_cur_input each: %9.1f us per frame "
+         "(%.3f us each)\n",
+         (double)spent[0] / runs[0], (double)spent[0] / runs[0] / num);
+   fprintf(stderr, "  netplay_send_cur_input_all : %9.1f us per frame "
+         "(%.3f us each)\n",
+         (double)spent[1] / runs[1], (double)spent[1] / runs[1] / num);
+   fprintf(stderr, "  bare send()                : %9.1f us per frame "
+         "(%.3f us each)\n",
+         (double)spent[2] / runs[2], (double)spent[2] / runs[2] / num);
+   fprintf(stderr, "  %u of %u spectators still connected\n",
+         bench_active(netplay), num);
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   netplay_t netplay;
+   struct delta_frame dframe;
+   uint32_t client;
+   int *client_fds  = NULL;
+   unsigned num     = 256;
+   unsigned frames  = 2000;
+   unsigned senders = 2;
+   const char *mode = "poll";
+   int ret          = 1;
+
+   for (i = 1; i < argc; i++)
+   {
+      unsigned *opt = NULL;
+
+      if (!strcmp(argv[i], "-m") && i + 1 < argc)
+      {
+         mode = argv[++i];
+         continue;
+      }
+      else if (!strcmp(argv[i], "-n"))
+         opt = &num;
+      else if (!strcmp(argv[i], "-f"))
+         opt = &frames;
+      else if (!strcmp(argv[i], "-k"))
+         opt = &senders;
+
+      if (!opt || i + 1 >= argc)
+      {
+         fprintf(stderr, "Usage: %s [-m poll|fanout] [-n spectators] "
+               "[-f frames] [-k senders per frame]\n", argv[0]);
+         return 1;
+      }
+
+      *opt = (unsigned)strtoul(argv[++i], NULL, 10);
+   }
+
+   if (!num || frames < 3 || !network_init())
+      return 1;
+
+   if (strcmp(mode, "poll") && strcmp(mode, "fanout"))
+      return 1;
+
+   /* A server that isn't playing, with two players connected elsewhere */
+   memset(&netplay, 0, sizeof(netplay));
+   memset(&dframe, 0, sizeof(dframe));
+   netplay.is_server          = true;
+   netplay.udp_fd             = -1;
+   netplay.self_mode          = NETPLAY_CONNECTION_SPECTATING;
+   netplay.packet_buffer_size = 65536;
+   netplay.buffer             = &dframe;
+   netplay.buffer_size        = 1;
+   dframe.used                = true;
+
+   for (client = 1; client <= BENCH_PLAYERS; client++)
+   {
+      netplay_input_state_t istate = netplay_input_state_for(
+            &dframe.real_input[client - 1], client, 1, true, false);
+
+      if (!istate)
+         return 1;
+
+      istate->used                  = true;
+      dframe.have_real[client]      = true;
+      netplay.client_devices[client] = 1 << (client - 1);
+      netplay.connected_players    |= 1 << client;
+   }
+
+   netplay_poll_init(&netplay);
+
+   if (!(client_fds = bench_connect(&netplay, num)))
+      goto end;
+
+   if (!strcmp(mode, "poll"))
+      bench_poll(&netplay, client_fds, frames, senders);
+   else
+      bench_fanout(&netplay, client_fds, frames);
+
+   ret = 0;
+
+end:
+   for (i = 0; i < (int)netplay.connections_size; i++)
+   {
+      struct netplay_connection *connection = &netplay.connections[i];
+
+      if (client_fds && client_fds[i] > 0)
+         socket_close(client_fds[i]);
+      if (connection->active)
+      {
+         socket_close(connection->fd);
+         netplay_deinit_socket_buffer(&connection->recv_packet_buffer);
+         netplay_deinit_socket_buffer(&connection->send_packet_buffer);
+      }
+   }
+   netplay_poll_deinit(&netplay);
+   netplay_delta_frame_free(&dframe);
+   free(netplay.connections);
+   free(client_fds);
+
+   return ret;
+}
@@ -0,0 +1,272 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <features/features_cpu.h>
+#include <net/net_compat.h>
+#include <retro_timers.h>
+
+#include "../../network/netplay/netplay_private.h"
+
+/*
+ * Measures how late a client's input reaches the server over a
+ * lossy link, with and without the input datagrams, at one input
+ * frame per frame period.
+ *
+ * The datagrams go through netplay_udp.c over loopback, with its
+ * debugging shim dropping, delaying and reordering them, so the
+ * link is set when building:
+ *
+ *    make clean && make LOSS=5 DELAY=20 JITTER=4
+ *
+ * TCP can't lose segments over loopback, so its copy of each
+ * input frame is delivered by a model of the same link instead:
+ * DELAY milliseconds after it was sent, or, when lost, after a
+ * fast retransmit (three more segments, then a round trip), and
+ * never before the frame ahead of it.
+ *
+ * The delay reported is how long past the link's one-way delay a
+ * frame's input arrived, in frames; a rollback goes back at least
+ * that far.
+ *
+ * Usage: netplay_udp_bench [-n frames] [-f frame period in us]
+ *
+ * return codes -
+ * normal   exit: 0
+ * error    exit: 1
+ */
+
+#ifndef DEBUG_NETPLAY_UDP_LOSS
+#define DEBUG_NETPLAY_UDP_LOSS 0
+#endif
+#ifndef DEBUG_NETPLAY_UDP_DELAY
+#define DEBUG_NETPLAY_UDP_DELAY 0
+#endif
+
+#define BENCH_PORT   "55436"
+#define BENCH_CLIENT 1
+
+static retro_time_t *bench_arrival = NULL;
+static uint32_t bench_udp_token    = 0;
+static bool bench_have_token       = false;
+
+int netplay_store_input(netplay_t *netplay,
+   struct netplay_connection *connection, uint32_t client_num,
+   const uint32_t *input)
+{
+   bench_arrival[netplay->read_frame_count[client_num]] =
+      cpu_features_get_time_usec();
+   netplay->read_frame_count[client_num]++;
+   return 1;
+}
+
+uint32_t netplay_expected_input_size(netplay_t *netplay, uint32_t devices)
+{
+   return 1;
+}
+
+/* The server hands out the token over TCP; pass it straight on */
+bool netplay_send_raw_cmd(netplay_t *netplay,
+   struct netplay_connection *connection, uint32_t cmd, const void *data,
+   size_t size)
+{
+   if (cmd == NETPLAY_CMD_UDP_TOKEN && size == sizeof(uint32_t))
+   {
+      bench_udp_token  = ntohl(*(const uint32_t*)data);
+      bench_have_token = true;
+   }
+   return true;
+}
+
+static int bench_cmp(const void *a, const void *b)
+{
+   double x = *(const double*)a;
+   double y = *(const double*)b;
+   return (x < y) ? -1 : (x > y);
+}
+
+static bool bench_run(const struct addrinfo *addr, unsigned frames,
+      retro_time_t period, bool use_udp, double *mean, double *p99)
+{
+   netplay_t server;
+   netplay_t client;
+   struct netplay_connection server_conn;
+   struct netplay_connection client_conn;
+   struct sockaddr_in *peer  = (struct sockaddr_in*)&server_conn.addr;
+   retro_time_t owd          = DEBUG_NETPLAY_UDP_DELAY * 1000;
+   retro_time_t *sent        = NULL;
+   retro_time_t *tcp_due     = NULL;
+   double *late              = NULL;
+   unsigned sent_frames      = 0;
+   retro_time_t start;
+   unsigned i;
+   bool ret                  = false;
+
+   memset(&server, 0, sizeof(server));
+   memset(&client, 0, sizeof(client));
+   memset(&server_conn, 0, sizeof(server_conn));
+   memset(&client_conn, 0, sizeof(client_conn));
+
+   sent          = (retro_time_t*)calloc(frames, sizeof(*sent));
+   tcp_due       = (retro_time_t*)calloc(frames, sizeof(*tcp_due));
+   late          = (double*)calloc(frames, sizeof(*late));
+   bench_arrival = (retro_time_t*)calloc(frames, sizeof(*bench_arrival));
+   if (!sent || !tcp_due || !late || !bench_arrival)
+      goto end;
+
+   server.is_server = true;
+   server.udp_fd    = -1;
+   client.udp_fd    = -1;
+   if (!netplay_udp_init(&server, addr) || !netplay_udp_init(&client, addr))
+      goto end;
+
+   server.connections          = &server_conn;
+   server.connections_size     = 1;
+   client.connections          = &client_conn;
+   client.connections_size     = 1;
+   server.connected_players    = 1 << BENCH_CLIENT;
+   client.connected_players    = 1 << BENCH_CLIENT;
+   server_conn.active          = client_conn.active = true;
+   server_conn.mode            = client_conn.mode   = NETPLAY_CONNECTION_PLAYING;
+   server_conn.udp             = client_conn.udp    = use_udp;
+   server_conn.udp_token       = 0x1234;
+   peer->sin_family            = AF_INET;
+   peer->sin_addr.s_addr       = htonl(INADDR_LOOPBACK);
+   bench_have_token            = false;
+
+   srand(1);
+   start = cpu_features_get_time_usec();
+
+   while (server.read_frame_count[BENCH_CLIENT] < frames)
+   {
+      retro_time_t now = cpu_features_get_time_usec();
+
+      if (sent_frames < frames && now >= start + sent_frames * period)
+      {
+         uint32_t cmd[5];
+
+         cmd[0] = htonl(NETPLAY_CMD_INPUT);
+         cmd[1] = htonl(3 * sizeof(uint32_t));
+         cmd[2] = htonl(sent_frames);
+         cmd[3] = htonl(BENCH_CLIENT);
+         cmd[4] = htonl(sent_frames);
+         netplay_udp_record(&client, &client_conn, cmd, 5);
+
+         sent[sent_frames]    = now;
+         tcp_due[sent_frames] = now + owd;
+         if (rand() % 100 < DEBUG_NETPLAY_UDP_LOSS)
+            tcp_due[sent_frames] += 3 * period + 3 * owd;
+         if (sent_frames && tcp_due[sent_frames] < tcp_due[sent_frames - 1])
+            tcp_due[sent_frames] = tcp_due[sent_frames - 1];
+         sent_frames++;
+
+         /* The server sends every frame too, which is what gets the
+          * client its token */
+         netplay_udp_send(&server, &server_conn);
+         if (bench_have_token && !client_conn.udp_token_sent)
+         {
+            client_conn.udp_token      = bench_udp_token;
+            client_conn.udp_token_sent = true;
+         }
+         netplay_udp_send(&client, &client_conn);
+      }
+
+      netplay_udp_receive(&server);
+      netplay_udp_receive(&client);
+
+      /* Whatever TCP has delivered by now */
+      while (server.read_frame_count[BENCH_CLIENT] < sent_frames &&
+            tcp_due[server.read_frame_count[BENCH_CLIENT]] <= now)
+      {
+         uint32_t input = 0;
+         netplay_store_input(&server, &server_conn, BENCH_CLIENT, &input);
+      }
+
+      retro_sleep(1);
+   }
+
+   *mean = 0;
+   for (i = 0; i < frames; i++)
+   {
+      late[i] = (double)(bench_arrival[i] - sent[i] - owd) / period;
+      if (late[i] < 0)
+         late[i] = 0;
+      *mean  += late[i];
+   }
+   *mean /= frames;
+
+   qsort(late, frames, sizeof(*late), bench_cmp);
+   *p99 = late[frames * 99 / 100];
+   ret  = true;
+
+end:
+   netplay_udp_free_connection(&server_conn);
+   netplay_udp_free_connection(&client_conn);
+   netplay_udp_deinit(&server);
+   netplay_udp_deinit(&client);
+   free(sent);
+   free(tcp_due);
+   free(late);
+   free(bench_arrival);
+   bench_arrival = NULL;
+   return ret;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   struct addrinfo hints;
+   struct addrinfo *addr = NULL;
+   unsigned frames       = 1200;
+   unsigned period       = 16667;
+   double tcp_mean       = 0;
+   double tcp_p99        = 0;
+   double udp_mean       = 0;
+   double udp_p99        = 0;
+
+   for (i = 1; i < argc; i++)
+   {
+      unsigned *opt = NULL;
+
+      if (!strcmp(argv[i], "-n"))
+         opt = &frames;
+      else if (!strcmp(argv[i], "-f"))
+         opt = &period;
+
+      if (!opt || i + 1 >= argc)
+      {
+         fprintf(stderr, "Usage: %s [-n frames] "
+               "[-f frame period in us]\n", argv[0]);
+         return 1;
+      }
+
+      *opt = (unsigned)strtoul(argv[++i], NULL, 10);
+   }
+
+   if (!frames || !period || !network_init())
+      return 1;
+
+   memset(&hints, 0, sizeof(hints));
+   hints.ai_family   = AF_INET;
+   hints.ai_socktype = SOCK_DGRAM;
+   if (getaddrinfo("127.0.0.1", BENCH_PORT, &hints, &addr) != 0 || !addr)
+      return 1;
+
+   if (     !bench_run(addr, frames, period, false, &tcp_mean, &tcp_p99)
+         || !bench_run(addr, frames, period, true,  &udp_mean, &udp_p99))
+   {
+      freeaddrinfo(addr);
+      return 1;
+   }
+
+   freeaddrinfo(addr);
+
+   fprintf(stderr, "%u frames of %u us, %d ms one-way, %d%% loss\n",
+         frames, period, DEBUG_NETPLAY_UDP_DELAY, DEBUG_NETPLAY_UDP_LOSS);
+   fprintf(stderr, "  TCP        : mean %.3f, p99 %.2f frames late\n",
+         tcp_mean, tcp_p99);
+   fprintf(stderr, "  TCP + UDP  : mean %.3f, p99 %.2f frames late\n",
+         udp_mean, udp_p99);
+
+   return 0;
+}
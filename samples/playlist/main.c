@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <features/features_cpu.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
+
+#include "../../configuration.h"
+#include "../../playlist.h"
+
+/*
+ * Imports a collection into an empty playlist the way the
+ * database scanner does, checking each path and pushing it,
+ * then times the other path lookups, bumping existing entries
+ * to the top, and writing and loading the playlist file.
+ *
+ * Usage: playlist_bench [-n entries] [-o playlist path]
+ *
+ * return codes -
+ * normal   exit: 0
+ * error    exit: 1
+ */
+
+#define BENCH_CORE_PATH "/cores/bench_libretro.so"
+#define BENCH_CORE_NAME "Bench"
+
+static settings_t bench_settings;
+
+settings_t *config_get_ptr(void)
+{
+   return &bench_settings;
+}
+
+static void bench_path(char *s, size_t len, unsigned i)
+{
+   snprintf(s, len, "/roms/system/game %u.zip", i);
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned entry;
+   char path[256];
+   playlist_t *playlist     = NULL;
+   const char *out          = "playlist_bench.lpl";
+   unsigned entries         = 20000;
+   unsigned hits            = 0;
+   retro_time_t start;
+   retro_time_t exists_time = 0;
+   retro_time_t push_time   = 0;
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         entries = (unsigned)strtoul(argv[++i], NULL, 10);
+      else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+         out = argv[++i];
+      else
+      {
+         fprintf(stderr, "Usage: %s [-n entries] [-o playlist path]\n",
+               argv[0]);
+         return 1;
+      }
+   }
+
+   if (!entries)
+      return 1;
+
+   filestream_delete(out);
+
+   if (!(playlist = playlist_init(out, entries)))
+      return 1;
+
+   /* What the database scanner does for each match */
+   for (entry = 0; entry < entries; entry++)
+   {
+      bench_path(path, sizeof(path), entry);
+
+      start        = cpu_features_get_time_usec();
+      hits        += playlist_entry_exists(playlist, path, "DETECT");
+      exists_time += cpu_features_get_time_usec() - start;
+
+      start        = cpu_features_get_time_usec();
+      playlist_push(playlist, path, path + 13, BENCH_CORE_PATH,
+            BENCH_CORE_NAME, "DETECT", "Bench.lpl");
+      push_time   += cpu_features_get_time_usec() - start;
+   }
+
+   fprintf(stderr, "%u entries\n", entries);
+   fprintf(stderr, "  import     : %9.3f ms (%.3f ms in exists, "
+         "%u already there)\n",
+         (exists_time + push_time) / 1000.0, exists_time / 1000.0, hits);
+
+   /* Lookups, half of which miss */
+   srand(1);
+   hits  = 0;
+   start = cpu_features_get_time_usec();
+   for (entry = 0; entry < entries; entry++)
+   {
+      bench_path(path, sizeof(path), (unsigned)rand() % (entries * 2));
+      hits += playlist_entry_exists(playlist, path, NULL);
+   }
+   fprintf(stderr, "  lookups    : %9.3f ms for %u (%u hits)\n",
+         (cpu_features_get_time_usec() - start) / 1000.0, entries, hits);
+
+   /* Pushing existing entries moves them to the top */
+   start = cpu_features_get_time_usec();
+   for (entry = 0; entry < entries / 4; entry++)
+   {
+      bench_path(path, sizeof(path), (unsigned)rand() % entries);
+      playlist_push(playlist, path, path + 13, BENCH_CORE_PATH,
+            BENCH_CORE_NAME, "DETECT", "Bench.lpl");
+   }
+   fprintf(stderr, "  bump       : %9.3f ms for %u\n",
+         (cpu_features_get_time_usec() - start) / 1000.0, entries / 4);
+
+   start = cpu_features_get_time_usec();
+   playlist_write_file(playlist);
+   fprintf(stderr, "  write      : %9.3f ms\n",
+         (cpu_features_get_time_usec() - start) / 1000.0);
+
+   playlist_free(playlist);
+
+   start    = cpu_features_get_time_usec();
+   playlist = playlist_init(out, entries);
+   fprintf(stderr, "  load       : %9.3f ms (%u entries)\n",
+         (cpu_features_get_time_usec() - start) / 1000.0,
+         playlist ? (unsigned)playlist_size(playlist) : 0);
+
+   playlist_free(playlist);
+   filestream_delete(out);
+
+   return 0;
+}
@@ -750,7 +750,9 @@ static int task_database_iterate_next(database_info_handle_t *db)
 static int database_info_list_iterate_new(database_state_handle_t *db_state,
       const char *query)
 {
-   const char *new_database = database_info_get_current_name(db_state);
+   /* Matching only needs these, and a playlist entry their name */
+   static const char *fields[] = { "name", "crc", "serial" };
+   const char *new_database    = database_info_get_current_name(db_state);
 
 #ifndef RARCH_INTERNAL
    fprintf(stderr, "Check database [%d/%d] : %s\n", (unsigned)db_state->list_index,
@@ -761,7 +763,8 @@ static int database_info_list_iterate_new(database_state_handle_t *db_state,
       database_info_list_free(db_state->info);
       free(db_state->info);
    }
-   db_state->info = database_info_list_new(new_database, query);
+   db_state->info = database_info_list_new_fields(new_database, query,
+         fields, ARRAY_SIZE(fields));
    return 0;
 }
 
@@ -0,0 +1,259 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <lists/dir_list.h>
+#include <lists/string_list.h>
+#include <queues/task_queue.h>
+#include <string/stdstring.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#include "tasks_internal.h"
+
+/* Number of files listed per iteration of the task */
+#define TASK_DIR_LIST_BATCH 256
+
+/* Shared by the task and its owner, freed
+ * once both let go of it */
+struct task_dir_list
+{
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+   struct dir_list_stream *stream;
+   /* Sorted files not taken by the owner yet */
+   struct string_list *pending;
+   char *dir;
+   char *exts;
+   unsigned refs;
+   bool include_dirs;
+   bool include_hidden;
+   bool include_compressed;
+   bool cancelled;
+   bool finished;
+   bool error;
+};
+
+static void task_dir_list_lock(task_dir_list_t *handle)
+{
+#ifdef HAVE_THREADS
+   slock_lock(handle->lock);
+#endif
+}
+
+static void task_dir_list_unlock(task_dir_list_t *handle)
+{
+#ifdef HAVE_THREADS
+   slock_unlock(handle->lock);
+#endif
+}
+
+static void task_dir_list_unref(task_dir_list_t *handle)
+{
+   unsigned refs;
+
+   task_dir_list_lock(handle);
+   refs = --handle->refs;
+   task_dir_list_unlock(handle);
+
+   if (refs)
+      return;
+
+   dir_list_stream_free(handle->stream);
+   string_list_free(handle->pending);
+#ifdef HAVE_THREADS
+   slock_free(handle->lock);
+#endif
+   free(handle->dir);
+   free(handle->exts);
+   free(handle);
+}
+
+static void task_dir_list_handler(retro_task_t *task)
+{
+   task_dir_list_t *handle   = (task_dir_list_t*)task->state;
+   struct string_list *batch = NULL;
+   bool cancelled            = false;
+   int ret                   = -1;
+
+   task_dir_list_lock(handle);
+   cancelled = handle->cancelled;
+   task_dir_list_unlock(handle);
+
+   if (task_get_cancelled(task))
+      cancelled = true;
+
+   if (cancelled)
+      goto end;
+
+   /* Opening may already take a while on slow drives,
+    * so that happens here rather than on push */
+   if (!handle->stream)
+   {
+      handle->stream = dir_list_stream_new(handle->dir, handle->exts,
+            handle->include_dirs, handle->include_hidden,
+            handle->include_compressed);
+
+      if (!handle->stream)
+         goto end;
+   }
+
+   if (!(batch = string_list_new()))
+      goto end;
+
+   ret = dir_list_stream_read(handle->stream, batch, TASK_DIR_LIST_BATCH);
+
+   if (ret == -1)
+      goto end;
+
+   /* Batches are sorted here so that the owner
+    * only has to merge them */
+   dir_list_sort(batch, true);
+
+   task_dir_list_lock(handle);
+   if (!dir_list_merge(handle->pending, batch, true))
+      ret = -1;
+   task_dir_list_unlock(handle);
+
+   if (ret == 1)
+   {
+      string_list_free(batch);
+      return;
+   }
+
+end:
+   string_list_free(batch);
+
+   task_dir_list_lock(handle);
+   handle->finished = true;
+   handle->error    = ret == -1 && !cancelled;
+   task_dir_list_unlock(handle);
+
+   task_set_progress(task, 100);
+   task_set_finished(task, true);
+}
+
+static void task_dir_list_cleanup(retro_task_t *task)
+{
+   task_dir_list_t *handle = (task_dir_list_t*)task->state;
+
+   dir_list_stream_free(handle->stream);
+   handle->stream = NULL;
+
+   task_dir_list_unref(handle);
+}
+
+task_dir_list_t *task_push_dir_list(const char *dir, const char *exts,
+      bool include_dirs, bool include_hidden, bool include_compressed)
+{
+   retro_task_t *task      = NULL;
+   task_dir_list_t *handle = NULL;
+
+   if (string_is_empty(dir))
+      return NULL;
+
+   handle = (task_dir_list_t*)calloc(1, sizeof(*handle));
+
+   if (!handle)
+      return NULL;
+
+#ifdef HAVE_THREADS
+   if (!(handle->lock = slock_new()))
+      goto error;
+#endif
+
+   handle->pending            = string_list_new();
+   handle->dir                = strdup(dir);
+   handle->exts               = string_is_empty(exts) ? NULL : strdup(exts);
+   handle->include_dirs       = include_dirs;
+   handle->include_hidden     = include_hidden;
+   handle->include_compressed = include_compressed;
+   /* One for the task and one for the owner */
+   handle->refs               = 2;
+
+   if (!handle->pending || !handle->dir)
+      goto error;
+
+   if (!(task = task_init()))
+      goto error;
+
+   task->type     = TASK_TYPE_NONE;
+   task->state    = handle;
+   task->handler  = task_dir_list_handler;
+   task->cleanup  = task_dir_list_cleanup;
+   task->mute     = true;
+   task->progress = -1;
+
+   task_queue_push(task);
+
+   return handle;
+
+error:
+   string_list_free(handle->pending);
+#ifdef HAVE_THREADS
+   if (handle->lock)
+      slock_free(handle->lock);
+#endif
+   free(handle->dir);
+   free(handle->exts);
+   free(handle);
+   return NULL;
+}
+
+bool task_dir_list_poll(task_dir_list_t *handle, bool *pending)
+{
+   bool finished;
+
+   task_dir_list_lock(handle);
+   finished = handle->finished;
+   if (pending)
+      *pending = handle->pending->size > 0;
+   task_dir_list_unlock(handle);
+
+   return finished;
+}
+
+bool task_dir_list_take(task_dir_list_t *handle,
+      struct string_list *list, bool *error)
+{
+   bool finished;
+   bool merged;
+
+   task_dir_list_lock(handle);
+   merged   = dir_list_merge(list, handle->pending, true);
+   finished = handle->finished;
+   if (error)
+      *error = handle->error || !merged;
+   task_dir_list_unlock(handle);
+
+   return finished || !merged;
+}
+
+void task_dir_list_free(task_dir_list_t *handle)
+{
+   if (!handle)
+      return;
+
+   task_dir_list_lock(handle);
+   handle->cancelled = true;
+   task_dir_list_unlock(handle);
+
+   task_dir_list_unref(handle);
+}
@@ -19,6 +19,7 @@
 #include <errno.h>
 
 #include <file/nbio.h>
+#include <features/features_cpu.h>
 #include <formats/image.h>
 #include <compat/strl.h>
 #include <string/stdstring.h>
@@ -199,6 +200,11 @@ static int cb_nbio_image_menu_thumbnail(void *data, size_t len)
 
    image_transfer_set_buffer_ptr(image->handle, image->type, ptr);
 
+   /* Large boxart can inflate on a second core while
+    * this one unfilters the rows already available. */
+   image_transfer_set_threaded(image->handle, image->type,
+         cpu_features_get_core_amount() > 1);
+
    image->size                     = len;
    image->pos_increment            = (len / 2) ?
       ((unsigned)(len / 2)) : 1;
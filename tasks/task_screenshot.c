@@ -67,6 +67,7 @@ struct screenshot_task_state
    unsigned width;
    unsigned height;
    unsigned pixel_format_type;
+   unsigned compression;
    uint8_t *out_buffer;
    const void *frame;
    char filename[PATH_MAX_LENGTH];
@@ -102,12 +103,13 @@ static bool screenshot_dump_direct(screenshot_task_state_t *state)
 
    scaler_ctx_gen_reset(&state->scaler);
 
-   ret = rpng_save_image_bgr24(
+   ret = rpng_save_image_bgr24_level(
          state->filename,
          state->out_buffer,
          state->width,
          state->height,
-         state->width * 3
+         state->width * 3,
+         state->compression
          );
 
    free(state->out_buffer);
@@ -227,6 +229,7 @@ static bool screenshot_dump(
    state->silence             = savestate;
    state->history_list_enable = settings->bools.history_list_enable;
    state->pixel_format_type   = video_driver_get_pixel_format();
+   state->compression         = settings->uints.screenshot_compression;
 
    if (!fullpath)
    {
@@ -22,6 +22,7 @@
 #include <retro_common_api.h>
 #include <retro_miscellaneous.h>
 
+#include <lists/string_list.h>
 #include <queues/task_queue.h>
 
 #ifdef HAVE_CONFIG_H
@@ -58,6 +59,29 @@ bool task_push_netplay_nat_traversal(void *nat_traversal_state, uint16_t port);
 
 #endif
 
+typedef struct task_dir_list task_dir_list_t;
+
+/* Lists a directory in the background, see dir_list_new()
+ * for the arguments. The files are collected from the
+ * returned handle with task_dir_list_take(), which has
+ * to be freed with task_dir_list_free() when done. */
+task_dir_list_t *task_push_dir_list(const char *dir, const char *exts,
+      bool include_dirs, bool include_hidden, bool include_compressed);
+
+/* Returns true once the whole directory has been listed.
+ * @pending is set if there are files to be taken. */
+bool task_dir_list_poll(task_dir_list_t *handle, bool *pending);
+
+/* Merges the files listed since the last call into the
+ * sorted listing @list, directories first. Returns true
+ * once the whole directory has been listed, @error is set
+ * if that failed. */
+bool task_dir_list_take(task_dir_list_t *handle,
+      struct string_list *list, bool *error);
+
+/* Stops the listing if it is still running. */
+void task_dir_list_free(task_dir_list_t *handle);
+
 bool task_push_image_load(const char *fullpath,
       retro_task_callback_t cb, void *userdata);
 